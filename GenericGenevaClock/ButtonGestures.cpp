@@ -0,0 +1,187 @@
+/////////////////////////////////////////////////////////////////////////////////
+// ButtonGestures.cpp
+//
+// Contains the implementation of the ButtonGestures class.  This recognizes
+// clicks, double clicks, long presses, and very long presses from the
+// pushbutton's timestamped edges.  See ButtonGestures.h for more information.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original code.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>                 // For memset().
+#include "ButtonGestures.h"         // For ButtonGestures class.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ButtonGestures()  (constructor)
+//
+// Starts with the button released.
+/////////////////////////////////////////////////////////////////////////////////
+ButtonGestures::ButtonGestures(uint64_t debounceUs, uint64_t doubleClickUs,
+                               uint64_t longPressUs, uint64_t veryLongPressUs) :
+    m_DebounceUs(debounceUs), m_DoubleClickUs(doubleClickUs), m_LongPressUs(longPressUs),
+    m_VeryLongPressUs(veryLongPressUs), m_Raw(false), m_RawUs(0), m_BurstUs(0),
+    m_Stable(false), m_PressUs(0), m_VeryLongSent(false), m_ClickPending(false),
+    m_ClickUs(0), m_Head(0), m_Count(0), m_Dropped(0)
+{
+    memset(m_Queue, 0, sizeof(m_Queue));
+} // End ButtonGestures().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// OnEdge()
+//
+// A change that follows a quiet spell starts a new burst.  Bounces within the
+// burst only push back the time the input must stay put till.
+/////////////////////////////////////////////////////////////////////////////////
+void ButtonGestures::OnEdge(bool pressed, uint64_t timeUs)
+{
+    Settle(timeUs);
+    if (pressed == m_Raw)
+    {
+        return;
+    }
+    if (timeUs - m_RawUs >= m_DebounceUs)
+    {
+        m_BurstUs = timeUs;
+    }
+    m_Raw   = pressed;
+    m_RawUs = timeUs;
+} // End OnEdge().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Poll()
+/////////////////////////////////////////////////////////////////////////////////
+void ButtonGestures::Poll(uint64_t nowUs)
+{
+    Settle(nowUs);
+    if (m_Stable)
+    {
+        // A press held this long is not the second click of a double click.
+        if (nowUs - m_PressUs >= m_LongPressUs)
+        {
+            FlushClick();
+        }
+        if (!m_VeryLongSent && (nowUs - m_PressUs >= m_VeryLongPressUs))
+        {
+            m_VeryLongSent = true;
+            Emit(ButtonVeryLongPress, m_PressUs + m_VeryLongPressUs);
+        }
+    }
+    else if (m_ClickPending && (nowUs - m_ClickUs >= m_DoubleClickUs))
+    {
+        FlushClick();
+    }
+} // End Poll().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Next()
+/////////////////////////////////////////////////////////////////////////////////
+bool ButtonGestures::Next(ButtonEvent_t &event)
+{
+    if (!m_Count)
+    {
+        return false;
+    }
+    event  = m_Queue[m_Head];
+    m_Head = (m_Head + 1) % QUEUE_SIZE;
+    m_Count--;
+    return true;
+} // End Next().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Settle()
+/////////////////////////////////////////////////////////////////////////////////
+void ButtonGestures::Settle(uint64_t nowUs)
+{
+    if ((m_Raw == m_Stable) || (nowUs - m_RawUs < m_DebounceUs))
+    {
+        return;
+    }
+    m_Stable = m_Raw;
+    if (m_Stable)
+    {
+        OnPress(m_BurstUs);
+    }
+    else
+    {
+        OnRelease(m_BurstUs);
+    }
+} // End Settle().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// OnPress(), OnRelease()
+//
+// A press too long after a pending click ends that click.  Otherwise the
+// click waits for this press's release to see whether it was a double click.
+// The release of a very long press was already reported.
+/////////////////////////////////////////////////////////////////////////////////
+void ButtonGestures::OnPress(uint64_t timeUs)
+{
+    if (m_ClickPending && (timeUs - m_ClickUs > m_DoubleClickUs))
+    {
+        FlushClick();
+    }
+    m_PressUs      = timeUs;
+    m_VeryLongSent = false;
+} // End OnPress().
+
+void ButtonGestures::OnRelease(uint64_t timeUs)
+{
+    if (m_VeryLongSent)
+    {
+        return;
+    }
+    if (timeUs - m_PressUs >= m_LongPressUs)
+    {
+        FlushClick();
+        Emit(ButtonLongPress, timeUs);
+    }
+    else if (m_ClickPending)
+    {
+        m_ClickPending = false;
+        Emit(ButtonDoubleClick, timeUs);
+    }
+    else
+    {
+        m_ClickPending = true;
+        m_ClickUs      = timeUs;
+    }
+} // End OnRelease().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// FlushClick()
+/////////////////////////////////////////////////////////////////////////////////
+void ButtonGestures::FlushClick()
+{
+    if (m_ClickPending)
+    {
+        m_ClickPending = false;
+        Emit(ButtonClick, m_ClickUs);
+    }
+} // End FlushClick().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Emit()
+/////////////////////////////////////////////////////////////////////////////////
+void ButtonGestures::Emit(ButtonGesture_t gesture, uint64_t timeUs)
+{
+    if (m_Count >= QUEUE_SIZE)
+    {
+        m_Dropped++;
+        return;
+    }
+    ButtonEvent_t &event = m_Queue[(m_Head + m_Count) % QUEUE_SIZE];
+    event.gesture = gesture;
+    event.timeUs  = timeUs;
+    m_Count++;
+} // End Emit().
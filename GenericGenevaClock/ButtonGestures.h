@@ -0,0 +1,215 @@
+/////////////////////////////////////////////////////////////////////////////////
+// ButtonGestures.h
+//
+// Contains the ButtonGestures class.  This turns the pushbutton's timestamped
+// edges, as captured by the board's pin change interrupt, into gestures:
+//      ButtonClick         - A short press, with no second press soon after.
+//      ButtonDoubleClick   - Two short presses in quick succession.
+//      ButtonLongPress     - A press held for LONG_PRESS_US or more, reported
+//                            when it is released.
+//      ButtonVeryLongPress - A press held for VERY_LONG_PRESS_US, reported
+//                            while it is still held.  Its release is ignored.
+//
+// Contact bounce is filtered using the edges' own times rather than delays:
+// a change only counts once the input has stayed put for DEBOUNCE_US, and the
+// change is then dated from the first edge of its burst.  Nothing here waits.
+// Edges are passed in with OnEdge(), the timers are run by Poll(), and the
+// gestures found are queued for Next().  A click is only reported once the
+// double click time has passed without a second press, or the second press
+// has been held for a long press.
+//
+// The class has no hardware dependencies, so it can be driven on the host with
+// made up edge traces.
+//
+// Example:
+//      ButtonGestures gestures;
+//      ...
+//      void ButtonTask(void *pArg)
+//      {
+//          InputEdge_t edge;
+//          while (gClock.NextInputEdge(edge))
+//          {
+//              gestures.OnEdge(edge.active, edge.timeUs);
+//          }
+//          gestures.Poll(gClock.Hal()->Micros());
+//          ButtonEvent_t event;
+//          while (gestures.Next(event)) { ... }
+//      }
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined BUTTONGESTURES_H
+#define BUTTONGESTURES_H
+
+#include <stdint.h>             // For standard integer types.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ButtonGesture_t
+//
+// The gestures that ButtonGestures recognizes.
+/////////////////////////////////////////////////////////////////////////////////
+enum ButtonGesture_t
+{
+    ButtonNone = 0,
+    ButtonClick,
+    ButtonDoubleClick,
+    ButtonLongPress,
+    ButtonVeryLongPress
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ButtonEvent_t
+//
+// A recognized gesture.  'timeUs' is when the gesture was complete: the
+// release that ended it, or for ButtonVeryLongPress, the time it had been
+// held long enough.
+/////////////////////////////////////////////////////////////////////////////////
+struct ButtonEvent_t
+{
+    ButtonGesture_t gesture;    // What was recognized.
+    uint64_t timeUs;            // When it was complete.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ButtonGestures class
+//
+// Recognizes pushbutton gestures from timestamped edges.
+/////////////////////////////////////////////////////////////////////////////////
+class ButtonGestures
+{
+public:
+    static const uint32_t QUEUE_SIZE = 8;                   // Most queued events.
+    static const uint64_t DEBOUNCE_US        = 50000;       // Default debounce.
+    static const uint64_t DOUBLE_CLICK_US    = 400000;      // Default double
+                                                            // click time.
+    static const uint64_t LONG_PRESS_US      = 3000000;     // Default long press.
+    static const uint64_t VERY_LONG_PRESS_US = 10000000;    // Default very long
+                                                            // press.
+
+    /////////////////////////////////////////////////////////////////////////////
+    // ButtonGestures()  (constructor)
+    //
+    // Arguments:
+    //   - debounceUs      - Time the input must be steady for a change to count.
+    //   - doubleClickUs   - Most time from the release of a click to the
+    //                       press of a second one for a double click.
+    //   - longPressUs     - Least hold time of a long press.
+    //   - veryLongPressUs - Hold time of a very long press.
+    /////////////////////////////////////////////////////////////////////////////
+    ButtonGestures(uint64_t debounceUs      = DEBOUNCE_US,
+                   uint64_t doubleClickUs   = DOUBLE_CLICK_US,
+                   uint64_t longPressUs     = LONG_PRESS_US,
+                   uint64_t veryLongPressUs = VERY_LONG_PRESS_US);
+
+    // Destructor.
+    ~ButtonGestures() {}
+
+    /////////////////////////////////////////////////////////////////////////////
+    // OnEdge()
+    //
+    // Passes in a change of the button input.  Edges must be passed in time
+    // order.  Repeats of the same state are ignored.
+    //
+    // Arguments:
+    //   - pressed - New state of the input: true if pressed.
+    //   - timeUs  - Time of the edge (e.g. InputEdge_t::timeUs).
+    /////////////////////////////////////////////////////////////////////////////
+    void OnEdge(bool pressed, uint64_t timeUs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Poll()
+    //
+    // Runs the debounce, double click, and very long press timers up to
+    // 'nowUs', which must be no earlier than the last edge.  Call
+    // periodically, e.g. every 20 ms, after passing in any new edges.
+    /////////////////////////////////////////////////////////////////////////////
+    void Poll(uint64_t nowUs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Next()
+    //
+    // Removes the oldest recognized gesture into 'event' and returns 'true',
+    // or returns 'false' if there is none.
+    /////////////////////////////////////////////////////////////////////////////
+    bool Next(ButtonEvent_t &event);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Accessors.
+    //
+    // IsPressed() - Returns the debounced state of the button.
+    // Dropped()   - Returns the number of events lost to a full queue.
+    /////////////////////////////////////////////////////////////////////////////
+    bool     IsPressed() const                      { return m_Stable; }
+    uint32_t Dropped() const                        { return m_Dropped; }
+
+private:
+    /////////////////////////////////////////////////////////////////////////////
+    // Private methods.
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Settle()
+    //
+    // Accepts the input's state as debounced if it has been steady since
+    // before 'nowUs' - DEBOUNCE.
+    /////////////////////////////////////////////////////////////////////////////
+    void Settle(uint64_t nowUs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // OnPress(), OnRelease()
+    //
+    // Handle a debounced press or release at 'timeUs'.
+    /////////////////////////////////////////////////////////////////////////////
+    void OnPress(uint64_t timeUs);
+    void OnRelease(uint64_t timeUs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // FlushClick()
+    //
+    // Reports a click that is waiting to see if it is a double click.
+    /////////////////////////////////////////////////////////////////////////////
+    void FlushClick();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Emit()
+    //
+    // Queues 'gesture' at 'timeUs'.
+    /////////////////////////////////////////////////////////////////////////////
+    void Emit(ButtonGesture_t gesture, uint64_t timeUs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Unimplemented methods.  We don't want users to try to use these.
+    /////////////////////////////////////////////////////////////////////////////
+    ButtonGestures(ButtonGestures const &);
+    ButtonGestures &operator=(ButtonGestures &bg);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private instance data.
+    /////////////////////////////////////////////////////////////////////////////
+    uint64_t m_DebounceUs;          // Debounce time.
+    uint64_t m_DoubleClickUs;       // Double click time.
+    uint64_t m_LongPressUs;         // Long press time.
+    uint64_t m_VeryLongPressUs;     // Very long press time.
+    bool     m_Raw;                 // Input state as of the last edge.
+    uint64_t m_RawUs;               // Time of the last edge.
+    uint64_t m_BurstUs;             // Time of the first edge of the burst.
+    bool     m_Stable;              // Debounced state.
+    uint64_t m_PressUs;             // Time of the debounced press.
+    bool     m_VeryLongSent;        // True once this press was very long.
+    bool     m_ClickPending;        // True while a click may become double.
+    uint64_t m_ClickUs;             // Release time of the pending click.
+    ButtonEvent_t m_Queue[QUEUE_SIZE];
+                                    // Recognized gestures, oldest first.
+    uint32_t m_Head;                // Index of the oldest event.
+    uint32_t m_Count;               // Number of queued events.
+    uint32_t m_Dropped;             // Events lost to a full queue.
+
+}; // End class ButtonGestures
+
+#endif // BUTTONGESTURES_H
@@ -0,0 +1,204 @@
+/////////////////////////////////////////////////////////////////////////////////
+// ClockBoardHal.h
+//
+// Declares the ClockBoardHal interface.  This is the hardware abstraction layer
+// (HAL) used by the GenericClockBoard class for all of its pin, pin change
+// interrupt, timing, delay, non-volatile storage, and retained (deep sleep)
+// memory needs.  Two backends are provided:
+//      Esp32Hal     - Talks to the real ESP32 hardware (see Esp32Hal.h).
+//      SimulatedHal - A host (Linux) backend that models a 28BYJ-48 stepper,
+//                     the clock's gear train, and the home reed switch, and
+//                     that runs in virtual time (see SimulatedHal.h).
+//
+// Pin numbers are ESP32 GPIO numbers.  Bit masks used by SetPins() and
+// ClearPins() follow the ESP32 GPIO.out_w1ts/out_w1tc register layout, so
+// only GPIO 0 through GPIO 31 may be used with them.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined CLOCKBOARDHAL_H
+#define CLOCKBOARDHAL_H
+
+#include <stdint.h>             // For standard integer types.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ClockBoardHal class
+//
+// Abstract interface to the board's hardware.
+/////////////////////////////////////////////////////////////////////////////////
+class ClockBoardHal
+{
+public:
+    // Pin change interrupt handler.
+    typedef void (*PinChangeIsr_t)(void *pArg);
+
+    static const uint32_t DUTY_MAX      = 255;  // SetPinDuties() full duty.
+    static const uint32_t MAX_DUTY_PINS = 4;    // Max pins with SetPinDuties().
+    static const uint32_t MAX_RETAINED_BYTES = 128;
+                                                // Max WriteRetained() length.
+
+    // Destructor.
+    virtual ~ClockBoardHal() {}
+
+    /////////////////////////////////////////////////////////////////////////////
+    // PinMode()
+    //
+    // Configures a pin.  'mode' is one of the Arduino INPUT, OUTPUT, or
+    // INPUT_PULLUP values.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual void PinMode(uint8_t pin, uint8_t mode) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // WritePin()
+    //
+    // Drives a single output pin high ('true') or low ('false').
+    /////////////////////////////////////////////////////////////////////////////
+    virtual void WritePin(uint8_t pin, bool high) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SetPins()
+    //
+    // Drives every output pin whose bit is set in 'mask' high.  Pins whose
+    // bits are clear are unaffected.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual void SetPins(uint32_t mask) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // ClearPins()
+    //
+    // Drives every output pin whose bit is set in 'mask' low.  Pins whose
+    // bits are clear are unaffected.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual void ClearPins(uint32_t mask) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // HoldPins()
+    //
+    // Drives every output pin whose bit is set in 'mask' with a PWM signal of
+    // 'dutyPercent' (1 to 100), so that a stepper phase can be held at a
+    // reduced current.  Any pins held by an earlier call are first returned to
+    // normal SetPins() / ClearPins() control, driven low.  A 'mask' of 0 just
+    // releases the held pins.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual void HoldPins(uint32_t mask, uint32_t dutyPercent) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SetPinDuties(), ReleasePinDuties()
+    //
+    // SetPinDuties() drives each output 'pPins[i]' with a PWM signal of
+    // 'pDuties[i]' / DUTY_MAX, for 'count' pins, so that the stepper coils can
+    // be driven at part of their full current for microstepping.  The pins
+    // are changed together, as one step.  The first call for a pin gives it
+    // its own PWM channel, after which SetPins() and ClearPins() no longer
+    // affect it.  At most MAX_DUTY_PINS pins may be driven this way at once.
+    // Must be fast, since it is called from the step timer callback.
+    //
+    // ReleasePinDuties() returns the pins to normal SetPins() / ClearPins()
+    // control, driven low.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual void SetPinDuties(const uint8_t *pPins, const uint32_t *pDuties,
+                              uint32_t count) = 0;
+    virtual void ReleasePinDuties(const uint8_t *pPins, uint32_t count) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // ReadPin()
+    //
+    // Returns 'true' if the input pin is high, 'false' if it is low.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual bool ReadPin(uint8_t pin) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Micros()
+    //
+    // Returns a monotonic microsecond clock.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual uint64_t Micros() = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // DelayMicroseconds()
+    //
+    // Busy waits for the specified number of microseconds.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual void DelayMicroseconds(uint32_t us) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Delay()
+    //
+    // Waits for the specified number of milliseconds, allowing other tasks
+    // to run.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual void Delay(uint32_t ms) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // ReadStorage()
+    //
+    // Reads a block of non-volatile data that was previously written with
+    // WriteStorage().  'pKey' names the block and may be at most 15 characters
+    // long.  Returns 'true' if a block of exactly 'length' bytes was found and
+    // copied to 'pData'.  Returns 'false' otherwise, leaving 'pData' unchanged.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual bool ReadStorage(const char *pKey, void *pData, uint32_t length) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // WriteStorage()
+    //
+    // Writes a block of non-volatile data that survives a reboot.  Flash has a
+    // limited number of erase cycles, so writes must be budgeted: the clock
+    // writes one small block about once a minute (its position after each
+    // move), plus a few per home.  Anything written more often belongs in
+    // retained memory.  Returns 'true' on success.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual bool WriteStorage(const char *pKey, const void *pData, uint32_t length) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // ReadRetained()
+    //
+    // Reads the retained block that was previously written with
+    // WriteRetained().  Returns 'true' if a block of exactly 'length' bytes was
+    // found and copied to 'pData'.  Returns 'false' otherwise, leaving 'pData'
+    // unchanged.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual bool ReadRetained(void *pData, uint32_t length) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // WriteRetained()
+    //
+    // Writes the single retained block of at most MAX_RETAINED_BYTES.  Retained
+    // memory (RTC slow memory on the ESP32) survives deep sleep, but not a
+    // restart or power loss.  Unlike storage, it does not wear, so it may be
+    // written at any rate.  Returns 'true' on success.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual bool WriteRetained(const void *pData, uint32_t length) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // AttachPinChange()
+    //
+    // Calls 'pIsr(pArg)' from interrupt context whenever the level of input
+    // 'pin' changes.  The handler must be short, and may only call ReadPin()
+    // and Micros() on the HAL.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual void AttachPinChange(uint8_t pin, PinChangeIsr_t pIsr, void *pArg) = 0;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // DetachPinChange()
+    //
+    // Removes the pin change handler of 'pin', if any.
+    /////////////////////////////////////////////////////////////////////////////
+    virtual void DetachPinChange(uint8_t pin) = 0;
+
+}; // End class ClockBoardHal
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// DefaultClockBoardHal()
+//
+// Returns the HAL used when none is specified.  This is the Esp32Hal instance
+// on the ESP32, and a default SimulatedHal instance on the host.
+/////////////////////////////////////////////////////////////////////////////////
+ClockBoardHal *DefaultClockBoardHal();
+
+#endif // CLOCKBOARDHAL_H
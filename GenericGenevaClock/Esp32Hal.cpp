@@ -0,0 +1,241 @@
+/////////////////////////////////////////////////////////////////////////////////
+// Esp32Hal.cpp
+//
+// Contains the implementation of the Esp32Hal class.  This is the ClockBoardHal
+// backend that talks directly to the ESP32 hardware.  See Esp32Hal.h.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original code.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#if defined ARDUINO
+
+#include "Esp32Hal.h"               // For Esp32Hal class.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Instance()
+//
+// Returns a pointer to the single Esp32Hal instance.  The instance is created
+// on first use so that it is valid even when called from other static
+// constructors.
+/////////////////////////////////////////////////////////////////////////////////
+Esp32Hal *Esp32Hal::Instance()
+{
+    static Esp32Hal instance;
+    return &instance;
+} // End Instance().
+
+
+// NVS namespace used for storage.
+const char *Esp32Hal::PREFS_NAMESPACE = "GenevaClock";
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// OpenPrefs()
+//
+// Opens the storage namespace on first use.
+/////////////////////////////////////////////////////////////////////////////////
+bool Esp32Hal::OpenPrefs()
+{
+    if (!m_PrefsOpen)
+    {
+        m_PrefsOpen = m_Prefs.begin(PREFS_NAMESPACE, false);
+    }
+    return m_PrefsOpen;
+} // End OpenPrefs().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ReadStorage()
+//
+// Reads a block of data from NVS if it exists and is the expected size.
+/////////////////////////////////////////////////////////////////////////////////
+bool Esp32Hal::ReadStorage(const char *pKey, void *pData, uint32_t length)
+{
+    if (!OpenPrefs() || (m_Prefs.getBytesLength(pKey) != length))
+    {
+        return false;
+    }
+    return m_Prefs.getBytes(pKey, pData, length) == length;
+} // End ReadStorage().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// WriteStorage()
+//
+// Writes a block of data to NVS.  NVS appends each write to the current page
+// and only erases a page once it is full and its live entries have moved, so
+// the erases are spread over the whole partition (see the README for the
+// clock's wear budget).
+/////////////////////////////////////////////////////////////////////////////////
+bool Esp32Hal::WriteStorage(const char *pKey, const void *pData, uint32_t length)
+{
+    return OpenPrefs() && (m_Prefs.putBytes(pKey, pData, length) == length);
+} // End WriteStorage().
+
+
+// The retained block.  RTC_DATA_ATTR places it in RTC slow memory, which is
+// powered during deep sleep, and which is zeroed by any other kind of reset.
+RTC_DATA_ATTR static uint32_t gRetainedLength;
+RTC_DATA_ATTR static uint8_t  gRetained[ClockBoardHal::MAX_RETAINED_BYTES];
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ReadRetained()
+//
+// Reads the retained block if it has been written with the expected size.
+/////////////////////////////////////////////////////////////////////////////////
+bool Esp32Hal::ReadRetained(void *pData, uint32_t length)
+{
+    if (gRetainedLength != length)
+    {
+        return false;
+    }
+    memcpy(pData, gRetained, length);
+    return true;
+} // End ReadRetained().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// WriteRetained()
+//
+// Writes the retained block.
+/////////////////////////////////////////////////////////////////////////////////
+bool Esp32Hal::WriteRetained(const void *pData, uint32_t length)
+{
+    if (length > MAX_RETAINED_BYTES)
+    {
+        return false;
+    }
+    memcpy(gRetained, pData, length);
+    gRetainedLength = length;
+    return true;
+} // End WriteRetained().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// HoldPins()
+//
+// Attaches the masked pins to the hold PWM channel at 'dutyPercent', after
+// detaching any pins held before.  A detached pin goes back to the GPIO
+// output register, where the stepper phases are always clear while held.
+/////////////////////////////////////////////////////////////////////////////////
+void Esp32Hal::HoldPins(uint32_t mask, uint32_t dutyPercent)
+{
+    for (uint8_t pin = 0; m_HeldPins; pin++)
+    {
+        if (m_HeldPins & (1UL << pin))
+        {
+            ledcDetachPin(pin);
+            m_HeldPins &= ~(1UL << pin);
+        }
+    }
+    if (!mask)
+    {
+        return;
+    }
+
+    if (!m_HoldSetup)
+    {
+        ledcSetup(HOLD_CHANNEL, HOLD_FREQ_HZ, HOLD_RESOLUTION);
+        m_HoldSetup = true;
+    }
+    ledcWrite(HOLD_CHANNEL, ((1UL << HOLD_RESOLUTION) - 1) * dutyPercent / 100);
+    for (uint8_t pin = 0; pin < 32; pin++)
+    {
+        if (mask & (1UL << pin))
+        {
+            ledcAttachPin(pin, HOLD_CHANNEL);
+        }
+    }
+    m_HeldPins = mask;
+} // End HoldPins().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// DutyChannel()
+//
+// Returns the index of the SetPinDuties() channel driving 'pin', or
+// MAX_DUTY_PINS if there is none.
+/////////////////////////////////////////////////////////////////////////////////
+uint32_t Esp32Hal::DutyChannel(uint8_t pin) const
+{
+    uint32_t i = 0;
+    while ((i < MAX_DUTY_PINS) && (m_DutyPins[i] != pin))
+    {
+        i++;
+    }
+    return i;
+} // End DutyChannel().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetPinDuties()
+//
+// Sets the PWM duty of each pin.  A pin without a channel is given the first
+// free one, which is set up at the same frequency as the hold channel so that
+// the coils are silent.  Once a pin has its channel, only duties that change
+// are written, which for a microstep is at most two of the four coils.
+/////////////////////////////////////////////////////////////////////////////////
+void Esp32Hal::SetPinDuties(const uint8_t *pPins, const uint32_t *pDuties, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t channel = DutyChannel(pPins[i]);
+        if (channel >= MAX_DUTY_PINS)
+        {
+            channel = DutyChannel(NO_PIN);
+            if (channel >= MAX_DUTY_PINS)
+            {
+                continue;
+            }
+            ledcSetup(DUTY_CHANNEL + channel, HOLD_FREQ_HZ, HOLD_RESOLUTION);
+            ledcWrite(DUTY_CHANNEL + channel, 0);
+            ledcAttachPin(pPins[i], DUTY_CHANNEL + channel);
+            m_DutyPins[channel] = pPins[i];
+            m_Duties[channel]   = 0;
+        }
+        if (m_Duties[channel] != pDuties[i])
+        {
+            ledcWrite(DUTY_CHANNEL + channel, pDuties[i]);
+            m_Duties[channel] = pDuties[i];
+        }
+    }
+} // End SetPinDuties().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ReleasePinDuties()
+//
+// Detaches each pin from its PWM channel and drives it low.
+/////////////////////////////////////////////////////////////////////////////////
+void Esp32Hal::ReleasePinDuties(const uint8_t *pPins, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t channel = DutyChannel(pPins[i]);
+        if (channel < MAX_DUTY_PINS)
+        {
+            ledcWrite(DUTY_CHANNEL + channel, 0);
+            ledcDetachPin(pPins[i]);
+            m_DutyPins[channel] = NO_PIN;
+            GPIO.out_w1tc = 1UL << pPins[i];
+        }
+    }
+} // End ReleasePinDuties().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// DefaultClockBoardHal()
+//
+// On the ESP32, the default HAL talks to the real hardware.
+/////////////////////////////////////////////////////////////////////////////////
+ClockBoardHal *DefaultClockBoardHal()
+{
+    return Esp32Hal::Instance();
+} // End DefaultClockBoardHal().
+
+#endif // ARDUINO
@@ -0,0 +1,123 @@
+/////////////////////////////////////////////////////////////////////////////////
+// Esp32Hal.h
+//
+// Declares the Esp32Hal class.  This is the ClockBoardHal backend that talks
+// directly to the ESP32 hardware.  Stepper phase updates go straight to the
+// GPIO.out_w1ts and GPIO.out_w1tc registers so that a full phase change costs
+// only two register writes.  Non-volatile storage uses the Preferences (NVS)
+// library, and retained memory is a block of RTC slow memory.  Reduced current stepper holding uses one LEDC PWM channel,
+// attached to each held phase pin.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined ESP32HAL_H
+#define ESP32HAL_H
+
+#if defined ARDUINO
+
+#include <Arduino.h>            // For pinMode(), digitalRead(), GPIO ...
+#include <Preferences.h>        // For Preferences (NVS) storage.
+#include <string.h>             // For memset().
+#include "ClockBoardHal.h"      // For ClockBoardHal interface.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Esp32Hal class
+//
+// ESP32 implementation of the ClockBoardHal interface.  Use Instance() to get
+// the single instance of this class.
+/////////////////////////////////////////////////////////////////////////////////
+class Esp32Hal : public ClockBoardHal
+{
+public:
+    /////////////////////////////////////////////////////////////////////////////
+    // Instance()
+    //
+    // Returns a pointer to the single Esp32Hal instance.
+    /////////////////////////////////////////////////////////////////////////////
+    static Esp32Hal *Instance();
+
+    // ClockBoardHal interface.  See ClockBoardHal.h.
+    void     PinMode(uint8_t pin, uint8_t mode)   { pinMode(pin, mode); }
+    void     WritePin(uint8_t pin, bool high)     { digitalWrite(pin, high ? HIGH : LOW); }
+    void     SetPins(uint32_t mask)               { GPIO.out_w1ts = mask; }
+    void     ClearPins(uint32_t mask)             { GPIO.out_w1tc = mask; }
+    void     HoldPins(uint32_t mask, uint32_t dutyPercent);
+    void     SetPinDuties(const uint8_t *pPins, const uint32_t *pDuties, uint32_t count);
+    void     ReleasePinDuties(const uint8_t *pPins, uint32_t count);
+    bool     ReadPin(uint8_t pin)                 { return digitalRead(pin) == HIGH; }
+    uint64_t Micros()                             { return esp_timer_get_time(); }
+    void     DelayMicroseconds(uint32_t us)       { delayMicroseconds(us); }
+    void     Delay(uint32_t ms)                   { delay(ms); }
+    bool     ReadStorage(const char *pKey, void *pData, uint32_t length);
+    bool     WriteStorage(const char *pKey, const void *pData, uint32_t length);
+    bool     ReadRetained(void *pData, uint32_t length);
+    bool     WriteRetained(const void *pData, uint32_t length);
+    void     AttachPinChange(uint8_t pin, PinChangeIsr_t pIsr, void *pArg)
+                            { attachInterruptArg(digitalPinToInterrupt(pin), pIsr, pArg, CHANGE); }
+    void     DetachPinChange(uint8_t pin)         { detachInterrupt(digitalPinToInterrupt(pin)); }
+
+private:
+    // Constructor.  Use Instance() instead.
+    Esp32Hal() : m_PrefsOpen(false), m_HoldSetup(false), m_HeldPins(0)
+    {
+        memset(m_DutyPins, NO_PIN, sizeof(m_DutyPins));
+        memset(m_Duties, 0, sizeof(m_Duties));
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // OpenPrefs()
+    //
+    // Opens the NVS namespace used for storage on first use.  NVS is not
+    // ready during static construction, so this is deferred.
+    /////////////////////////////////////////////////////////////////////////////
+    bool OpenPrefs();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // DutyChannel()
+    //
+    // Returns the index of the SetPinDuties() channel driving 'pin', or
+    // MAX_DUTY_PINS if there is none.
+    /////////////////////////////////////////////////////////////////////////////
+    uint32_t DutyChannel(uint8_t pin) const;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Unimplemented methods.  We don't want users to try to use these.
+    /////////////////////////////////////////////////////////////////////////////
+    Esp32Hal(Esp32Hal const &);
+    Esp32Hal &operator=(Esp32Hal &hal);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private static constants.
+    /////////////////////////////////////////////////////////////////////////////
+    static const char *PREFS_NAMESPACE;     // NVS namespace for storage.
+    static const uint8_t  HOLD_CHANNEL    = 8;      // LEDC channel for holding.
+                                                    // The RGBLed library takes
+                                                    // channels from 15 down.
+    static const uint32_t HOLD_FREQ_HZ    = 20000;  // Above hearing.
+    static const uint8_t  HOLD_RESOLUTION = 8;      // Duty resolution (bits).
+    static const uint8_t  DUTY_CHANNEL    = 0;      // First LEDC channel for
+                                                    // SetPinDuties().  Uses
+                                                    // MAX_DUTY_PINS channels.
+    static const uint8_t  NO_PIN          = 0xff;   // Unused m_DutyPins entry.
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private instance data.
+    /////////////////////////////////////////////////////////////////////////////
+    Preferences m_Prefs;            // NVS access.
+    bool        m_PrefsOpen;        // True once m_Prefs has been opened.
+    bool        m_HoldSetup;        // True once HOLD_CHANNEL is set up.
+    uint32_t    m_HeldPins;         // Pins attached to HOLD_CHANNEL.
+    uint8_t     m_DutyPins[MAX_DUTY_PINS];
+                                    // Pin driven by each SetPinDuties() channel.
+    uint32_t    m_Duties[MAX_DUTY_PINS];
+                                    // Duty of each SetPinDuties() channel.
+
+}; // End class Esp32Hal
+
+#endif // ARDUINO
+
+#endif // ESP32HAL_H
@@ -28,6 +28,10 @@
 // https://github.com/wilmouths/RGBLed.
 //
 // History:
+//  - agent 16-OCT-2026
+//    - Paced the stepper from StepTimer through ClockBoardHal.
+//    - Added interrupt captured input edges, coil hold policies, step timing
+//      statistics, and sine table microstepping.
 //  - jmcorbett 11-MAY-2024
 //    Original code.
 //
@@ -35,6 +39,8 @@
 //
 /////////////////////////////////////////////////////////////////////////////////
 
+#include <string.h>                 // For memset().
+#include <math.h>                   // For sin().
 #include "GenericClockBoard.h"      // For GenericClockBoard class.
 
 // GenericClockBoard static definitions.
@@ -75,31 +81,50 @@ RGBLed GenericClockBoard::RgbLed(
 //                           clock.  Set to 'true' for normally open (N.O.)
 //                           sensors.  Set to 'false' for normally closed (N.C.)
 //                           sensors.
+//   - pHal                - Specifies the hardware abstraction layer used to
+//                           access pins and time.  If NULL, the
+//                           DefaultClockBoardHal() is used.
 /////////////////////////////////////////////////////////////////////////////////
 GenericClockBoard::GenericClockBoard(
     uint32_t rapidSecondsPerRev,    // Number of seconds for fastest motor rev.
     uint32_t fullStepsPerRev,       // Number of full steps per motor revolution.
     bool     stepperPinsReversed,   // True if servo runs backwards.
     bool     stepperHalfStepping,   // True for half stepping, false for full.
-    bool     homeNormallyOpen) :    // True if home switch is normally open.
-             m_CurrentStepperPhase(0)
+    bool     homeNormallyOpen,      // True if home switch is normally open.
+    ClockBoardHal *pHal) :          // Hardware abstraction layer, or NULL.
+             m_pHal(pHal ? pHal : DefaultClockBoardHal()),
+             m_CurrentStepperPhase(0), m_RapidSecondsPerRev(rapidSecondsPerRev),
+             m_FullStepsPerRev(fullStepsPerRev), m_HalfStepping(stepperHalfStepping),
+             m_Microsteps(0), m_StepsPerFullStep(stepperHalfStepping ? 2 : 1),
+             m_QueueHead(0), m_QueueCount(0),
+             m_Moving(false), m_WaitingTask(NULL), m_StepPosition(0),
+             m_MoveDir(1), m_StepStartUs(0), m_StepIntervalUs(1),
+             m_LastMoveDir(0), m_BacklashSteps(0), m_MoveTakeUp(0),
+             m_HomeLatchArmed(false), m_HomeLatchDir(1), m_HomeLatched(false),
+             m_HomeLatchStop(false), m_HomeLatchEdge(),
+             m_HomeActive(false), m_ButtonActive(false), m_MoveDelta(0),
+             m_MoveSteps(0), m_MoveIndex(0), m_pMoveRamp(&m_FastRamp),
+             m_CoilPolicy(CoilRelease), m_HoldDutyPercent(HOLD_DUTY_PERCENT),
+             m_SettleUs(0), m_Settled(false), m_CoilsHeld(false), m_CoilCount(0),
+             m_CoilMoving(false)
 {
+#if STEP_TIMING_STATS
+    m_MoveSpeed      = StepFast;
+    m_TimingLastUs   = 0;
+    m_TimingStepping = false;
+#endif
+
     // Save a pointer to the proper motor pins array and initialize them as OUTPUTs.
     m_pStepperPins = stepperPinsReversed ? StepperPinsReversed : StepperPins;
     for (uint32_t i = 0; i < NUM_STEPPER_PINS; i++)
     {
-        pinMode(m_pStepperPins[i], OUTPUT);
-        digitalWrite(m_pStepperPins[i], LOW);
+        m_pHal->PinMode(m_pStepperPins[i], OUTPUT);
+        m_pHal->WritePin(m_pStepperPins[i], false);
     }
 
-    // Half stepping uses 8 phases, full stepping uses 4.
-    m_NumStepperPhases = stepperHalfStepping ? 8 : 4;
-
     // Initialize motor step related class data.
-    uint32_t stepsPerRev = fullStepsPerRev * (stepperHalfStepping ? 2 : 1);
-
-    const uint32_t US_PER_SEC = 1000000;
-    m_StepperRapidDelayUs =  US_PER_SEC * rapidSecondsPerRev / stepsPerRev;
+    memset(m_MicrostepDuty, 0, sizeof(m_MicrostepDuty));
+    ConfigureSteps();
 
     // Macro to create a bit pattern from a port number.
     #define PIN_BP(p) (1UL << m_pStepperPins[p])
@@ -119,20 +144,94 @@ GenericClockBoard::GenericClockBoard(
             m_StepperSequence[j + 1] = PIN_BP(i) | PIN_BP((i + 1) % NUM_STEPPER_PINS);
         }
     }
+    for (uint32_t i = 0; i < m_NumStepperPhases; i++)
+    {
+        m_StepperCoils[i] =
+            static_cast<uint16_t>(__builtin_popcount(m_StepperSequence[i]) * COIL_UNIT);
+    }
+
+    // Start accounting for coil power.  The coils are off till the first step.
+    memset(&m_CoilStats, 0, sizeof(m_CoilStats));
+    m_CoilStatsStartUs = m_pHal->Micros();
+    m_CoilSinceUs      = m_CoilStatsStartUs;
 
     // Initialize the home and pushbutton inputs.
     m_InvertHome = homeNormallyOpen;
-    pinMode(HOME_PIN, INPUT_PULLUP);
-    pinMode(PUSHBUTTON_PIN, INPUT_PULLUP);
+    m_pHal->PinMode(HOME_PIN, INPUT_PULLUP);
+    m_pHal->PinMode(PUSHBUTTON_PIN, INPUT_PULLUP);
+
+    // Initialize the asynchronous stepping support.
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    m_StepMux = mux;
+    m_StepTimer.Begin(StepTimerCallback, this);
+
+    // Read the inputs once, then let their pin change interrupts keep them
+    // up to date.
+    m_HomeActive   = m_pHal->ReadPin(HOME_PIN) ^ m_InvertHome;
+    m_ButtonActive = !m_pHal->ReadPin(PUSHBUTTON_PIN);
+    m_pHal->AttachPinChange(HOME_PIN, HomeIsr, this);
+    m_pHal->AttachPinChange(PUSHBUTTON_PIN, ButtonIsr, this);
 
 } // End GenericClockBoard()
 
 
+/////////////////////////////////////////////////////////////////////////////////
+// ConfigureSteps()
+//
+// Sets the number of phases, the slow and fast speeds, and the default
+// StepAuto profiles for the current steps per full step.
+/////////////////////////////////////////////////////////////////////////////////
+void GenericClockBoard::ConfigureSteps()
+{
+    // Half stepping uses 8 phases, full stepping uses 4, and microstepping
+    // uses 4 per microstep.
+    m_NumStepperPhases = NUM_STEPPER_PINS * m_StepsPerFullStep;
+    uint32_t stepsPerRev = m_FullStepsPerRev * m_StepsPerFullStep;
+
+    const uint32_t US_PER_SEC = 1000000;
+    m_StepperRapidDelayUs =  US_PER_SEC * m_RapidSecondsPerRev / stepsPerRev;
+
+    // StepSlow and StepFast are constant speed, so their ramps are empty.
+    // Slow moves use 5 times the rapid delay.
+    m_SlowRamp.pIntervalUs = NULL;
+    m_SlowRamp.length      = 0;
+    m_SlowRamp.cruiseUs    = m_StepperRapidDelayUs * 5;
+    m_SlowRamp.shift       = 0;
+    m_FastRamp.pIntervalUs = NULL;
+    m_FastRamp.length      = 0;
+    m_FastRamp.cruiseUs    = m_StepperRapidDelayUs;
+    m_FastRamp.shift       = 0;
+
+    // Install the default StepAuto profiles, fastest first.  All are S-curves
+    // that start and stop at 1/2 of the rapid rate, which is well within the
+    // 28BYJ-48's pull-in rate.  By default the motor is limited to 1.25 times
+    // the rapid rate, which can be raised via Planner().SetMotorLimits() for
+    // motors that are known to run faster.
+    const uint32_t rapidRate = stepsPerRev / m_RapidSecondsPerRev;
+    const uint32_t accel     = rapidRate * 8;
+    const uint32_t jerk      = accel * 10;
+    const MotionProfile_t PROFILES[] =
+    {
+        { rapidRate * 3 / 2, accel, jerk },
+        { rapidRate * 5 / 4, accel, jerk },
+        { rapidRate,         accel, jerk }
+    };
+    m_Planner.ClearProfiles();
+    m_Planner.SetStartVelocity(rapidRate / 2);
+    for (uint32_t i = 0; i < sizeof(PROFILES) / sizeof(PROFILES[0]); i++)
+    {
+        m_Planner.AddProfile(PROFILES[i]);
+    }
+    m_Planner.SetMotorLimits(rapidRate * 5 / 4, accel);
+} // End ConfigureSteps().
+
+
 /////////////////////////////////////////////////////////////////////////////////
 // Step()
 //
 // Step the stepper motor a specific number of steps in a specified direction
-// at a specified speed.
+// at a specified speed.  This is a blocking wrapper around StepAsync() and
+// WaitForMove().
 //
 // Arguments:
 //   steps - Specifies the number of steps and direction that the motor will
@@ -146,54 +245,649 @@ GenericClockBoard::GenericClockBoard(
 /////////////////////////////////////////////////////////////////////////////////
 void GenericClockBoard::Step(int32_t steps, StepperSpeed_t speed)
 {
+    // If the queue is full, let it drain before trying again.
+    while (!StepAsync(steps, speed))
+    {
+        WaitForMove();
+    }
+    WaitForMove();
+
+} // End Step().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// StepAsync()
+//
+// Queue a move of a specific number of steps in a specified direction at a
+// specified speed, then return immediately.
+//
+// Arguments:
+//   steps - Specifies the number of steps and direction that the motor will
+//           move.  A positive value will move the motor in the clockwise
+//           (CW) direction.  A negative value will move the motor in the
+//           counterclockwise (CCW) direction.
+//   speed - Specifies the speed profile that will be used for the move.
+//
+// Returns:
+//   Returns 'true' if the move was queued (or was a zero length move), or
+//   'false' if the move queue is full.
+/////////////////////////////////////////////////////////////////////////////////
+bool GenericClockBoard::StepAsync(int32_t steps, StepperSpeed_t speed)
+{
+    bool kick = false;
+
+    portENTER_CRITICAL(&m_StepMux);
     if (!steps)
     {
-        GPIO.out_w1tc = m_StepperClearMask;
+        // Nothing to move.  Just make sure the stepper is de-energized if idle,
+        // unless it is meant to be held.
+        if (!m_Moving && (m_CoilPolicy == CoilRelease))
+        {
+            m_pHal->ClearPins(m_StepperClearMask);
+        }
+        portEXIT_CRITICAL(&m_StepMux);
+        return true;
+    }
+    if (m_QueueCount >= MOVE_QUEUE_SIZE)
+    {
+        portEXIT_CRITICAL(&m_StepMux);
+        return false;
+    }
+
+    // Append the move to the queue.  If the step timer is idle, it must be
+    // kicked to start the move.
+    StepperMove_t &move = m_MoveQueue[(m_QueueHead + m_QueueCount) % MOVE_QUEUE_SIZE];
+    move.steps = steps;
+    move.speed = speed;
+    m_QueueCount++;
+    kick = !m_Moving;
+    m_Moving = true;
+    portEXIT_CRITICAL(&m_StepMux);
+
+    // The timer is not armed when we are idle, so it is safe to output the first
+    // step directly from here.  This also avoids a timer round trip of latency.
+    if (kick)
+    {
+        OnStepTimer();
+    }
+    return true;
+
+} // End StepAsync().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// WaitForMove()
+//
+// Blocks until all queued moves have completed.
+/////////////////////////////////////////////////////////////////////////////////
+void GenericClockBoard::WaitForMove()
+{
+#if defined ARDUINO
+    // Sleep until the step timer callback notifies us that it went idle.  The
+    // timeout guards against a notification that raced with our check.
+    m_WaitingTask = xTaskGetCurrentTaskHandle();
+    while (IsMoving())
+    {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WAIT_POLL_MS));
+    }
+    m_WaitingTask = NULL;
+#else
+    // On the host, run virtual time forward until the queue drains.
+    while (IsMoving() && StepTimer::AdvanceHostToNext())
+    {
+    }
+#endif
+} // End WaitForMove().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// StepPosition()
+//
+// Returns the total signed number of steps output since construction.
+/////////////////////////////////////////////////////////////////////////////////
+int64_t GenericClockBoard::StepPosition()
+{
+    portENTER_CRITICAL(&m_StepMux);
+    int64_t position = m_StepPosition;
+    portEXIT_CRITICAL(&m_StepMux);
+    return position;
+} // End StepPosition().
+
+
+#if STEP_TIMING_STATS
+/////////////////////////////////////////////////////////////////////////////////
+// GetStepTiming()
+//
+// Copies the step timing statistics.  They are copied under the lock so that
+// they are consistent even while moving.
+/////////////////////////////////////////////////////////////////////////////////
+void GenericClockBoard::GetStepTiming(StepTimingStats &stats)
+{
+    portENTER_CRITICAL(&m_StepMux);
+    stats = m_StepTiming;
+    portEXIT_CRITICAL(&m_StepMux);
+} // End GetStepTiming().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ResetStepTiming()
+//
+// Clears the step timing statistics.
+/////////////////////////////////////////////////////////////////////////////////
+void GenericClockBoard::ResetStepTiming()
+{
+    portENTER_CRITICAL(&m_StepMux);
+    m_StepTiming.Reset();
+    portEXIT_CRITICAL(&m_StepMux);
+} // End ResetStepTiming().
+#endif // STEP_TIMING_STATS
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetCoilPolicy()
+//
+// Selects what the coils do when idle.  If the stepper is idle and the new
+// policy is CoilRelease, the coils are released now.
+/////////////////////////////////////////////////////////////////////////////////
+void GenericClockBoard::SetCoilPolicy(CoilPolicy_t policy, uint32_t holdDutyPercent,
+                                      uint32_t settleMs)
+{
+    m_CoilPolicy      = policy;
+    m_HoldDutyPercent = (holdDutyPercent > 100) ? 100 : holdDutyPercent;
+    m_SettleUs        = settleMs * 1000;
+    if ((policy == CoilRelease) && !IsMoving())
+    {
+        if (m_CoilsHeld)
+        {
+            m_pHal->HoldPins(0, 0);
+            m_CoilsHeld = false;
+        }
+        m_pHal->ClearPins(m_StepperClearMask);
+        if (m_Microsteps)
+        {
+            OutputMicrostep(m_CurrentStepperPhase, 0);
+        }
+    }
+} // End SetCoilPolicy().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// GetCoilStats()
+//
+// Copies the coil on time, including the time since the last phase change.
+/////////////////////////////////////////////////////////////////////////////////
+void GenericClockBoard::GetCoilStats(CoilStats_t &stats)
+{
+    portENTER_CRITICAL(&m_StepMux);
+    uint64_t now = m_pHal->Micros();
+    AccountCoils(now, m_CoilMoving, m_CoilCount);
+    stats           = m_CoilStats;
+    stats.elapsedUs = now - m_CoilStatsStartUs;
+    portEXIT_CRITICAL(&m_StepMux);
+} // End GetCoilStats().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ResetCoilStats()
+//
+// Clears the coil on time.
+/////////////////////////////////////////////////////////////////////////////////
+void GenericClockBoard::ResetCoilStats()
+{
+    portENTER_CRITICAL(&m_StepMux);
+    uint64_t now = m_pHal->Micros();
+    memset(&m_CoilStats, 0, sizeof(m_CoilStats));
+    m_CoilStatsStartUs = now;
+    m_CoilSinceUs      = now;
+    portEXIT_CRITICAL(&m_StepMux);
+} // End ResetCoilStats().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// EstimateCoilMa()
+//
+// Moving coil time is the same for every policy.  Idle coil time is counted
+// in full by CoilHoldFull, at the PWM duty by CoilHoldReduced, and not at all
+// by CoilRelease.
+/////////////////////////////////////////////////////////////////////////////////
+double GenericClockBoard::EstimateCoilMa(CoilPolicy_t policy, const CoilStats_t &stats) const
+{
+    if (!stats.elapsedUs)
+    {
+        return 0.0;
+    }
+    double coilUs = static_cast<double>(stats.movingCoilUs);
+    if (policy == CoilHoldFull)
+    {
+        coilUs += stats.idleCoilUs;
+    }
+    else if (policy == CoilHoldReduced)
+    {
+        coilUs += stats.idleCoilUs * (m_HoldDutyPercent / 100.0);
+    }
+    return COIL_CURRENT_MA * coilUs / stats.elapsedUs;
+} // End EstimateCoilMa().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetMicrostepping()
+//
+// Switches between microstepping and the constructor's full or half stepping.
+// The current phase and StepPosition() are rescaled to the new steps so that
+// the field, and so the rotor, stays where it is.  The sine table holds a
+// quarter wave of duties from 0 to 90 degrees in 'microsteps' steps.
+/////////////////////////////////////////////////////////////////////////////////
+bool GenericClockBoard::SetMicrostepping(uint32_t microsteps)
+{
+    if (IsMoving() ||
+        (microsteps && ((microsteps < MIN_MICROSTEPS) || (microsteps > MAX_MICROSTEPS) ||
+                        (microsteps & (microsteps - 1)))))
+    {
+        return false;
+    }
+
+    // Release the coils, whichever way they are driven.
+    if (m_CoilsHeld)
+    {
+        m_pHal->HoldPins(0, 0);
+        m_CoilsHeld = false;
+    }
+    ReleaseDutyPins();
+    m_pHal->ClearPins(m_StepperClearMask);
+
+    uint32_t oldSteps = m_StepsPerFullStep;
+    uint32_t newSteps = microsteps ? microsteps : (m_HalfStepping ? 2 : 1);
+    m_Microsteps       = microsteps;
+    m_StepsPerFullStep = newSteps;
+
+    const double PI = 3.14159265358979323846;
+    if (microsteps)
+    {
+        for (uint32_t i = 0; i <= microsteps; i++)
+        {
+            m_MicrostepDuty[i] = static_cast<uint8_t>(
+                ClockBoardHal::DUTY_MAX * sin(i * PI / (2 * microsteps)) + 0.5);
+        }
+    }
+    ConfigureSteps();
+
+    // Round to the nearest new step when the new steps are coarser.
+    portENTER_CRITICAL(&m_StepMux);
+    m_CurrentStepperPhase = static_cast<int32_t>(
+        (m_CurrentStepperPhase * newSteps + oldSteps / 2) / oldSteps % m_NumStepperPhases);
+    m_StepPosition = (m_StepPosition * static_cast<int64_t>(newSteps) +
+                      ((m_StepPosition < 0) ? -1 : 1) * static_cast<int64_t>(oldSteps / 2)) /
+                     static_cast<int64_t>(oldSteps);
+    m_BacklashSteps = (m_BacklashSteps * newSteps + oldSteps / 2) / oldSteps;
+    AccountCoils(m_pHal->Micros(), false, 0);
+    portEXIT_CRITICAL(&m_StepMux);
+    return true;
+} // End SetMicrostepping().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ArmHomeLatch()
+//
+// Clears any latched home edge and starts looking for the next one made by a
+// step in 'direction'.  If 'stopMove' is 'true', the step timer ends the move
+// early once the edge is latched (see OnStepTimer()).
+/////////////////////////////////////////////////////////////////////////////////
+void GenericClockBoard::ArmHomeLatch(int32_t direction, bool stopMove)
+{
+    portENTER_CRITICAL(&m_StepMux);
+    m_HomeLatched    = false;
+    m_HomeLatchArmed = true;
+    m_HomeLatchDir   = (direction < 0) ? -1 : 1;
+    m_HomeLatchStop  = stopMove;
+    portEXIT_CRITICAL(&m_StepMux);
+} // End ArmHomeLatch().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// DisarmHomeLatch()
+//
+// Stops looking for a home edge and clears any latched edge.
+/////////////////////////////////////////////////////////////////////////////////
+void GenericClockBoard::DisarmHomeLatch()
+{
+    portENTER_CRITICAL(&m_StepMux);
+    m_HomeLatchArmed = false;
+    m_HomeLatched    = false;
+    m_HomeLatchStop  = false;
+    portEXIT_CRITICAL(&m_StepMux);
+} // End DisarmHomeLatch().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// HomeLatched()
+//
+// Returns 'true', and the latched edge's position, if an edge was latched.
+/////////////////////////////////////////////////////////////////////////////////
+bool GenericClockBoard::HomeLatched(double &position)
+{
+    portENTER_CRITICAL(&m_StepMux);
+    bool        latched = m_HomeLatched;
+    InputEdge_t edge    = m_HomeLatchEdge;
+    portEXIT_CRITICAL(&m_StepMux);
+    if (latched)
+    {
+        position = EdgePosition(edge);
+    }
+    return latched;
+} // End HomeLatched().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// HomeIsr(), ButtonIsr()
+//
+// Pin change interrupt trampolines.
+/////////////////////////////////////////////////////////////////////////////////
+void IRAM_ATTR GenericClockBoard::HomeIsr(void *pArg)
+{
+    static_cast<GenericClockBoard *>(pArg)->OnInputEdge(HOME_PIN);
+} // End HomeIsr().
+
+void IRAM_ATTR GenericClockBoard::ButtonIsr(void *pArg)
+{
+    static_cast<GenericClockBoard *>(pArg)->OnInputEdge(PUSHBUTTON_PIN);
+} // End ButtonIsr().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// OnInputEdge()
+//
+// Called from interrupt context when the home or pushbutton input changes.
+// Contact bounce and interrupts that arrive after the input has already
+// changed back can report the same state twice, so only real changes of the
+// cached state are recorded.  The edge is located within the current step by
+// the time elapsed since the step was output.  Integer math is used since
+// the ESP32 does not allow floating point in interrupts.
+/////////////////////////////////////////////////////////////////////////////////
+void IRAM_ATTR GenericClockBoard::OnInputEdge(uint8_t pin)
+{
+    bool isHome = (pin == HOME_PIN);
+    bool active = isHome ? (m_pHal->ReadPin(HOME_PIN) ^ m_InvertHome)
+                         : !m_pHal->ReadPin(PUSHBUTTON_PIN);
+    volatile bool &cached = isHome ? m_HomeActive : m_ButtonActive;
+    if (active == cached)
+    {
         return;
     }
+    cached = active;
+
+    InputEdge_t edge;
+    edge.timeUs = m_pHal->Micros();
+    edge.pin    = pin;
+    edge.active = active;
+
+    portENTER_CRITICAL_ISR(&m_StepMux);
+    uint64_t elapsed  = edge.timeUs - m_StepStartUs;
+    edge.stepPosition = m_StepPosition;
+    edge.stepDir      = static_cast<int8_t>(m_MoveDir);
+    edge.stepFraction = (!m_Moving || (elapsed >= m_StepIntervalUs)) ? 65535
+                      : static_cast<uint16_t>((elapsed << 16) / m_StepIntervalUs);
+    if (isHome && m_HomeLatchArmed && (m_MoveDir == m_HomeLatchDir) &&
+        (active == (m_HomeLatchDir > 0)))
+    {
+        m_HomeLatchEdge  = edge;
+        m_HomeLatched    = true;
+        m_HomeLatchArmed = false;
+    }
+    portEXIT_CRITICAL_ISR(&m_StepMux);
 
-    // Use modulo arithmatic to make the stepper move in the selected direction.
-    int32_t delta = (steps > 0) ? 1 : (m_NumStepperPhases - 1);
+    m_InputEdges.Push(edge);
+} // End OnInputEdge().
 
-    // Since 'delta' is used to affect the motor direction, we only need to
-    // use the magnitude of the move for the rest of the function.
-    int32_t absSteps = abs(steps);
 
-    // Output the specified number of steps applying accel and decel as needed.
-    for (int32_t j = 0; j < absSteps; j++)
+/////////////////////////////////////////////////////////////////////////////////
+// StepTimerCallback()
+//
+// Static trampoline registered with the StepTimer.
+/////////////////////////////////////////////////////////////////////////////////
+void GenericClockBoard::StepTimerCallback(void *pArg)
+{
+    static_cast<GenericClockBoard *>(pArg)->OnStepTimer();
+} // End StepTimerCallback().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// OnStepTimer()
+//
+// Outputs the next step of the current move and re-arms the step timer for that
+// step's duration.  When the current move is complete, the next queued move is
+// started.  When no work remains, the stepper is de-energized and the board is
+// marked idle.  A move that the home latch is to stop (see ArmHomeLatch()) is
+// cut short once the edge is latched, to end after as many more steps as it
+// has taken so far, up to the length of its ramp.  Since the ramp is played
+// back symmetrically, it then simply decelerates from its current speed.
+/////////////////////////////////////////////////////////////////////////////////
+void GenericClockBoard::OnStepTimer()
+{
+#if STEP_TIMING_STATS
+    // Time the step that just ended.  The next phase write is timed from
+    // this one, whether or not a step follows.
+    uint64_t timingUs = m_pHal->Micros();
+    if (m_TimingStepping)
+    {
+        portENTER_CRITICAL(&m_StepMux);
+        m_StepTiming.Record(m_MoveSpeed, m_StepIntervalUs,
+                            static_cast<uint32_t>(timingUs - m_TimingLastUs));
+        portEXIT_CRITICAL(&m_StepMux);
+    }
+    m_TimingLastUs   = timingUs;
+    m_TimingStepping = false;
+#endif
+
+    if (m_HomeLatchStop)
+    {
+        portENTER_CRITICAL(&m_StepMux);
+        if (m_HomeLatched)
+        {
+            m_HomeLatchStop = false;
+            int32_t rampSteps = static_cast<int32_t>(m_pMoveRamp->length << m_pMoveRamp->shift);
+            int32_t stopSteps = m_MoveIndex + ((m_MoveIndex < rampSteps) ? m_MoveIndex : rampSteps);
+            if (stopSteps < m_MoveSteps)
+            {
+                m_MoveSteps = stopSteps;
+            }
+        }
+        portEXIT_CRITICAL(&m_StepMux);
+    }
+
+    if (m_MoveIndex >= m_MoveSteps)
+    {
+        // The current move is complete.  Fetch the next one, or go idle once
+        // the last step has been held for the settle time.  Only this callback
+        // removes moves, so a move that is queued stays queued.
+        portENTER_CRITICAL(&m_StepMux);
+        bool queued = (m_QueueCount != 0);
+        portEXIT_CRITICAL(&m_StepMux);
+        if (!queued)
+        {
+            if (!m_Settled && m_SettleUs)
+            {
+                m_Settled = true;
+                m_StepTimer.StartOnce(m_SettleUs);
+                return;
+            }
+            if (GoIdle())
+            {
+                return;
+            }
+        }
+
+        portENTER_CRITICAL(&m_StepMux);
+        StepperMove_t move = m_MoveQueue[m_QueueHead];
+        m_QueueHead = (m_QueueHead + 1) % MOVE_QUEUE_SIZE;
+        m_QueueCount--;
+        portEXIT_CRITICAL(&m_StepMux);
+        m_Settled = false;
+
+        // Use modulo arithmatic to make the stepper move in the selected
+        // direction.  Since 'm_MoveDelta' is used to affect the motor direction,
+        // we only need to use the magnitude of the move from here on.  A move
+        // that reverses direction first takes up the backlash.
+        m_MoveDir    = (move.steps > 0) ? 1 : -1;
+        m_MoveDelta  = (move.steps > 0) ? 1 : (m_NumStepperPhases - 1);
+        m_MoveTakeUp = (m_LastMoveDir && (m_MoveDir != m_LastMoveDir))
+                     ? static_cast<int32_t>(m_BacklashSteps) : 0;
+        m_LastMoveDir = m_MoveDir;
+        m_MoveSteps  = abs(move.steps) + m_MoveTakeUp;
+        m_MoveIndex  = 0;
+#if STEP_TIMING_STATS
+        m_MoveSpeed = move.speed;
+#endif
+
+        // Look up the ramp for the move's speed once, so that each step is
+        // just a table lookup.  StepAuto uses the planner's selected profile.
+        m_pMoveRamp = (move.speed == StepAuto) ? &m_Planner.SelectedRamp()
+                    : (move.speed == StepSlow) ? &m_SlowRamp : &m_FastRamp;
+    }
+
+    // Disable all stepper phases.  This ends the previous step (if any).  When
+    // starting from idle, the held phase must be released first.  Microsteps
+    // simply replace the previous duties.
+    if (m_CoilsHeld && !m_Microsteps)
+    {
+        m_pHal->HoldPins(0, 0);
+    }
+    m_CoilsHeld = false;
+    if (!m_Microsteps)
     {
-        // Increment the stepper phase and wrap as needed.
-        m_CurrentStepperPhase = (m_CurrentStepperPhase + delta) % m_NumStepperPhases;
+        m_pHal->ClearPins(m_StepperClearMask);
+    }
+
+    // Increment the stepper phase and wrap as needed.
+    m_CurrentStepperPhase = (m_CurrentStepperPhase + m_MoveDelta) % m_NumStepperPhases;
+
+    // Track the absolute position, and when this step started so that input
+    // edges can be located within it.  This must be done before the step is
+    // output, since the output may cause an input edge right away.  The
+    // position is 64 bits, so it must be updated under the lock to be read
+    // consistently from other tasks and the pin change interrupts.  Backlash
+    // take-up steps don't move the dial, so they aren't counted.
+    uint32_t intervalUs = StepRampIntervalUs(*m_pMoveRamp, m_MoveIndex, m_MoveSteps);
+    uint64_t now        = m_pHal->Micros();
+    portENTER_CRITICAL(&m_StepMux);
+    if (m_MoveIndex >= m_MoveTakeUp)
+    {
+        m_StepPosition += m_MoveDir;
+    }
+    m_StepStartUs    = now;
+    m_StepIntervalUs = intervalUs;
+    AccountCoils(now, true, PhaseCoils(m_CurrentStepperPhase));
+    portEXIT_CRITICAL(&m_StepMux);
+
+    // Output the new phase to the stepper and hold it for the step's duration.
+    // Note that all phases are only disabled at the start of the next step.
+    // Disabling them earlier led to missed steps.
+    if (m_Microsteps)
+    {
+        OutputMicrostep(m_CurrentStepperPhase, 100);
+    }
+    else
+    {
+        m_pHal->SetPins(m_StepperSequence[m_CurrentStepperPhase]);
+    }
+    m_StepTimer.StartOnce(intervalUs);
+    m_MoveIndex++;
+#if STEP_TIMING_STATS
+    m_TimingStepping = true;
+#endif
 
-        // Output the new phase to the stepper.
-        GPIO.out_w1ts = m_StepperSequence[m_CurrentStepperPhase];
+} // End OnStepTimer().
 
-        // Assume we are making a fast move and make an initial delay.
-        delayMicroseconds(m_StepperRapidDelayUs);
 
-        // For slow speed, add an additional delay.
-        if (speed == StepSlow)
+/////////////////////////////////////////////////////////////////////////////////
+// GoIdle()
+//
+// Applies the coil policy, then marks the board idle and wakes any task
+// waiting in WaitForMove().  The coils are changed before the board is marked
+// idle, since StepAsync() may start the next move itself once it is.
+/////////////////////////////////////////////////////////////////////////////////
+bool GenericClockBoard::GoIdle()
+{
+    switch (m_CoilPolicy)
+    {
+    case CoilHoldFull:
+        // Leave the last phase energized.
+        break;
+    case CoilHoldReduced:
+        if (m_Microsteps)
+        {
+            OutputMicrostep(m_CurrentStepperPhase, m_HoldDutyPercent);
+        }
+        else
         {
-            delayMicroseconds(m_StepperRapidDelayUs * 4);
+            m_pHal->ClearPins(m_StepperClearMask);
+            m_pHal->HoldPins(m_StepperSequence[m_CurrentStepperPhase], m_HoldDutyPercent);
         }
-        else if (speed == StepAuto)
+        m_CoilsHeld = true;
+        break;
+    default:
+        if (m_Microsteps)
         {
-            // Delay based on accel/decel.  Seems like all phases should be
-            // disabled after the first delay to reduce heat and power use of
-            // the stepper.  However, this led to missed steps, so it was
-            // moved below.
-            if (j < 20)            delayMicroseconds(m_StepperRapidDelayUs); // Acceleration
-            if (j < 10)            delayMicroseconds(m_StepperRapidDelayUs); // Acceleration
-            if (j < 5)             delayMicroseconds(m_StepperRapidDelayUs); // Acceleration
-            if (absSteps - j < 20) delayMicroseconds(m_StepperRapidDelayUs); // Deceleration
-            if (absSteps - j < 10) delayMicroseconds(m_StepperRapidDelayUs); // Deceleration
-            if (absSteps - j < 5)  delayMicroseconds(m_StepperRapidDelayUs); // Deceleration
+            OutputMicrostep(m_CurrentStepperPhase, 0);
         }
+        else
+        {
+            m_pHal->ClearPins(m_StepperClearMask);
+        }
+        break;
+    }
 
-        // Disable all stepper phases.
-        GPIO.out_w1tc = m_StepperClearMask;
+    portENTER_CRITICAL(&m_StepMux);
+    if (m_QueueCount)
+    {
+        portEXIT_CRITICAL(&m_StepMux);
+        return false;
+    }
+    AccountCoils(m_pHal->Micros(), false, PhaseCoils(m_CurrentStepperPhase));
+    m_Moving = false;
+    portEXIT_CRITICAL(&m_StepMux);
+#if defined ARDUINO
+    TaskHandle_t waiter = m_WaitingTask;
+    if (waiter)
+    {
+        xTaskNotifyGive(waiter);
     }
+#endif
+    return true;
 
-} // End Step().
+} // End GoIdle().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// OutputMicrostep()
+//
+// Microstep 'phase' lies 'r' microsteps past full step 'q', which energizes
+// only coil 'q'.  Coil 'q' is driven at cos() and the next coil at sin() of
+// the angle between them, so that the field points 'r' microsteps toward the
+// next coil with constant strength.  Half way, both coils are at 71%, which
+// is the same direction as the half step that energizes both.
+/////////////////////////////////////////////////////////////////////////////////
+uint32_t GenericClockBoard::OutputMicrostep(uint32_t phase, uint32_t percent)
+{
+    uint32_t q = phase / m_Microsteps;
+    uint32_t r = phase & (m_Microsteps - 1);
+    uint32_t duty[NUM_STEPPER_PINS] = { 0, 0, 0, 0 };
+    duty[q]                          = m_MicrostepDuty[m_Microsteps - r] * percent / 100;
+    duty[(q + 1) % NUM_STEPPER_PINS] = m_MicrostepDuty[r] * percent / 100;
+    m_pHal->SetPinDuties(m_pStepperPins, duty, NUM_STEPPER_PINS);
+    return duty[0] + duty[1] + duty[2] + duty[3];
+} // End OutputMicrostep().
 
 
+/////////////////////////////////////////////////////////////////////////////////
+// ReleaseDutyPins()
+//
+// Returns the phase pins to normal output control, if microstepping.
+/////////////////////////////////////////////////////////////////////////////////
+void GenericClockBoard::ReleaseDutyPins()
+{
+    if (m_Microsteps)
+    {
+        m_pHal->ReleasePinDuties(m_pStepperPins, NUM_STEPPER_PINS);
+    }
+} // End ReleaseDutyPins().
+
@@ -24,6 +24,10 @@
 // https://github.com/wilmouths/RGBLed.
 //
 // History:
+//  - agent 16-OCT-2026
+//    - Paced the stepper from StepTimer through ClockBoardHal.
+//    - Added interrupt captured input edges, coil hold policies, step timing
+//      statistics, and sine table microstepping.
 //  - jmcorbett 11-MAY-2024
 //    Original creation.
 //
@@ -34,7 +38,14 @@
 #define GENERICCLOCKBOARD_H
 
 #include "SerialDebugSetup.h"   // For common SerialDebug options.
+#if defined ARDUINO
 #include <RGBLed.h>             // For RGBLed class supports the board's RGB LEDs.
+#endif
+#include "StepTimer.h"          // For StepTimer class that paces the stepper.
+#include "ClockBoardHal.h"      // For ClockBoardHal hardware abstraction.
+#include "MotionPlanner.h"      // For MotionPlanner acceleration profiles.
+#include "SpscRing.h"           // For SpscRing lock-free ring buffer.
+#include "StepTimingStats.h"    // For StepTimingStats and STEP_TIMING_STATS.
 
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -44,9 +55,10 @@
 // via the Step() method.  The selections are:
 //      StepSlow - Will move the stepper at slow speed for the full duration of
 //                 the move.
-//      StepAuto - Will make long moves use the fast speed with accel and decel
-//                 at the beginning and end of the move.  Short moves will be
-//                 done at slow speed.
+//      StepAuto - Will accelerate and decelerate using the board's
+//                 MotionPlanner.  Long moves cruise at the fastest profile
+//                 the motor can follow (which may be faster than StepFast).
+//                 Short moves turn around before reaching full speed.
 //      StepFast - Will move the stepper at fast speed for the full duration of
 //                 the move.
 /////////////////////////////////////////////////////////////////////////////////
@@ -58,6 +70,65 @@ enum StepperSpeed_t
 };
 
 
+/////////////////////////////////////////////////////////////////////////////////
+// InputEdge_t
+//
+// A change of the home sensor or pushbutton input, captured by its pin change
+// interrupt.  The step fields locate the edge to a fraction of a step: the
+// edge happened after 'stepFraction' / 65536 of the step from
+// 'stepPosition - stepDir' to 'stepPosition' had elapsed.  If the stepper was
+// idle, 'stepFraction' is 65535.  See GenericClockBoard::EdgePosition().
+/////////////////////////////////////////////////////////////////////////////////
+struct InputEdge_t
+{
+    uint64_t timeUs;        // Time of the edge (HAL Micros()).
+    int64_t  stepPosition;  // StepPosition() when the edge happened.
+    uint16_t stepFraction;  // Elapsed part of the current step (1/65536).
+    int8_t   stepDir;       // +1 (CW) or -1 (CCW) for the current step.
+    uint8_t  pin;           // HOME_PIN or PUSHBUTTON_PIN.
+    bool     active;        // New state: true if home or pressed.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// CoilPolicy_t
+//
+// This enum is used to select how the stepper coils are driven while the
+// stepper is idle (see GenericClockBoard::SetCoilPolicy()).  The selections
+// are:
+//      CoilRelease     - De-energizes the coils once the last step of a move
+//                        has settled.  Draws the least current, but leaves no
+//                        holding torque.  This is the default.
+//      CoilHoldFull    - Keeps the last phase fully energized.
+//      CoilHoldReduced - Keeps the last phase energized at a reduced current,
+//                        by driving it with PWM once the last step has
+//                        settled.
+/////////////////////////////////////////////////////////////////////////////////
+enum CoilPolicy_t
+{
+    CoilRelease = 0,    // De-energize when idle.
+    CoilHoldFull,       // Hold at full current when idle.
+    CoilHoldReduced     // Hold at reduced current when idle.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// CoilStats_t
+//
+// Coil on time, as returned by GenericClockBoard::GetCoilStats().  Times are
+// in coil-microseconds, i.e. the time each coil was on, summed over the
+// coils.  A half step energizes one or two coils.  When microstepping, each
+// coil counts in proportion to its PWM duty.
+/////////////////////////////////////////////////////////////////////////////////
+struct CoilStats_t
+{
+    uint64_t elapsedUs;     // Time since the statistics were reset.
+    uint64_t movingCoilUs;  // Coil on time while moving and settling.
+    uint64_t idleCoilUs;    // Coil on time the last phase would have taken
+                            // while idle, if held at full current.
+};
+
+
 
 /////////////////////////////////////////////////////////////////////////////////
 // GenericClockBoard class
@@ -97,23 +168,36 @@ public:
     //                           clock.  Set to 'true' for normally open (N.O.)
     //                           sensors.  Set to 'false' for normally closed
     //                           (N.C.) sensors.
+    //   - pHal                - Specifies the hardware abstraction layer used
+    //                           to access pins and time.  If NULL, the
+    //                           DefaultClockBoardHal() is used, which is the
+    //                           real ESP32 hardware on the target.
     /////////////////////////////////////////////////////////////////////////////
     GenericClockBoard(
                       uint32_t rapidSecondsPerRev,
                       uint32_t fullStepsPerRev     = 2048,
                       bool     stepperPinsReversed = false,
                       bool     stepperHalfStepping = true,
-                      bool     homeNormallyOpen    = true
+                      bool     homeNormallyOpen    = true,
+                      ClockBoardHal *pHal          = NULL
                       );
 
     // Destructorl
-    ~GenericClockBoard() {}
+    ~GenericClockBoard()
+    {
+        m_pHal->DetachPinChange(HOME_PIN);
+        m_pHal->DetachPinChange(PUSHBUTTON_PIN);
+        m_StepTimer.Stop();
+        ReleaseDutyPins();
+    }
 
     /////////////////////////////////////////////////////////////////////////////
     // Step()
     //
     // Step the stepper motor a specific number of steps in a specified direction
-    // at a specified speed.
+    // at a specified speed.  This is a blocking wrapper around StepAsync() and
+    // WaitForMove().  It returns after the move, and any moves that were
+    // previously queued via StepAsync(), have completed.
     //
     // Arguments:
     //   steps - Specifies the number of steps and direction that the motor will
@@ -127,21 +211,263 @@ public:
     /////////////////////////////////////////////////////////////////////////////
     void Step(int32_t steps, StepperSpeed_t speed);
 
+    /////////////////////////////////////////////////////////////////////////////
+    // StepAsync()
+    //
+    // Queue a move of a specific number of steps in a specified direction at a
+    // specified speed, then return immediately.  Moves are executed in order
+    // from a timer callback, so the caller is free to do other work while the
+    // stepper runs.
+    //
+    // Arguments:
+    //   steps - Specifies the number of steps and direction that the motor will
+    //           move.  A positive value will move the motor in the clockwise
+    //           (CW) direction.  A negative value will move the motor in the
+    //           counterclockwise (CCW) direction.
+    //   speed - Specifies the speed profile that will be used for the move.
+    //
+    // Returns:
+    //   Returns 'true' if the move was queued (or was a zero length move), or
+    //   'false' if the move queue is full.
+    /////////////////////////////////////////////////////////////////////////////
+    bool StepAsync(int32_t steps, StepperSpeed_t speed);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // IsMoving()
+    //
+    // Returns 'true' if the stepper is executing a move or has moves queued.
+    // Returns 'false' otherwise.
+    /////////////////////////////////////////////////////////////////////////////
+    bool IsMoving() const  { return m_Moving; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // WaitForMove()
+    //
+    // Blocks until all queued moves have completed.  On the ESP32 the calling
+    // task sleeps while it waits, so other tasks may run.
+    /////////////////////////////////////////////////////////////////////////////
+    void WaitForMove();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // StepPosition()
+    //
+    // Returns the total signed number of steps output since construction.
+    // Clockwise steps count up and counterclockwise steps count down.  This is
+    // updated as each step is output, so it is exact even while moving.
+    // Backlash take-up steps (see SetBacklashSteps()) are not counted, so this
+    // follows the dial side of the gear train.
+    /////////////////////////////////////////////////////////////////////////////
+    int64_t StepPosition();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // StepperPhase(), RestoreStepperPhase()
+    //
+    // The phase the stepper was last driven to.  The rotor stays at that phase
+    // while the power is off, so restoring it after a restart, before the
+    // first move, keeps the rotor from jumping to the board's initial phase.
+    // Call RestoreStepperPhase() only while idle.
+    /////////////////////////////////////////////////////////////////////////////
+    uint32_t StepperPhase() const       { return static_cast<uint32_t>(m_CurrentStepperPhase); }
+    void RestoreStepperPhase(uint32_t phase)
+                { m_CurrentStepperPhase = static_cast<int32_t>(phase % m_NumStepperPhases); }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Backlash compensation.
+    //
+    // When a move reverses the direction of the last move, the motor must
+    // first turn through the gear train's backlash before the dial moves.
+    // The board adds that many take-up steps to the start of each reversing
+    // move, at the move's speed, without counting them in StepPosition().
+    // The first move after construction is not compensated, since the
+    // direction the backlash was last taken up is unknown.
+    //
+    // SetBacklashSteps() - Sets the take-up steps added on each reversal.  0
+    //                      (the default) disables compensation.  Takes effect
+    //                      with the next reversing move.  Rescaled by
+    //                      SetMicrostepping().
+    // BacklashSteps()    - Returns the take-up steps added on each reversal.
+    // LastDirection()    - Returns the direction of the last move started: 1
+    //                      for clockwise, -1 for counterclockwise, or 0 if
+    //                      there has been none.
+    // RestoreDirection() - Sets the direction of the last move, for example
+    //                      from before a restart.  Call only while idle.
+    /////////////////////////////////////////////////////////////////////////////
+    void SetBacklashSteps(uint32_t steps)           { m_BacklashSteps = steps; }
+    uint32_t BacklashSteps() const                  { return m_BacklashSteps; }
+    int32_t LastDirection() const                   { return m_LastMoveDir; }
+    void RestoreDirection(int32_t direction)
+                { m_LastMoveDir = (direction > 0) ? 1 : (direction < 0) ? -1 : 0; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Home sensor edge latch.
+    //
+    // While armed, the home sensor's pin change interrupt latches the position
+    // of the first edge that makes it active during a clockwise step, or that
+    // makes it inactive during a counterclockwise step.  This lets the home
+    // edge be measured, to a fraction of a step, as part of ordinary moves.
+    // Latching disarms the latch.
+    //
+    // ArmHomeLatch()    - Clears any latched edge and arms the latch for
+    //                     steps in 'direction' (1 for clockwise, -1 for
+    //                     counterclockwise).  Clockwise, only an inactive to
+    //                     active change latches, so arming while on home does
+    //                     not latch.  Counterclockwise, only an active to
+    //                     inactive change latches.  If 'stopMove' is
+    //                     'true', a latched edge also ends the move that
+    //                     made it early, decelerating on the move's ramp, so
+    //                     that a long search move overshoots the edge by no
+    //                     more than its deceleration.
+    // DisarmHomeLatch() - Disarms the latch and clears any latched edge.
+    // HomeLatched()     - Returns 'true', and the edge's position in steps
+    //                     (see EdgePosition()) in 'position', if an edge has
+    //                     been latched.
+    /////////////////////////////////////////////////////////////////////////////
+    void ArmHomeLatch(int32_t direction = 1, bool stopMove = false);
+    void DisarmHomeLatch();
+    bool HomeLatched(double &position);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Input edges.
+    //
+    // Every change of the home sensor and pushbutton inputs is captured by a
+    // pin change interrupt and queued in a small lock-free ring buffer, so
+    // that short button presses are never missed no matter how seldom they
+    // are checked.  The ring holds INPUT_EDGE_RING_SIZE edges.  Once full,
+    // new edges are dropped (and counted) until it is read.  Only one task
+    // may read edges.
+    //
+    // NextInputEdge()     - Removes the oldest edge into 'edge' and returns
+    //                       'true', or returns 'false' if there is none.
+    // InputEdgesDropped() - Returns the number of edges dropped.
+    // EdgePosition()      - Returns the position of an edge in (fractional)
+    //                       steps, on the same scale as StepPosition().
+    /////////////////////////////////////////////////////////////////////////////
+    bool     NextInputEdge(InputEdge_t &edge)       { return m_InputEdges.Pop(edge); }
+    uint32_t InputEdgesDropped() const              { return m_InputEdges.Dropped(); }
+    static double EdgePosition(const InputEdge_t &edge)
+    {
+        return edge.stepPosition - edge.stepDir * (1.0 - edge.stepFraction / 65536.0);
+    }
+
+#if STEP_TIMING_STATS
+    /////////////////////////////////////////////////////////////////////////////
+    // Step timing.  Only available when STEP_TIMING_STATS is 1.
+    //
+    // The step timer callback times every step, from the phase write that
+    // starts it to the one that ends it, and records it against the step's
+    // intended interval.  Steps that end the stepper's idle time are not
+    // recorded, since there is no previous phase write to time from.
+    //
+    // GetStepTiming()   - Copies the statistics recorded so far into 'stats'.
+    //                     Safe to call while moving.
+    // ResetStepTiming() - Clears the statistics.
+    /////////////////////////////////////////////////////////////////////////////
+    void GetStepTiming(StepTimingStats &stats);
+    void ResetStepTiming();
+#endif
+
     /////////////////////////////////////////////////////////////////////////////
     // IsHome()
     //
     // Returns 'true' if the home sensor is active, based on the type of sensor
-    // (N.O. or N.C.) in use.  Returns 'false' otherwise.
+    // (N.O. or N.C.) in use.  Returns 'false' otherwise.  The state is kept
+    // up to date by the pin change interrupt, so this does not read the pin.
     /////////////////////////////////////////////////////////////////////////////
-    bool IsHome()          { return ((digitalRead(HOME_PIN) == HIGH) ^ m_InvertHome); }
+    bool IsHome()          { return m_HomeActive; }
 
 
     /////////////////////////////////////////////////////////////////////////////
     // IsButtonPressed()
     //
     // Returns 'true' if the board's pushbutton is active.  Returns 'false' otherwise.
+    // Like IsHome(), this does not read the pin.
     /////////////////////////////////////////////////////////////////////////////
-    bool IsButtonPressed() { return digitalRead(PUSHBUTTON_PIN) == LOW; }
+    bool IsButtonPressed() { return m_ButtonActive; }
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Hal()
+    //
+    // Returns the hardware abstraction layer in use by this board.
+    /////////////////////////////////////////////////////////////////////////////
+    ClockBoardHal *Hal()   { return m_pHal; }
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Coil power.
+    //
+    // By default the coils are de-energized once each move is done, so the
+    // motor has no holding torque while idle.  A hold policy trades current
+    // for holding torque.  The board accounts for the coil on time, from
+    // which the average coil current of each policy can be estimated for the
+    // clock's real pattern of moves.
+    //
+    // SetCoilPolicy()   - Selects what the coils do when idle (see
+    //                     CoilPolicy_t), the PWM duty in percent used by
+    //                     CoilHoldReduced, and how long (in ms) the last step
+    //                     of a move stays fully energized before the policy
+    //                     is applied.  WaitForMove() includes the settle time.
+    //                     Must be called by the task that moves the stepper.
+    //                     A change to CoilRelease takes effect at once, other
+    //                     changes the next time the stepper stops.
+    // CoilPolicy()      - Returns the current policy.
+    // GetCoilStats()    - Copies the coil on time since the last reset.
+    // ResetCoilStats()  - Clears the coil on time.
+    // EstimateCoilMa()  - Returns the average coil current, in mA, that
+    //                     'policy' would have drawn over 'stats'.  Assumes
+    //                     each energized coil draws COIL_CURRENT_MA.
+    /////////////////////////////////////////////////////////////////////////////
+    void SetCoilPolicy(CoilPolicy_t policy, uint32_t holdDutyPercent = HOLD_DUTY_PERCENT,
+                       uint32_t settleMs = 0);
+    CoilPolicy_t CoilPolicy() const                 { return m_CoilPolicy; }
+    void GetCoilStats(CoilStats_t &stats);
+    void ResetCoilStats();
+    double EstimateCoilMa(CoilPolicy_t policy, const CoilStats_t &stats) const;
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Microstepping.
+    //
+    // By default the coils are switched fully on and off in the full or half
+    // step sequence given to the constructor.  Microstepping instead drives
+    // each coil with a PWM duty from a sine table, so that the field turns in
+    // 'microstepsPerFullStep' smaller steps per full step.  The motor runs
+    // more smoothly and quietly, and can be positioned more finely.  Every
+    // step count (moves, StepPosition(), planner profiles) is then in
+    // microsteps.  The rapid, slow, and StepAuto speeds stay the same in
+    // revolutions per second, so each microstep is shorter: at 16 microsteps
+    // and 8 seconds per rev the fastest profile takes a step every 163 us.
+    //
+    // SetMicrostepping()      - Selects 'microstepsPerFullStep' microsteps per
+    //                           full step (a power of 2 from MIN_MICROSTEPS to
+    //                           MAX_MICROSTEPS), or 0 to go back to the
+    //                           constructor's full or half stepping.  Rebuilds
+    //                           the slow and fast speeds and the default
+    //                           StepAuto profiles (replacing any installed
+    //                           ones), rescales StepPosition(), and releases
+    //                           the coils.  Returns 'false', changing nothing,
+    //                           if the value is not valid or the stepper is
+    //                           moving.
+    // MicrostepsPerFullStep() - Returns the microsteps per full step, or 0 if
+    //                           not microstepping.
+    // StepsPerFullStep()      - Returns the steps per full step in use: the
+    //                           microsteps, or 2 when half stepping, or 1.
+    /////////////////////////////////////////////////////////////////////////////
+    bool SetMicrostepping(uint32_t microstepsPerFullStep);
+    uint32_t MicrostepsPerFullStep() const          { return m_Microsteps; }
+    uint32_t StepsPerFullStep() const               { return m_StepsPerFullStep; }
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Planner()
+    //
+    // Returns the motion planner used for StepAuto moves.  The board installs
+    // default profiles based on rapidSecondsPerRev, which may be replaced or
+    // tuned (e.g. via MotionPlanner::SetMotorLimits()).  The planner should
+    // only be changed while the stepper is idle.
+    /////////////////////////////////////////////////////////////////////////////
+    MotionPlanner &Planner() { return m_Planner; }
+    const MotionPlanner &Planner() const { return m_Planner; }
 
 
     // User accessable I/O pin assignments.
@@ -163,14 +489,152 @@ public:
     static const int32_t STEP_CW        = 1;   // Clockwise specifier.
     static const int32_t STEP_CCW       = -1;  // Counterclockwise specifier.
 
+    // Coil power constants.  A 28BYJ-48 (5 V) coil is about 50 ohms, which
+    // leaves about 80 mA after the ULN2003 driver's drop.
+    static const uint32_t COIL_CURRENT_MA   = 80;  // Current per energized coil.
+    static const uint32_t HOLD_DUTY_PERCENT = 30;  // Default CoilHoldReduced duty.
+
+    // Microstepping limits.
+    static const uint32_t MIN_MICROSTEPS    = 4;   // Fewest microsteps per full step.
+    static const uint32_t MAX_MICROSTEPS    = 32;  // Most microsteps per full step.
+
+    // Board I/O pin assignments.  These are used internally, and are only
+    // public so that HAL backends (such as the simulator) can find them, and
+    // so that input edges can be told apart.
+    static const uint8_t PHASE_1_PIN    = 19;  // Stepper phase 1 output.
+    static const uint8_t PHASE_2_PIN    = 16;  // Stepper phase 2 output.
+    static const uint8_t PHASE_3_PIN    = 17;  // Stepper phase 3 output.
+    static const uint8_t PHASE_4_PIN    = 21;  // Stepper phase 4 output.
+    static const uint8_t HOME_PIN       = 32;  // Home input pin assignment.
+    static const uint8_t PUSHBUTTON_PIN = 26;  // Pushbutton input pin assignment.
+
 protected:
 
 
 private:
+    /////////////////////////////////////////////////////////////////////////////
+    // Private types.
+    /////////////////////////////////////////////////////////////////////////////
+
+    // A single queued move.
+    struct StepperMove_t
+    {
+        int32_t        steps;       // Signed number of steps to move.
+        StepperSpeed_t speed;       // Speed profile for the move.
+    };
+
     /////////////////////////////////////////////////////////////////////////////
     // Private methods.
     /////////////////////////////////////////////////////////////////////////////
 
+    /////////////////////////////////////////////////////////////////////////////
+    // StepTimerCallback()
+    //
+    // Static trampoline that is registered with the StepTimer.  'pArg' points
+    // to the GenericClockBoard instance that owns the timer.
+    /////////////////////////////////////////////////////////////////////////////
+    static void StepTimerCallback(void *pArg);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // HomeIsr(), ButtonIsr()
+    //
+    // Static pin change interrupt trampolines.  'pArg' points to the
+    // GenericClockBoard instance.
+    /////////////////////////////////////////////////////////////////////////////
+    static void IRAM_ATTR HomeIsr(void *pArg);
+    static void IRAM_ATTR ButtonIsr(void *pArg);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // OnInputEdge()
+    //
+    // Records a change of the home or pushbutton input, updates the cached
+    // input state and the home latch, and queues the edge.
+    /////////////////////////////////////////////////////////////////////////////
+    void IRAM_ATTR OnInputEdge(uint8_t pin);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // OnStepTimer()
+    //
+    // Called each time the step timer expires.  Outputs the next step of the
+    // current move (fetching the next queued move as needed) and re-arms the
+    // timer for that step's duration.  When no work remains, de-energizes the
+    // stepper and marks the board idle.
+    /////////////////////////////////////////////////////////////////////////////
+    void OnStepTimer();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // ConfigureSteps()
+    //
+    // Sets the number of phases, the slow and fast speeds, and the default
+    // StepAuto profiles for the current steps per full step.
+    /////////////////////////////////////////////////////////////////////////////
+    void ConfigureSteps();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // OutputMicrostep()
+    //
+    // Drives the coils for microstep 'phase' at 'percent' of the sine table
+    // duties.  Returns the coils' load in COIL_UNITs (see AccountCoils()).
+    /////////////////////////////////////////////////////////////////////////////
+    uint32_t OutputMicrostep(uint32_t phase, uint32_t percent);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // ReleaseDutyPins()
+    //
+    // Returns the phase pins to normal output control, if microstepping.
+    /////////////////////////////////////////////////////////////////////////////
+    void ReleaseDutyPins();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // PhaseCoils()
+    //
+    // Returns the load, in COIL_UNITs, of the coils that 'phase' energizes.
+    /////////////////////////////////////////////////////////////////////////////
+    uint32_t PhaseCoils(uint32_t phase) const
+    {
+        if (!m_Microsteps)
+        {
+            return m_StepperCoils[phase];
+        }
+        uint32_t r = phase & (m_Microsteps - 1);
+        return m_MicrostepDuty[m_Microsteps - r] + m_MicrostepDuty[r];
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // GoIdle()
+    //
+    // Called from the step timer callback once the last queued move has
+    // settled.  Applies the coil policy and marks the board idle.  Returns
+    // 'false', without marking the board idle, if a move was queued while the
+    // policy was being applied.
+    /////////////////////////////////////////////////////////////////////////////
+    bool GoIdle();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // AccountCoils()
+    //
+    // Adds the coil on time since the last call to the coil statistics, then
+    // starts timing a load of 'coils' COIL_UNITs, either moving or idle.  A
+    // coil that is fully on is one COIL_UNIT, so that a microstepped coil
+    // counts in proportion to its duty.  Must be called with m_StepMux held.
+    /////////////////////////////////////////////////////////////////////////////
+    void AccountCoils(uint64_t nowUs, bool moving, uint32_t coils)
+    {
+        uint64_t coilUs = (nowUs > m_CoilSinceUs)
+                        ? (nowUs - m_CoilSinceUs) * m_CoilCount / COIL_UNIT : 0;
+        if (m_CoilMoving)
+        {
+            m_CoilStats.movingCoilUs += coilUs;
+        }
+        else
+        {
+            m_CoilStats.idleCoilUs += coilUs;
+        }
+        m_CoilSinceUs = nowUs;
+        m_CoilMoving  = moving;
+        m_CoilCount   = coils;
+    }
+
     /////////////////////////////////////////////////////////////////////////////
     // Unimplemented methods.  We don't want users to try to use these.
     /////////////////////////////////////////////////////////////////////////////
@@ -183,33 +647,107 @@ private:
     /////////////////////////////////////////////////////////////////////////////
 
     // Stepper related constants.
-    static const uint8_t PHASE_1_PIN = 19;
-    static const uint8_t PHASE_2_PIN = 16;
-    static const uint8_t PHASE_3_PIN = 17;
-    static const uint8_t PHASE_4_PIN = 21;
-
     static const uint32_t NUM_STEPPER_PINS = 4;
     static const uint8_t StepperPins[NUM_STEPPER_PINS];
     static const uint8_t StepperPinsReversed[NUM_STEPPER_PINS];
 
-    // I/O pin assignments.
-    static const uint8_t HOME_PIN       = 32;   // Home input pin assignment.
-    static const uint8_t PUSHBUTTON_PIN = 26;   // Pushbutton input pin assignment.
+    static const uint32_t COIL_UNIT = ClockBoardHal::DUTY_MAX;
+                                                // Load of one fully on coil.
+    static const uint32_t MOVE_QUEUE_SIZE = 8;  // Max number of queued moves.
+    static const uint32_t INPUT_EDGE_RING_SIZE = 16; // Max queued input edges.
+    static const uint32_t WAIT_POLL_MS    = 10; // Max sleep per WaitForMove()
+                                                // check, in case a wakeup is
+                                                // missed.
 
 
     /////////////////////////////////////////////////////////////////////////////
     // Private instance data.
     /////////////////////////////////////////////////////////////////////////////
+    ClockBoardHal *m_pHal;          // Hardware abstraction layer.
     int32_t  m_CurrentStepperPhase; // Current phase of stepper.
     const uint8_t *m_pStepperPins;  // Stepper pin array.
-    uint32_t m_NumStepperPhases;    // Number of stepper phases (4 or 8).
+    uint32_t m_RapidSecondsPerRev;  // Seconds per rev at rapid speed.
+    uint32_t m_FullStepsPerRev;     // Full steps per rev.
+    bool     m_HalfStepping;        // True if half stepping when not
+                                    // microstepping.
+    uint32_t m_Microsteps;          // Microsteps per full step, or 0.
+    uint32_t m_StepsPerFullStep;    // Steps per full step (1, 2, or
+                                    // m_Microsteps).
+    uint8_t  m_MicrostepDuty[MAX_MICROSTEPS + 1];
+                                    // Quarter sine wave of coil duties.
+    uint32_t m_NumStepperPhases;    // Number of stepper phases (4, 8, or 4
+                                    // times m_Microsteps).
     uint32_t m_StepperRapidDelayUs; // Micros to delay stepper phase update
                                     // for rapid moves.  Slower moves are based
                                     // on multiples of this value.
     uint32_t m_StepperClearMask;    // Bit pattern of stepper pins.
     uint32_t m_StepperSequence[8];  // Sequence of stepper phases to produce
                                     // clockwise motion.
+    uint16_t m_StepperCoils[8];     // Load of the coils each phase energizes
+                                    // (COIL_UNITs).
     bool     m_InvertHome;          // True if home switch is N.O.
+    StepRamp_t m_SlowRamp;          // Step intervals for StepSlow.
+    StepRamp_t m_FastRamp;          // Step intervals for StepFast.
+    MotionPlanner m_Planner;        // Accel/decel profiles for StepAuto.
+
+    // Asynchronous stepping data.  Fields below are shared with the step
+    // timer callback and are protected by m_StepMux where noted.
+    StepTimer m_StepTimer;          // Paces stepper phase updates.
+    portMUX_TYPE m_StepMux;         // Protects the move queue and m_Moving.
+    StepperMove_t m_MoveQueue[MOVE_QUEUE_SIZE];
+                                    // Queued moves (m_StepMux).
+    uint32_t m_QueueHead;           // Index of oldest queued move (m_StepMux).
+    uint32_t m_QueueCount;          // Number of queued moves (m_StepMux).
+    volatile bool m_Moving;         // True while moves remain (m_StepMux).
+    TaskHandle_t m_WaitingTask;     // Task blocked in WaitForMove(), if any.
+    int64_t  m_StepPosition;        // Steps output since construction
+                                    // (m_StepMux).
+    int32_t  m_MoveDir;             // +1 for CW moves, -1 for CCW moves.
+    uint64_t m_StepStartUs;         // Time the current step was output
+                                    // (m_StepMux).
+    uint32_t m_StepIntervalUs;      // Duration of the current step
+                                    // (m_StepMux).
+    int32_t  m_LastMoveDir;         // Direction of the last move, or 0.
+    uint32_t m_BacklashSteps;       // Take-up steps added on reversal.
+    int32_t  m_MoveTakeUp;          // Take-up steps of the current move.
+    bool     m_HomeLatchArmed;      // True while looking for an edge (m_StepMux).
+    int32_t  m_HomeLatchDir;        // Direction of steps to latch (m_StepMux).
+    bool     m_HomeLatched;         // True once an edge is latched (m_StepMux).
+    volatile bool m_HomeLatchStop;  // True if a latched edge ends the move
+                                    // (m_StepMux).
+    InputEdge_t m_HomeLatchEdge;    // The latched edge (m_StepMux).
+
+    // Input edge data.  These are written by the pin change interrupts.
+    volatile bool m_HomeActive;     // Cached IsHome() state.
+    volatile bool m_ButtonActive;   // Cached IsButtonPressed() state.
+    SpscRing<InputEdge_t, INPUT_EDGE_RING_SIZE> m_InputEdges;
+                                    // Captured edges, oldest first.
+    int32_t  m_MoveDelta;           // Phase increment of the current move.
+    int32_t  m_MoveSteps;           // Length of the current move.
+    int32_t  m_MoveIndex;           // Index of the next step of the move.
+    const StepRamp_t *m_pMoveRamp;  // Step intervals of the current move.
+
+    // Coil power data.
+    CoilPolicy_t m_CoilPolicy;      // What the coils do when idle.
+    uint32_t m_HoldDutyPercent;     // CoilHoldReduced PWM duty.
+    uint32_t m_SettleUs;            // Full current time after the last step.
+    bool     m_Settled;             // True once the last step has settled.
+    bool     m_CoilsHeld;           // True while the HAL holds a phase.
+    CoilStats_t m_CoilStats;        // Coil on time (m_StepMux).
+    uint64_t m_CoilStatsStartUs;    // Time of the last reset (m_StepMux).
+    uint64_t m_CoilSinceUs;         // Start of the current timing (m_StepMux).
+    uint32_t m_CoilCount;           // Load being timed, in COIL_UNITs
+                                    // (m_StepMux).
+    bool     m_CoilMoving;          // True if timing moving coils (m_StepMux).
+
+#if STEP_TIMING_STATS
+    // Step timing data.  Written by the step timer callback.
+    StepperSpeed_t m_MoveSpeed;     // Speed of the current move.
+    StepTimingStats m_StepTiming;   // Recorded statistics (m_StepMux).
+    uint64_t m_TimingLastUs;        // Time of the last phase write.
+    bool     m_TimingStepping;      // True if the last phase write started
+                                    // a step, so the next one ends it.
+#endif
 
 }; // End class GenericClockBoard
 
@@ -17,15 +17,74 @@
 //         stepping and clock positioning.
 //      5. 28BYJ-48 stepper motors are geared such that the actual steps
 //         per revolution using half steps are 4075.52 as opposed to the 4096
-//         that is normally used in Arduino code.  Due to this, there is some
-//         daily clock drift.  To accommodate this, the clock can be optionally
-//         commanded to perform a homing operation periodically at 12:00.
+//         that is normally used in Arduino code.  The actual ratio is given to
+//         GenevaClockMechanics as a fraction so that there is no daily clock
+//         drift.  The clock can also be optionally commanded to perform a
+//         homing operation periodically at 12:00.
+//      6. Each home measures how far the motor really travelled since the
+//         previous one.  GenevaClockMechanics learns the effective steps per
+//         12 hour cycle and the backlash from these measurements and saves them
+//         in NVS.
+//      7. Rather than stopping for a full home at 12:00, the home sensor edge
+//         is latched as the indicator passes 12:00 during normal minute
+//         updates.  Small errors are corrected on the fly, and a full home is
+//         only done if the edge is missing or too far off.
+//      8. The home sensor and pushbutton are read by pin change interrupts
+//         that queue timestamped edges, instead of being polled, so that the
+//         home edge is located to a fraction of a step and short button
+//         presses are not missed.
+//      9. loop() runs a small cooperative scheduler instead of doing
+//         everything in sequence followed by a fixed 100 ms delay.  Each
+//         task runs at its own rate, and the scheduler reports each task's
+//         run time and worst case latency.
+//     10. The clock mechanics run in their own task on core 1 (MotionTask),
+//         away from the WiFi stack on core 0.  loop() sends them minute
+//         updates and home requests through a lock-free queue, so WiFi, the
+//         config portal, and the LED keep running while the clock moves or
+//         homes at power up, on a button press, or after a failed 12:00 check.
+//     11. At power up, the clock resumes from the position it saved, and
+//         starts homing (or just probing for the edge) on core 1 before the
+//         RTC and the network are brought up, so that the motor time and the
+//         network time overlap.  The first minute update is held till there
+//         is a time to show, and the time each boot stage finished is logged.
+//     12. The RGB LED's fades and flashes are played by a LedAnimator ticked
+//         from the scheduler, instead of by RGBLed calls that delay() between
+//         frames.  The power up LED test no longer holds up setup(), and an
+//         error report no longer stops loop().
+//     13. What the LED shows is decided by a LedCompositor, in layers: an
+//         error over homing, over passing events such as an NTP sync, over
+//         the time source.  Each pattern is shown for a minimum time, so a
+//         sync during a home is shown once the home is done, instead of being
+//         painted over, and callbacks post to it without touching the LED.
+//     14. Pushbutton presses are recognized as clicks, double clicks, long
+//         presses, and very long presses by a ButtonGestures fed from the
+//         queued button edges, with the debounce timed from the edges, so
+//         no press holds up the scheduler while it is timed.  Erasing the
+//         config now takes a 10 second hold, and a 3 second hold restarts.
+//     15. The minute task is not run several times a second to see if the
+//         minute has changed.  It finds the sub-second phase of the minute
+//         from when the time read changes, and sleeps till a few ms before
+//         the next boundary, so the update starts within about a millisecond
+//         of it.  The latency is measured and reported.
+//     16. An optional low power mode (LOW_POWER_MODE) lets the clock run from
+//         batteries.  The ESP32 deep sleeps between minutes, and is woken by
+//         the DS3231's minute alarm.  Each wake restores the position kept in
+//         RTC memory, moves the clock, and sleeps again without starting
+//         WiFi.  The average current of each hour is estimated from the time
+//         spent awake, and reported.
 //
 // Note that this implementation relies heavily on the use of an ESP32.  Most
 // ESP32 boards should work with the code.  However, the code probably won't
 // work with other processors, including the ESP8266.
 //
 // History:
+//  - agent 16-OCT-2026
+//    - Moved the loop() work into TaskScheduler tasks, with the clock
+//      mechanics in a MotionTask pinned to core 1.
+//    - Overlapped the power up home with RTC and network bring-up, and
+//      resumed from a saved position when it can be trusted.
+//    - Added non-blocking LED status layers, pushbutton gestures, minute
+//      boundary wakeups, and an optional deep sleep low power mode.
 //  - jmcorbett 11-MAY-2024
 //    - Use RGBLed library for RGB LED outputs to reduce their intensity.
 //    - Made use of the GenericClockBoard library.
@@ -41,8 +100,21 @@
 /////////////////////////////////////////////////////////////////////////////////
 
 #include <String>                   // For String class.
+#include <atomic>                   // For std::atomic.
 #include <WiFiTimeManager.h>        // Manages timezone, DST, and NTP.
 #include "GenevaClockMechanics.h"   // For GenevaClockMechanics (clock mechanics).
+#include "StepIntervalTable.h"      // For compile time step interval tables.
+#include "TaskScheduler.h"          // For TaskScheduler cooperative scheduler.
+#include "MotionTask.h"             // For MotionTask (clock mechanics task).
+#include "LedAnimator.h"            // For LedAnimator non-blocking LED effects.
+#include "LedCompositor.h"          // For LedCompositor LED status layers.
+#include "ButtonGestures.h"         // For ButtonGestures pushbutton gestures.
+#include "MinuteBoundary.h"         // For MinuteBoundary minute wakeups.
+#include <esp_sleep.h>              // For deep sleep and its wakeup sources.
+#include <driver/rtc_io.h>          // For rtc_gpio_pullup_en().
+#if defined CONFIG_PM_ENABLE
+#include <esp_pm.h>                 // For esp_pm_configure().
+#endif
 
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -60,6 +132,14 @@ static const uint32_t RAPID_SECONDS_PER_REV = 8;
 // 28byj-48 has 2048 full steps per full rev of the output shaft (4096 half steps).
 static const uint32_t FULL_STEPS_PER_REV = 2048;
 
+// The 28BYJ-48 gearbox is not exactly 64:1, so the actual number of full steps
+// per rev of the output shaft is closer to 2037.76 (4075.52 half steps).  The
+// exact value is given as the fraction ACTUAL_FULL_STEPS_PER_REV_NUM /
+// ACTUAL_FULL_STEPS_PER_REV_DEN so that the clock does not drift.  Set both to
+// FULL_STEPS_PER_REV and 1 to use the nominal value.
+static const uint32_t ACTUAL_FULL_STEPS_PER_REV_NUM = 203776;
+static const uint32_t ACTUAL_FULL_STEPS_PER_REV_DEN = 100;
+
 // This stepper needs to have the phases reversed.  Set to 'false' if stepper runs
 // backwards.
 static const bool REVERSE_STEPPER = true;
@@ -69,12 +149,50 @@ static const bool REVERSE_STEPPER = true;
 // ture.  If full stepping is desired, set it to false.
 static const bool USE_HALF_STEPPING = true;
 
+// MICROSTEPS selects microstepping, with the coils driven by PWM from a sine
+// table, in MICROSTEPS steps per full step (4, 8, 16, or 32).  The motor runs
+// more smoothly and quietly, and the hands can be placed more finely, at the
+// cost of many more step timer callbacks (16 microsteps is 8 times as many as
+// half stepping).  Set to 0 to use plain half (or full) stepping.
+static const uint32_t MICROSTEPS = 0;
+
 // The home sensor is normally open.  Set to false if normally closed.
 static const bool HOME_SWITCH_NORMALLY_OPEN = true;
 
-// Comment out the following line if homing the clock each 12:00 is not wanted.
+// COIL_POLICY selects what the stepper coils do between moves (see CoilPolicy_t
+// in GenericClockBoard.h).  CoilRelease draws the least current, but leaves the
+// motor free to slip under the Geneva wheel's load.  CoilHoldReduced holds it
+// at COIL_HOLD_DUTY percent of full current.  COIL_SETTLE_MS is how long the
+// last step of each move stays fully energized before the policy applies.  The
+// report task logs the average coil current each policy would draw.
+static const CoilPolicy_t COIL_POLICY = CoilRelease;
+static const uint32_t COIL_HOLD_DUTY  = 30;
+static const uint32_t COIL_SETTLE_MS  = 0;
+
+// Comment out the following line if re-homing the clock when its position
+// check at 12:00 fails is not wanted.
 #define HOME_AT_12 1
 
+// Set LOW_POWER_MODE to 1 to run the clock from batteries.  The ESP32 then
+// spends each minute in deep sleep, and is woken by the DS3231's minute alarm
+// on its INT/SQW output, which must be wired to AUX_1_PIN.  A minute wake only
+// moves the clock, and goes back to sleep without starting WiFi, so it uses
+// the POSIX time zone rules in LOW_POWER_TZ, which should match the time zone
+// given to WiFiTimeManager.  The clock wakes fully, with WiFi, NTP, and the
+// config portal, at power on, when the pushbutton is pressed, and every
+// LOW_POWER_SYNC_HOURS, and stays up for LOW_POWER_AWAKE_MINUTES.  Requires
+// USE_RTC.  The LOW_POWER_*_MA values are the board's current draw, used to
+// estimate the average current from the time spent awake.
+#define LOW_POWER_MODE 0
+static const char    *LOW_POWER_TZ            = "EST5EDT,M3.2.0,M11.1.0";
+static const uint32_t LOW_POWER_SYNC_HOURS    = 24;
+static const uint32_t LOW_POWER_AWAKE_MINUTES = 5;
+static const float    LOW_POWER_AWAKE_MA      = 45.0f;  // Awake, WiFi off.
+static const float    LOW_POWER_WIFI_MA       = 120.0f; // Awake, WiFi on.
+static const float    LOW_POWER_SLEEP_MA      = 0.25f;  // Deep sleep, with
+                                                        // the DS3231.
+static const uint32_t LOW_POWER_BOOT_MS       = 200;    // Wake to setup().
+
 // Define aliases for RGB color arrays for better code readability.
 #define NTP_CLOCK_LED   RGBLed::BLUE   // NTP clock LED color = blue.
 #define LOCAL_CLOCK_LED RGBLed::GREEN  // Local clock LED color = green.
@@ -84,6 +202,10 @@ static const bool HOME_SWITCH_NORMALLY_OPEN = true;
 // END OF USER SETTABLE CONSTANTS
 /////////////////////////////////////////////////////////////////////////////////
 
+#if LOW_POWER_MODE && !defined USE_RTC
+#error "LOW_POWER_MODE requires USE_RTC."
+#endif
+
 
 /////////////////////////////////////////////////////////////////////////////////
 // Local global variables.
@@ -94,6 +216,87 @@ static GenevaClockMechanics
    gClock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, REVERSE_STEPPER,
         USE_HALF_STEPPING, HOME_SWITCH_NORMALLY_OPEN);
 
+// Step interval tables for the above motor configuration, generated at compile
+// time.  These replace the ramps that the board would otherwise compute at run
+// time.
+typedef StepIntervalTable<RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV,
+                          USE_HALF_STEPPING> StepTables;
+
+// Runs the clock mechanics in their own task, once started by setup().  From
+// then on, gClock is only moved through gMotion.
+static MotionTask gMotion(gClock);
+
+// Number of homes requested from gMotion.
+static uint32_t gHomesRequested = 0;
+
+// Runs the clock's periodic work from loop().
+static TaskScheduler gScheduler;
+
+// MinuteTask()'s scheduler task.  It runs when gMinuteBoundary wants.
+static int32_t gMinuteTask = TaskScheduler::INVALID_TASK;
+
+// Finds the time of the next minute boundary for MinuteTask().
+static MinuteBoundary gMinuteBoundary;
+
+// Time from each minute boundary to the motion task starting the update,
+// since the last report (see MinuteTask() and ReportTask()).
+struct MinuteLatency_t
+{
+    uint32_t updates;           // Updates timed.
+    uint64_t totalUs;           // Total latency.
+    uint32_t maxUs;             // Worst latency.
+    uint32_t maxUncertainUs;    // Worst uncertainty of the boundary time.
+};
+static MinuteLatency_t gMinuteLatency = { 0, 0, 0, 0 };
+
+// Plays the RGB LED's fades and flashes.  Ticked by LedTask().
+static LedAnimator gLed(GenericClockBoard::RgbLed);
+
+// Decides what gLed shows, from the status layers posted to it.
+static LedCompositor gLedStatus(gLed);
+
+// gLedStatus patterns (see SetupLedPatterns()).
+static uint8_t gNtpPattern    = LedCompositor::INVALID_PATTERN;
+static uint8_t gLocalPattern  = LedCompositor::INVALID_PATTERN;
+static uint8_t gHomingPattern = LedCompositor::INVALID_PATTERN;
+static uint8_t gSyncPattern   = LedCompositor::INVALID_PATTERN;
+
+// Recognizes pushbutton gestures.  Fed by ButtonTask().
+static ButtonGestures gButton;
+
+// Error being reported on the LED (see ReportIfError()), or 0.
+static uint32_t gErrorCode = 0;
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Boot pipeline stages.
+//
+// setup() starts the home on the motion task first, then brings up the RTC and
+// the network while the clock moves.  The first time is sent to the clock once
+// there is a time source, and the motion task runs it as soon as the home is
+// done.  Each stage's finish time, in ms after power on, is recorded by
+// BootStageDone() and reported by ReportBoot() once the time is showing.
+/////////////////////////////////////////////////////////////////////////////////
+enum BootStage_t
+{
+    BootMotionStarted = 0,      // Motion task started, and any home requested.
+    BootRtcReady,               // RTC checked.
+    BootNetworkStarted,         // WiFiTimeManager initialized and connecting.
+    BootSetupDone,              // setup() returned.
+    BootTimeSource,             // RTC, NTP, or (after a wait) local time ready.
+    BootHomed,                  // Mechanism position known.
+    BootShowingTime,            // Dial showing the current time.
+    NUM_BOOT_STAGES
+};
+static const char *BOOT_STAGE_NAMES[NUM_BOOT_STAGES] =
+    { "motion started", "rtc ready", "network started", "setup done",
+      "time source", "homed", "showing time" };
+static uint32_t gBootStageMs[NUM_BOOT_STAGES];
+                                // When each stage finished, or 0.
+
+// Longest to wait for the RTC or NTP before showing the local clock's time.
+static const uint32_t TIME_SOURCE_WAIT_MS = 60000;
+
 
 /////////////////////////////////////////////////////////////////////////////////
 // WiFiTimeManager related constants and variables.
@@ -117,6 +320,12 @@ static const char *AP_PWD  = NULL;
 
     #include <DS323x_Generic.h> // https://github.com/khoih-prog/DS323x_Generic
     static DS323x gRtc;         // The DS3231 RTC instance.
+    static std::atomic<bool> gRtcTimeValid(false);
+                                // True once the RTC holds a real time.
+    static std::atomic<bool> gTimeSet(false);
+                                // Set by UtcSetCallback(), which may run
+                                // outside the loop task, when the time was
+                                // set.  Cleared by MinuteTask().
 
 
     /////////////////////////////////////////////////////////////////////////////
@@ -152,12 +361,17 @@ static const char *AP_PWD  = NULL;
         }
 
         // If the RTC is uninitialized, then set a default time (the start of 2024).
+        // It isn't a time source till NTP sets it.
         if (rRtc.oscillatorStopFlag())
         {
             printlnD("RTC uninitialized.");
             rRtc.now(DateTime(2024, 1, 1, 0, 0, 0));
             rRtc.oscillatorStopFlag(false);
         }
+        else
+        {
+            gRtcTimeValid = true;
+        }
 
         // Setup the RTC callbacks.  These should be done before calling
         // WiFiTimeManager::Init(), since it will use the callbacks to initialize
@@ -187,76 +401,387 @@ static const char *AP_PWD  = NULL;
     //
     // This callback is invoked after an NTP time update is received from the NTP
     // server.  It converts the time_t value to a DateTime value and updates the
-    // RTC time.
+    // RTC time.  It may run outside the loop task, so it only flags the new
+    // time for the scheduled tasks (see gTimeSet).
     /////////////////////////////////////////////////////////////////////////////
     void UtcSetCallback(time_t t)
     {
         // Push the new time to the RTC.
         gRtc.now(DateTime(t));
 
-        // Blink LED to show that we just got an update.
-        gClock.RgbLed.brightness(RGBLed::MAGENTA, 2);
+        // Blink LED to show that we just got an update.  It is shown for a
+        // second once nothing more important is on the LED.
+        gLedStatus.Pulse(LedLayerEvent, gSyncPattern);
 
         // Reset the RTC stop flag to inidcate that the RTC time is valid.
         // Really only needs to be done once, but adds little overhead when
         // done here.
         gRtc.oscillatorStopFlag(false);
+        gRtcTimeValid = true;
+
+        // The time may have jumped.  WiFiTask() wakes the minute task to find
+        // the minute boundary again.
+        gTimeSet = true;
     } // End UtcSetCallback().
 
 #endif // End USE_RTC.
 
 
 /////////////////////////////////////////////////////////////////////////////////
-// CheckButton()
+// Low power mode code.
+/////////////////////////////////////////////////////////////////////////////////
+#if LOW_POWER_MODE
+
+    // DS3231 registers and bits used for the minute alarm.
+    static const uint8_t DS3231_ADDRESS = 0x68;     // I2C address.
+    static const uint8_t DS3231_ALARM2  = 0x0b;     // Alarm 2 minutes, hours,
+                                                    // and day/date registers.
+    static const uint8_t DS3231_CONTROL = 0x0e;     // Control register.
+    static const uint8_t DS3231_STATUS  = 0x0f;     // Status register.
+    static const uint8_t DS3231_A2M     = 0x80;     // Alarm 2 mask bit.
+    static const uint8_t DS3231_INTCN   = 0x04;     // INT/SQW is the alarm
+                                                    // interrupt.
+    static const uint8_t DS3231_A2IE    = 0x02;     // Alarm 2 interrupt enable.
+    static const uint8_t DS3231_A1IE    = 0x01;     // Alarm 1 interrupt enable.
+    static const uint8_t DS3231_A2F     = 0x02;     // Alarm 2 flag.
+
+    // Power accounting, kept in RTC memory across deep sleeps.  Zeroed at
+    // power on and by a restart.
+    struct PowerLog_t
+    {
+        uint32_t syncUtc;           // RTC time of the last full wake.
+        uint32_t hourUtc;           // RTC time the current hour began.
+        uint32_t wakes;             // Wakes this hour.
+        float    awakeS;            // Seconds awake this hour.
+        float    chargeMaS;         // Charge used awake this hour (mA s).
+        float    lastAvgMa;         // Average current of the last hour.
+    };
+    RTC_DATA_ATTR static PowerLog_t gPowerLog;
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    // WriteRtcRegister(), ReadRtcRegister()
+    //
+    // Write and read a DS3231 register directly, for the alarm settings that
+    // the DS323x library is not used for.
+    /////////////////////////////////////////////////////////////////////////////
+    void WriteRtcRegister(uint8_t reg, uint8_t value)
+    {
+        Wire.beginTransmission(DS3231_ADDRESS);
+        Wire.write(reg);
+        Wire.write(value);
+        Wire.endTransmission();
+    } // End WriteRtcRegister().
+
+    uint8_t ReadRtcRegister(uint8_t reg)
+    {
+        Wire.beginTransmission(DS3231_ADDRESS);
+        Wire.write(reg);
+        Wire.endTransmission(false);
+        Wire.requestFrom(DS3231_ADDRESS, static_cast<uint8_t>(1));
+        return static_cast<uint8_t>(Wire.read());
+    } // End ReadRtcRegister().
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SetMinuteAlarm()
+    //
+    // Sets DS3231 alarm 2 to go off at the start of every minute, with the
+    // INT/SQW output (active low) as its interrupt instead of a square wave,
+    // and clears the alarm flag so that the output is released till the next
+    // minute.
+    /////////////////////////////////////////////////////////////////////////////
+    void SetMinuteAlarm()
+    {
+        for (uint8_t i = 0; i < 3; i++)
+        {
+            WriteRtcRegister(DS3231_ALARM2 + i, DS3231_A2M);
+        }
+        uint8_t control = ReadRtcRegister(DS3231_CONTROL) & ~DS3231_A1IE;
+        WriteRtcRegister(DS3231_CONTROL, control | DS3231_INTCN | DS3231_A2IE);
+        WriteRtcRegister(DS3231_STATUS, ReadRtcRegister(DS3231_STATUS) & ~DS3231_A2F);
+    } // End SetMinuteAlarm().
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    // AccountPower()
+    //
+    // Adds the charge used since this wake began to gPowerLog: the boot, the
+    // time since, at 'awakeMa', and the stepper coils.  Once an hour of RTC
+    // time has passed, logs the average current over it, counting the rest of
+    // the hour as asleep, and starts the next hour.
+    /////////////////////////////////////////////////////////////////////////////
+    void AccountPower(uint32_t nowUtc, float awakeMa)
+    {
+        CoilStats_t coils;
+        gClock.GetCoilStats(coils);
+        float awakeS = (LOW_POWER_BOOT_MS + millis()) / 1000.0f;
+        gPowerLog.hourUtc    = gPowerLog.hourUtc ? gPowerLog.hourUtc :
+                               nowUtc - static_cast<uint32_t>(awakeS);
+        gPowerLog.wakes++;
+        gPowerLog.awakeS    += awakeS;
+        gPowerLog.chargeMaS += awakeS * awakeMa +
+                               gClock.EstimateCoilMa(COIL_POLICY, coils) * coils.elapsedUs / 1.0e6;
+
+        uint32_t elapsedS = nowUtc - gPowerLog.hourUtc;
+        if (elapsedS >= 3600)
+        {
+            float asleepS = (elapsedS > gPowerLog.awakeS) ? elapsedS - gPowerLog.awakeS : 0.0f;
+            gPowerLog.lastAvgMa = (gPowerLog.chargeMaS + asleepS * LOW_POWER_SLEEP_MA) / elapsedS;
+            debugI("Low power: %u wakes, %.1f s awake in %u s, average %.3f mA.",
+                   gPowerLog.wakes, gPowerLog.awakeS, elapsedS, gPowerLog.lastAvgMa);
+            gPowerLog.hourUtc   = nowUtc;
+            gPowerLog.wakes     = 0;
+            gPowerLog.awakeS    = 0.0f;
+            gPowerLog.chargeMaS = 0.0f;
+        }
+    } // End AccountPower().
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    // EnterDeepSleep()
+    //
+    // Accounts for this wake, sets the minute alarm, and deep sleeps till the
+    // alarm pulls AUX_1_PIN low or the pushbutton is pressed.  The clock's
+    // position must already be saved.  Does not return.
+    /////////////////////////////////////////////////////////////////////////////
+    void EnterDeepSleep(uint32_t nowUtc, float awakeMa)
+    {
+        const gpio_num_t ALARM_PIN  = static_cast<gpio_num_t>(GenericClockBoard::AUX_1_PIN);
+        const gpio_num_t BUTTON_PIN = static_cast<gpio_num_t>(GenericClockBoard::PUSHBUTTON_PIN);
+        AccountPower(nowUtc, awakeMa);
+        SetMinuteAlarm();
+        rtc_gpio_pullup_en(ALARM_PIN);
+        rtc_gpio_pulldown_dis(ALARM_PIN);
+        rtc_gpio_pullup_en(BUTTON_PIN);
+        rtc_gpio_pulldown_dis(BUTTON_PIN);
+        esp_sleep_enable_ext0_wakeup(ALARM_PIN, 0);
+        esp_sleep_enable_ext1_wakeup(1ULL << BUTTON_PIN, ESP_EXT1_WAKEUP_ALL_LOW);
+        Serial.flush();
+        esp_deep_sleep_start();
+    } // End EnterDeepSleep().
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    // MinuteWake()
+    //
+    // Called from setup(), after the clock's position is restored, when the
+    // minute alarm woke us.  Moves the clock to the RTC's time and goes back
+    // to sleep, without starting the motion task or WiFi.  Returns, so that
+    // setup() carries on with a full wake, if the position was not restored
+    // from a clean sleep, the RTC time is not valid, a time sync is due, or
+    // the clock needs a home.
+    /////////////////////////////////////////////////////////////////////////////
+    void MinuteWake()
+    {
+        Wire.begin();
+        gRtc.attach(Wire);
+        if (gClock.HomeRequired() || gRtc.oscillatorStopFlag())
+        {
+            return;
+        }
+        uint32_t nowUtc = static_cast<uint32_t>(UtcGetCallback());
+        if (nowUtc - gPowerLog.syncUtc >= LOW_POWER_SYNC_HOURS * 3600)
+        {
+            return;
+        }
+
+        time_t t = nowUtc;
+        tm now;
+        setenv("TZ", LOW_POWER_TZ, 1);
+        tzset();
+        localtime_r(&t, &now);
+        gClock.UpdateClock(now);
+        gClock.WaitForMove();
+        if (gClock.HomeRequired() || !gClock.RetainPosition())
+        {
+            return;
+        }
+        EnterDeepSleep(nowUtc, LOW_POWER_AWAKE_MA);
+    } // End MinuteWake().
+
+#endif // End LOW_POWER_MODE.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// IsMinuteWake()
 //
-// This function checks the reset button.  If pressed for a long time (about 3
-// seconds), it will reset all of our WiFi credentials as well as all timezone,
-// DST, and NTP data, then reset the processor.  If pressed for a short time and
-// the network is not connected, it will start the config portal.  It will also
-// home the clock.
+// Returns 'true' if this boot is a low power mode minute alarm wake.
 /////////////////////////////////////////////////////////////////////////////////
-void CheckButton()
+bool IsMinuteWake()
 {
-    // Check for a button press.
-    if (gClock.IsButtonPressed())
+#if LOW_POWER_MODE
+    return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_EXT0;
+#else
+    return false;
+#endif
+} // End IsMinuteWake().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// BootStageDone()
+//
+// Records when a boot stage first finished.
+/////////////////////////////////////////////////////////////////////////////////
+void BootStageDone(BootStage_t stage)
+{
+    if (!gBootStageMs[stage])
+    {
+        gBootStageMs[stage] = millis();
+        debugD("Boot: %s at %u ms.", BOOT_STAGE_NAMES[stage], gBootStageMs[stage]);
+    }
+} // End BootStageDone().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ReportBoot()
+//
+// Logs the boot stage times, and which of the time source and the home held
+// up showing the time.
+/////////////////////////////////////////////////////////////////////////////////
+void ReportBoot()
+{
+    for (uint32_t i = 0; i < NUM_BOOT_STAGES; i++)
+    {
+        debugI("Boot: %-15s %6u ms", BOOT_STAGE_NAMES[i], gBootStageMs[i]);
+    }
+    debugI("Boot critical path: %s.",
+           (gBootStageMs[BootTimeSource] > gBootStageMs[BootHomed]) ? "time source" : "home");
+} // End ReportBoot().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TimeSourceReady()
+//
+// Returns 'true' once there is a time worth showing: from the RTC if it has
+// been set, or from NTP.  Without either, the local clock's time is used
+// after TIME_SOURCE_WAIT_MS, as a clock with no RTC and no network always did.
+/////////////////////////////////////////////////////////////////////////////////
+bool TimeSourceReady()
+{
+    if (gBootStageMs[BootTimeSource])
+    {
+        return true;
+    }
+    bool ready = gpWtm->UsingNetworkTime() || (millis() >= TIME_SOURCE_WAIT_MS);
+#if defined USE_RTC
+    ready = ready || gRtcTimeValid;
+#endif
+    if (ready)
+    {
+        BootStageDone(BootTimeSource);
+    }
+    return ready;
+} // End TimeSourceReady().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// RequestHome()
+//
+// Asks the motion task to home the clock, unless a home it was asked for has
+// not finished yet.
+/////////////////////////////////////////////////////////////////////////////////
+void RequestHome()
+{
+    if ((gMotion.Status().homesDone >= gHomesRequested) && gMotion.Home())
+    {
+        gHomesRequested++;
+    }
+} // End RequestHome().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SaveClockPosition()
+//
+// Has the motion task save the clock's position as a clean shutdown, so that
+// the next boot can skip the home.  Waits at most a second for the save, since
+// the motion task may be stuck.
+//
+// Arguments:
+//   - retainOnly - If 'true', the position is only saved to retained memory,
+//                  for a deep sleep, and storage keeps its Idle position (see
+//                  GenevaClockMechanics::RetainPosition()).
+/////////////////////////////////////////////////////////////////////////////////
+void SaveClockPosition(bool retainOnly)
+{
+    const uint32_t SAVE_WAIT_MS = 1000;
+    uint32_t commandsRun = gMotion.Status().commandsRun;
+    if (retainOnly ? gMotion.RetainPosition() : gMotion.SavePosition())
     {
-        // Poor mans debounce/press-hold.
-        delay(50);
-        if(gClock.IsButtonPressed())
+        uint32_t startMs = millis();
+        while ((gMotion.Status().commandsRun == commandsRun) &&
+               (millis() - startMs < SAVE_WAIT_MS))
         {
-            printlnI("Button Pressed.");
-            // Loop to check for button release.  If still pressed after 3
-            // seconds, indicates a long press (reset request).
-            // If released before 3 seconds, indicates a short press which
-            // will preform a home, and restart the config portal if not
-            // currently connected.
-            const uint32_t BUTTON_CHECK_DELAY_MS = 100;
-            for (uint32_t i = 0; i < 3000; i += BUTTON_CHECK_DELAY_MS)
-            {
-                if (!gClock.IsButtonPressed())
-                {
-                    if (!gpWtm->IsConnected())
-                    {
-                        printlnI("Starting config portal.");
-                        gpWtm->setConfigPortalBlocking(false);
-                        gpWtm->setConfigPortalTimeout(0);
-                        gpWtm->startConfigPortal(AP_NAME);
-                    }
-                    gClock.Home();
-                    break;
-                }
-                delay(BUTTON_CHECK_DELAY_MS);
-            }
-            // Still holding button for 3s, reset settings and restart.
-            if(gClock.IsButtonPressed())
-            {
-                printlnI("Button Held, Erasing Config and restarting.");
-                gpWtm->ResetData();
-                ESP.restart();
-            }
+            delay(10);
         }
     }
-} // End CheckButton().
+} // End SaveClockPosition().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// RestartClock()
+//
+// Saves the clock's position as a clean shutdown, then restarts the processor.
+/////////////////////////////////////////////////////////////////////////////////
+void RestartClock()
+{
+    SaveClockPosition(false);
+    ESP.restart();
+} // End RestartClock().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// HandleButton()
+//
+// This function acts on a pushbutton gesture recognized by gButton:
+//      Click           - Homes the clock, and starts the config portal if the
+//                        network is not connected.
+//      Double click    - Starts the config portal, even if connected.
+//      Long press      - Held 3 to 10 seconds, then released.  Saves the
+//                        position and restarts.
+//      Very long press - Held for 10 seconds.  Resets all of our WiFi
+//                        credentials as well as all timezone, DST, and NTP
+//                        data, then restarts.
+//
+// The button is not polled.  Its edges are captured by interrupt and queued
+// by the board with timestamps, and ButtonTask() passes them to gButton,
+// which filters contact bounce using the edges' own times, so nothing here
+// waits for the button.
+/////////////////////////////////////////////////////////////////////////////////
+void HandleButton(const ButtonEvent_t &event)
+{
+    switch (event.gesture)
+    {
+    case ButtonClick:
+        printlnI("Button clicked.");
+        if (!gpWtm->IsConnected())
+        {
+            printlnI("Starting config portal.");
+            gpWtm->setConfigPortalBlocking(false);
+            gpWtm->setConfigPortalTimeout(0);
+            gpWtm->startConfigPortal(AP_NAME);
+        }
+        RequestHome();
+        break;
+    case ButtonDoubleClick:
+        printlnI("Button double clicked, starting config portal.");
+        gpWtm->setConfigPortalBlocking(false);
+        gpWtm->setConfigPortalTimeout(0);
+        gpWtm->startConfigPortal(AP_NAME);
+        break;
+    case ButtonLongPress:
+        printlnI("Button held, restarting.");
+        RestartClock();
+        break;
+    case ButtonVeryLongPress:
+        printlnI("Button held, erasing config and restarting.");
+        gpWtm->ResetData();
+        RestartClock();
+        break;
+    default:
+        break;
+    }
+} // End HandleButton().
 
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -266,47 +791,335 @@ void CheckButton()
 // times if the specified count is non-zero.  A 'blinkCount' value of zero simply
 // returns.
 //
-// Note that a non-zero 'blinkCount' will cause the function to repeat until
-// the pushbotton is pressed.  This will cause the system to reboot.
+// Note that a non-zero 'blinkCount' stops the clock, and the blinking repeats
+// until the pushbotton is pressed.  This will cause the system to reboot.
+// The blinking is played by gLed, so this returns at once, and the scheduler
+// keeps the network, debug output, and pushbutton running meanwhile.  Only
+// the first error is reported.
 //
 // Arguments:
 //    - blinkCount - This is the number of blinks to repeatedly display.  A value
 //                   of zero will cause the function to return immediately without
 //                   blinking.
-//
-// Note: Beware that this function enters an (almost) infinite loop.  The only
-//       way to exit (if the blinkCount is non-zero) is to press the pushbutton
-//       which will cause the clock to reboot.
 /////////////////////////////////////////////////////////////////////////////////
 void ReportIfError(uint32_t blinkCount)
 {
-    // If count is non-zero, then repeatedly blink the specified number of times.
-    // Otherwise, simply return.
-    if (blinkCount)
+    if (blinkCount && !gErrorCode)
+    {
+        printlnE("Reporting error on the LED till the button is pressed.");
+        gErrorCode = blinkCount;
+        const LedAnimation_t ERROR_FLASH =
+            { LedFlash, ERROR_LED, 100, 150, 200, 0, static_cast<uint16_t>(blinkCount), 2000 };
+        gLedStatus.Set(LedLayerFatal, gLedStatus.AddPattern(ERROR_FLASH, 0));
+    }
+} // End ReportIfError().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetupLedPatterns()
+//
+// Registers the LED status patterns with gLedStatus.  Called at the start of
+// setup(), before anything can post them.  The error pattern is registered by
+// ReportIfError(), since it depends on the error.
+/////////////////////////////////////////////////////////////////////////////////
+void SetupLedPatterns()
+{
+    const LedAnimation_t NTP_SOLID    = { LedSolid, NTP_CLOCK_LED,   2, 0, 0, 0, 0, 0 };
+    const LedAnimation_t LOCAL_SOLID  = { LedSolid, LOCAL_CLOCK_LED, 2, 0, 0, 0, 0, 0 };
+    const LedAnimation_t HOMING_SOLID = { LedSolid, RGBLed::WHITE,   2, 0, 0, 0, 0, 0 };
+    const LedAnimation_t SYNC_FLASH   = { LedFlash, RGBLed::MAGENTA, 2, 250, 250, 0, 1, 0 };
+    gNtpPattern    = gLedStatus.AddPattern(NTP_SOLID, 0);
+    gLocalPattern  = gLedStatus.AddPattern(LOCAL_SOLID, 0);
+    gHomingPattern = gLedStatus.AddPattern(HOMING_SOLID, 1000);
+    gSyncPattern   = gLedStatus.AddPattern(SYNC_FLASH, 1000);
+} // End SetupLedPatterns().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Scheduled tasks.
+//
+// These used to be run one after the other by loop(), followed by a fixed
+// 100 ms delay.  Now each is run by gScheduler at its own rate (see setup()).
+//
+// MinuteTask() - Sends the current time to the motion task when it changes,
+//                once there is a time source, and records the last boot
+//                stages.  It is not periodic, but runs at the next minute
+//                boundary, or every 250 ms till the time is shown.
+// HomeTask()   - Reports the power up home's result, and requests a home if
+//                UpdateClock()'s 12:00 check failed.
+// WiFiTask()   - Processes the WiFi connection and config portal, and wakes
+//                the minute task when the time was set.
+// LedTask()    - Posts the time source and homing layers to gLedStatus, and
+//                plays the top layer on the LED, after the power up fades.
+// ButtonTask() - Recognizes pushbutton gestures from the queued edges and
+//                acts on them, or restarts if an error is being reported.
+// DebugTask()  - Runs the SerialDebug handler.
+// StatusTask() - Prints the time (for debug only).
+// ReportTask() - Reports and clears the scheduler's task statistics, and the
+//                step timing statistics if STEP_TIMING_STATS is 1.  Also
+//                reports the average coil current of each coil policy, and
+//                in low power mode, the average current of the last hour.
+// SleepTask()  - In low power mode, retains the position and deep sleeps once
+//                the clock has been up LOW_POWER_AWAKE_MINUTES, and is idle
+//                and showing the time.
+/////////////////////////////////////////////////////////////////////////////////
+void MinuteTask(void *pArg)
+{
+    const uint64_t WAIT_US  = 250000;
+    const uint64_t RETRY_US = 20000;
+    static int32_t  lastMinutes = -1;
+    static uint64_t boundaryUs  = 0;
+    uint64_t nowUs = gClock.Hal()->Micros();
+
+    // Time the last update, from the earliest the minute boundary can have
+    // been to the motion task starting the update.
+    MotionStatus_t status = gMotion.Status();
+    if (boundaryUs && (status.updateStartUs >= boundaryUs))
     {
-        // Turn off all LEDs.
-        gClock.RgbLed.off();
-        gClock.RgbLed.brightness(100);
+        uint32_t latencyUs = static_cast<uint32_t>(status.updateStartUs - boundaryUs);
+        gMinuteLatency.updates++;
+        gMinuteLatency.totalUs += latencyUs;
+        gMinuteLatency.maxUs    = (latencyUs > gMinuteLatency.maxUs) ?
+                                  latencyUs : gMinuteLatency.maxUs;
+        boundaryUs = 0;
+    }
 
-        // Blink the specified number of times forever!
-        while (1)
+    if (!gBootStageMs[BootShowingTime])
+    {
+        if (!status.homeRequired && (status.homeState == HomeIdle) &&
+            (status.homesDone >= gHomesRequested))
         {
-            delay(2000);
-
-            // Blink the error LED the specified number of times.
-            for (int i = 0; i < blinkCount; i++)
-            {
-                gClock.RgbLed.flash(ERROR_LED, 150, 200);
-            }
-
-            // Check for button press.  If so, restart the system.
-            if (gClock.IsButtonPressed())
-            {
-                ESP.restart();
-            }
+            BootStageDone(BootHomed);
+        }
+        if (status.showingTime)
+        {
+            BootStageDone(BootShowingTime);
+            ReportBoot();
         }
     }
-} // End ReportIfError().
+
+    // Don't move the clock to a made up time while waiting for a real one, or
+    // at all once an error is being reported.
+    if (gErrorCode || !TimeSourceReady())
+    {
+        gScheduler.RunAt(gMinuteTask, nowUs + WAIT_US);
+        return;
+    }
+
+#if defined USE_RTC
+    // The time was set and may have jumped, so find the minute boundary again.
+    if (gTimeSet.exchange(false))
+    {
+        gMinuteBoundary.Restart();
+    }
+#endif
+
+    tm now;
+    gpWtm->GetLocalTime(&now);
+    bool boundary   = gMinuteBoundary.Observe(nowUs, now);
+    int32_t minutes = now.tm_hour * 60 + now.tm_min;
+    if ((minutes != lastMinutes) && gMotion.UpdateClock(now))
+    {
+        lastMinutes = minutes;
+        if (boundary && gMinuteBoundary.IsLocked())
+        {
+            uint32_t uncertainUs = gMinuteBoundary.UncertainUs();
+            boundaryUs = gMinuteBoundary.BoundaryUs() - uncertainUs;
+            gMinuteLatency.maxUncertainUs = (uncertainUs > gMinuteLatency.maxUncertainUs) ?
+                                            uncertainUs : gMinuteLatency.maxUncertainUs;
+        }
+    }
+
+    // Sleep till the next boundary, unless the update must be retried or the
+    // boot stages are still being watched.
+    uint64_t wakeUs = gMinuteBoundary.NextWakeUs();
+    if (minutes != lastMinutes)
+    {
+        wakeUs = (wakeUs < nowUs + RETRY_US) ? wakeUs : nowUs + RETRY_US;
+    }
+    if (!gBootStageMs[BootShowingTime])
+    {
+        wakeUs = (wakeUs < nowUs + WAIT_US) ? wakeUs : nowUs + WAIT_US;
+    }
+    gScheduler.RunAt(gMinuteTask, wakeUs);
+} // End MinuteTask().
+
+void HomeTask(void *pArg)
+{
+    // Nothing to do till the requested homes are done.
+    static bool powerUpHome = true;
+    MotionStatus_t status = gMotion.Status();
+    if (gErrorCode || (status.homesDone < gHomesRequested) || (status.homeState != HomeIdle))
+    {
+        return;
+    }
+    if (powerUpHome)
+    {
+        powerUpHome = false;
+        ReportIfError(static_cast<uint32_t>(status.homeStatus));
+    }
+
+#if defined HOME_AT_12
+    // UpdateClock() checks the home sensor as the indicator passes 12:00 and
+    // silently corrects any small error.  Only if that check fails (or the
+    // clock has never been homed) is a full home needed.
+    if (status.homeRequired)
+    {
+        RequestHome();
+    }
+#endif // HOME_AT_12
+} // End HomeTask().
+
+void WiFiTask(void *pArg)
+{
+#if defined USE_RTC
+    // Wake the minute task if the time was set (see UtcSetCallback()).
+    if (gTimeSet)
+    {
+        gScheduler.Trigger(gMinuteTask);
+    }
+#endif
+
+    // If not connected, check for a new connection.
+    if(!gpWtm->IsConnected())
+    {
+        if (gpWtm->process())
+        {
+            // This is the place to do something when we transition from
+            // unconnected to connected.  As an example, here we get the time.
+            gpWtm->GetUtcTimeT();
+        }
+    }
+} // End WiFiTask().
+
+void LedTask(void *pArg)
+{
+    static uint8_t steadyPattern = LedCompositor::INVALID_PATTERN;
+    static bool    homing        = false;
+    static bool    testDone      = false;
+
+    // Only post changes, since setting a layer restarts its pattern.
+    uint8_t pattern = gpWtm->UsingNetworkTime() ? gNtpPattern : gLocalPattern;
+    if (pattern != steadyPattern)
+    {
+        steadyPattern = pattern;
+        gLedStatus.Set(LedLayerSteady, pattern);
+    }
+    if ((gMotion.Status().homeState != HomeIdle) != homing)
+    {
+        homing = !homing;
+        if (homing)
+        {
+            gLedStatus.Set(LedLayerHoming, gHomingPattern);
+        }
+        else
+        {
+            gLedStatus.Clear(LedLayerHoming);
+        }
+    }
+
+    // The power up fades are played on gLed directly, unless an error cuts
+    // them short.  Posts made meanwhile wait in gLedStatus.
+    testDone = testDone || gErrorCode || gLed.IsIdle();
+    if (testDone)
+    {
+        gLedStatus.Tick(millis());
+    }
+    else
+    {
+        gLed.Tick(millis());
+    }
+} // End LedTask().
+
+void ButtonTask(void *pArg)
+{
+    // While an error is reported, the button only restarts.
+    if (gErrorCode)
+    {
+        if (gClock.IsButtonPressed())
+        {
+            RestartClock();
+        }
+        return;
+    }
+
+    // Consume the queued input edges.  Only the button's edges matter here;
+    // home sensor edges are handled by the clock mechanics through the latch.
+    InputEdge_t edge;
+    while (gClock.NextInputEdge(edge))
+    {
+        if (edge.pin == GenericClockBoard::PUSHBUTTON_PIN)
+        {
+            gButton.OnEdge(edge.active, edge.timeUs);
+        }
+    }
+    gButton.Poll(gClock.Hal()->Micros());
+
+    ButtonEvent_t event;
+    while (gButton.Next(event))
+    {
+        HandleButton(event);
+    }
+} // End ButtonTask().
+
+void DebugTask(void *pArg)
+{
+    debugHandle();
+} // End DebugTask().
+
+void StatusTask(void *pArg)
+{
+    tm now;
+    gpWtm->GetLocalTime(&now);
+    gpWtm->PrintDateTime(&now);
+} // End StatusTask().
+
+void ReportTask(void *pArg)
+{
+    gScheduler.Report();
+    gScheduler.ResetStats();
+
+    debugI("Minute updates %u, boundary to motion start avg %u us, max %u us "
+           "(boundary known to %u us)", gMinuteLatency.updates,
+           gMinuteLatency.updates ? static_cast<uint32_t>(gMinuteLatency.totalUs /
+                                                          gMinuteLatency.updates) : 0,
+           gMinuteLatency.maxUs, gMinuteLatency.maxUncertainUs);
+    memset(&gMinuteLatency, 0, sizeof(gMinuteLatency));
+
+    CoilStats_t coils;
+    gClock.GetCoilStats(coils);
+    debugI("Coil current: release %.2f mA, full hold %.2f mA, reduced hold %.2f mA",
+           gClock.EstimateCoilMa(CoilRelease, coils), gClock.EstimateCoilMa(CoilHoldFull, coils),
+           gClock.EstimateCoilMa(CoilHoldReduced, coils));
+#if LOW_POWER_MODE
+    debugI("Low power: last hour average %.3f mA.", gPowerLog.lastAvgMa);
+#endif
+#if STEP_TIMING_STATS
+    static StepTimingStats stepTiming;
+    gClock.GetStepTiming(stepTiming);
+    gClock.ResetStepTiming();
+    stepTiming.Report();
+#endif
+} // End ReportTask().
+
+#if LOW_POWER_MODE
+void SleepTask(void *pArg)
+{
+    MotionStatus_t status = gMotion.Status();
+    if (gErrorCode || (millis() < LOW_POWER_AWAKE_MINUTES * 60000) ||
+        !status.showingTime || status.moving || status.homeRequired ||
+        (status.homeState != HomeIdle) || gButton.IsPressed() ||
+        gpWtm->getConfigPortalActive())
+    {
+        return;
+    }
+    SaveClockPosition(true);
+    WiFi.disconnect(true);
+    WiFi.mode(WIFI_OFF);
+    gPowerLog.syncUtc = static_cast<uint32_t>(UtcGetCallback());
+    EnterDeepSleep(gPowerLog.syncUtc, LOW_POWER_WIFI_MA);
+} // End SleepTask().
+#endif // End LOW_POWER_MODE.
 
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -319,9 +1132,47 @@ void setup()
     // Get the Serial class ready for use.
     Serial.begin(250000);
     Serial.setDebugOutput(true);
-    delay(1000);
+    if (!IsMinuteWake())
+    {
+        delay(1000);
+    }
     printlnV("Starting.");
 
+    // Register the LED status patterns before anything can report on the LED.
+    SetupLedPatterns();
+
+    // Use the compile time step interval tables for StepAuto moves.  These
+    // are for half (or full) steps, so microstepping uses the tables the board
+    // computes at run time instead.
+    if (MICROSTEPS)
+    {
+        gClock.SetMicrostepping(MICROSTEPS);
+    }
+    else
+    {
+        StepTables::Install(gClock.Planner());
+    }
+
+    // Use the actual (fractional) steps per rev to eliminate drift.
+    gClock.SetFullStepsPerRev(ACTUAL_FULL_STEPS_PER_REV_NUM, ACTUAL_FULL_STEPS_PER_REV_DEN);
+
+    // Restore the drift calibration learned by previous homes, if any, then
+    // the position the clock was left at.
+    gClock.LoadCalibration();
+    gClock.RestorePosition();
+
+    // Select what the coils do between moves.
+    gClock.SetCoilPolicy(COIL_POLICY, COIL_HOLD_DUTY, COIL_SETTLE_MS);
+
+#if LOW_POWER_MODE
+    // A minute alarm wake just moves the clock and goes back to sleep.  If
+    // it returns, a full wake is needed.
+    if (IsMinuteWake())
+    {
+        MinuteWake();
+    }
+#endif // End LOW_POWER_MODE.
+
     // If the pushbutton is pressed at startup, then perform a home calibration.
     // The red LED will light when the calibration request is detected.  Release
     // the pushbutton before the red LED goes out (2 seconds) in order for the
@@ -333,22 +1184,21 @@ void setup()
         gClock.Calibrate();
     }
 
-    // Cycle the LEDs at power up just to show that they work.  Here we do some
-    // fancy fading of each LED just to show off (and to verify that dimming works).
-    const int FADE_STEPS = 75;
-    const int FADE_DURATION_MS = 750;
-    gClock.RgbLed.fadeIn(NTP_CLOCK_LED, FADE_STEPS, FADE_DURATION_MS);
-    gClock.RgbLed.fadeOut(NTP_CLOCK_LED, FADE_STEPS, FADE_DURATION_MS);
-    gClock.RgbLed.fadeIn(LOCAL_CLOCK_LED, FADE_STEPS, FADE_DURATION_MS);
-    gClock.RgbLed.fadeOut(LOCAL_CLOCK_LED, FADE_STEPS, FADE_DURATION_MS);
-    gClock.RgbLed.fadeIn(ERROR_LED, FADE_STEPS, FADE_DURATION_MS);
-    gClock.RgbLed.fadeOut(ERROR_LED, FADE_STEPS, FADE_DURATION_MS);
-    gClock.RgbLed.brightness(2);
-
-    // Home the clock to 12:00 while showing white LED.  Display any error.
-    gClock.RgbLed.brightness(RGBLed::WHITE, 2);
-    ReportIfError(static_cast<uint32_t>(gClock.Home()));
-    gClock.RgbLed.off();
+    // Start the motion task, and have it home the clock to 12:00 first, since
+    // the home is usually the longest stage.  Everything below runs on this
+    // core while the clock moves, and the home task displays any error.  If
+    // the position was restored, the home is just a short probe for the edge
+    // where it should be, and after a clean restart, no home is needed at all.
+    if (!gMotion.Begin())
+    {
+        const uint32_t MOTION_TASK_ERROR = 6;
+        ReportIfError(MOTION_TASK_ERROR);
+    }
+    if (gMotion.Status().homeRequired)
+    {
+        RequestHome();
+    }
+    BootStageDone(BootMotionStarted);
 
     // Init a pointer to our WiFiTimeManager instance.
     // This should be done before RTC init since the WiFiTimeManager
@@ -362,6 +1212,7 @@ void setup()
     // to initialize the current time.
     ReportIfError(SetupRtc(gRtc, gpWtm));
 #endif // End USE_RTC.
+    BootStageDone(BootRtcReady);
 
     // Initialize the WiFiTimeManager class with our AP and button selections.
     gpWtm->Init(AP_NAME, AP_PWD, SETUP_BUTTON);
@@ -382,6 +1233,50 @@ void setup()
         printlnA("Connected.)");
         gpWtm->GetUtcTimeT();
     }
+    BootStageDone(BootNetworkStarted);
+
+    // Cycle the LEDs at power up just to show that they work.  Here we do some
+    // fancy fading of each LED just to show off (and to verify that dimming works).
+    // The fades are queued, and played by the LED task while the clock moves and
+    // the network connects.  After them, the LED task shows the LED status
+    // layers.
+    const uint16_t FADE_DURATION_MS = 750;
+    int *pFadeColors[] = { NTP_CLOCK_LED, LOCAL_CLOCK_LED, ERROR_LED };
+    for (uint32_t i = 0; i < sizeof(pFadeColors) / sizeof(pFadeColors[0]); i++)
+    {
+        LedAnimation_t fadeIn  = { LedFadeIn,  pFadeColors[i], 100, FADE_DURATION_MS, 0, 1, 0, 0 };
+        LedAnimation_t fadeOut = { LedFadeOut, pFadeColors[i], 100, FADE_DURATION_MS, 0, 1, 0, 0 };
+        gLed.Queue(fadeIn);
+        gLed.Queue(fadeOut);
+    }
+
+#if defined CONFIG_PM_ENABLE
+    // Let the idle task lower the CPU clock while the scheduler is idle, if
+    // the core was built with power management.  Automatic light sleep is
+    // left off, since it would stop the LEDC duties that hold the coils and
+    // microstep, and the pin change interrupts that latch the home edge.
+    esp_pm_config_esp32_t pmConfig = { 240, 80, false };
+    esp_pm_configure(&pmConfig);
+#endif
+
+    // Run the clock's periodic work.  Periods and deadlines are in ms, and
+    // higher priorities run first.
+    //                 name      function    arg   period  deadline  priority
+    gScheduler.AddTask("button", ButtonTask, NULL,     20,       50, 7);
+    gMinuteTask =
+    gScheduler.AddTask("minute", MinuteTask, NULL,      0,     1000, 6);
+    gScheduler.AddTask("home",   HomeTask,   NULL,   1000,     1000, 5);
+    gScheduler.AddTask("wifi",   WiFiTask,   NULL,     50,      200, 4);
+    gScheduler.AddTask("led",    LedTask,    NULL,     20,      100, 3);
+    gScheduler.AddTask("debug",  DebugTask,  NULL,     50,      200, 2);
+    gScheduler.AddTask("status", StatusTask, NULL,  10000,     1000, 1);
+    gScheduler.AddTask("report", ReportTask, NULL, 600000,     1000, 0);
+#if LOW_POWER_MODE
+    gScheduler.AddTask("sleep",  SleepTask,  NULL,   1000,     1000, 0);
+#endif
+    gScheduler.Trigger(gMinuteTask);
+    gScheduler.ResetStats();
+    BootStageDone(BootSetupDone);
 
 } // End setup().
 
@@ -389,69 +1284,14 @@ void setup()
 /////////////////////////////////////////////////////////////////////////////////
 // loop()
 //
-// The Arduino loop() function.  Polls the WiFiTimeManager if we are not already
-// connected to the WiFi.  Get the UTC time on a transition of the WiFi being
-// connected.  Re-home the clock twice per day.
+// The Arduino loop() function.  Runs the scheduled tasks (see setup()), which
+// poll the WiFiTimeManager if we are not already connected to the WiFi, keep
+// the clock at the current time, re-home it if needed, and handle the LED,
+// the pushbutton, and debug output.
 /////////////////////////////////////////////////////////////////////////////////
 void loop()
 {
-    // If not connected, check for a new connection.
-    if(!gpWtm->IsConnected())
-    {
-        // Avoid delays() in loop when non-blocking and other long running code.
-        if (gpWtm->process())
-        {
-            // This is the place to do something when we transition from
-            // unconnected to connected.  As an example, here we get the time.
-            gpWtm->GetUtcTimeT();
-        }
-    }
-
-    // Update the LEDs.
-    gClock.RgbLed.brightness(
-        gpWtm->UsingNetworkTime() ? NTP_CLOCK_LED : LOCAL_CLOCK_LED, 2);
-
-    // Update the time and run the clock's mechanics.
-    tm now;
-    gpWtm->GetLocalTime(&now);
-    gClock.UpdateClock(now);
-
-#if defined HOME_AT_12
-    // Re adjust the clock twice per day at 12:00 if desired.
-    static bool clockAdjusted = false;
-    if (((now.tm_hour % 12) == 0) && (now.tm_min == 0))
-    {
-        // If we haven't done so yet since it turned 12:00:00 , home the clock in
-        // order to keep it accurate. This insures that we only home the clock
-        // once at each 12:00:00.
-        if (!clockAdjusted)
-        {
-            gClock.Home();
-            clockAdjusted = true;
-        }
-    }
-    else
-    {
-        clockAdjusted = false;
-    }
-#endif // HOME_AT_12
-
-    // Update the debug handler.
-    debugHandle();
-
-    // Read the time every 10 seconds (for debug only).
-    static uint32_t lastTime = millis();
-    uint32_t thisTime = millis();
-    const uint32_t updateTime = 10000;
-    if (thisTime - lastTime >= updateTime)
-    {
-        // Read the local time and display the results.
-        lastTime = thisTime;
-        gpWtm->PrintDateTime(&now);
-    }
-
-    // Add some delay till the next loop iterataion.
-    const uint32_t LOOP_DELAY_MS = 100;
-    delay(LOOP_DELAY_MS);
+    // Run whatever tasks are due, then sleep till the next one is.
+    gScheduler.RunOnce();
 
 } // End loop().
@@ -18,6 +18,11 @@
 // That is, only GPIO 0 through GPIO 31 may be used to run the stepper.
 //
 // History:
+//  - agent 16-OCT-2026
+//    - Moved the stepping onto ClockBoardHal and MotionPlanner.
+//    - Added drift and backlash calibration, on the fly home verification, a
+//      resumable home state machine, backlash compensation, cost based
+//      UpdateClock() moves, and saved and retained positions.
 //  - jmcorbett 11-MAY-2024
 //    Original code.
 //
@@ -25,9 +30,22 @@
 //
 /////////////////////////////////////////////////////////////////////////////////
 
+#include <math.h>                   // For sqrt(), fabs() ...
+#include <string.h>                 // For memset().
 #include "GenevaClockMechanics.h"   // For GenevaClockMechanics class.
 
 
+// Drift calibration constants.
+const char  *GenevaClockMechanics::CAL_STORAGE_KEY     = "cal";
+const double GenevaClockMechanics::CAL_FORGET          = 0.9;
+const double GenevaClockMechanics::CAL_MAX_ERROR       = 0.02;
+const double GenevaClockMechanics::CAL_NOISE_WEIGHT    = 0.25;
+const float  GenevaClockMechanics::CAL_BACKLASH_WEIGHT = 0.25f;
+
+// Saved position constants.
+const char  *GenevaClockMechanics::POS_STORAGE_KEY     = "pos";
+
+
 /////////////////////////////////////////////////////////////////////////////////
 // GenevaClockMechanics()  (constructor)
 //
@@ -43,28 +61,319 @@ GenevaClockMechanics::GenevaClockMechanics(
     uint32_t fullStepsPerRev,       // Number of full steps per motor revolution.
     bool     stepperPinsReversed,   // True if servo runs backwards.
     bool     stepperHalfStepping,   // True for half stepping, false for full.
-    bool     homeNormallyOpen) :    // True if home switch is normally open.
+    bool     homeNormallyOpen,      // True if home switch is normally open.
+    ClockBoardHal *pHal) :          // Hardware abstraction layer, or NULL.
              GenericClockBoard(rapidSecondsPerRev, fullStepsPerRev,
                                stepperPinsReversed, stepperHalfStepping,
-                               homeNormallyOpen),
-             m_LastStepperPos(0), m_LastMinutes(0)
-{
-    // Initialize motor step related class data.
-    uint32_t stepsPerRev = fullStepsPerRev * (stepperHalfStepping ? 2 : 1);
-    m_StepsPerHour       = (stepsPerRev * GEAR_RATIO) / HOURS_PER_REV;
-
-    // HOURS_PER_REV has a value of 3 in this implementation.  We use the following
-    // calculation where the grouping of the division is important in order to
-    // cancel out the factor of 3.  This eliminates a remainder in the division
-    // and insures that m_StepsPerCycle is an exact integer.
-    //
-    // NOTE THAT THIS IS HIGHLY IMPLEMENTATION SPECIFIC, AND MAY NOT WORK IN
-    // IMPLEMENTATIONS WHERE OTHER RATIOS ARE USED.
-    m_StepsPerCycle = stepsPerRev * GEAR_RATIO * (HOURS_PER_CYCLE / HOURS_PER_REV);
+                               homeNormallyOpen, pHal),
+             m_LastMinutes(0),
+             m_FullStepsNumerator(fullStepsPerRev), m_FullStepsDenominator(1),
+             m_LastHomePosition(0.0), m_HomeValid(false), m_HomeRequired(true),
+             m_FlyByArmed(false), m_FlyByDue(false), m_HomeEdgeAhead(false),
+             m_RejectedEdgeValid(false), m_RejectedEdge(0.0),
+             m_HomeState(HomeIdle), m_HomeStatus(StatusSuccess),
+             m_pHomeCallback(NULL), m_pHomeArg(NULL), m_HomeMoving(false),
+             m_HomeEdgeKnown(false), m_HomeEdge(0.0), m_HomeChunk(0),
+             m_HomeSearched(0), m_HomeMoveFrom(0), m_HomeCount(0),
+             m_HomeBackedOff(false),
+             m_HomeReleaseKnown(false), m_HomeRelease(0.0),
+             m_HomeFastSteps(0), m_HomeSteps(0), m_LastDirection(0),
+             m_AutoBacklash(true), m_Generation(0), m_HomeProbe(false),
+             m_MaxHoldMinutes(DEFAULT_MAX_HOLD_MINUTES),
+             m_HoldCostUs(DEFAULT_HOLD_COST_MS * 1000),
+             m_ReversalCostUs(DEFAULT_REVERSAL_COST_MS * 1000),
+             m_LoadStartMinutes(0), m_LoadedMinutes(0), m_LoadPercent(0)
+{
+    memset(&m_LastPath, 0, sizeof(m_LastPath));
+    memset(&m_PathStats, 0, sizeof(m_PathStats));
+
+    // Initialize motor step related class data.  Until told otherwise, assume
+    // the nominal (integer) number of steps per rev.
+    SetFullStepsPerRev(fullStepsPerRev, 1);
 
 } // End GenevaClockMechanics()
 
 
+/////////////////////////////////////////////////////////////////////////////////
+// SetFullStepsPerRev()
+//
+// Sets the actual number of full steps per motor output shaft revolution as a
+// fraction.  Motor steps per minute is then kept as the exact fraction:
+//
+//      steps per rev * GEAR_RATIO * (HOURS_PER_CYCLE / HOURS_PER_REV)
+//      --------------------------------------------------------------
+//                          MINUTES_PER_CYCLE
+//
+// Arguments:
+//   - numerator   - Numerator of the full steps per rev.
+//   - denominator - Denominator of the full steps per rev.  Must not be 0.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::SetFullStepsPerRev(uint32_t numerator, uint32_t denominator)
+{
+    if (!denominator)
+    {
+        denominator = 1;
+    }
+    m_FullStepsNumerator   = numerator;
+    m_FullStepsDenominator = denominator;
+
+    // HOURS_PER_REV has a value of 3 in this implementation, so the grouping of
+    // the division is important in order to cancel out the factor of 3.
+    m_MinuteStepNumerator = static_cast<int64_t>(numerator) * StepsPerFullStep() *
+                            GEAR_RATIO * (HOURS_PER_CYCLE / HOURS_PER_REV);
+    m_MinuteStepDivisor   = static_cast<int64_t>(denominator) * MINUTES_PER_CYCLE;
+    m_ConfiguredSteps     = static_cast<double>(m_MinuteStepNumerator) / denominator;
+
+    // Rounded whole step values used to bound homing moves and such.
+    m_StepsPerCycle = static_cast<int32_t>(
+        (m_MinuteStepNumerator + denominator / 2) / denominator);
+    m_StepsPerHour  = static_cast<uint32_t>(
+        (m_MinuteStepNumerator * MINUTES_PER_HOUR + m_MinuteStepDivisor / 2) /
+        m_MinuteStepDivisor);
+
+    // Anything learned was relative to the old value.
+    memset(&m_Cal, 0, sizeof(m_Cal));
+    ApplyBacklash();
+    ResetPosition();
+} // End SetFullStepsPerRev().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetMicrostepping()
+//
+// Changes the board's steps per full step, then recomputes the steps per
+// minute from the saved full steps per rev.  Positions in the old steps,
+// including the last home edge, no longer mean anything.
+/////////////////////////////////////////////////////////////////////////////////
+bool GenevaClockMechanics::SetMicrostepping(uint32_t microstepsPerFullStep)
+{
+    if (IsHoming() || !GenericClockBoard::SetMicrostepping(microstepsPerFullStep))
+    {
+        return false;
+    }
+    SetFullStepsPerRev(m_FullStepsNumerator, m_FullStepsDenominator);
+    m_HomeValid    = false;
+    m_HomeRequired = true;
+    m_FlyByArmed   = false;
+    DisarmHomeLatch();
+    return true;
+} // End SetMicrostepping().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ApplyStepsPerCycle()
+//
+// Sets the motor steps per minute from a fractional number of steps per 12 hour
+// cycle, kept to 1/CAL_STEP_SCALE of a step.  The error accumulator is rescaled
+// to the new divisor so that the current position is kept.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::ApplyStepsPerCycle(double stepsPerCycle)
+{
+    int64_t divisor = CAL_STEP_SCALE * MINUTES_PER_CYCLE;
+    m_StepError = static_cast<int64_t>(
+        static_cast<double>(m_StepError) * divisor / m_MinuteStepDivisor);
+    m_MinuteStepNumerator = static_cast<int64_t>(stepsPerCycle * CAL_STEP_SCALE + 0.5);
+    m_MinuteStepDivisor   = divisor;
+    m_StepsPerCycle       = static_cast<int32_t>(stepsPerCycle + 0.5);
+    m_StepsPerHour        = static_cast<uint32_t>(
+        stepsPerCycle / HOURS_PER_CYCLE + 0.5);
+} // End ApplyStepsPerCycle().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// StepsPerCycle()
+//
+// Returns the steps per 12 hour cycle currently in use.
+/////////////////////////////////////////////////////////////////////////////////
+double GenevaClockMechanics::StepsPerCycle() const
+{
+    return static_cast<double>(m_MinuteStepNumerator) * MINUTES_PER_CYCLE /
+           m_MinuteStepDivisor;
+} // End StepsPerCycle().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// LoadCalibration()
+//
+// Restores the drift calibration from non-volatile storage.  A calibration that
+// was learned with a different configured steps per rev is ignored.  The
+// backlash measured by the first home is restored even before there are any
+// drift samples.
+/////////////////////////////////////////////////////////////////////////////////
+bool GenevaClockMechanics::LoadCalibration()
+{
+    Calibration_t cal;
+    if (!Hal()->ReadStorage(CAL_STORAGE_KEY, &cal, sizeof(cal)) ||
+        (cal.magic != CAL_MAGIC) ||
+        (fabs(cal.configuredSteps - m_ConfiguredSteps) > 0.5))
+    {
+        printlnD("No drift calibration found.");
+        return false;
+    }
+    m_Cal = cal;
+    if (m_Cal.samples && (m_Cal.sumCycles2 > 0.0))
+    {
+        ApplyStepsPerCycle(m_Cal.sumTravelCycles / m_Cal.sumCycles2);
+    }
+    ApplyBacklash();
+    debugD("Loaded drift calibration: %d samples, steps/cycle*1000 = %d.",
+        m_Cal.samples, static_cast<int32_t>(StepsPerCycle() * 1000.0));
+    return true;
+} // End LoadCalibration().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ResetCalibration()
+//
+// Forgets the learned calibration, both in memory and in storage.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::ResetCalibration()
+{
+    memset(&m_Cal, 0, sizeof(m_Cal));
+    ApplyStepsPerCycle(m_ConfiguredSteps);
+    ApplyBacklash();
+    Hal()->WriteStorage(CAL_STORAGE_KEY, &m_Cal, sizeof(m_Cal));
+} // End ResetCalibration().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// UpdateCalibration()
+//
+// Adds a home measurement to the drift calibration.  The travel between two
+// homes should be a whole number of cycles, k, of S steps each, so the steps
+// per cycle is fit by weighted least squares through the origin:
+//
+//      S = sum(travel * k) / sum(k * k)
+//
+// Older samples are slowly forgotten so that the fit can follow wear.  Samples
+// that are implausibly far from the current estimate (e.g. due to missed steps
+// or someone turning the dial by hand) are ignored.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::UpdateCalibration(double travelSteps, double backlashSteps)
+{
+    if (backlashSteps >= 0.0)
+    {
+        float backlash = static_cast<float>(backlashSteps);
+        m_Cal.backlash = (m_Cal.samples || (m_Cal.backlash > 0.0f))
+                       ? m_Cal.backlash + CAL_BACKLASH_WEIGHT * (backlash - m_Cal.backlash)
+                       : backlash;
+        ApplyBacklash();
+    }
+
+    double current = StepsPerCycle();
+    double cycles  = floor(travelSteps / current + 0.5);
+    if ((travelSteps != 0.0) && (cycles != 0.0))
+    {
+        double error = travelSteps - cycles * current;
+        if (fabs(error / cycles) > current * CAL_MAX_ERROR)
+        {
+            debugW("Ignoring home measurement, error = %d steps.",
+                static_cast<int32_t>(error));
+        }
+        else
+        {
+            // The first sample mostly measures the error of the configured
+            // value, so only later ones are used to estimate the noise.
+            if (m_Cal.samples)
+            {
+                m_Cal.noiseVar += CAL_NOISE_WEIGHT * (error * error - m_Cal.noiseVar);
+            }
+            m_Cal.magic            = CAL_MAGIC;
+            m_Cal.configuredSteps  = m_ConfiguredSteps;
+            m_Cal.sumTravelCycles  = CAL_FORGET * m_Cal.sumTravelCycles +
+                                     travelSteps * cycles;
+            m_Cal.sumCycles2       = CAL_FORGET * m_Cal.sumCycles2 + cycles * cycles;
+            m_Cal.samples++;
+            ApplyStepsPerCycle(m_Cal.sumTravelCycles / m_Cal.sumCycles2);
+            debugD("Drift calibration: error = %d steps, steps/cycle*1000 = %d.",
+                static_cast<int32_t>(error), static_cast<int32_t>(StepsPerCycle() * 1000.0));
+        }
+    }
+
+    m_Cal.magic           = CAL_MAGIC;
+    m_Cal.configuredSteps = m_ConfiguredSteps;
+    Hal()->WriteStorage(CAL_STORAGE_KEY, &m_Cal, sizeof(m_Cal));
+} // End UpdateCalibration().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetBacklashCompensation()
+//
+// Sets a fixed number of take-up steps, or BACKLASH_AUTO to follow the learned
+// backlash.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::SetBacklashCompensation(int32_t steps)
+{
+    m_AutoBacklash = (steps == BACKLASH_AUTO);
+    if (m_AutoBacklash)
+    {
+        ApplyBacklash();
+    }
+    else
+    {
+        SetBacklashSteps((steps > 0) ? static_cast<uint32_t>(steps) : 0);
+    }
+} // End SetBacklashCompensation().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ApplyBacklash()
+//
+// Rounds the learned backlash to whole take-up steps for the board.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::ApplyBacklash()
+{
+    if (m_AutoBacklash)
+    {
+        SetBacklashSteps((m_Cal.backlash > 0.0f)
+                         ? static_cast<uint32_t>(m_Cal.backlash + 0.5f) : 0);
+    }
+} // End ApplyBacklash().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// RecommendedHomeInterval()
+//
+// The uncertainty of the fitted steps per cycle is about sigma / sqrt(sum(k*k)),
+// where sigma is the measurement noise.  The clock may run until that much
+// error per cycle adds up to half a minute.
+/////////////////////////////////////////////////////////////////////////////////
+uint32_t GenevaClockMechanics::RecommendedHomeInterval(uint32_t maxCycles) const
+{
+    if ((m_Cal.samples < CAL_MIN_SAMPLES) || (m_Cal.sumCycles2 <= 0.0) || (maxCycles <= 1))
+    {
+        return 1;
+    }
+
+    // Never assume better than one step of measurement noise.
+    double noiseVar = (m_Cal.noiseVar > 1.0) ? m_Cal.noiseVar : 1.0;
+    double sigma    = sqrt(noiseVar / m_Cal.sumCycles2);
+    double allowed  = 0.5 * StepsPerCycle() / MINUTES_PER_CYCLE;
+    double cycles   = allowed / sigma;
+    if (cycles >= maxCycles)
+    {
+        return maxCycles;
+    }
+    return (cycles < 1.0) ? 1 : static_cast<uint32_t>(cycles);
+} // End RecommendedHomeInterval().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ResetPosition()
+//
+// Marks the clock as being at 12:00.  The error accumulator starts at one half
+// step so that each commanded position is the exact position rounded to the
+// nearest step.  A home always ends moving clockwise.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::ResetPosition()
+{
+    m_StepperPos    = 0;
+    m_StepError     = m_MinuteStepDivisor / 2;
+    m_LastMinutes   = 0;
+    m_LastDirection = 1;
+} // End ResetPosition().
+
+
 /////////////////////////////////////////////////////////////////////////////////
 // UpdateClock()
 //
@@ -73,14 +382,21 @@ GenevaClockMechanics::GenevaClockMechanics(
 // the current time, this method will do the following:
 //  - Determine the difference, in minutes, between the current time and the
 //    last time the method was called.
-//  - Move the time indicator the correct number of steps, in the shortest
-//    distance possible, to the new time.
+//  - Move the time indicator the correct number of steps to the new time,
+//    whichever way round is cheaper, or hold if the new time is a little
+//    behind the dial.  See PlanPath().
+// Nothing is done while homing, since the position is not known yet.
 //
 // Arguments:
 //  - localTime is the current time.
 /////////////////////////////////////////////////////////////////////////////////
 void GenevaClockMechanics::UpdateClock(tm &localTime)
 {
+    if (IsHoming())
+    {
+        return;
+    }
+
     // Calculate the number of minutes since 12:00.
     int32_t newTimeInMinutes = (
         (localTime.tm_hour % HOURS_PER_CYCLE) * MINUTES_PER_HOUR) + localTime.tm_min;
@@ -88,54 +404,346 @@ void GenevaClockMechanics::UpdateClock(tm &localTime)
     // Check if update is needed (i.e. has time changed?).
     if(newTimeInMinutes != m_LastMinutes)
     {
+        int32_t lastMinutes = m_LastMinutes;
+
+        // Determine the change in minutes, taking the cheaper way around the
+        // dial.  If holding, the dial keeps its time till the time catches up.
+        int32_t forwardMinutes = newTimeInMinutes - m_LastMinutes;
+        if (forwardMinutes < 0)
+        {
+            forwardMinutes += MINUTES_PER_CYCLE;
+        }
+        m_LastPath = PlanPath(forwardMinutes);
+        const PathPlan_t &plan = m_LastPath;
+        int32_t deltaMinutes   = plan.deltaMinutes;
+        debugD("Path %d min: forward %u us, backward %u us, hold %u us, chose %s.",
+            forwardMinutes, plan.forwardUs, plan.backwardUs, plan.holdUs,
+            (plan.choice == PathForward) ? "forward" :
+            (plan.choice == PathBackward) ? "backward" : "hold");
+        if (plan.choice == PathHold)
+        {
+            debugI("Holding %d min ahead of %02d:%02d.", plan.aheadMinutes,
+                localTime.tm_hour, localTime.tm_min);
+            m_PathStats.holds++;
+            m_PathStats.costUs += plan.holdUs;
+            return;
+        }
+        if (plan.choice == PathBackward)
+        {
+            debugI("Moving back %d min to %02d:%02d.", -deltaMinutes,
+                localTime.tm_hour, localTime.tm_min);
+            m_PathStats.backward++;
+            m_PathStats.costUs += plan.backwardUs;
+        }
+        else
+        {
+            m_PathStats.forward++;
+            m_PathStats.costUs += plan.forwardUs;
+        }
+        int32_t direction = (deltaMinutes > 0) ? 1 : -1;
+        if (m_LastDirection && (direction != m_LastDirection))
+        {
+            m_PathStats.reversals++;
+        }
+        m_LastDirection = direction;
+
         // Remember the current time for next iteration.
         debugD("newTimeInMinutes = %d,   %02d:%02d",
             newTimeInMinutes, localTime.tm_hour, localTime.tm_min);
         m_LastMinutes = newTimeInMinutes;
 
-        // Determine the number of steps corresponding to the new time in minutes.
-        int32_t newMotorPos =
-            ((newTimeInMinutes * m_StepsPerCycle) / MINUTES_PER_CYCLE);
-        debugD("newMotorPos = %d", newMotorPos);
-
-        // Calculate the number of steps and direction between the new time and
-        // the old time.
-        int32_t deltaSteps = newMotorPos - m_LastStepperPos;
-        debugD("deltaSteps = %d, m_LastStepperPos = %d", deltaSteps, m_LastStepperPos);
-
-        if (deltaSteps > m_StepsPerCycle / 2)
+        // A long move is saved as under way, since power lost part way would
+        // leave the dial further off than the boot probe accepts.
+        m_Generation++;
+        if ((deltaMinutes > FLY_BY_TOLERANCE_MINUTES) || (-deltaMinutes > FLY_BY_TOLERANCE_MINUTES))
         {
-            deltaSteps -= m_StepsPerCycle;
+            WritePosition(PosUnknown);
         }
-        else if (deltaSteps < -m_StepsPerCycle / 2)
+
+        // Convert the change in minutes to whole motor steps, Bresenham style.
+        // The fractional step that is left over is carried in m_StepError, so
+        // the error never exceeds half a step no matter how long we run.
+        int64_t acc = deltaMinutes * m_MinuteStepNumerator + m_StepError;
+        int64_t deltaSteps = acc / m_MinuteStepDivisor;
+        if ((acc % m_MinuteStepDivisor) < 0)
         {
-            deltaSteps += m_StepsPerCycle;
+            // Round toward negative infinity so that m_StepError stays positive.
+            deltaSteps--;
         }
+        m_StepError = acc - deltaSteps * m_MinuteStepDivisor;
 
         // Actually move the time indicator the number of steps required to get
         // to the new time.
-        debugD("Step(%d, StepAuto);", deltaSteps);
-        Step(deltaSteps, StepAuto);
+        debugD("Step(%d, StepAuto);", static_cast<int32_t>(deltaSteps));
+        Step(static_cast<int32_t>(deltaSteps), StepAuto);
+
+        // Remember the step position for next iteration.
+        m_StepperPos += deltaSteps;
 
-        // Remember the last step position for next iteration.
-        m_LastStepperPos = (m_LastStepperPos + deltaSteps) % m_StepsPerCycle;
-        debugD("m_LastStepperPos = %d\n", m_LastStepperPos);
+        // Check the home sensor edge in case we just passed 12:00.
+        CheckHomeEdge(deltaSteps, (deltaMinutes > 0) &&
+                                  (lastMinutes + deltaMinutes >= MINUTES_PER_CYCLE));
+        WritePosition(PosIdle);
     }
 } // End UpdateClock().
 
 
+/////////////////////////////////////////////////////////////////////////////////
+// SetPathCosts()
+//
+// Sets the most minutes the dial may hold ahead of the time, the hold cost per
+// square minute, and the cost of reversing besides taking up the backlash.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::SetPathCosts(uint32_t maxHoldMinutes, uint32_t holdCostMs,
+                                        uint32_t reversalCostMs)
+{
+    m_MaxHoldMinutes = maxHoldMinutes;
+    m_HoldCostUs     = holdCostMs * 1000;
+    m_ReversalCostUs = reversalCostMs * 1000;
+} // End SetPathCosts().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetGenevaLoad()
+//
+// Sets the dial arc, within each turn of the Geneva drive wheel, over which
+// the Geneva wheel is engaged, and the extra cost of steps taken over it.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::SetGenevaLoad(uint32_t startMinutes, uint32_t loadedMinutes,
+                                         uint32_t extraPercent)
+{
+    const uint32_t PERIOD = HOURS_PER_REV * MINUTES_PER_HOUR;
+    m_LoadStartMinutes = startMinutes % PERIOD;
+    m_LoadedMinutes    = (loadedMinutes < PERIOD) ? loadedMinutes : PERIOD;
+    m_LoadPercent      = extraPercent;
+} // End SetGenevaLoad().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// PlanPath()
+//
+// Compares the costs of moving clockwise, moving counterclockwise, and
+// holding, and returns the cheapest.  Ties go to clockwise, then
+// counterclockwise, since holding leaves the dial wrong for a while.
+/////////////////////////////////////////////////////////////////////////////////
+PathPlan_t GenevaClockMechanics::PlanPath(int32_t forwardMinutes) const
+{
+    const uint64_t NOT_ALLOWED = UINT32_MAX;
+    int32_t  backwardMinutes   = forwardMinutes - MINUTES_PER_CYCLE;
+
+    uint64_t forwardUs  = MoveCostUs(forwardMinutes);
+    uint64_t backwardUs = MoveCostUs(backwardMinutes);
+    uint64_t holdUs     = NOT_ALLOWED;
+    if (-backwardMinutes <= static_cast<int32_t>(m_MaxHoldMinutes))
+    {
+        holdUs = static_cast<uint64_t>(backwardMinutes) * backwardMinutes * m_HoldCostUs;
+    }
+
+    PathPlan_t plan;
+    plan.aheadMinutes = 0;
+    plan.forwardUs  = static_cast<uint32_t>((forwardUs < NOT_ALLOWED) ? forwardUs : NOT_ALLOWED);
+    plan.backwardUs = static_cast<uint32_t>((backwardUs < NOT_ALLOWED) ? backwardUs : NOT_ALLOWED);
+    plan.holdUs     = static_cast<uint32_t>(holdUs);
+    if ((forwardUs <= backwardUs) && (forwardUs <= holdUs))
+    {
+        plan.choice       = PathForward;
+        plan.deltaMinutes = forwardMinutes;
+    }
+    else if (backwardUs <= holdUs)
+    {
+        plan.choice       = PathBackward;
+        plan.deltaMinutes = backwardMinutes;
+    }
+    else
+    {
+        plan.choice       = PathHold;
+        plan.deltaMinutes = 0;
+        plan.aheadMinutes = -backwardMinutes;
+    }
+    return plan;
+} // End PlanPath().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// MoveCostUs()
+//
+// Estimates the cost of moving 'minutes' from the dial's time.  See
+// SetPathCosts() for what is counted.
+/////////////////////////////////////////////////////////////////////////////////
+uint64_t GenevaClockMechanics::MoveCostUs(int32_t minutes) const
+{
+    int32_t  direction  = (minutes > 0) ? 1 : -1;
+    int64_t  absMinutes = (minutes > 0) ? minutes : -minutes;
+    int64_t  steps      = (absMinutes * m_MinuteStepNumerator + m_MinuteStepDivisor / 2) /
+                          m_MinuteStepDivisor;
+    uint64_t cruiseUs   = Planner().SelectedRamp().cruiseUs;
+    uint32_t backlash   = static_cast<uint32_t>(m_Cal.backlash + 0.5f);
+
+    // A reversal takes up the backlash before the dial moves.
+    uint64_t costUs = 0;
+    if (m_LastDirection && (direction != m_LastDirection))
+    {
+        steps  += backlash;
+        costUs += m_ReversalCostUs;
+    }
+    costUs += Planner().MoveDurationUs(static_cast<int32_t>(steps));
+
+    // Going counterclockwise, the next move must reverse again.
+    if (direction < 0)
+    {
+        costUs += m_ReversalCostUs + backlash * cruiseUs;
+    }
+
+    if (m_LoadedMinutes && m_LoadPercent)
+    {
+        int64_t loadedSteps = (LoadedMinutes(m_LastMinutes, minutes) * m_MinuteStepNumerator +
+                               m_MinuteStepDivisor / 2) / m_MinuteStepDivisor;
+        costUs += loadedSteps * cruiseUs * m_LoadPercent / 100;
+    }
+    return costUs;
+} // End MoveCostUs().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// LoadedMinutes()
+//
+// The load arc repeats every turn of the drive wheel.  The loaded minutes
+// before a dial time 't' are the whole turns before it, plus the part of the
+// arc (and of the previous turn's arc, if it wraps past the turn) that lies
+// before 't' within its turn.  The loaded minutes on the path are the
+// difference of this at the path's two ends.
+/////////////////////////////////////////////////////////////////////////////////
+int32_t GenevaClockMechanics::LoadedMinutes(int32_t fromMinutes, int32_t minutes) const
+{
+    const int32_t PERIOD = HOURS_PER_REV * MINUTES_PER_HOUR;
+    int32_t ends[2] = { fromMinutes + MINUTES_PER_CYCLE,
+                        fromMinutes + minutes + MINUTES_PER_CYCLE };
+    int32_t end     = m_LoadStartMinutes + m_LoadedMinutes;
+    int32_t loaded[2];
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        int32_t t = ends[i] % PERIOD;
+        loaded[i] = (ends[i] / PERIOD) * m_LoadedMinutes;
+        if (t > m_LoadStartMinutes)
+        {
+            loaded[i] += ((t < end) ? t : end) - m_LoadStartMinutes;
+        }
+        if (end > PERIOD)
+        {
+            loaded[i] += (t < end - PERIOD) ? t : end - PERIOD;
+        }
+    }
+    return (loaded[1] > loaded[0]) ? loaded[1] - loaded[0] : loaded[0] - loaded[1];
+} // End LoadedMinutes().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// CheckHomeEdge()
+//
+// The board's home latch is only armed once the indicator has moved clockwise
+// since the last counterclockwise move, so that the gear train backlash is
+// taken up the same way as when Home() finds the edge.  A latched edge is
+// verified whenever it appears.  If 12:00 was passed and no edge has appeared
+// within FLY_BY_WINDOW_MINUTES, a full Home() is requested.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::CheckHomeEdge(int64_t deltaSteps, bool passedTwelve)
+{
+    if (deltaSteps < 0)
+    {
+        DisarmHomeLatch();
+        m_FlyByArmed        = false;
+        m_FlyByDue          = false;
+        m_HomeEdgeAhead     = false;
+        m_RejectedEdgeValid = false;
+        return;
+    }
+    if (!m_FlyByArmed)
+    {
+        ArmHomeLatch();
+        m_FlyByArmed = true;
+        return;
+    }
+
+    if (passedTwelve)
+    {
+        m_FlyByDue = true;
+    }
+
+    double edgePosition;
+    if (HomeLatched(edgePosition))
+    {
+        if (!VerifyHomeEdge(edgePosition))
+        {
+            // Remember where the edge really is, for Home().
+            m_RejectedEdge      = edgePosition;
+            m_RejectedEdgeValid = true;
+            m_HomeRequired      = true;
+        }
+        m_FlyByDue = false;
+        ArmHomeLatch();
+    }
+    else if (m_FlyByDue && (m_LastMinutes >= FLY_BY_WINDOW_MINUTES))
+    {
+        printlnW("Home edge not seen near 12:00.");
+        m_HomeRequired  = true;
+        m_FlyByDue      = false;
+        m_HomeEdgeAhead = true;
+    }
+} // End CheckHomeEdge().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// VerifyHomeEdge()
+//
+// The edge should be a whole number of cycles from the last home edge.  If it
+// is close enough, it becomes the new reference: the position is re-anchored
+// so that the edge is exactly 12:00, and the next UpdateClock() moves make up
+// the difference.  The edge position is fractional, but 12:00 is the first
+// whole step past the edge, just as Home() stops on it.
+/////////////////////////////////////////////////////////////////////////////////
+bool GenevaClockMechanics::VerifyHomeEdge(double edgePosition)
+{
+    if (!m_HomeValid)
+    {
+        return false;
+    }
+
+    double travel    = edgePosition - m_LastHomePosition;
+    double steps     = StepsPerCycle();
+    double cycles    = floor(travel / steps + 0.5);
+    double error     = travel - cycles * steps;
+    double  tolerance = steps * FLY_BY_TOLERANCE_MINUTES / MINUTES_PER_CYCLE;
+    if ((cycles < 1.0) || (fabs(error) > tolerance))
+    {
+        debugW("Home edge off by %d steps.", static_cast<int32_t>(error));
+        return false;
+    }
+    debugD("Home edge verified, off by %d steps.", static_cast<int32_t>(error));
+
+    // Moving onto the edge doesn't measure the backlash.
+    UpdateCalibration(travel, -1.0);
+    m_LastHomePosition = edgePosition;
+
+    // Re-anchor.  The current time may be just before 12:00 if the clock was
+    // running ahead.
+    int32_t minutes = m_LastMinutes;
+    if (minutes > MINUTES_PER_CYCLE / 2)
+    {
+        minutes -= MINUTES_PER_CYCLE;
+    }
+    m_StepperPos = StepPosition() - (static_cast<int64_t>(floor(edgePosition)) + 1);
+    m_StepError  = minutes * m_MinuteStepNumerator + m_MinuteStepDivisor / 2 -
+                   m_StepperPos * m_MinuteStepDivisor;
+    return true;
+} // End VerifyHomeEdge().
+
+
 /////////////////////////////////////////////////////////////////////////////////
 // Home()
 //
-// Home the clock to the 12:00 position.  We want to always approach the home
-// switch slowly in the clockwise direction to achieve the best repeatability.
-//  The strategy here is as follows:
-//   - If we are not already on the home, then move rapidly clockwise toward the
-//     home till the home switch is detected.
-//   - Rapidly back off the home switch in the counterclockwise direction until
-//     the home switch is no longer detected.
-//   - Slowly approach the home in the clockwise direction until the home switch
-//     is detected.
+// Home the clock to the 12:00 position, blocking till done.  This simply runs
+// the StartHome() / PollHome() state machine to completion, waiting for each
+// queued move in turn.  See StartHome() for the strategy.
 //
 // Returns:
 // Returns a status code as follows:
@@ -147,55 +755,628 @@ void GenevaClockMechanics::UpdateClock(tm &localTime)
 /////////////////////////////////////////////////////////////////////////////////
 StatusCode_t GenevaClockMechanics::Home()
 {
+    StartHome();
+    while (PollHome(m_StepsPerHour))
+    {
+        WaitForMove();
+    }
+    return m_HomeStatus;
+} // End Home().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// StartHome()
+//
+// Start homing the clock to the 12:00 position.  We want to always approach
+// the home switch slowly in the clockwise direction to achieve the best
+// repeatability.  The strategy here is as follows:
+//   - If we are not already on the home, then move rapidly toward the home
+//     till the home switch edge is found (see PollSeek() and PollSearch()).
+//   - Rapidly back off the home switch in the counterclockwise direction until
+//     the home switch is no longer detected.
+//   - Approach the home in the clockwise direction until the home switch is
+//     detected, rapidly till within HOME_FINE_STEPS of where the edge is
+//     expected, then slowly.
+// The work is done by PollHome().
+//
+// Arguments:
+//   - pCallback - Called at each phase change and when the home ends, or NULL.
+//   - pArg      - Passed to 'pCallback'.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::StartHome(HomeCallback_t pCallback, void *pArg)
+{
+    if (IsHoming())
+    {
+        return;
+    }
+
     // Debug.
     printlnV("HomeClock(): homing clock to 12:00.");
 
-    // Phase 1, move rapidly CW till home is detected.  Return with an error if
-    // home is not detected within a reasonable distance.
-    uint32_t i = 0;
-    const uint32_t MAX_STEPS = m_StepsPerCycle + m_StepsPerHour;
-    for (i = 0; !IsHome() && (i < MAX_STEPS); i++)
+    // Homing does its own edge detection.
+    DisarmHomeLatch();
+    m_FlyByArmed    = false;
+    m_FlyByDue      = false;
+    m_HomeRequired  = false;
+    m_HomeEdgeKnown = false;
+    m_HomeSteps     = 0;
+    m_pHomeCallback = pCallback;
+    m_pHomeArg      = pArg;
+    m_Generation++;
+    WritePosition(PosUnknown);
+    SetHomeState(HomeSeeking);
+} // End StartHome().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// PollHome()
+//
+// Advances the home started by StartHome().  A move queued by the previous
+// call must finish before the next phase can look at where it stopped, so
+// nothing is done till the stepper is idle.  The home latch may have ended
+// the move early, so its steps are counted from where it stopped.
+//
+// Arguments:
+//   - maxSteps - Most single steps to take in phases 2 and 3.
+//
+// Returns:
+//   Returns 'true' while the home is in progress.
+/////////////////////////////////////////////////////////////////////////////////
+bool GenevaClockMechanics::PollHome(uint32_t maxSteps)
+{
+    if (!IsHoming() || IsMoving())
+    {
+        return IsHoming();
+    }
+
+    if (m_HomeMoving)
+    {
+        int64_t moved = StepPosition() - m_HomeMoveFrom;
+        m_HomeSteps  += static_cast<uint32_t>((moved < 0) ? -moved : moved);
+    }
+
+    switch (m_HomeState)
+    {
+    case HomeSeeking:
+        PollSeek();
+        break;
+    case HomeSearching:
+        PollSearch();
+        break;
+    case HomeBackingOff:
+        PollBackOff(maxSteps);
+        break;
+    case HomeApproaching:
+        PollApproach(maxSteps);
+        break;
+    default:
+        break;
+    }
+    return IsHoming();
+} // End PollHome().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// PollSeek()
+//
+// Phase 1 of the home.  If the position is known from an earlier home (or from
+// an edge that failed verification), and is not already within
+// FLY_BY_TOLERANCE_MINUTES of the edge, the expected edge is approached the
+// shorter way around with one rapid move that stops HOME_SEEK_MARGIN_MINUTES
+// short of it (clockwise), or the same distance beyond it (counterclockwise).
+// The next call checks where the move ended.  If the edge has not been found
+// by then, it is searched for (see PollSearch()).
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::PollSeek()
+{
+    if (m_HomeMoving)
+    {
+        // The seek move is done.
+        m_HomeMoving    = false;
+        m_HomeEdgeKnown = HomeLatched(m_HomeEdge);
+        if (m_HomeEdgeKnown && m_HomeProbe && CheckProbeEdge(m_HomeEdge))
+        {
+            return;
+        }
+        if (m_HomeEdgeKnown || IsHome())
+        {
+            EdgeFound();
+        }
+        else
+        {
+            StartSearch();
+        }
+        return;
+    }
+
+    // If the clock has passed 12:00 clockwise without seeing the edge, the
+    // edge must be ahead, so go straight to the search.
+    const int32_t MARGIN = m_StepsPerHour * HOME_SEEK_MARGIN_MINUTES / MINUTES_PER_HOUR;
+    bool   seek        = m_HomeValid && !m_HomeEdgeAhead;
+    double last        = m_RejectedEdgeValid ? m_RejectedEdge : m_LastHomePosition;
+    m_HomeEdgeAhead     = false;
+    m_RejectedEdgeValid = false;
+    if (IsHome())
     {
-        Step(STEP_CW, StepFast);
+        EdgeFound();
+        return;
     }
-    if (i >= MAX_STEPS)
+    if (seek)
+    {
+        double cycle = StepsPerCycle();
+        double past = fmod(static_cast<double>(StepPosition()) - last, cycle);
+        if (past < 0.0)
+        {
+            past += cycle;
+        }
+        // If just past the expected edge, yet not on the switch, the edge must
+        // really be just ahead.
+        bool nearEdge = (past < cycle * FLY_BY_TOLERANCE_MINUTES / MINUTES_PER_CYCLE);
+        if (!nearEdge && (past < cycle / 2.0))
+        {
+            // Back up through the switch.  The latch only sees clockwise edges.
+            HomeMove(-static_cast<int32_t>(past) - MARGIN, StepAuto);
+            return;
+        }
+        else if (!nearEdge && (cycle - past > MARGIN))
+        {
+            // The latch catches the edge, and stops the move, if it comes
+            // sooner than expected.
+            ArmHomeLatch(STEP_CW, true);
+            HomeMove(static_cast<int32_t>(cycle - past) - MARGIN, StepAuto);
+            return;
+        }
+    }
+    StartSearch();
+} // End PollSeek().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// StartSearch()
+//
+// Starts the clockwise edge search of phase 1, with the board's home latch
+// armed to record exactly where the edge is and to stop the search move there.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::StartSearch()
+{
+    ArmHomeLatch(STEP_CW, true);
+    m_HomeChunk    = HOME_SEARCH_FIRST_STEPS;
+    m_HomeSearched = 0;
+    SetHomeState(HomeSearching);
+} // End StartSearch().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// PollSearch()
+//
+// Searches for the edge clockwise in moves that start short, since the edge
+// is most likely close, and double in length till the rest of the search fits
+// in one move.  Once long enough, they use the faster StepAuto profile.  The
+// switch is never polled step by step.  The latch stops the move that reaches
+// the edge, so it only overshoots by its deceleration.  Gives up with a phase
+// 1 error after a cycle plus an hour.  A boot probe (see RestorePosition())
+// only searches HOME_SEEK_MARGIN_MINUTES either side of where it expects the
+// edge, then carries on as a full home.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::PollSearch()
+{
+    const int32_t MARGIN    = m_StepsPerHour * HOME_SEEK_MARGIN_MINUTES / MINUTES_PER_HOUR;
+    const int32_t MAX_STEPS = m_HomeProbe ? 2 * MARGIN : m_StepsPerCycle + m_StepsPerHour;
+
+    if (m_HomeMoving)
+    {
+        m_HomeMoving    = false;
+        m_HomeSearched += m_HomeChunk;
+        if (HomeLatched(m_HomeEdge))
+        {
+            if (m_HomeProbe && CheckProbeEdge(m_HomeEdge))
+            {
+                return;
+            }
+            m_HomeEdgeKnown = true;
+            EdgeFound();
+            return;
+        }
+    }
+    if (m_HomeProbe && (m_HomeSearched >= MAX_STEPS))
+    {
+        printlnW("Boot probe found no edge, homing.");
+        m_HomeProbe    = false;
+        m_HomeValid    = false;
+        m_HomeSearched = 0;
+    }
+    else if (m_HomeSearched >= MAX_STEPS)
     {
         printlnE("Home phase 1 error.");
-        return StatusHomePhase1Error;
+        DisarmHomeLatch();
+        EndHome(StatusHomePhase1Error);
+        return;
+    }
+    // A move too short to get through its ramp and back would only crawl at
+    // the profile's start speed, so the first few are fast instead.
+    const StepRamp_t &ramp = Planner().SelectedRamp();
+    int32_t rampSteps = static_cast<int32_t>(ramp.length << ramp.shift);
+    int32_t rest      = MAX_STEPS - m_HomeSearched;
+    m_HomeChunk = (2 * m_HomeChunk < rest) ? 2 * m_HomeChunk : rest;
+    HomeMove(m_HomeChunk, (m_HomeChunk < 2 * rampSteps) ? StepFast : StepAuto);
+} // End PollSearch().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// EdgeFound()
+//
+// Ends phase 1.  The last search move may have carried well into, or right
+// past, the switch, so it first returns to just past the edge in one move.
+// The board's latch then watches for the switch opening during phase 2.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::EdgeFound()
+{
+    m_HomeProbe = false;
+    ArmHomeLatch(STEP_CCW);
+    m_HomeCount = 0;
+    SetHomeState(HomeBackingOff);
+    int64_t pastEdge = static_cast<int64_t>(floor(m_HomeEdge)) + 1;
+    if (m_HomeEdgeKnown && (StepPosition() > pastEdge))
+    {
+        HomeMove(static_cast<int32_t>(pastEdge - StepPosition()), StepFast);
     }
+} // End EdgeFound().
 
-    // Phase 2, move rapidly off the home switch in the CCW direction.  Return
-    // with an error if home is not removed within a reasonable distance.
-    for (i = 0; IsHome() && (i < m_StepsPerHour); i++)
+
+/////////////////////////////////////////////////////////////////////////////////
+// PollBackOff()
+//
+// Phase 2, move rapidly off the home switch in the CCW direction, at most
+// 'maxSteps' steps per call.  Ends with an error if home is not removed within
+// a reasonable distance.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::PollBackOff(uint32_t maxSteps)
+{
+    for (uint32_t n = 0; IsHome() && (m_HomeCount < m_StepsPerHour) && (n < maxSteps); n++)
     {
         Step(STEP_CCW, StepFast);
+        m_HomeCount++;
+        m_HomeSteps++;
     }
-    if (i >= m_StepsPerHour)
+    if (m_HomeCount >= m_StepsPerHour)
     {
         printlnE("Home phase 2 error.");
-        return StatusHomePhase2Error;
+        EndHome(StatusHomePhase2Error);
+        return;
+    }
+    if (IsHome())
+    {
+        return;
     }
 
-    // Phase 3, move slowly back to home in the CW direction.  Return with an
-    // error if home is not detected within a reasonable distance.
-    for (i = 0; !IsHome() && (i < m_StepsPerHour); i++)
+    // Off the switch.  The edge is expected where phase 1 found it or,
+    // failing that, the backlash the board doesn't take up away.  The board
+    // latches exactly where within a step the switch opened, and where it
+    // closes again.
+    m_HomeBackedOff    = (m_HomeCount > 0);
+    m_HomeReleaseKnown = HomeLatched(m_HomeRelease);
+    m_HomeFastSteps    = m_HomeEdgeKnown
+                       ? static_cast<int64_t>(floor(m_HomeEdge)) - StepPosition()
+                       : static_cast<int64_t>(Backlash()) - BacklashSteps();
+    m_HomeFastSteps -= HOME_FINE_STEPS;
+
+    // The first step reverses, so the board takes up the backlash with it.
+    // There is no need to do that slowly.
+    if (BacklashSteps() && (m_HomeFastSteps < 1))
+    {
+        m_HomeFastSteps = 1;
+    }
+    m_HomeCount = 0;
+    ArmHomeLatch();
+    SetHomeState(HomeApproaching);
+} // End PollBackOff().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// PollApproach()
+//
+// Phase 3, move back to home in the CW direction, at most 'maxSteps' steps
+// per call.  Ends with an error if home is not detected within a reasonable
+// distance.  Otherwise learns from how far we actually travelled since the
+// last home, then resets the current time and stepper position to zero.  The
+// approach only measures the backlash if it started from phase 2.  The
+// backlash is the whole steps between the first step off the switch and the
+// first step back on it, less one.  Where within a step an edge appears
+// depends on how the rotor moves during the step, which differs between the
+// two directions, so fractions are not compared.  The step position doesn't
+// count the steps the board took up on each reversal, so they are added
+// back.  If the switch opening wasn't latched, phase 2 stopped on the first
+// step off it instead.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::PollApproach(uint32_t maxSteps)
+{
+    for (uint32_t n = 0; !IsHome() && (m_HomeCount < m_StepsPerHour) && (n < maxSteps); n++)
     {
-        Step(STEP_CW, StepSlow);
+        Step(STEP_CW, (static_cast<int64_t>(m_HomeCount) < m_HomeFastSteps) ? StepFast
+                                                                             : StepSlow);
+        m_HomeCount++;
+        m_HomeSteps++;
     }
-    if (i >= m_StepsPerHour)
+    if (m_HomeCount >= m_StepsPerHour)
     {
         printlnE("Home phase 3 error.");
-        return StatusHomePhase3Error;
+        DisarmHomeLatch();
+        EndHome(StatusHomePhase3Error);
+        return;
     }
+    if (!IsHome())
+    {
+        return;
+    }
+
+    // Homed successfully.
+    double position;
+    if (!HomeLatched(position))
+    {
+        position = static_cast<double>(StepPosition() - 1);
+    }
+    double backlash = -1.0;
+    if (m_HomeBackedOff)
+    {
+        backlash = m_HomeReleaseKnown ? floor(position) - ceil(m_HomeRelease) + 1.0
+                                      : static_cast<double>(m_HomeCount) - 1.0;
+        backlash += BacklashSteps();
+        backlash  = (backlash > 0.0) ? backlash : 0.0;
+    }
+    UpdateCalibration(m_HomeValid ? position - m_LastHomePosition : 0, backlash);
+    m_LastHomePosition = position;
+    m_HomeValid        = true;
+    ResetPosition();
 
-    // Homed successfully.  Reset the current time and stepper position to zero.
-    m_LastStepperPos = 0;
-    m_LastMinutes  = 0;
+    // We just approached the edge clockwise, so watch for the next one.
+    ArmHomeLatch();
+    m_FlyByArmed = true;
 
     printlnV("Done homing.");
+    EndHome(StatusSuccess);
+} // End PollApproach().
 
-    return StatusSuccess;
-} // End Home().
+
+/////////////////////////////////////////////////////////////////////////////////
+// HomeMove()
+//
+// Queues a move for the home.  PollHome() waits for it to finish before
+// calling the current phase again.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::HomeMove(int32_t steps, StepperSpeed_t speed)
+{
+    m_HomeMoveFrom = StepPosition();
+    StepAsync(steps, speed);
+    m_HomeMoving   = true;
+} // End HomeMove().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetHomeState()
+//
+// Changes the home phase and reports it to the callback, if any.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::SetHomeState(HomeState_t state)
+{
+    m_HomeState  = state;
+    m_HomeMoving = false;
+    if (m_pHomeCallback)
+    {
+        HomeProgress_t progress = { state, m_HomeSteps, m_HomeStatus };
+        m_pHomeCallback(progress, m_pHomeArg);
+    }
+} // End SetHomeState().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// EndHome()
+//
+// Ends the home with 'status', saves the position, and reports it.  A failed
+// home leaves the position unknown.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::EndHome(StatusCode_t status)
+{
+    m_HomeStatus = status;
+    m_HomeProbe  = false;
+    if (status != StatusSuccess)
+    {
+        m_HomeValid = false;
+    }
+    WritePosition(PosIdle);
+    SetHomeState(HomeIdle);
+} // End EndHome().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// RestorePosition()
+//
+// Restores the position saved by the last run, if it was saved with the same
+// gear train and stepping mode, and the clock wasn't part way through a long
+// move or a home when it stopped.  A position saved by SavePosition() is
+// trusted as is.  Any other still needs the next home to confirm it, but that
+// home becomes a short probe for the edge where it should be (see
+// PollSearch()).  If the edge is found within FLY_BY_TOLERANCE_MINUTES of
+// where it is expected, the probe re-anchors the position just as a fly-by
+// would, and the home ends there.  Otherwise the home carries on as a full
+// home.
+//
+// A Shutdown position left in retained memory by RetainPosition() is newer
+// than the one in storage, so it is used first.  It is used only once, so that
+// a reset part way through the moves that follow falls back on storage.
+//
+// Returns:
+//   Returns 'true' if the position was restored.
+/////////////////////////////////////////////////////////////////////////////////
+bool GenevaClockMechanics::RestorePosition()
+{
+    SavedPosition_t saved;
+    if (Hal()->ReadRetained(&saved, sizeof(saved)) && IsUsablePosition(saved) &&
+        (saved.state == PosShutdown))
+    {
+        SavedPosition_t spent;
+        memset(&spent, 0, sizeof(spent));
+        Hal()->WriteRetained(&spent, sizeof(spent));
+    }
+    else if (!Hal()->ReadStorage(POS_STORAGE_KEY, &saved, sizeof(saved)) ||
+             !IsUsablePosition(saved))
+    {
+        printlnI("No saved position.");
+        return false;
+    }
+    m_Generation = saved.generation;
+    if (saved.state == PosUnknown)
+    {
+        printlnW("Saved position is unknown.");
+        return false;
+    }
+
+    m_StepperPos    = saved.stepperPos;
+    m_StepError     = static_cast<int64_t>(static_cast<double>(saved.stepError) *
+                                           m_MinuteStepDivisor / saved.stepDivisor);
+    m_LastMinutes   = saved.lastMinutes;
+    m_LastDirection = saved.lastDirection;
+    RestoreDirection(saved.boardDirection);
+    RestoreStepperPhase(saved.stepperPhase);
+    m_LastHomePosition = static_cast<double>(StepPosition() - m_StepperPos) + saved.homeOffset;
+    m_HomeValid    = true;
+    m_HomeRequired = (saved.state != PosShutdown);
+    m_HomeProbe    = m_HomeRequired;
+    m_FlyByArmed   = false;
+    debugI("Restored position %d:%02d, generation %u%s.",
+           m_LastMinutes / MINUTES_PER_HOUR, m_LastMinutes % MINUTES_PER_HOUR,
+           m_Generation, m_HomeProbe ? ", probing" : "");
+    return true;
+} // End RestorePosition().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SavePosition()
+//
+// Saves the position before a planned restart or power down, so that the
+// next RestorePosition() can trust it without a probe.  Does nothing special
+// if the clock is moving, homing, or waiting for a home.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::SavePosition()
+{
+    bool settled = !IsMoving() && !IsHoming() && !m_HomeRequired;
+    WritePosition(settled ? PosShutdown : PosIdle);
+} // End SavePosition().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// RetainPosition()
+//
+// Saves the position as a clean shutdown to retained memory only, just before
+// a deep sleep.  Storage keeps the Idle position written when the last move
+// finished, so if power is lost while asleep, the next boot probes for 12:00
+// instead of trusting a position that may have been disturbed.
+//
+// Returns:
+//   Returns 'true' if the position was retained, or 'false' if the clock is
+//   moving, homing, or waiting for a home.
+/////////////////////////////////////////////////////////////////////////////////
+bool GenevaClockMechanics::RetainPosition()
+{
+    if (IsMoving() || IsHoming() || m_HomeRequired)
+    {
+        return false;
+    }
+    WritePosition(PosShutdown, true);
+    return true;
+} // End RetainPosition().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// IsUsablePosition()
+//
+// Returns 'true' if 'saved' is a valid position saved with the same gear train
+// and stepping mode.
+/////////////////////////////////////////////////////////////////////////////////
+bool GenevaClockMechanics::IsUsablePosition(const SavedPosition_t &saved) const
+{
+    return (saved.magic == POS_MAGIC) && (saved.stepDivisor > 0) &&
+           (saved.stepsPerFullStep == StepsPerFullStep()) &&
+           (fabs(saved.configuredSteps - m_ConfiguredSteps) <= 0.5);
+} // End IsUsablePosition().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// WritePosition()
+//
+// Writes the position to storage (or to retained memory if 'retained' is
+// 'true') with 'state', or as PosUnknown if the position isn't known.  The
+// home position is saved relative to the stepper position, since the board
+// counts from zero again on every boot.
+/////////////////////////////////////////////////////////////////////////////////
+void GenevaClockMechanics::WritePosition(uint32_t state, bool retained)
+{
+    SavedPosition_t saved;
+    memset(&saved, 0, sizeof(saved));
+    saved.magic            = POS_MAGIC;
+    saved.generation       = m_Generation;
+    saved.state            = m_HomeValid ? state : static_cast<uint32_t>(PosUnknown);
+    saved.stepsPerFullStep = StepsPerFullStep();
+    saved.configuredSteps  = m_ConfiguredSteps;
+    saved.stepperPos       = m_StepperPos;
+    saved.stepError        = m_StepError;
+    saved.stepDivisor      = m_MinuteStepDivisor;
+    saved.homeOffset       = m_LastHomePosition - static_cast<double>(StepPosition() - m_StepperPos);
+    saved.lastMinutes      = m_LastMinutes;
+    saved.lastDirection    = m_LastDirection;
+    saved.boardDirection   = LastDirection();
+    saved.stepperPhase     = StepperPhase();
+    if (retained)
+    {
+        Hal()->WriteRetained(&saved, sizeof(saved));
+    }
+    else
+    {
+        Hal()->WriteStorage(POS_STORAGE_KEY, &saved, sizeof(saved));
+    }
+} // End WritePosition().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// CheckProbeEdge()
+//
+// Called when a boot probe finds an edge at 'edgePosition'.  If it is within
+// FLY_BY_TOLERANCE_MINUTES of a whole number of cycles from the restored home
+// position, the position is re-anchored to it and the home ends successfully.
+// Otherwise the restored position is dropped, and the caller carries on with
+// a full home from the edge.
+//
+// Returns:
+//   Returns 'true' if the home ended.
+/////////////////////////////////////////////////////////////////////////////////
+bool GenevaClockMechanics::CheckProbeEdge(double edgePosition)
+{
+    double travel    = edgePosition - m_LastHomePosition;
+    double steps     = StepsPerCycle();
+    double cycles    = floor(travel / steps + 0.5);
+    double error     = travel - cycles * steps;
+    double tolerance = steps * FLY_BY_TOLERANCE_MINUTES / MINUTES_PER_CYCLE;
+    m_HomeProbe = false;
+    if (fabs(error) > tolerance)
+    {
+        debugW("Boot probe edge off by %d steps, homing.", static_cast<int32_t>(error));
+        m_HomeValid = false;
+        return false;
+    }
+    debugI("Boot probe edge off by %d steps.", static_cast<int32_t>(error));
+
+    // The travel since the last home before the restart is as good a sample
+    // as any.
+    UpdateCalibration(travel, -1.0);
+    m_LastHomePosition = edgePosition;
+    ResetPosition();
+    m_StepperPos = StepPosition() - (static_cast<int64_t>(floor(edgePosition)) + 1);
+    m_StepError -= m_StepperPos * m_MinuteStepDivisor;
+
+    ArmHomeLatch();
+    m_FlyByArmed = true;
+    EndHome(StatusSuccess);
+    return true;
+} // End CheckProbeEdge().
 
 
 /////////////////////////////////////////////////////////////////////////////
@@ -216,12 +1397,13 @@ void GenevaClockMechanics::Calibrate()
     {
         Home();
         if (IsButtonPressed()) break;
-        delay(10000);
+        Hal()->Delay(10000);
         if (IsButtonPressed()) break;
         Step(-m_StepsPerHour, StepFast);
         if (IsButtonPressed()) break;
-        delay(500);
+        Hal()->Delay(500);
     }
+    m_HomeRequired = true;
     printlnV("Done calibrating.");
 } // End Calibrate().
 
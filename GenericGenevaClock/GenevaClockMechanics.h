@@ -14,6 +14,11 @@
 // the home position of the clock.
 //
 // History:
+//  - agent 16-OCT-2026
+//    - Moved the stepping onto ClockBoardHal and MotionPlanner.
+//    - Added drift and backlash calibration, on the fly home verification, a
+//      resumable home state machine, backlash compensation, cost based
+//      UpdateClock() moves, and saved and retained positions.
 //  - jmcorbett 11-MAY-2024
 //    Original creation.
 //
@@ -24,7 +29,10 @@
 #define GENEVACLOCKMECHANICS_H
 
 #include <time.h>               // For tm structure.
+#include <string.h>             // For memset().
+#if defined ARDUINO
 #include <Arduino.h>            // For digitalRead() ...
+#endif
 #include "GenericClockBoard.h"  // For GenericClockBoard class.
 
 
@@ -47,6 +55,100 @@ enum StatusCode_t
 };
 
 
+/////////////////////////////////////////////////////////////////////////////////
+// HomeState_t
+//
+// This enum gives the phase of a home started by
+// GenevaClockMechanics::StartHome():
+//  HomeIdle        - Not homing.
+//  HomeSeeking     - Phase 1, moving rapidly to where the edge is expected.
+//  HomeSearching   - Phase 1, searching clockwise for the edge.
+//  HomeBackingOff  - Phase 2, moving off the switch counterclockwise.
+//  HomeApproaching - Phase 3, moving back onto the switch clockwise.
+/////////////////////////////////////////////////////////////////////////////////
+enum HomeState_t
+{
+    HomeIdle = 0,
+    HomeSeeking,
+    HomeSearching,
+    HomeBackingOff,
+    HomeApproaching
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// HomeProgress_t
+//
+// Passed to a HomeCallback_t each time a home changes phase, and once more
+// when it ends.
+/////////////////////////////////////////////////////////////////////////////////
+struct HomeProgress_t
+{
+    HomeState_t  state;         // New phase, or HomeIdle once the home ended.
+    uint32_t     steps;         // Steps moved since the home started.
+    StatusCode_t status;        // Result.  Only valid when 'state' is HomeIdle.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// HomeCallback_t
+//
+// Home progress callback.  'pArg' is the value given to StartHome().  The
+// callback is called from PollHome(), so it may not start another home.
+/////////////////////////////////////////////////////////////////////////////////
+typedef void (*HomeCallback_t)(const HomeProgress_t &progress, void *pArg);
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// PathChoice_t
+//
+// This enum gives the way UpdateClock() chose to reach a new time:
+//  PathForward  - Moved clockwise.
+//  PathBackward - Moved counterclockwise.
+//  PathHold     - Did not move.  The new time was a little behind the dial, so
+//                 the dial waits for the time to catch up with it.
+/////////////////////////////////////////////////////////////////////////////////
+enum PathChoice_t
+{
+    PathForward = 0,
+    PathBackward,
+    PathHold
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// PathPlan_t
+//
+// One UpdateClock() decision, with the estimated cost of each way to the new
+// time in microseconds of motor time.  A cost of UINT32_MAX means that way was
+// not allowed.
+/////////////////////////////////////////////////////////////////////////////////
+struct PathPlan_t
+{
+    PathChoice_t choice;        // The cheapest way.
+    int32_t  deltaMinutes;      // Minutes moved (negative if counterclockwise).
+    int32_t  aheadMinutes;      // Minutes the dial is left ahead of the time.
+    uint32_t forwardUs;         // Cost of moving clockwise.
+    uint32_t backwardUs;        // Cost of moving counterclockwise.
+    uint32_t holdUs;            // Cost of holding.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// PathStats_t
+//
+// Counts of UpdateClock() decisions.
+/////////////////////////////////////////////////////////////////////////////////
+struct PathStats_t
+{
+    uint32_t forward;           // Clockwise moves.
+    uint32_t backward;          // Counterclockwise moves.
+    uint32_t holds;             // Times the dial held.
+    uint32_t reversals;         // Moves that reversed the motor.
+    uint64_t costUs;            // Total estimated cost of the chosen ways.
+};
+
+
 /////////////////////////////////////////////////////////////////////////////////
 // GenevaClockMechanics class
 //
@@ -56,6 +158,9 @@ enum StatusCode_t
 class GenevaClockMechanics : public GenericClockBoard
 {
 public:
+    static const uint32_t HOME_POLL_STEPS = 8;  // Default most single steps
+                                                // taken by one PollHome().
+
     /////////////////////////////////////////////////////////////////////////////
     // GenericClockBoard()  (constructor)
     //
@@ -86,13 +191,17 @@ public:
     //                           clock.  Set to 'true' for normally open (N.O.)
     //                           sensors.  Set to 'false' for normally closed
     //                           (N.C.) sensors.
+    //   - pHal                - Specifies the hardware abstraction layer used
+    //                           to access pins and time.  If NULL, the real
+    //                           ESP32 hardware is used on the target.
     /////////////////////////////////////////////////////////////////////////////
     GenevaClockMechanics(
         uint32_t rapidSecondsPerRev,    // Number of seconds for fastest motor rev.
         uint32_t fullStepsPerRev,       // Number of full steps per motor revolution.
         bool     stepperPinsReversed,   // True if servo runs backwards.
         bool     stepperHalfStepping,   // True for half stepping, false for full.
-        bool     homeNormallyOpen);     // True if home switch is normally open.
+        bool     homeNormallyOpen,      // True if home switch is normally open.
+        ClockBoardHal *pHal = NULL);    // Hardware abstraction layer, or NULL.
 
 
     // Destructor.
@@ -107,8 +216,14 @@ public:
     // passed the current time, this method will do the following:
     //  - Determine the difference, in minutes, between the current time and the
     //    last time the method was called.
-    //  - Move the time indicator the correct number of steps, in the shortest
-    //    distance possible, to the new time.
+    //  - Move the time indicator the correct number of steps to the new time,
+    //    whichever way round is cheaper, or hold if the new time is a little
+    //    behind the dial.  See SetPathCosts().
+    //  - Verify the position "on the fly" as the indicator passes 12:00.  See
+    //    HomeRequired().
+    //
+    // Nothing is done while a home is in progress.  The first call after it
+    // ends moves to the current time.
     //
     // Arguments:
     //  - localTime is the current time.
@@ -116,18 +231,84 @@ public:
     void UpdateClock(tm &localTime);
 
 
+    /////////////////////////////////////////////////////////////////////////////
+    // HomeRequired()
+    //
+    // While UpdateClock() moves the indicator clockwise past 12:00, the board
+    // latches the step at which the home sensor becomes active.  If that edge
+    // is within FLY_BY_TOLERANCE_MINUTES of where it is expected, the position
+    // is silently corrected to it (and it counts as a drift calibration
+    // sample), so no full Home() is needed.  Returns 'true' if the clock has
+    // never been homed, or if the edge was missing or too far off, in which
+    // case Home() should be called.
+    /////////////////////////////////////////////////////////////////////////////
+    bool HomeRequired() const                       { return m_HomeRequired; }
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Saved position.
+    //
+    // The position is saved to non-volatile storage after every move, so that
+    // a restart need not search up to 13 hours of dial for 12:00.  Each save
+    // records a generation count, which goes up with every move started, and
+    // how the clock was left:
+    //  - Unknown.  A home, or a move of more than FLY_BY_TOLERANCE_MINUTES,
+    //    was under way (these are saved as they start), or the last home
+    //    failed.
+    //  - Idle.  The last move finished.  Power may since have been lost during
+    //    a shorter move, or the dial turned by hand, so the position must be
+    //    checked.
+    //  - Shutdown.  SavePosition() was called with the clock idle and its
+    //    position verified, so the position is exact.
+    //
+    // RestorePosition()    - Restores a saved Idle or Shutdown position.  Call
+    //                        from setup() after LoadCalibration(), before
+    //                        moving.  Returns 'true' if a position was
+    //                        restored.  Unless it was a Shutdown position,
+    //                        HomeRequired() stays 'true', but the next home
+    //                        starts with a probe: one rapid move to just short
+    //                        of where the edge is expected, then a search of
+    //                        at most twice HOME_SEEK_MARGIN_MINUTES.  If the
+    //                        edge is within FLY_BY_TOLERANCE_MINUTES of where
+    //                        it is expected, the position is corrected to it
+    //                        and the home ends there.  Otherwise the full home
+    //                        carries on.
+    //                        A Shutdown position in retained memory (see
+    //                        RetainPosition()) is used before storage.
+    // SavePosition()       - Saves the position as a clean shutdown.  Call
+    //                        when idle, just before restarting.
+    // RetainPosition()     - Saves the position as a clean shutdown to
+    //                        retained memory only.  Call when idle, just
+    //                        before a deep sleep.  Storage keeps the Idle
+    //                        position, so a power loss while asleep still
+    //                        leads to a probe.  Returns 'false' if the clock
+    //                        was not idle.
+    // PositionGeneration() - Returns the number of moves started, counted
+    //                        across restarts.
+    /////////////////////////////////////////////////////////////////////////////
+    bool     RestorePosition();
+    void     SavePosition();
+    bool     RetainPosition();
+    uint32_t PositionGeneration() const             { return m_Generation; }
+
+
     /////////////////////////////////////////////////////////////////////////////
     // Home()
     //
     // Home the clock to the 12:00 position.  We want to always approach the home
     // switch slowly in the clockwise direction to achieve the best repeatability.
     //  The strategy here is as follows:
-    //   - If we are not already on the home, then move rapidly clockwise toward
-    //     the home till the home switch is detected.
+    //   - If we are not already on the home, then move rapidly toward the home
+    //     till the home switch edge is found.  If the clock has been homed
+    //     before, this goes the shorter way around to where the edge is
+    //     expected.  Otherwise it searches clockwise.
     //   - Rapidly back off the home switch in the counterclockwise direction
     //     until the home switch is no longer detected.
-    //   - Slowly approach the home in the clockwise direction until the home
-    //     switch is detected.
+    //   - Approach the home in the clockwise direction until the home switch
+    //     is detected, slowly for only the last few steps.
+    //
+    // This blocks until the home is done.  It is a wrapper around StartHome()
+    // and PollHome(), and finishes any home already started by them.
     //
     // Returns:
     // Returns a status code as follows:
@@ -141,6 +322,35 @@ public:
     StatusCode_t Home();
 
 
+    /////////////////////////////////////////////////////////////////////////////
+    // Non-blocking home.
+    //
+    // StartHome() starts the same home as Home(), and PollHome() advances it
+    // without blocking the caller for long, so that WiFi, the LED, and the
+    // pushbutton keep running while the clock homes.  The rapid moves of
+    // phase 1 are queued with StepAsync() and PollHome() returns right away
+    // while they run.  Phases 2 and 3 must stop on the very step at which the
+    // switch changes, so they are stepped one at a time, at most 'maxSteps'
+    // steps per call.
+    //
+    // StartHome()  - Starts a home.  'pCallback', if not NULL, is called with
+    //                'pArg' at each phase change and when the home ends.  Does
+    //                nothing if a home is already in progress.
+    // PollHome()   - Advances the home.  Takes at most 'maxSteps' single steps
+    //                (about 2 ms each at fast speed, longer at slow speed).
+    //                Returns 'true' while the home is still in progress.  Call
+    //                it every few ms till it returns 'false'.
+    // IsHoming()   - Returns 'true' while a home is in progress.
+    // HomeState()  - Returns the phase of the home in progress.
+    // HomeStatus() - Returns the result of the last home.
+    /////////////////////////////////////////////////////////////////////////////
+    void         StartHome(HomeCallback_t pCallback = NULL, void *pArg = NULL);
+    bool         PollHome(uint32_t maxSteps = HOME_POLL_STEPS);
+    bool         IsHoming() const                   { return m_HomeState != HomeIdle; }
+    HomeState_t  HomeState() const                  { return m_HomeState; }
+    StatusCode_t HomeStatus() const                 { return m_HomeStatus; }
+
+
     /////////////////////////////////////////////////////////////////////////////
     // Calibrate()
     //
@@ -154,6 +364,136 @@ public:
     /////////////////////////////////////////////////////////////////////////////
     void Calibrate();
 
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SetFullStepsPerRev()
+    //
+    // Sets the actual number of FULL steps per revolution of the stepper motor's
+    // output shaft as the fraction numerator / denominator.  The 28BYJ-48's
+    // gearbox is not exactly 64:1, so it really takes about 2037.76 full steps
+    // (4075.52 half steps) per rev rather than 2048.  Using the actual value,
+    // for example SetFullStepsPerRev(203776, 100), lets UpdateClock() keep the
+    // clock exact indefinitely instead of drifting between homes.
+    //
+    // The constructor's fullStepsPerRev is used (with a denominator of 1) until
+    // this is called.  It should be called before Home() and before
+    // LoadCalibration().  Any learned calibration is discarded.
+    //
+    // Arguments:
+    //   - numerator   - Numerator of the full steps per rev.
+    //   - denominator - Denominator of the full steps per rev.  Must not be 0.
+    /////////////////////////////////////////////////////////////////////////////
+    void SetFullStepsPerRev(uint32_t numerator, uint32_t denominator = 1);
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SetMicrostepping()
+    //
+    // Selects microstepping as GenericClockBoard::SetMicrostepping() does,
+    // then re-applies the full steps per rev given to SetFullStepsPerRev(), so
+    // that the steps per minute, hour, and cycle follow the new steps per full
+    // step.  Any learned calibration is discarded and the clock must be homed
+    // again.  Call from setup() before LoadCalibration(), which then only
+    // finds a calibration learned with the same steps.
+    /////////////////////////////////////////////////////////////////////////////
+    bool SetMicrostepping(uint32_t microstepsPerFullStep);
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Path planning.
+    //
+    // UpdateClock() estimates what each way to a new time costs, in
+    // microseconds of motor time, and takes the cheapest.  Since the coils
+    // draw current for the whole of a move, this minimizes energy as well as
+    // time, so every move uses the StepAuto profile.  The costs are:
+    //  - Moving.  The duration of the move with the selected StepAuto profile.
+    //  - Reversing.  Reversing the motor first takes up the gear train
+    //    backlash (Backlash(), once measured), then costs 'reversalCostMs',
+    //    which also stands for the on the fly 12:00 check that is lost until
+    //    the next clockwise move.  A counterclockwise move pays this twice,
+    //    since the clock must reverse again to carry on.
+    //  - The Geneva load.  Steps taken while the Geneva wheel is engaged need
+    //    more torque, and cost 'extraPercent' more.  See SetGenevaLoad().
+    //  - Holding.  If the new time is no more than 'maxHoldMinutes' behind the
+    //    dial, the dial may instead wait for the time to catch up.  This costs
+    //    'holdCostMs' per square minute, as the dial is that many minutes
+    //    ahead for that many minutes.  With the defaults, a 1 minute NTP
+    //    correction backwards holds, and larger ones move back.
+    //
+    // Each decision is logged, and the last one is kept for analysis.
+    //
+    // SetPathCosts()  - Sets the hold limit and the hold and reversal costs.
+    // SetGenevaLoad() - Marks the dial arc over which the Geneva wheel is
+    //                   engaged.  The drive wheel turns once every
+    //                   HOURS_PER_REV hours, and is engaged from
+    //                   'startMinutes' to 'startMinutes' + 'loadedMinutes'
+    //                   past 12:00 of each turn.  A 'loadedMinutes' of 0 (the
+    //                   default) means there is no extra load.
+    // LastPath()      - Returns the last decision.
+    // GetPathStats()  - Copies the decision counts.
+    // ResetPathStats() - Clears the decision counts.
+    /////////////////////////////////////////////////////////////////////////////
+    void SetPathCosts(uint32_t maxHoldMinutes, uint32_t holdCostMs, uint32_t reversalCostMs);
+    void SetGenevaLoad(uint32_t startMinutes, uint32_t loadedMinutes, uint32_t extraPercent);
+    const PathPlan_t &LastPath() const              { return m_LastPath; }
+    void GetPathStats(PathStats_t &stats) const     { stats = m_PathStats; }
+    void ResetPathStats()               { memset(&m_PathStats, 0, sizeof(m_PathStats)); }
+
+    // Default path costs.
+    static const uint32_t DEFAULT_MAX_HOLD_MINUTES = 2;
+    static const uint32_t DEFAULT_HOLD_COST_MS     = 400;
+    static const uint32_t DEFAULT_REVERSAL_COST_MS = 250;
+
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Drift calibration.
+    //
+    // Each successful Home(), or home edge verified by UpdateClock(), measures
+    // how many steps were actually commanded since the previous one, which
+    // must be a whole number of 12 hour cycles.
+    // A running least squares fit of these measurements gives the effective
+    // steps per cycle, which then replaces the configured value.  Home() also
+    // latches where the switch opens as it backs off counterclockwise and
+    // where it closes again clockwise.  The distance between the two edges,
+    // plus any backlash the board already took up, estimates the gear train
+    // backlash plus reed switch hysteresis.  The learned values are saved to
+    // non-volatile storage after each update.
+    //
+    // The backlash is compensated by the board (see
+    // GenericClockBoard::SetBacklashSteps()), so that the step position, and
+    // so the dial, stays right however often UpdateClock() reverses.
+    //
+    // LoadCalibration()         - Restores the learned values from storage.
+    //                             Returns 'true' if a calibration matching the
+    //                             configured steps per rev was found.  Call
+    //                             from setup() after SetFullStepsPerRev().
+    // ResetCalibration()        - Forgets the learned values and reverts to
+    //                             the configured steps per rev.
+    // StepsPerCycle()           - Returns the steps per 12 hour cycle in use.
+    // Backlash()                - Returns the estimated backlash plus switch
+    //                             hysteresis in steps.
+    // CalibrationSamples()      - Returns the number of home measurements
+    //                             that have been used.
+    // RecommendedHomeInterval() - Returns the number of 12 hour cycles that
+    //                             the clock may run before the expected drift
+    //                             reaches half a minute, limited to between 1
+    //                             and 'maxCycles'.  This is 1 until at least
+    //                             two measurements have been made.
+    // SetBacklashCompensation() - Sets the steps taken up on each reversal,
+    //                             or BACKLASH_AUTO (the default) to use the
+    //                             rounded Backlash() as it is learned.  0
+    //                             disables compensation.
+    /////////////////////////////////////////////////////////////////////////////
+    bool     LoadCalibration();
+    void     ResetCalibration();
+    double   StepsPerCycle() const;
+    float    Backlash() const                       { return m_Cal.backlash; }
+    uint32_t CalibrationSamples() const             { return m_Cal.samples; }
+    uint32_t RecommendedHomeInterval(uint32_t maxCycles) const;
+    void     SetBacklashCompensation(int32_t steps);
+
+    static const int32_t BACKLASH_AUTO = -1;    // Learn the backlash.
+
 protected:
 
 
@@ -162,6 +502,118 @@ private:
     // Private methods.
     /////////////////////////////////////////////////////////////////////////////
 
+    /////////////////////////////////////////////////////////////////////////////
+    // ResetPosition()
+    //
+    // Marks the clock as being at 12:00 with no accumulated step error.
+    /////////////////////////////////////////////////////////////////////////////
+    void ResetPosition();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Home state machine steps.  See PollHome().
+    //
+    // PollSeek()      - Phase 1.  Makes one rapid move the shorter way to
+    //                   where the edge is expected, if it is known.
+    // StartSearch()   - Starts the phase 1 clockwise edge search.
+    // PollSearch()    - Queues the next search move, or checks the last one.
+    // EdgeFound()     - Ends phase 1, returning to just past the edge.
+    // PollBackOff()   - Phase 2.  Steps counterclockwise off the switch.
+    // PollApproach()  - Phase 3.  Steps clockwise back onto the switch.
+    // HomeMove()      - Queues a phase 1 move.
+    // SetHomeState()  - Changes phase and reports it.
+    // EndHome()       - Ends the home with 'status' and reports it.
+    /////////////////////////////////////////////////////////////////////////////
+    void PollSeek();
+    void StartSearch();
+    void PollSearch();
+    void EdgeFound();
+    void PollBackOff(uint32_t maxSteps);
+    void PollApproach(uint32_t maxSteps);
+    void HomeMove(int32_t steps, StepperSpeed_t speed);
+    void SetHomeState(HomeState_t state);
+    void EndHome(StatusCode_t status);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // CheckHomeEdge()
+    //
+    // Called by UpdateClock() after each move to process the board's home edge
+    // latch.
+    //
+    // Arguments:
+    //   - deltaSteps   - Steps just moved.
+    //   - passedTwelve - True if the move passed 12:00 clockwise.
+    /////////////////////////////////////////////////////////////////////////////
+    void CheckHomeEdge(int64_t deltaSteps, bool passedTwelve);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Path planning.  See SetPathCosts().
+    //
+    // PlanPath()      - Returns the cheapest way to a time 'forwardMinutes'
+    //                   (1 to 719) clockwise of the dial.
+    // MoveCostUs()    - Returns the cost of moving 'minutes' (negative for
+    //                   counterclockwise) from the dial's time.
+    // LoadedMinutes() - Returns how many of the minutes from 'fromMinutes' to
+    //                   'fromMinutes' + 'minutes' are in the Geneva load arc.
+    /////////////////////////////////////////////////////////////////////////////
+    PathPlan_t PlanPath(int32_t forwardMinutes) const;
+    uint64_t   MoveCostUs(int32_t minutes) const;
+    int32_t    LoadedMinutes(int32_t fromMinutes, int32_t minutes) const;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // VerifyHomeEdge()
+    //
+    // Compares a latched home edge, in fractional steps, with where it was
+    // expected.  If within tolerance, re-anchors the position to it and returns
+    // 'true'.
+    /////////////////////////////////////////////////////////////////////////////
+    bool VerifyHomeEdge(double edgePosition);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // UpdateCalibration()
+    //
+    // Adds a home measurement to the drift calibration and saves the result.
+    //
+    // Arguments:
+    //   - travelSteps   - Steps commanded between the previous home edge and
+    //                     this one, or 0 if there was no previous home.
+    //   - backlashSteps - Measured backlash plus hysteresis, or negative if
+    //                     the backlash was not measured.
+    /////////////////////////////////////////////////////////////////////////////
+    void UpdateCalibration(double travelSteps, double backlashSteps);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // WritePosition()
+    //
+    // Saves the position to storage, or to retained memory if 'retained' is
+    // 'true', as 'state' (a SavedState_t).  If the position is not known, it
+    // is saved as PosUnknown whatever 'state' is.
+    /////////////////////////////////////////////////////////////////////////////
+    void WritePosition(uint32_t state, bool retained = false);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // CheckProbeEdge()
+    //
+    // Checks an edge found by the boot probe against where the restored
+    // position expects it.  If it agrees, re-anchors the position to it,
+    // ends the home, and returns 'true'.
+    /////////////////////////////////////////////////////////////////////////////
+    bool CheckProbeEdge(double edgePosition);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // ApplyBacklash()
+    //
+    // Passes the learned backlash to the board, if compensating automatically.
+    /////////////////////////////////////////////////////////////////////////////
+    void ApplyBacklash();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // ApplyStepsPerCycle()
+    //
+    // Sets the motor steps per minute from a (possibly fractional) number of
+    // steps per 12 hour cycle.
+    /////////////////////////////////////////////////////////////////////////////
+    void ApplyStepsPerCycle(double stepsPerCycle);
+
     /////////////////////////////////////////////////////////////////////////////
     // Unimplemented methods.  We don't want users to try to use these.
     /////////////////////////////////////////////////////////////////////////////
@@ -179,15 +631,156 @@ private:
                                                     // Number minutes per cycle.
     static const uint32_t GEAR_RATIO        = 32 / 8;  // Main gear 32, motor 8.
 
+    // Drift calibration constants.
+    static const uint32_t CAL_MAGIC         = 0x47434331; // "GCC1"
+    static const char    *CAL_STORAGE_KEY;                // Storage block name.
+    static const int64_t  CAL_STEP_SCALE    = 1000;  // Learned steps per cycle
+                                                     // resolution (1/1000 step).
+    static const uint32_t CAL_MIN_SAMPLES   = 2;     // Samples needed before
+                                                     // homes are spaced out.
+    static const double   CAL_FORGET;       // Weight kept by old samples.
+    static const double   CAL_MAX_ERROR;    // Largest plausible per cycle
+                                            // error, as a fraction.
+    static const double   CAL_NOISE_WEIGHT; // Weight of new noise samples.
+    static const float    CAL_BACKLASH_WEIGHT; // Weight of new backlash samples.
+
+    // Saved position constants.
+    static const uint32_t POS_MAGIC         = 0x47435031; // "GCP1"
+    static const char    *POS_STORAGE_KEY;                // Storage block name.
+
+    // Home() constants.
+    static const int32_t  HOME_SEEK_MARGIN_MINUTES  = 5; // Distance short of
+                                                    // the expected edge that
+                                                    // the rapid seek stops.
+    static const int32_t  HOME_SEARCH_FIRST_STEPS   = 4; // Half the length
+                                                    // of the first edge
+                                                    // search move.
+    static const int32_t  HOME_FINE_STEPS           = 3; // Slow steps before
+                                                    // the expected edge.
+
+    // Fly-by home verification constants.
+    static const int32_t  FLY_BY_TOLERANCE_MINUTES = 2; // Largest error that
+                                                        // is silently corrected.
+    static const int32_t  FLY_BY_WINDOW_MINUTES    = FLY_BY_TOLERANCE_MINUTES + 1;
+                                                    // Minutes past 12:00 by
+                                                    // which an edge must have
+                                                    // been seen.
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private types.
+    /////////////////////////////////////////////////////////////////////////////
+
+    // Drift calibration state.  This is saved to non-volatile storage as is.
+    struct Calibration_t
+    {
+        uint32_t magic;             // CAL_MAGIC when valid.
+        uint32_t samples;           // Number of measurements used.
+        double   configuredSteps;   // Configured steps per cycle when learned.
+        double   sumTravelCycles;   // Weighted sum of travel * cycles.
+        double   sumCycles2;        // Weighted sum of cycles squared.
+        double   noiseVar;          // Measurement noise variance (steps^2).
+        float    backlash;          // Backlash plus hysteresis (steps).
+    };
+
+    // How the clock was left when its position was saved.
+    enum SavedState_t
+    {
+        PosUnknown = 0,             // Moving, or not homed.
+        PosIdle,                    // Stopped after a move.
+        PosShutdown                 // Stopped by SavePosition() or
+                                    // RetainPosition().
+    };
+
+    // Saved position.  This is saved to non-volatile storage (or retained
+    // memory) as is.
+    struct SavedPosition_t
+    {
+        uint32_t magic;             // POS_MAGIC when valid.
+        uint32_t generation;        // Moves started when saved.
+        uint32_t state;             // SavedState_t.
+        uint32_t stepsPerFullStep;  // Board steps per full step when saved.
+        double   configuredSteps;   // Configured steps per cycle when saved.
+        int64_t  stepperPos;        // m_StepperPos.
+        int64_t  stepError;         // m_StepError.
+        int64_t  stepDivisor;       // m_MinuteStepDivisor.
+        double   homeOffset;        // Last home edge, relative to 12:00.
+        int32_t  lastMinutes;       // m_LastMinutes.
+        int32_t  lastDirection;     // m_LastDirection.
+        int32_t  boardDirection;    // The board's LastDirection().
+        uint32_t stepperPhase;      // The board's StepperPhase().
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // IsUsablePosition()
+    //
+    // Returns 'true' if 'saved' is a valid position saved with the same gear
+    // train and stepping mode.  Declared here since it needs SavedPosition_t.
+    /////////////////////////////////////////////////////////////////////////////
+    bool IsUsablePosition(const SavedPosition_t &saved) const;
+
 
     /////////////////////////////////////////////////////////////////////////////
     // Private instance data.
     /////////////////////////////////////////////////////////////////////////////
-    int32_t  m_LastStepperPos;      // Last updated position of motor, in steps.
+    int64_t  m_StepperPos;          // Commanded motor position since the last
+                                    // home, in steps (not wrapped).
+    int64_t  m_StepError;           // Bresenham error accumulator.  The exact
+                                    // position is m_StepperPos plus
+                                    // m_StepError / m_MinuteStepDivisor steps.
+    int64_t  m_MinuteStepNumerator; // Motor steps per minute is the fraction
+    int64_t  m_MinuteStepDivisor;   // m_MinuteStepNumerator / m_MinuteStepDivisor.
     int32_t  m_LastMinutes;         // Last updated time, in minutes
-                                    // Should normally be -719 through 719.
-    uint32_t m_StepsPerHour;        // Number of motor steps per hour.
-    int32_t  m_StepsPerCycle;       // Number of motor steps per 12 hours.
+                                    // Should normally be 0 through 719.
+    uint32_t m_FullStepsNumerator;  // Full steps per rev is the fraction
+    uint32_t m_FullStepsDenominator; // m_FullStepsNumerator /
+                                    // m_FullStepsDenominator.
+    double   m_ConfiguredSteps;     // Configured steps per 12 hour cycle.
+    Calibration_t m_Cal;            // Drift calibration state.
+    double   m_LastHomePosition;    // Home edge position (steps) at the last home.
+    bool     m_HomeValid;           // True if m_LastHomePosition is valid.
+    bool     m_HomeRequired;        // True if a full Home() is needed.
+    bool     m_FlyByArmed;          // True if the board's home latch is armed
+                                    // and backlash is taken up clockwise.
+    bool     m_FlyByDue;            // True if 12:00 was passed and no edge
+                                    // has been seen yet.
+    bool     m_HomeEdgeAhead;       // True if 12:00 was passed clockwise and
+                                    // no edge was seen, so it is still ahead.
+    bool     m_RejectedEdgeValid;   // True if m_RejectedEdge is valid.
+    double   m_RejectedEdge;        // Position of the last edge that failed
+                                    // verification, for Home().
+    HomeState_t  m_HomeState;       // Phase of the home in progress.
+    StatusCode_t m_HomeStatus;      // Result of the last home.
+    HomeCallback_t m_pHomeCallback; // Home progress callback, or NULL.
+    void    *m_pHomeArg;            // Argument for m_pHomeCallback.
+    bool     m_HomeMoving;          // True if PollHome() queued a move that
+                                    // has not been checked yet.
+    bool     m_HomeEdgeKnown;       // True if m_HomeEdge is valid.
+    double   m_HomeEdge;            // Edge position latched in phase 1.
+    int32_t  m_HomeChunk;           // Length of the last search move.
+    int32_t  m_HomeSearched;        // Steps searched so far.
+    int64_t  m_HomeMoveFrom;        // Where the last home move started.
+    uint32_t m_HomeCount;           // Steps taken so far in phase 2 or 3.
+    bool     m_HomeBackedOff;       // True if phase 2 moved off the switch.
+    bool     m_HomeReleaseKnown;    // True if m_HomeRelease is valid.
+    double   m_HomeRelease;         // Edge position latched in phase 2.
+    int64_t  m_HomeFastSteps;       // Phase 3 steps to take at fast speed.
+    uint32_t m_HomeSteps;           // Steps moved since the home started.
+    uint32_t m_StepsPerHour;        // Motor steps per hour (rounded).
+    int32_t  m_StepsPerCycle;       // Motor steps per 12 hours (rounded).
+    int32_t  m_LastDirection;       // Direction of the last move (1 for
+                                    // clockwise, -1, or 0 if unknown).
+    bool     m_AutoBacklash;        // True if compensating Backlash().
+    uint32_t m_Generation;          // Moves started, across restarts.
+    bool     m_HomeProbe;           // True if the next home starts with a
+                                    // probe of a restored position.
+    uint32_t m_MaxHoldMinutes;      // Most minutes the dial may hold ahead.
+    uint32_t m_HoldCostUs;          // Hold cost per square minute.
+    uint32_t m_ReversalCostUs;      // Cost of reversing, besides backlash.
+    int32_t  m_LoadStartMinutes;    // Start of the Geneva load arc.
+    int32_t  m_LoadedMinutes;       // Length of the Geneva load arc.
+    uint32_t m_LoadPercent;         // Extra cost of loaded steps.
+    PathPlan_t  m_LastPath;         // The last UpdateClock() decision.
+    PathStats_t m_PathStats;        // Decision counts.
 
 
 }; // End class GenevaClockMechanics.
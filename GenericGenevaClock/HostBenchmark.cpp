@@ -0,0 +1,2929 @@
+/////////////////////////////////////////////////////////////////////////////////
+// HostBenchmark.cpp
+//
+// Contains a host (Linux) benchmark program for the clock's stepping code.
+// This file is only built on the host (i.e. when ARDUINO is not defined), so
+// the Arduino IDE simply sees an empty file.  To build and run it:
+//      g++ -std=gnu++11 -O2 -pthread -I. *.cpp -o HostBenchmark && ./HostBenchmark
+//
+// The benchmarks are:
+//      - Step interval CPU cost.  Compares the per-step CPU time needed to
+//        decide a step's interval using the original branching code, the run
+//        time MotionPlanner tables, and the compile time StepIntervalTable
+//        tables.
+//      - Step interval jitter.  Plays moves out in real time with busy wait
+//        delays, once the original way (a delayMicroseconds() call per rapid
+//        interval, with up to 7 per step) and once with a single table lookup
+//        and delay per step, and reports how far each step's actual period
+//        strays from its intended period.  Each delay call costs much more on
+//        the ESP32 than on a PC, so the host numbers understate the
+//        difference.
+//      - Drift calibration.  Runs the clock for several simulated days on a
+//        SimulatedHal whose gear ratio and backlash differ from the configured
+//        values, homing whenever GenevaClockMechanics asks for it,
+//        and reports how the learned steps per cycle, the dial error, and the
+//        number and duration of homes evolve.  It then simulates a reboot to
+//        check that the calibration is restored from storage.
+//      - Home verification.  Runs the clock for a week with a full home at
+//        every 12:00, and again with the home edge verified on the fly as the
+//        indicator passes 12:00, knocking the dial off twice along the way,
+//        and reports the number and total duration of the full homes.
+//      - Homing time.  Times the original and current Home() from random
+//        dial positions, at power up and while running.
+//      - Button capture.  Scripts short button presses and compares polling
+//        the button from loop() with reading the interrupt captured edges.
+//      - Scheduler.  Runs the sketch's work for a simulated hour as the
+//        original loop() and with TaskScheduler, and compares the button and
+//        minute update latencies and the idle time.
+//      - Home latency test.  Homes the clock from a scheduler task with the
+//        blocking Home() and with StartHome() / PollHome(), and reports how
+//        long the other tasks were held up.  The program exits with a
+//        non-zero status if a polled home blocks them for more than 50 ms.
+//      - SpscRing test.  Pushes and pops 2 million items between two
+//        threads and checks that none are lost, duplicated, reordered, or
+//        torn.
+//      - SeqLock test.  Publishes 2 million snapshots from one thread while
+//        another reads them, and checks that no read is torn or goes back.
+//      - MotionTask test.  Sends moves to a MotionTask running a simulated
+//        clock in another thread, and checks that they all run in order and
+//        that every status read matches the moves run so far.
+//      - Step timing test.  Runs moves at each speed with random latency
+//        added to the step timer, as WiFi interrupts add it on the ESP32, and
+//        checks that the step timing statistics account for all of it.
+//      - Coil power.  Runs the clock for a simulated day with each coil
+//        policy, and compares the average coil current each one draws with
+//        the estimates made from the CoilRelease run.
+//      - Microstepping.  Runs the clock for 12 simulated hours with half
+//        stepping and with 8, 16, and 32 microsteps per full step, and
+//        compares the dial resolution and error, missed steps, move time, and
+//        host CPU time per step.
+//      - Scenario suite.  Replays scripted calls in virtual time: a day of
+//        minute updates, daylight saving time changes, NTP corrections,
+//        homes from random positions at power up, and Calibrate().  Reports
+//        the motor time, steps, direction reversals, host CPU time per call,
+//        and the longest any call blocked.  Run "./HostBenchmark scenarios"
+//        to run only this, for example to check a change for regressions.
+//      - Backlash test.  Makes thousands of random moves either way on a
+//        motor with backlash, without compensation, with the actual backlash
+//        configured, and with the backlash Home() measures, and checks that
+//        the compensated dial error stays within a couple of half steps.
+//      - Boot test.  Power cycles a simulated clock with no saved position,
+//        after a power loss, after a clean shutdown, and with the dial turned
+//        while off, and reports the time from power on to showing the
+//        correct time.
+//      - LED animator test.  Plays the sketch's power up fades and error
+//        blinks in virtual time, and checks their timing and the CPU time
+//        per tick.
+//      - LED compositor test.  Posts the sketch's LED status layers in
+//        virtual time, including posts from several threads at once, and
+//        checks that each is shown in priority order for at least its
+//        minimum time.
+//      - Button gesture test.  Feeds made up pushbutton edge traces, with
+//        contact bounce and glitches, to ButtonGestures, and checks the
+//        clicks, double clicks, long presses, and very long presses found
+//        and when they are reported.
+//      - Minute boundary test.  Runs the minute task's wakeups for three
+//        simulated hours against a time source that drifts, jumps, and
+//        changes to daylight saving time, and compares the wakeups and the
+//        boundary latency with polling every 250 ms.
+//      - Minute task test.  Runs the same minute wakeups from a task that
+//        reschedules itself through TaskScheduler, as the sketch's does, with
+//        a MotionTask running the updates, and checks that every minute is
+//        still seen and reports the boundary to motion latency.
+//      - Low power test.  Runs a day of the sketch's LOW_POWER_MODE minute
+//        wakes, each a new clock restored from retained memory, with and
+//        without power losses while asleep, and reports the awake time, the
+//        storage writes, and the average current against staying awake.
+//      The program exits with a non-zero status if any test fails.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#if !defined ARDUINO
+
+#include <stdio.h>                  // For printf().
+#include <stdint.h>                 // For INT64_MAX.
+#include <string.h>                 // For strcmp().
+#include <math.h>                   // For fabs().
+#include <time.h>                   // For struct tm.
+#include <algorithm>                // For std::sort().
+#include <chrono>                   // For std::chrono::steady_clock.
+#include <thread>                   // For std::thread.
+#include <atomic>                   // For std::atomic.
+#include <vector>                   // For std::vector.
+#include "GenericClockBoard.h"      // For StepperSpeed_t.
+#include "GenevaClockMechanics.h"   // For GenevaClockMechanics class.
+#include "SimulatedHal.h"           // For SimulatedHal class.
+#include "MotionPlanner.h"          // For MotionPlanner class.
+#include "StepIntervalTable.h"      // For compile time step tables.
+#include "SpscRing.h"               // For SpscRing template.
+#include "SeqLock.h"                // For SeqLock template.
+#include "MotionTask.h"             // For MotionTask class.
+#include "TaskScheduler.h"          // For TaskScheduler class.
+#include "StepTimingStats.h"        // For StepTimingStats class.
+#include "StepTimer.h"              // For StepTimer::SetHostLatency().
+#include "LedAnimator.h"            // For LedAnimator class.
+#include "LedCompositor.h"          // For LedCompositor class.
+#include "ButtonGestures.h"         // For ButtonGestures class.
+#include "MinuteBoundary.h"         // For MinuteBoundary class.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Benchmark configuration.  These match GenericGenevaClock.ino.
+/////////////////////////////////////////////////////////////////////////////////
+static const uint32_t RAPID_SECONDS_PER_REV = 8;
+static const uint32_t FULL_STEPS_PER_REV    = 2048;
+static const bool     USE_HALF_STEPPING     = true;
+static const float    LOW_POWER_AWAKE_MA    = 45.0f;
+static const float    LOW_POWER_WIFI_MA     = 120.0f;
+static const float    LOW_POWER_SLEEP_MA    = 0.25f;
+static const uint32_t LOW_POWER_BOOT_MS     = 200;
+
+typedef StepIntervalTable<RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV,
+                          USE_HALF_STEPPING> StepTables;
+
+typedef std::chrono::steady_clock Clock_t;
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// NowNs()
+//
+// Returns the host's monotonic time in nanoseconds.
+/////////////////////////////////////////////////////////////////////////////////
+static uint64_t NowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock_t::now().time_since_epoch()).count();
+} // End NowNs().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// BusyWaitUs()
+//
+// Spins for the specified number of microseconds, like delayMicroseconds().
+/////////////////////////////////////////////////////////////////////////////////
+static void BusyWaitUs(uint32_t us)
+{
+    uint64_t endNs = NowNs() + static_cast<uint64_t>(us) * 1000;
+    while (NowNs() < endNs)
+    {
+    }
+} // End BusyWaitUs().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// OriginalDelayCount()
+//
+// Returns the number of rapid delays that the original GenericClockBoard::Step()
+// made for step 'j' of a move that is 'absSteps' long.  This is the original
+// branching code, kept here for comparison.
+/////////////////////////////////////////////////////////////////////////////////
+static uint32_t OriginalDelayCount(int32_t j, int32_t absSteps, StepperSpeed_t speed)
+{
+    uint32_t count = 1;
+    if (speed == StepSlow)
+    {
+        count += 4;
+    }
+    else if (speed == StepAuto)
+    {
+        if (j < 20)            count++;
+        if (j < 10)            count++;
+        if (j < 5)             count++;
+        if (absSteps - j < 20) count++;
+        if (absSteps - j < 10) count++;
+        if (absSteps - j < 5)  count++;
+    }
+    return count;
+} // End OriginalDelayCount().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Per-step interval functions.  Each is called once per step, the same way
+// the step timer callback would, and is kept out of line so that the compiler
+// cannot fold the loop that calls it.
+/////////////////////////////////////////////////////////////////////////////////
+static MotionPlanner gRunTimePlanner;
+static StepRamp_t    gTables[3];
+
+__attribute__((noinline))
+static uint32_t OriginalIntervalUs(int32_t j, int32_t absSteps, StepperSpeed_t speed)
+{
+    return OriginalDelayCount(j, absSteps, speed) * StepTables::FAST_US;
+}
+
+__attribute__((noinline))
+static uint32_t PlannerIntervalUs(int32_t j, int32_t absSteps, StepperSpeed_t speed)
+{
+    if (speed == StepAuto)
+    {
+        return gRunTimePlanner.IntervalUs(j, absSteps);
+    }
+    return (speed == StepSlow) ? StepTables::SLOW_US : StepTables::FAST_US;
+}
+
+__attribute__((noinline))
+static uint32_t TableIntervalUs(int32_t j, int32_t absSteps, const StepRamp_t *pRamp)
+{
+    return StepRampIntervalUs(*pRamp, j, absSteps);
+}
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// BenchmarkIntervalCost()
+//
+// Measures the CPU time needed to decide each step's interval.
+/////////////////////////////////////////////////////////////////////////////////
+static void BenchmarkIntervalCost()
+{
+    const int32_t  MOVES[]  = { 91, 455, 5461, 32768 };
+    const uint32_t NUM_MOVES = sizeof(MOVES) / sizeof(MOVES[0]);
+    const uint32_t REPEATS   = 200;
+    const StepperSpeed_t SPEEDS[] = { StepSlow, StepAuto, StepFast };
+    const char *SPEED_NAMES[]     = { "StepSlow", "StepAuto", "StepFast" };
+
+    gRunTimePlanner.SetStartVelocity(StepTables::START_RATE);
+    gRunTimePlanner.AddProfile(StepTables::AutoProfile(1));
+    gTables[0] = StepTables::SlowRamp();
+    gTables[1] = StepTables::AutoRamp(1);
+    gTables[2] = StepTables::FastRamp();
+
+    printf("Step interval CPU cost (ns per step)\n");
+    printf("  %-9s %10s %10s %10s\n", "speed", "original", "planner", "constexpr");
+    for (uint32_t s = 0; s < 3; s++)
+    {
+        uint64_t steps = 0;
+        uint64_t sink  = 0;
+        uint64_t ns[3] = { 0, 0, 0 };
+        for (uint32_t r = 0; r < REPEATS; r++)
+        {
+            for (uint32_t m = 0; m < NUM_MOVES; m++)
+            {
+                int32_t n = MOVES[m];
+                uint64_t t0 = NowNs();
+                for (int32_t j = 0; j < n; j++)
+                {
+                    sink += OriginalIntervalUs(j, n, SPEEDS[s]);
+                }
+                uint64_t t1 = NowNs();
+                for (int32_t j = 0; j < n; j++)
+                {
+                    sink += PlannerIntervalUs(j, n, SPEEDS[s]);
+                }
+                uint64_t t2 = NowNs();
+                const StepRamp_t *pRamp = &gTables[s];
+                for (int32_t j = 0; j < n; j++)
+                {
+                    sink += TableIntervalUs(j, n, pRamp);
+                }
+                uint64_t t3 = NowNs();
+                ns[0] += t1 - t0;
+                ns[1] += t2 - t1;
+                ns[2] += t3 - t2;
+                steps += n;
+            }
+        }
+        printf("  %-9s %10.2f %10.2f %10.2f   (checksum %llu)\n", SPEED_NAMES[s],
+               static_cast<double>(ns[0]) / steps, static_cast<double>(ns[1]) / steps,
+               static_cast<double>(ns[2]) / steps, static_cast<unsigned long long>(sink));
+    }
+    printf("\n");
+} // End BenchmarkIntervalCost().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// PlayOriginal()
+//
+// Plays a StepAuto move out in real time the original way, with one delay per
+// rapid interval, and records each step's period error in 'errNs'.
+/////////////////////////////////////////////////////////////////////////////////
+static void PlayOriginal(int32_t absSteps, int64_t *errNs)
+{
+    uint64_t last = NowNs();
+    for (int32_t j = 0; j < absSteps; j++)
+    {
+        uint32_t count = OriginalDelayCount(j, absSteps, StepAuto);
+        for (uint32_t i = 0; i < count; i++)
+        {
+            BusyWaitUs(StepTables::FAST_US);
+        }
+        uint64_t now = NowNs();
+        errNs[j] = static_cast<int64_t>(now - last) -
+                   static_cast<int64_t>(count) * StepTables::FAST_US * 1000;
+        last = now;
+    }
+} // End PlayOriginal().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// PlayTable()
+//
+// Plays a StepAuto move out in real time with one table lookup and one delay
+// per step, and records each step's period error in 'errNs'.
+/////////////////////////////////////////////////////////////////////////////////
+static void PlayTable(int32_t absSteps, int64_t *errNs)
+{
+    const StepRamp_t ramp = StepTables::AutoRamp(1);
+    uint64_t last = NowNs();
+    for (int32_t j = 0; j < absSteps; j++)
+    {
+        uint32_t us = StepRampIntervalUs(ramp, j, absSteps);
+        BusyWaitUs(us);
+        uint64_t now = NowNs();
+        errNs[j] = static_cast<int64_t>(now - last) - static_cast<int64_t>(us) * 1000;
+        last = now;
+    }
+} // End PlayTable().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ReportJitter()
+//
+// Sorts the per-step period errors in 'errNs' and prints their statistics.
+/////////////////////////////////////////////////////////////////////////////////
+static void ReportJitter(const char *pName, int64_t *errNs, uint32_t count)
+{
+    std::sort(errNs, errNs + count);
+    double mean = 0.0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        mean += errNs[i];
+    }
+    mean /= count;
+    printf("  %-10s mean %7.2f us  p50 %7.2f us  p99 %7.2f us  max %8.2f us\n",
+           pName, mean / 1000.0, errNs[count / 2] / 1000.0,
+           errNs[count * 99 / 100] / 1000.0, errNs[count - 1] / 1000.0);
+} // End ReportJitter().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// BenchmarkJitter()
+//
+// Plays StepAuto moves out in real time and measures the error between each
+// step's actual and intended period.  The host is not a real time system, so
+// each method is run several times (interleaved) and the run with the lowest
+// 99th percentile error is reported, which filters out most preemption.
+/////////////////////////////////////////////////////////////////////////////////
+static void BenchmarkJitter()
+{
+    const int32_t  MOVE_STEPS = 455;
+    const uint32_t TRIALS     = 3;
+    static int64_t errNs[MOVE_STEPS];
+    static int64_t bestNs[2][MOVE_STEPS];
+    int64_t bestP99[2] = { INT64_MAX, INT64_MAX };
+
+    printf("Step period error, %d step StepAuto move in real time (best of %u)\n",
+           MOVE_STEPS, TRIALS);
+    for (uint32_t t = 0; t < TRIALS; t++)
+    {
+        for (uint32_t m = 0; m < 2; m++)
+        {
+            if (m == 0)
+            {
+                PlayOriginal(MOVE_STEPS, errNs);
+            }
+            else
+            {
+                PlayTable(MOVE_STEPS, errNs);
+            }
+            std::sort(errNs, errNs + MOVE_STEPS);
+            if (errNs[MOVE_STEPS * 99 / 100] < bestP99[m])
+            {
+                bestP99[m] = errNs[MOVE_STEPS * 99 / 100];
+                std::copy(errNs, errNs + MOVE_STEPS, bestNs[m]);
+            }
+        }
+    }
+    ReportJitter("original", bestNs[0], MOVE_STEPS);
+    ReportJitter("table",    bestNs[1], MOVE_STEPS);
+    printf("\n");
+} // End BenchmarkJitter().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// DialError()
+//
+// Returns how far, in minutes, the simulated dial is from 'minutes' past 12:00.
+/////////////////////////////////////////////////////////////////////////////////
+static double DialError(const SimulatedHal &hal, int32_t minutes)
+{
+    double error = hal.DialMinutes() - (minutes % 720);
+    if (error > 360.0)
+    {
+        error -= 720.0;
+    }
+    else if (error < -360.0)
+    {
+        error += 720.0;
+    }
+    return error;
+} // End DialError().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// RunStats_t
+//
+// Statistics gathered by RunMinutes().
+/////////////////////////////////////////////////////////////////////////////////
+struct RunStats_t
+{
+    uint32_t homes;         // Number of full homes.
+    uint64_t homeUs;        // Total (virtual) time spent in full homes.
+    double   maxError;      // Largest dial error seen, in minutes.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// RunMinutes()
+//
+// Runs the clock minute by minute from minute 'first' (minutes since the start
+// of the run, where the run starts at 12:00) through 'last'.  After each
+// update, a full home is done if 'homeAtTwelve' is true and it is 12:00 (the
+// original sketch's behaviour), or whenever the mechanics ask for one (the
+// current sketch's behaviour).
+/////////////////////////////////////////////////////////////////////////////////
+static void RunMinutes(SimulatedHal &hal, GenevaClockMechanics &clock, int32_t first,
+                       int32_t last, bool homeAtTwelve, RunStats_t &stats)
+{
+    for (int32_t m = first; m <= last; m++)
+    {
+        struct tm now = {};
+        now.tm_hour = (m / 60) % 24;
+        now.tm_min  = m % 60;
+        clock.UpdateClock(now);
+        hal.Delay(10);
+        double err = DialError(hal, m);
+        if (fabs(err) > fabs(stats.maxError))
+        {
+            stats.maxError = err;
+        }
+        if (homeAtTwelve ? ((m % 720) == 0) : clock.HomeRequired())
+        {
+            uint64_t start = hal.Micros();
+            clock.Home();
+            stats.homeUs += hal.Micros() - start;
+            stats.homes++;
+        }
+    }
+} // End RunMinutes().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// BenchmarkCalibration()
+//
+// Runs the clock minute by minute for several simulated days with the nominal
+// 2048 full steps per rev configured, while the simulated motor really takes
+// 2037.76 and has some backlash.  The clock is homed whenever the mechanics
+// ask for it, the same way as the sketch's loop() does.
+/////////////////////////////////////////////////////////////////////////////////
+static void BenchmarkCalibration()
+{
+    const uint32_t DAYS             = 15;
+    const double   TRUE_HALF_STEPS  = 4075.52;
+    const double   TRUE_BACKLASH    = 8.0;
+    const double   TRUE_STEPS       = TRUE_HALF_STEPS * 16.0;
+
+    SimulatedHal hal(true, true);
+    hal.SetHalfStepsPerRev(TRUE_HALF_STEPS);
+    hal.SetBacklash(TRUE_BACKLASH);
+    hal.SetDialMinutes(300.0);
+
+    GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                               USE_HALF_STEPPING, true, &hal);
+    StepTables::Install(clock.Planner());
+    clock.LoadCalibration();
+
+    printf("Drift calibration, configured %u steps/cycle, actual %.2f, backlash %.0f\n",
+           FULL_STEPS_PER_REV * 32, TRUE_STEPS, TRUE_BACKLASH);
+    printf("  %3s %5s %8s %12s %9s %9s %9s\n", "day", "homes", "home s",
+           "steps/cycle", "backlash", "samples", "max err");
+
+    RunStats_t stats = { 1, hal.Micros(), 0.0 };
+    clock.Home();
+    stats.homeUs = hal.Micros() - stats.homeUs;
+
+    for (uint32_t day = 1; day <= DAYS; day++)
+    {
+        RunMinutes(hal, clock, (day - 1) * 1440 + 1, day * 1440, false, stats);
+        printf("  %3u %5u %8.1f %12.2f %9.2f %9u %9.3f\n", day, stats.homes,
+               stats.homes ? stats.homeUs / 1.0e6 / stats.homes : 0.0,
+               clock.StepsPerCycle(), clock.Backlash(), clock.CalibrationSamples(),
+               stats.maxError);
+        RunStats_t next = { 0, 0, 0.0 };
+        stats = next;
+    }
+
+    // Reboot.  A new instance restores the calibration from storage.
+    GenevaClockMechanics rebooted(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                                  USE_HALF_STEPPING, true, &hal);
+    bool loaded = rebooted.LoadCalibration();
+    printf("  After reboot: loaded %s, steps/cycle %.2f, %u samples, %u storage writes\n",
+           loaded ? "yes" : "no", rebooted.StepsPerCycle(),
+           rebooted.CalibrationSamples(), hal.StorageWrites());
+    printf("\n");
+} // End BenchmarkCalibration().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// BenchmarkFlyBy()
+//
+// Runs the clock for a week, once with a full home at every 12:00 (the
+// original sketch) and once relying on the home edge being verified on the fly
+// by UpdateClock().  The dial is knocked 1 minute fast on day 3 (which should
+// be corrected silently at the next 12:00) and 10 minutes slow on day 5 (which
+// should fall back to a full home).
+/////////////////////////////////////////////////////////////////////////////////
+static void BenchmarkFlyBy()
+{
+    const int32_t DAYS       = 7;
+    const int32_t SMALL_SLIP = 3 * 1440 + 300;      // Day 3, 5:00.
+    const int32_t LARGE_SLIP = 5 * 1440 + 300;      // Day 5, 5:00.
+
+    printf("Home verification over %d days (dial knocked +1 min on day 3, "
+           "-10 min on day 5)\n", DAYS);
+    printf("  %-14s %6s %12s %14s %12s\n", "policy", "homes", "homing s",
+           "max err (min)", "final err");
+    for (uint32_t p = 0; p < 2; p++)
+    {
+        bool homeAtTwelve = (p == 0);
+        SimulatedHal hal(true, true);
+        hal.SetHalfStepsPerRev(4075.52);
+        hal.SetBacklash(8.0);
+        GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                                   USE_HALF_STEPPING, true, &hal);
+        StepTables::Install(clock.Planner());
+        clock.SetFullStepsPerRev(203776, 100);
+        clock.Home();
+
+        RunStats_t stats = { 0, 0, 0.0 };
+        RunMinutes(hal, clock, 1, SMALL_SLIP, homeAtTwelve, stats);
+        hal.SetDialMinutes(hal.DialMinutes() + 1.0);
+        RunMinutes(hal, clock, SMALL_SLIP + 1, LARGE_SLIP, homeAtTwelve, stats);
+        hal.SetDialMinutes(hal.DialMinutes() - 10.0);
+        RunMinutes(hal, clock, LARGE_SLIP + 1, DAYS * 1440, homeAtTwelve, stats);
+        printf("  %-14s %6u %12.1f %14.3f %12.3f\n",
+               homeAtTwelve ? "home at 12:00" : "fly-by",
+               stats.homes, stats.homeUs / 1.0e6, stats.maxError,
+               DialError(hal, DAYS * 1440));
+    }
+    printf("\n");
+} // End BenchmarkFlyBy().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// OriginalHome()
+//
+// The original Home() phases: step clockwise till the switch is found, step
+// counterclockwise off it, then step slowly clockwise back onto it, checking
+// the switch after every step.
+/////////////////////////////////////////////////////////////////////////////////
+static void OriginalHome(GenevaClockMechanics &clock)
+{
+    const uint32_t STEPS_PER_CYCLE = static_cast<uint32_t>(clock.StepsPerCycle() + 0.5);
+    const uint32_t STEPS_PER_HOUR  = STEPS_PER_CYCLE / 12;
+    uint32_t i;
+    for (i = 0; !clock.IsHome() && (i < STEPS_PER_CYCLE + STEPS_PER_HOUR); i++)
+    {
+        clock.Step(GenericClockBoard::STEP_CW, StepFast);
+    }
+    for (i = 0; clock.IsHome() && (i < STEPS_PER_HOUR); i++)
+    {
+        clock.Step(GenericClockBoard::STEP_CCW, StepFast);
+    }
+    for (i = 0; !clock.IsHome() && (i < STEPS_PER_HOUR); i++)
+    {
+        clock.Step(GenericClockBoard::STEP_CW, StepSlow);
+    }
+} // End OriginalHome().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// BenchmarkHoming()
+//
+// Times the original and current Home() from random dial positions, both at
+// power up (position unknown) and when re-homing a running clock (position
+// known from the last home), and reports the average and worst case times and
+// the largest dial error after homing.
+/////////////////////////////////////////////////////////////////////////////////
+static void BenchmarkHoming()
+{
+    const uint32_t SAMPLES = 100;
+
+    printf("Home() time from %u random dial positions\n", SAMPLES);
+    printf("  %-10s %-10s %10s %10s %14s\n", "start", "method", "average s",
+           "worst s", "max err (min)");
+    for (uint32_t known = 0; known < 2; known++)
+    {
+        for (uint32_t current = 0; current < 2; current++)
+        {
+            uint32_t seed     = 54321;
+            double   totalUs  = 0.0;
+            uint64_t worstUs  = 0;
+            double   maxError = 0.0;
+            for (uint32_t n = 0; n < SAMPLES; n++)
+            {
+                seed = seed * 1664525 + 1013904223;
+                int32_t minutes = (seed >> 8) % 720;
+
+                SimulatedHal hal(true, true);
+                hal.SetHalfStepsPerRev(4075.52);
+                hal.SetBacklash(8.0);
+                if (!known)
+                {
+                    hal.SetDialMinutes(minutes + 0.5);
+                }
+                GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                                           USE_HALF_STEPPING, true, &hal);
+                StepTables::Install(clock.Planner());
+                clock.SetFullStepsPerRev(203776, 100);
+                if (known)
+                {
+                    clock.Home();
+                    tm now = {};
+                    now.tm_hour = minutes / 60;
+                    now.tm_min  = minutes % 60;
+                    clock.UpdateClock(now);
+                }
+
+                uint64_t start = hal.Micros();
+                if (current)
+                {
+                    clock.Home();
+                }
+                else
+                {
+                    OriginalHome(clock);
+                }
+                uint64_t us = hal.Micros() - start;
+                totalUs += us;
+                worstUs  = std::max(worstUs, us);
+                double err = DialError(hal, 0);
+                if (fabs(err) > fabs(maxError))
+                {
+                    maxError = err;
+                }
+            }
+            printf("  %-10s %-10s %10.1f %10.1f %14.3f\n",
+                   known ? "running" : "power up", current ? "current" : "original",
+                   totalUs / SAMPLES / 1.0e6, worstUs / 1.0e6, maxError);
+        }
+    }
+    printf("\n");
+} // End BenchmarkHoming().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// LoopSim_t
+//
+// State shared by the simulated sketch tasks used by BenchmarkScheduler().
+/////////////////////////////////////////////////////////////////////////////////
+struct LoopSim_t
+{
+    SimulatedHal         *pHal;         // The simulated board.
+    GenevaClockMechanics *pClock;       // The clock.
+    uint32_t seed;                      // Random number state.
+    int32_t  lastMinute;                // Last minute sent to UpdateClock().
+    uint64_t maxMinuteUs;               // Worst minute update latency.
+    uint32_t presses;                   // Button presses handled.
+    uint64_t sumButtonUs;               // Total button press latency.
+    uint64_t maxButtonUs;               // Worst button press latency.
+};
+
+static uint32_t LoopRandom(LoopSim_t &sim, uint32_t range)
+{
+    sim.seed = sim.seed * 1664525 + 1013904223;
+    return (sim.seed >> 8) % range;
+} // End LoopRandom().
+
+// Moves the clock when the minute changes.
+static void SimMinuteTask(void *pArg)
+{
+    LoopSim_t &sim = *static_cast<LoopSim_t *>(pArg);
+    uint64_t now    = sim.pHal->Micros();
+    int32_t  minute = static_cast<int32_t>(now / 60000000);
+    if (minute != sim.lastMinute)
+    {
+        sim.maxMinuteUs = std::max(sim.maxMinuteUs, static_cast<uint64_t>(now - minute * 60000000ull));
+        sim.lastMinute  = minute;
+        tm t = {};
+        t.tm_hour = (minute / 60) % 24;
+        t.tm_min  = minute % 60;
+        sim.pClock->UpdateClock(t);
+    }
+} // End SimMinuteTask().
+
+// Handles button presses, and scripts the next one.
+static void SimButtonTask(void *pArg)
+{
+    LoopSim_t &sim = *static_cast<LoopSim_t *>(pArg);
+    InputEdge_t edge;
+    bool pressed = false;
+    while (sim.pClock->NextInputEdge(edge))
+    {
+        if ((edge.pin == GenericClockBoard::PUSHBUTTON_PIN) && edge.active)
+        {
+            uint64_t latency = sim.pHal->Micros() - edge.timeUs;
+            sim.presses++;
+            sim.sumButtonUs += latency;
+            sim.maxButtonUs  = std::max(sim.maxButtonUs, latency);
+            pressed = true;
+        }
+    }
+    if (pressed)
+    {
+        sim.pHal->PressButtonAt(sim.pHal->Micros() + 200000 + LoopRandom(sim, 2000000), 30000);
+    }
+} // End SimButtonTask().
+
+// Stand-ins for the WiFi and LED work.
+static void SimWiFiTask(void *pArg)
+{
+    LoopSim_t &sim = *static_cast<LoopSim_t *>(pArg);
+    sim.pHal->DelayMicroseconds(500 + LoopRandom(sim, 5000));
+} // End SimWiFiTask().
+
+static void SimLedTask(void *pArg)
+{
+    static_cast<LoopSim_t *>(pArg)->pHal->DelayMicroseconds(200);
+} // End SimLedTask().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// BenchmarkScheduler()
+//
+// Runs the sketch's work for a simulated hour, once as the original loop()
+// (every task in sequence, then a 100 ms delay) and once with TaskScheduler
+// using the periods and priorities from setup().  The minute updates really
+// move the simulated clock, the WiFi work takes 0.5 to 5.5 ms, and a 30 ms
+// button press is scripted every 0.2 to 2.2 s.  Reports the button and minute
+// update latencies, and the time spent idle.
+/////////////////////////////////////////////////////////////////////////////////
+static void BenchmarkScheduler()
+{
+    const uint64_t RUN_US = 3600ull * 1000000;
+
+    printf("Sketch loop for 1 simulated hour\n");
+    printf("  %-10s %8s %14s %14s %16s %7s\n", "method", "presses",
+           "avg button ms", "max button ms", "max minute ms", "idle %");
+    for (uint32_t scheduled = 0; scheduled < 2; scheduled++)
+    {
+        SimulatedHal hal(true, true);
+        hal.SetHalfStepsPerRev(4075.52);
+        GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                                   USE_HALF_STEPPING, true, &hal);
+        StepTables::Install(clock.Planner());
+        clock.SetFullStepsPerRev(203776, 100);
+        clock.Home();
+
+        LoopSim_t sim = { &hal, &clock, 777, 0, 0, 0, 0, 0 };
+        hal.PressButtonAt(hal.Micros() + 500000, 30000);
+        uint64_t start  = hal.Micros();
+        uint64_t idleUs = 0;
+        if (scheduled)
+        {
+            TaskScheduler scheduler(&hal);
+            scheduler.AddTask("button", SimButtonTask, &sim,  20,   50, 7);
+            scheduler.AddTask("minute", SimMinuteTask, &sim, 250, 1000, 6);
+            scheduler.AddTask("wifi",   SimWiFiTask,   &sim,  50,  200, 4);
+            scheduler.AddTask("led",    SimLedTask,    &sim, 500,  500, 3);
+            scheduler.ResetStats();
+            while (hal.Micros() - start < RUN_US)
+            {
+                scheduler.RunOnce();
+            }
+            idleUs = scheduler.IdleUs();
+        }
+        else
+        {
+            while (hal.Micros() - start < RUN_US)
+            {
+                SimWiFiTask(&sim);
+                SimLedTask(&sim);
+                SimMinuteTask(&sim);
+                SimButtonTask(&sim);
+                hal.Delay(100);
+                idleUs += 100000;
+            }
+        }
+        uint64_t elapsedUs = hal.Micros() - start;
+        printf("  %-10s %8u %14.1f %14.1f %16.1f %7.1f\n",
+               scheduled ? "scheduler" : "loop()", sim.presses,
+               sim.sumButtonUs / 1000.0 / (sim.presses ? sim.presses : 1),
+               sim.maxButtonUs / 1000.0, sim.maxMinuteUs / 1000.0,
+               idleUs * 100.0 / elapsedUs);
+    }
+    printf("\n");
+} // End BenchmarkScheduler().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// HomeSim_t
+//
+// State of the simulated home task used by TestHomeLatency().
+/////////////////////////////////////////////////////////////////////////////////
+struct HomeSim_t
+{
+    GenevaClockMechanics *pClock;       // The clock.
+    bool polled;                        // True to use StartHome() / PollHome().
+    bool start;                         // True to start a home.
+};
+
+// Starts a home when asked, and advances it if it is not blocking.
+static void SimHomeTask(void *pArg)
+{
+    HomeSim_t &sim = *static_cast<HomeSim_t *>(pArg);
+    if (sim.start)
+    {
+        sim.start = false;
+        if (sim.polled)
+        {
+            sim.pClock->StartHome();
+        }
+        else
+        {
+            sim.pClock->Home();
+        }
+    }
+    sim.pClock->PollHome();
+} // End SimHomeTask().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestHomeLatency()
+//
+// Homes the clock from random dial positions, at power up and while running,
+// from a scheduler task alongside the button and WiFi tasks of
+// BenchmarkScheduler(), once with the blocking Home() and once with
+// StartHome() / PollHome().  Reports the home time, the worst button latency,
+// and the longest single task run, which is how long loop() was blocked.
+//
+// Returns:
+//   Returns 'true' if a polled home blocked loop() for more than
+//   HOME_LATENCY_TARGET_MS.
+/////////////////////////////////////////////////////////////////////////////////
+static bool TestHomeLatency()
+{
+    const uint32_t SAMPLES                = 20;
+    const uint32_t HOME_LATENCY_TARGET_MS = 50;
+    bool failed = false;
+
+    printf("Scheduled homes from %u random dial positions (target %u ms)\n",
+           SAMPLES, HOME_LATENCY_TARGET_MS);
+    printf("  %-10s %-10s %10s %10s %15s %15s %6s\n", "start", "method", "average s",
+           "worst s", "max button ms", "max blocked ms", "");
+    for (uint32_t known = 0; known < 2; known++)
+    {
+        for (uint32_t polled = 0; polled < 2; polled++)
+        {
+            uint32_t seed      = 24680;
+            double   totalUs   = 0.0;
+            uint64_t worstUs   = 0;
+            uint32_t maxButton = 0;
+            uint32_t maxRun    = 0;
+            for (uint32_t n = 0; n < SAMPLES; n++)
+            {
+                seed = seed * 1664525 + 1013904223;
+                int32_t minutes = (seed >> 8) % 720;
+
+                SimulatedHal hal(true, true);
+                hal.SetHalfStepsPerRev(4075.52);
+                hal.SetBacklash(8.0);
+                if (!known)
+                {
+                    hal.SetDialMinutes(minutes + 0.5);
+                }
+                GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                                           USE_HALF_STEPPING, true, &hal);
+                StepTables::Install(clock.Planner());
+                clock.SetFullStepsPerRev(203776, 100);
+                if (known)
+                {
+                    clock.Home();
+                    tm now = {};
+                    now.tm_hour = minutes / 60;
+                    now.tm_min  = minutes % 60;
+                    clock.UpdateClock(now);
+                }
+
+                LoopSim_t sim  = { &hal, &clock, seed, 0, 0, 0, 0, 0 };
+                HomeSim_t home = { &clock, polled != 0, true };
+                hal.PressButtonAt(hal.Micros() + 100000, 30000);
+                TaskScheduler scheduler(&hal);
+                int32_t button = scheduler.AddTask("button", SimButtonTask, &sim,  20,  50, 7);
+                int32_t homing = scheduler.AddTask("home",   SimHomeTask,   &home, 10, 100, 5);
+                scheduler.AddTask("wifi", SimWiFiTask, &sim, 50, 200, 4);
+                uint64_t start = hal.Micros();
+                while (home.start || clock.IsHoming())
+                {
+                    scheduler.RunOnce();
+                }
+                uint64_t us = hal.Micros() - start;
+                totalUs += us;
+                worstUs  = std::max(worstUs, us);
+
+                TaskStats_t buttonStats;
+                TaskStats_t homeStats;
+                scheduler.GetStats(button, buttonStats);
+                scheduler.GetStats(homing, homeStats);
+                maxButton = std::max(maxButton, buttonStats.maxLatencyUs);
+                maxRun    = std::max(maxRun, homeStats.maxRunUs);
+                if (clock.HomeStatus() != StatusSuccess)
+                {
+                    failed = true;
+                }
+            }
+            bool pass = (maxRun <= HOME_LATENCY_TARGET_MS * 1000);
+            if (polled && !pass)
+            {
+                failed = true;
+            }
+            printf("  %-10s %-10s %10.1f %10.1f %15.1f %15.1f %6s\n",
+                   known ? "running" : "power up", polled ? "polled" : "blocking",
+                   totalUs / SAMPLES / 1.0e6, worstUs / 1.0e6, maxButton / 1000.0,
+                   maxRun / 1000.0, polled ? (pass ? "pass" : "FAIL") : "");
+        }
+    }
+    printf("\n");
+    return failed;
+} // End TestHomeLatency().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestSpscRing()
+//
+// Stress tests SpscRing with a producer thread pushing numbered items as fast
+// as it can into a small ring, and the main thread popping them, then checks
+// that every item arrived exactly once, in order, and intact.  A full ring
+// makes the producer retry, so every refused push is counted as dropped but
+// nothing should actually be lost.
+// Also checks the full and empty behaviour single threaded.
+//
+// Returns:
+//    Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+struct RingItem_t
+{
+    uint32_t sequence;      // 0, 1, 2, ...
+    uint32_t check;         // Derived from sequence, to detect torn items.
+    uint64_t payload;       // Derived from sequence, to detect torn items.
+};
+
+static void RingProducer(SpscRing<RingItem_t, 16> *pRing, uint32_t count, uint64_t *pFull)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        RingItem_t item = { i, ~i, static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ull };
+        while (!pRing->Push(item))
+        {
+            (*pFull)++;
+            std::this_thread::yield();
+        }
+    }
+} // End RingProducer().
+
+static uint32_t TestSpscRing()
+{
+    const uint32_t ITEMS = 2000000;
+    uint32_t errors = 0;
+
+    // Single threaded: a full ring refuses and counts the extra item, and an
+    // empty ring returns nothing.
+    static SpscRing<RingItem_t, 16> edgeRing;
+    RingItem_t item = { 0, 0, 0 };
+    uint32_t   pushed = 0;
+    while (edgeRing.Push(item))
+    {
+        pushed++;
+    }
+    errors += (pushed != 16) || (edgeRing.Count() != 16) || (edgeRing.Dropped() != 1);
+    while (edgeRing.Pop(item))
+    {
+        pushed--;
+    }
+    errors += (pushed != 0) || (edgeRing.Count() != 0) || edgeRing.Pop(item);
+
+    // Two threads.
+    static SpscRing<RingItem_t, 16> ring;
+    uint64_t full  = 0;
+    uint64_t empty = 0;
+    uint32_t next  = 0;
+    uint64_t start = NowNs();
+    std::thread producer(RingProducer, &ring, ITEMS, &full);
+    while (next < ITEMS)
+    {
+        if (!ring.Pop(item))
+        {
+            empty++;
+            std::this_thread::yield();
+            continue;
+        }
+        if ((item.sequence != next) || (item.check != ~next) ||
+            (item.payload != static_cast<uint64_t>(next) * 0x9E3779B97F4A7C15ull))
+        {
+            errors++;
+            next = item.sequence;
+        }
+        next++;
+    }
+    producer.join();
+    double seconds = (NowNs() - start) / 1.0e9;
+    errors += ring.Pop(item) || (ring.Dropped() != full);
+
+    printf("SpscRing stress test, 16 slots, producer and consumer threads\n");
+    printf("  %10s %8s %12s %12s %10s   %s\n", "items", "errors", "full spins",
+           "empty spins", "Mitems/s", "result");
+    printf("  %10u %8u %12llu %12llu %10.1f   %s\n\n", ITEMS, errors,
+           static_cast<unsigned long long>(full), static_cast<unsigned long long>(empty),
+           ITEMS / seconds / 1.0e6, errors ? "FAIL" : "pass");
+    return errors;
+} // End TestSpscRing().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestSeqLock()
+//
+// Stress tests SeqLock with a writer thread publishing numbered snapshots as
+// fast as it can, while the main thread reads them, and checks that every
+// snapshot read is intact (not torn between two publishes) and that the
+// snapshots never go backward.  Until the first publish, the snapshot is all
+// zero.
+// A single CPU host rarely interleaves the threads finely enough to tear a
+// read, so the retry is also checked deterministically: a read hook
+// publishes a new snapshot after Read() has copied each word in turn, and
+// every such read must return the new snapshot intact.
+//
+// Returns:
+//    Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+struct SnapshotItem_t
+{
+    uint32_t sequence;      // 1, 2, 3, ...
+    uint32_t check;         // Derived from sequence, to detect torn reads.
+    uint64_t payload;       // Derived from sequence, to detect torn reads.
+    uint32_t last;          // Derived from sequence, to detect torn reads.
+};
+
+static SnapshotItem_t MakeSnapshot(uint32_t i)
+{
+    SnapshotItem_t item = { i, ~i, static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ull, i * 7 };
+    return item;
+} // End MakeSnapshot().
+
+static void SnapshotWriter(SeqLock<SnapshotItem_t> *pLock, uint32_t count)
+{
+    for (uint32_t i = 1; i <= count; i++)
+    {
+        pLock->Publish(MakeSnapshot(i));
+        if ((i & 0xFF) == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+} // End SnapshotWriter().
+
+// Publishes snapshot 'publish' once Read() has copied word 'atWord'.
+struct MidReadPublish_t
+{
+    SeqLock<SnapshotItem_t> *pLock;     // The lock being read.
+    uint32_t atWord;                    // Word to publish after.
+    uint32_t publish;                   // Snapshot to publish, or 0 once done.
+};
+
+static void PublishMidRead(void *pArg, uint32_t word)
+{
+    MidReadPublish_t &mid = *static_cast<MidReadPublish_t *>(pArg);
+    if (mid.publish && (word == mid.atWord))
+    {
+        mid.pLock->Publish(MakeSnapshot(mid.publish));
+        mid.publish = 0;
+    }
+} // End PublishMidRead().
+
+static uint32_t TestSeqLock()
+{
+    const uint32_t SNAPSHOTS = 2000000;
+    uint32_t errors = 0;
+
+    static SeqLock<SnapshotItem_t> lock;
+    uint64_t reads   = 0;
+    uint32_t last    = 0;
+    uint32_t changes = 0;
+    uint64_t start   = NowNs();
+    std::thread writer(SnapshotWriter, &lock, SNAPSHOTS);
+    while (last < SNAPSHOTS)
+    {
+        SnapshotItem_t item = lock.Read();
+        reads++;
+        uint32_t i = item.sequence;
+        if ((i < last) || ((i != 0) &&
+            ((item.check != ~i) || (item.last != i * 7) ||
+             (item.payload != static_cast<uint64_t>(i) * 0x9E3779B97F4A7C15ull))))
+        {
+            errors++;
+        }
+        changes += (i != last);
+        last = i;
+        if ((reads & 0x3F) == 0)
+        {
+            std::this_thread::yield();
+        }
+    }
+    writer.join();
+    double seconds = (NowNs() - start) / 1.0e9;
+    errors += (lock.Sequence() != 2 * SNAPSHOTS);
+
+    // Publish after each word of a read in turn.
+    const uint32_t WORDS = (sizeof(SnapshotItem_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+    static SeqLock<SnapshotItem_t> hooked;
+    uint32_t midErrors = 0;
+    hooked.Publish(MakeSnapshot(1));
+    for (uint32_t w = 0; w < WORDS; w++)
+    {
+        MidReadPublish_t mid = { &hooked, w, w + 2 };
+        hooked.SetReadHook(PublishMidRead, &mid);
+        SnapshotItem_t item = hooked.Read();
+        SnapshotItem_t want = MakeSnapshot(w + 2);
+        midErrors += (mid.publish != 0) || (item.sequence != want.sequence) ||
+                     (item.check != want.check) || (item.payload != want.payload) ||
+                     (item.last != want.last);
+    }
+    hooked.SetReadHook(NULL, NULL);
+    errors += midErrors;
+
+    printf("SeqLock stress test, writer and reader threads\n");
+    printf("  %10s %8s %12s %12s %10s %11s   %s\n", "snapshots", "errors", "reads",
+           "new seen", "Mreads/s", "mid-read", "result");
+    printf("  %10u %8u %12llu %12u %10.1f %5u torn   %s\n\n", SNAPSHOTS, errors,
+           static_cast<unsigned long long>(reads), changes, reads / seconds / 1.0e6,
+           midErrors, errors ? "FAIL" : "pass");
+    return errors;
+} // End TestSeqLock().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestMotionTask()
+//
+// Runs a MotionTask, driving a simulated clock, in a thread of its own, while
+// the main thread sends it random moves as fast as the queue takes them and
+// reads its status.  Every status read must show the position reached by
+// exactly the number of moves it says have run, and the moves must all run,
+// in order, with none lost.
+//
+// Returns:
+//    Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+static void MotionThread(MotionTask *pMotion, std::atomic<bool> *pStop)
+{
+    while (!pStop->load())
+    {
+        if (!pMotion->Poll())
+        {
+            std::this_thread::yield();
+        }
+    }
+    pMotion->Poll();
+} // End MotionThread().
+
+static uint32_t TestMotionTask()
+{
+    const uint32_t MOVES = 5000;
+    uint32_t errors = 0;
+
+    SimulatedHal hal(true, true);
+    GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                               USE_HALF_STEPPING, true, &hal);
+    MotionTask motion(clock);
+    motion.Begin();
+
+    // expected[n] is the position after n moves.
+    std::vector<int64_t> expected(MOVES + 1);
+    expected[0] = motion.Status().stepPosition;
+    uint32_t seed = 13579;
+    for (uint32_t n = 0; n < MOVES; n++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        int32_t steps = static_cast<int32_t>((seed >> 8) % 41) - 20;
+        expected[n + 1] = expected[n] + steps;
+    }
+
+    std::atomic<bool> stop(false);
+    uint64_t reads = 0;
+    uint64_t full  = 0;
+    uint32_t lastRun = 0;
+    uint64_t start = NowNs();
+    std::thread motionThread(MotionThread, &motion, &stop);
+    for (uint32_t n = 0; (n < MOVES) || (lastRun < MOVES); )
+    {
+        if (n < MOVES)
+        {
+            if (motion.Step(static_cast<int32_t>(expected[n + 1] - expected[n]), StepFast))
+            {
+                n++;
+            }
+            else
+            {
+                full++;
+                std::this_thread::yield();
+            }
+        }
+        MotionStatus_t status = motion.Status();
+        reads++;
+        if ((status.commandsRun < lastRun) || (status.commandsRun > n) ||
+            (status.stepPosition != expected[status.commandsRun]))
+        {
+            errors++;
+        }
+        lastRun = status.commandsRun;
+    }
+    stop.store(true);
+    motionThread.join();
+    double seconds = (NowNs() - start) / 1.0e9;
+    errors += (motion.CommandsDropped() != full) ||
+              (clock.StepPosition() != expected[MOVES]);
+
+    printf("MotionTask test, motion and sender threads\n");
+    printf("  %10s %8s %12s %12s %10s   %s\n", "moves", "errors", "queue full",
+           "status reads", "moves/s", "result");
+    printf("  %10u %8u %12llu %12llu %10.0f   %s\n\n", MOVES, errors,
+           static_cast<unsigned long long>(full), static_cast<unsigned long long>(reads),
+           MOVES / seconds, errors ? "FAIL" : "pass");
+    return errors;
+} // End TestMotionTask().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// BenchmarkCoilPower()
+//
+// Runs the clock for a simulated day of minute updates, starting with a home,
+// once with each coil policy.  Reports the average coil current each policy
+// drew, and what the first (CoilRelease) run's coil accounting estimated it
+// would draw.
+/////////////////////////////////////////////////////////////////////////////////
+static void BenchmarkCoilPower()
+{
+    const CoilPolicy_t POLICIES[] = { CoilRelease, CoilHoldFull, CoilHoldReduced };
+    const char *POLICY_NAMES[]    = { "release", "full hold", "reduced hold" };
+    const uint32_t NUM_POLICIES   = sizeof(POLICIES) / sizeof(POLICIES[0]);
+    const uint32_t HOLD_DUTY      = 30;
+    const uint32_t SETTLE_MS      = 20;
+    const int32_t  MINUTES        = 24 * 60;
+
+    printf("Coil power, one simulated day of minute updates, %u mA per coil\n",
+           GenericClockBoard::COIL_CURRENT_MA);
+    printf("  %-13s %12s %12s %10s %12s %8s\n", "policy", "moving s", "idle s",
+           "avg mA", "estimate mA", "held");
+    CoilStats_t releaseStats;
+    for (uint32_t i = 0; i < NUM_POLICIES; i++)
+    {
+        SimulatedHal hal(true, true);
+        hal.SetDialMinutes(200.0);
+        GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                                   USE_HALF_STEPPING, true, &hal);
+        clock.SetCoilPolicy(POLICIES[i], HOLD_DUTY, SETTLE_MS);
+        clock.Home();
+        clock.ResetCoilStats();
+
+        // Count how many minutes the phase is held by PWM between updates.
+        uint32_t held = 0;
+        for (int32_t m = 0; m < MINUTES; m++)
+        {
+            uint64_t start = hal.Micros();
+            struct tm now = {};
+            now.tm_hour = (m / 60) % 24;
+            now.tm_min  = m % 60;
+            clock.UpdateClock(now);
+            held += (hal.HeldPins() != 0);
+            hal.Delay(static_cast<uint32_t>((start + 60000000 - hal.Micros()) / 1000));
+        }
+
+        CoilStats_t stats;
+        clock.GetCoilStats(stats);
+        if (i == 0)
+        {
+            releaseStats = stats;
+        }
+        printf("  %-13s %12.1f %12.1f %10.3f %12.3f %8u\n", POLICY_NAMES[i],
+               stats.movingCoilUs / 1.0e6, stats.idleCoilUs / 1.0e6,
+               clock.EstimateCoilMa(POLICIES[i], stats),
+               clock.EstimateCoilMa(POLICIES[i], releaseStats), held);
+    }
+    printf("  (coil seconds, summed over the energized coils; held is minutes\n"
+           "   spent holding with PWM)\n\n");
+} // End BenchmarkCoilPower().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// BenchmarkMicrostepping()
+//
+// Runs the clock for 12 simulated hours of minute updates, after a home, with
+// half stepping and with 8, 16, and 32 microsteps per full step.  Reports the
+// dial resolution, the largest dial error after an update, the steps the
+// simulated motor missed, how long a two rev StepAuto move takes, and the
+// host CPU time per step callback.
+/////////////////////////////////////////////////////////////////////////////////
+static void BenchmarkMicrostepping()
+{
+    const uint32_t MODES[]   = { 0, 8, 16, 32 };
+    const uint32_t NUM_MODES = sizeof(MODES) / sizeof(MODES[0]);
+    const int32_t  MINUTES   = 12 * 60;
+
+    printf("Microstepping, 12 simulated hours of minute updates\n");
+    printf("  %-8s %10s %12s %12s %7s %10s %10s %8s\n", "mode", "steps/12h",
+           "res minutes", "max err min", "missed", "2 rev s", "steps", "ns/step");
+    for (uint32_t i = 0; i < NUM_MODES; i++)
+    {
+        SimulatedHal hal(true, true);
+        hal.SetDialMinutes(200.0);
+        GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                                   USE_HALF_STEPPING, true, &hal);
+        if (MODES[i])
+        {
+            clock.SetMicrostepping(MODES[i]);
+        }
+        clock.Home();
+
+        RunStats_t stats = {};
+        uint64_t startNs  = NowNs();
+        int64_t  startPos = clock.StepPosition();
+        RunMinutes(hal, clock, 0, MINUTES - 1, false, stats);
+        int64_t  steps = clock.StepPosition() - startPos;
+        uint64_t ns    = NowNs() - startNs;
+
+        int32_t  revSteps = 2 * FULL_STEPS_PER_REV * clock.StepsPerFullStep();
+        uint64_t moveUs   = hal.Micros();
+        clock.Step(revSteps, StepAuto);
+        moveUs = hal.Micros() - moveUs;
+
+        char mode[16];
+        snprintf(mode, sizeof(mode), MODES[i] ? "%u micro" : "half", MODES[i]);
+        printf("  %-8s %10.0f %12.5f %12.5f %7u %10.2f %10lld %8.0f\n", mode,
+               clock.StepsPerCycle(), 720.0 / clock.StepsPerCycle(), fabs(stats.maxError),
+               hal.MissedSteps(), moveUs / 1.0e6, static_cast<long long>(steps),
+               steps ? static_cast<double>(ns) / steps : 0.0);
+    }
+    printf("  (ns/step is host time for the minute updates, including the simulator)\n\n");
+} // End BenchmarkMicrostepping().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Scenario suite.
+//
+// Each scenario replays a script of calls on a freshly homed clock, with the
+// motor's actual gear ratio and some backlash, and totals what the calls cost.
+// Everything except the host CPU time runs in virtual time, so the results
+// are the same on every run and the whole suite runs in a fraction of a
+// second.
+/////////////////////////////////////////////////////////////////////////////////
+struct ScenarioStats_t
+{
+    uint32_t calls;             // Calls made.
+    uint64_t motorUs;           // Virtual time spent in the calls.
+    uint64_t maxBlockUs;        // Longest a single call blocked (virtual).
+    uint64_t steps;             // Half steps the motor moved.
+    uint32_t reversals;         // Motor direction reversals.
+    uint32_t holds;             // Updates that held the dial ahead.
+    uint64_t cpuNs;             // Host CPU time spent in the calls.
+    uint64_t maxCpuNs;          // Most host CPU time for a single call.
+    double   maxError;          // Largest dial error after a call, in minutes.
+    uint32_t missed;            // Steps the motor missed.
+    uint32_t failures;          // Homes that did not succeed.
+};
+
+// Scripted calls.
+enum ScenarioCall_t
+{
+    CallUpdate,                 // UpdateClock() to the scripted time.
+    CallHome,                   // Home().
+    CallCalibrate               // Calibrate(), ended by a button press.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// RunScenarioCall()
+//
+// Makes one call and adds its costs to 'stats'.  After an update the dial is
+// checked against 'minutes' (minutes past 00:00), and after a home against
+// 12:00.
+/////////////////////////////////////////////////////////////////////////////////
+static void RunScenarioCall(SimulatedHal &hal, GenevaClockMechanics &clock,
+                            ScenarioCall_t call, int32_t minutes, ScenarioStats_t &stats)
+{
+    uint64_t startUs  = hal.Micros();
+    uint64_t startNs  = NowNs();
+    switch (call)
+    {
+    case CallUpdate:
+    {
+        // A hold leaves the dial ahead on purpose.
+        PathStats_t before;
+        PathStats_t after;
+        clock.GetPathStats(before);
+        struct tm now = {};
+        now.tm_hour = (minutes / 60) % 24;
+        now.tm_min  = minutes % 60;
+        clock.UpdateClock(now);
+        clock.GetPathStats(after);
+        if (after.holds != before.holds)
+        {
+            stats.holds++;
+            minutes += clock.LastPath().aheadMinutes;
+        }
+        break;
+    }
+    case CallHome:
+        stats.failures += (clock.Home() != StatusSuccess);
+        minutes = 0;
+        break;
+    case CallCalibrate:
+        hal.PressButtonAt(startUs + 60000000, 600000000);
+        clock.Calibrate();
+        break;
+    }
+    uint64_t ns = NowNs() - startNs;
+    uint64_t us = hal.Micros() - startUs;
+
+    stats.calls++;
+    stats.motorUs   += us;
+    stats.maxBlockUs = std::max(stats.maxBlockUs, us);
+    stats.cpuNs     += ns;
+    stats.maxCpuNs   = std::max(stats.maxCpuNs, ns);
+    if (call != CallCalibrate)
+    {
+        double err = DialError(hal, minutes);
+        if (fabs(err) > fabs(stats.maxError))
+        {
+            stats.maxError = err;
+        }
+    }
+} // End RunScenarioCall().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetUpScenarioHal(), SetUpScenarioClock()
+//
+// Give the simulated motor its actual gear ratio and some backlash, and tell
+// the clock the actual ratio.
+/////////////////////////////////////////////////////////////////////////////////
+static void SetUpScenarioHal(SimulatedHal &hal)
+{
+    hal.SetHalfStepsPerRev(4075.52);
+    hal.SetBacklash(8.0);
+} // End SetUpScenarioHal().
+
+static void SetUpScenarioClock(GenevaClockMechanics &clock)
+{
+    StepTables::Install(clock.Planner());
+    clock.SetFullStepsPerRev(203776, 100);
+} // End SetUpScenarioClock().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// AddMotorStats()
+//
+// Adds the motor's steps, reversals, and missed steps since 'startSteps' and
+// 'startReversals' to 'stats'.
+/////////////////////////////////////////////////////////////////////////////////
+static void AddMotorStats(const SimulatedHal &hal, uint64_t startSteps,
+                          uint32_t startReversals, ScenarioStats_t &stats)
+{
+    stats.steps     += hal.MotorSteps() - startSteps;
+    stats.reversals += hal.Reversals() - startReversals;
+    stats.missed    += hal.MissedSteps();
+} // End AddMotorStats().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ReportScenario()
+//
+// Prints a scenario's statistics.  Returns the number of errors found: missed
+// steps, failed homes, or a dial more than a minute off.
+/////////////////////////////////////////////////////////////////////////////////
+static uint32_t ReportScenario(const char *pName, const ScenarioStats_t &stats)
+{
+    uint32_t errors = stats.missed + stats.failures + (fabs(stats.maxError) > 1.0);
+    printf("  %-11s %6u %9.1f %9.2f %9llu %5u %5u %10.2f %10.1f %9.3f   %s\n", pName,
+           stats.calls, stats.motorUs / 1.0e6, stats.maxBlockUs / 1.0e6,
+           static_cast<unsigned long long>(stats.steps), stats.reversals, stats.holds,
+           stats.cpuNs / 1.0e3 / stats.calls, stats.maxCpuNs / 1.0e3, stats.maxError,
+           errors ? "FAIL" : "pass");
+    return errors;
+} // End ReportScenario().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// RunScript()
+//
+// Homes a clock, sets it to minute 'startMinutes', then replays 'count'
+// scripted calls and reports them.  Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+static uint32_t RunScript(const char *pName, const ScenarioCall_t *pCalls,
+                          const int32_t *pMinutes, uint32_t count, int32_t startMinutes)
+{
+    SimulatedHal hal(true, true);
+    SetUpScenarioHal(hal);
+    GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                               USE_HALF_STEPPING, true, &hal);
+    SetUpScenarioClock(clock);
+    ScenarioStats_t setUp = {};
+    RunScenarioCall(hal, clock, CallHome, 0, setUp);
+    RunScenarioCall(hal, clock, CallUpdate, startMinutes, setUp);
+
+    ScenarioStats_t stats = {};
+    uint64_t startSteps     = hal.MotorSteps();
+    uint32_t startReversals = hal.Reversals();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        RunScenarioCall(hal, clock, pCalls[i], pMinutes[i], stats);
+    }
+    AddMotorStats(hal, startSteps, startReversals, stats);
+    return ReportScenario(pName, stats);
+} // End RunScript().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestScenarios()
+//
+// Runs the scenario suite:
+//   - day       - A full day of minute updates from 00:00.
+//   - dst fwd   - Minute updates from 01:00 to 04:00, with the clock jumping
+//                 from 01:59 to 03:00 as daylight saving time starts.
+//   - dst back  - Minute updates from 01:00 to 03:00, with 01:00 to 01:59
+//                 repeated as daylight saving time ends.
+//   - ntp       - Minute updates from 10:00 to 11:00, with NTP corrections
+//                 of +/-1, 2, 5, 15, and 30 minutes along the way.
+//   - power on  - Home() from 8 random dial positions at power up.
+//   - calibrate - Calibrate(), ended by a button press after a minute.
+//
+// Returns:
+//    Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+static uint32_t TestScenarios()
+{
+    const uint32_t POWER_ONS = 8;
+
+    printf("Scenario suite (virtual time, gear ratio error and backlash)\n");
+    printf("  %-11s %6s %9s %9s %9s %5s %5s %10s %10s %9s\n", "scenario", "calls",
+           "motor s", "max blk s", "steps", "revs", "holds", "avg cpu us", "max cpu us",
+           "max err");
+    uint32_t errors = 0;
+    std::vector<ScenarioCall_t> calls;
+    std::vector<int32_t> minutes;
+
+    for (int32_t m = 1; m <= 24 * 60; m++)
+    {
+        calls.push_back(CallUpdate);
+        minutes.push_back(m);
+    }
+    errors += RunScript("day", &calls[0], &minutes[0], calls.size(), 0);
+
+    minutes.clear();
+    for (int32_t m = 61; m <= 4 * 60; m++)
+    {
+        if ((m < 120) || (m >= 180))
+        {
+            minutes.push_back(m);
+        }
+    }
+    errors += RunScript("dst fwd", &calls[0], &minutes[0], minutes.size(), 60);
+
+    minutes.clear();
+    for (int32_t m = 61; m <= 3 * 60; m++)
+    {
+        minutes.push_back(m);
+        if (m == 119)
+        {
+            for (int32_t r = 60; r < 120; r++)
+            {
+                minutes.push_back(r);
+            }
+        }
+    }
+    errors += RunScript("dst back", &calls[0], &minutes[0], minutes.size(), 60);
+
+    // Each correction is applied at the start of its minute.
+    const int32_t CORRECTIONS[] = { 1, -1, 2, -2, 5, -5, 15, -15, 30, -30 };
+    minutes.clear();
+    int32_t offset = 0;
+    for (int32_t m = 601; m <= 660; m++)
+    {
+        uint32_t c = (m - 601) / 5;
+        if (((m - 601) % 5 == 0) && (c < sizeof(CORRECTIONS) / sizeof(CORRECTIONS[0])))
+        {
+            offset += CORRECTIONS[c];
+        }
+        minutes.push_back(m + offset);
+    }
+    errors += RunScript("ntp", &calls[0], &minutes[0], minutes.size(), 600);
+
+    ScenarioStats_t stats = {};
+    uint32_t seed = 24680;
+    for (uint32_t n = 0; n < POWER_ONS; n++)
+    {
+        seed = seed * 1664525 + 1013904223;
+        SimulatedHal hal(true, true);
+        SetUpScenarioHal(hal);
+        hal.SetDialMinutes(((seed >> 8) % 72000) / 100.0);
+        GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                                   USE_HALF_STEPPING, true, &hal);
+        SetUpScenarioClock(clock);
+        uint64_t startSteps = hal.MotorSteps();
+        RunScenarioCall(hal, clock, CallHome, 0, stats);
+        AddMotorStats(hal, startSteps, 0, stats);
+    }
+    errors += ReportScenario("power on", stats);
+
+    ScenarioCall_t calibrate = CallCalibrate;
+    int32_t        noMinutes = 0;
+    errors += RunScript("calibrate", &calibrate, &noMinutes, 1, 0);
+
+    printf("  (motor s and max blk s are virtual time spent in and blocked by the\n"
+           "   calls; revs are direction reversals; holds are updates that left\n"
+           "   the dial ahead of a small backward correction, and max err does not\n"
+           "   count the planned lead; cpu is host time per call)\n\n");
+    return errors;
+} // End TestScenarios().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestBacklash()
+//
+// Homes a clock whose motor has 8 half steps of backlash, then makes several
+// thousand random UpdateClock() moves of 1 to 10 minutes either way, with
+// holding disabled so that every backward step reverses the motor.  This is
+// done with no backlash compensation, with the actual backlash configured,
+// and with the backlash learned by Home().  Reports the backlash taken up,
+// the dial error after each move, and the error after the last one.  Fails if
+// the compensated runs are ever more than MAX_ERROR_MINUTES off.
+//
+// Returns:
+//    Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+static uint32_t TestBacklash()
+{
+    const uint32_t MOVES             = 3000;
+    const double   MAX_ERROR_MINUTES = 0.02;
+    const int32_t  MODES[]           = { 0, 8, GenevaClockMechanics::BACKLASH_AUTO };
+    const uint32_t NUM_MODES         = sizeof(MODES) / sizeof(MODES[0]);
+    uint32_t errors = 0;
+
+    printf("Backlash compensation, %u random moves of 1 to 10 minutes either way\n", MOVES);
+    printf("  %-6s %9s %9s %7s %12s %12s %6s\n", "comp", "take-up", "measured",
+           "revs", "max err min", "final err", "");
+    for (uint32_t i = 0; i < NUM_MODES; i++)
+    {
+        SimulatedHal hal(true, true);
+        SetUpScenarioHal(hal);
+        hal.SetDialMinutes(300.0);
+        GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                                   USE_HALF_STEPPING, true, &hal);
+        SetUpScenarioClock(clock);
+        clock.SetBacklashCompensation(MODES[i]);
+        clock.SetPathCosts(0, GenevaClockMechanics::DEFAULT_HOLD_COST_MS,
+                           GenevaClockMechanics::DEFAULT_REVERSAL_COST_MS);
+        errors += (clock.Home() != StatusSuccess);
+
+        uint32_t seed      = 13579;
+        int32_t  minutes   = 0;
+        double   maxError  = 0.0;
+        double   error     = 0.0;
+        uint32_t reversals = hal.Reversals();
+        for (uint32_t n = 0; n < MOVES; n++)
+        {
+            seed = seed * 1664525 + 1013904223;
+            int32_t delta = 1 + static_cast<int32_t>((seed >> 8) % 10);
+            minutes = (minutes + ((seed & 0x80000000) ? -delta : delta) + 1440) % 1440;
+            tm now = {};
+            now.tm_hour = minutes / 60;
+            now.tm_min  = minutes % 60;
+            clock.UpdateClock(now);
+            hal.Delay(10);
+            error = DialError(hal, minutes);
+            if (fabs(error) > fabs(maxError))
+            {
+                maxError = error;
+            }
+        }
+        reversals = hal.Reversals() - reversals;
+
+        bool pass = (MODES[i] == 0) || (fabs(maxError) <= MAX_ERROR_MINUTES);
+        errors += !pass + hal.MissedSteps();
+        char comp[16];
+        snprintf(comp, sizeof(comp), (MODES[i] < 0) ? "auto" : "%d", MODES[i]);
+        printf("  %-6s %9u %9.2f %7u %12.4f %12.4f %6s\n", comp, clock.BacklashSteps(),
+               clock.Backlash(), reversals, maxError, error,
+               (MODES[i] == 0) ? "" : (pass ? "pass" : "FAIL"));
+    }
+    printf("  (the simulated backlash is 8 half steps; a half step is %.4f minutes)\n\n",
+           720.0 / 65208.32);
+    return errors;
+} // End TestBacklash().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestBoot()
+//
+// Simulates power cycles.  Each boot, a clock is homed from a random dial
+// position and run for a few minutes, then powered off at a random time, and
+// powered on again up to two hours later as a new instance on the same
+// SimulatedHal, which keeps the dial, the rotor, and the storage.  This is
+// done with the storage erased (a cold boot), after an unplanned power loss
+// (an Idle position, checked by the boot probe), after SavePosition() (a
+// Shutdown position, trusted as is), and with the dial turned 30 minutes by
+// hand while the power was off (the probe fails and a full home follows).
+// Reports the virtual time from power on to showing the correct time, the
+// dial error then, the steps missed, and the storage writes per minute
+// update.  Fails if a home fails, the dial is ever more than
+// MAX_ERROR_MINUTES off, or a restored clock misses a step.  A cold boot may
+// miss one as the rotor snaps to the board's first phase, if it stopped
+// opposite it, but no more than MAX_COLD_MISSED per boot.
+//
+// Returns:
+//    Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+static uint32_t TestBoot()
+{
+    const uint32_t BOOTS             = 20;
+    const uint32_t RUN_MINUTES       = 10;
+    const double   MAX_ERROR_MINUTES = 0.05;
+    const uint32_t MAX_COLD_MISSED   = 1;
+    const char    *CASES[]           = { "cold", "idle", "shutdown", "turned" };
+    const uint32_t NUM_CASES         = sizeof(CASES) / sizeof(CASES[0]);
+    uint32_t errors = 0;
+
+    printf("Boot time, %u power cycles each, from power on to showing the time\n", BOOTS);
+    printf("  %-9s %6s %6s %9s %9s %12s %7s %11s %6s\n", "boot", "homes", "probes",
+           "avg s", "max s", "max err min", "missed", "writes/upd", "");
+    for (uint32_t c = 0; c < NUM_CASES; c++)
+    {
+        uint32_t seed     = 24680;
+        uint32_t homes    = 0;
+        uint32_t probes   = 0;
+        uint32_t failed   = 0;
+        uint32_t missed   = 0;
+        uint32_t writes   = 0;
+        uint32_t updates  = 0;
+        double   totalSec = 0.0;
+        double   maxSec   = 0.0;
+        double   maxError = 0.0;
+        for (uint32_t i = 0; i < BOOTS; i++)
+        {
+            SimulatedHal hal(true, true);
+            SetUpScenarioHal(hal);
+            seed = seed * 1664525 + 1013904223;
+            hal.SetDialMinutes((seed >> 8) % 720);
+            seed = seed * 1664525 + 1013904223;
+            int32_t minutes = static_cast<int32_t>((seed >> 8) % 1440);
+            uint32_t generation = 0;
+
+            // The run before the power is lost.
+            {
+                GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                                           USE_HALF_STEPPING, true, &hal);
+                SetUpScenarioClock(clock);
+                failed += (clock.Home() != StatusSuccess);
+                for (uint32_t n = 0; n <= RUN_MINUTES; n++)
+                {
+                    tm now = {};
+                    now.tm_hour = (minutes + n) % 1440 / 60;
+                    now.tm_min  = (minutes + n) % 60;
+                    uint32_t before = hal.StorageWrites();
+                    clock.UpdateClock(now);
+                    hal.Delay(60000);
+                    if (n > 0)
+                    {
+                        writes += hal.StorageWrites() - before;
+                        updates++;
+                    }
+                }
+                minutes += RUN_MINUTES;
+                if (c == 2)
+                {
+                    clock.SavePosition();
+                }
+                generation = clock.PositionGeneration();
+            }
+            if (c == 0)
+            {
+                hal.ClearStorage();
+            }
+            else if (c == 3)
+            {
+                hal.SetDialMinutes(hal.DialMinutes() + 30.0);
+            }
+
+            // Power on again, up to two hours later.
+            seed = seed * 1664525 + 1013904223;
+            minutes = (minutes + 1 + static_cast<int32_t>((seed >> 8) % 120)) % 1440;
+            uint64_t startUs = hal.Micros();
+            {
+                GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                                           USE_HALF_STEPPING, true, &hal);
+                SetUpScenarioClock(clock);
+                clock.LoadCalibration();
+                bool restored = clock.RestorePosition();
+                failed += (restored == (c == 0));
+                failed += restored && (clock.PositionGeneration() != generation);
+                if (clock.HomeRequired())
+                {
+                    homes++;
+                    probes += restored;
+                    failed += (clock.Home() != StatusSuccess);
+                }
+                tm now = {};
+                now.tm_hour = minutes / 60;
+                now.tm_min  = minutes % 60;
+                clock.UpdateClock(now);
+                clock.WaitForMove();
+            }
+            double seconds = (hal.Micros() - startUs) / 1.0e6;
+            double error   = DialError(hal, minutes);
+            totalSec += seconds;
+            maxSec    = (seconds > maxSec) ? seconds : maxSec;
+            maxError  = (fabs(error) > fabs(maxError)) ? error : maxError;
+            missed   += hal.MissedSteps();
+            failed   += (hal.MissedSteps() > ((c == 0) ? MAX_COLD_MISSED : 0));
+        }
+
+        bool pass = !failed && (fabs(maxError) <= MAX_ERROR_MINUTES);
+        errors += !pass;
+        printf("  %-9s %6u %6u %9.2f %9.2f %12.4f %7u %11.2f %6s\n", CASES[c], homes,
+               probes, totalSec / BOOTS, maxSec, maxError, missed,
+               static_cast<double>(writes) / updates, pass ? "pass" : "FAIL");
+    }
+    printf("  (virtual seconds; probes are homes that started from a restored\n"
+           "   position; the sketch may also wait for the network)\n\n");
+    return errors;
+} // End TestBoot().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestLedAnimator()
+//
+// Plays the sketch's LED animations on a stand-in RGBLed in virtual time:
+// the power up test of six 750 ms fades, a 3 blink error report for 10
+// repeats, and a breathe.  Each is ticked every 20 ms, as the sketch's LED
+// task does, and again every 7 ms.  Checks that the fades take 4.5 s however
+// often they are ticked, that the error blinks the right number of times with
+// the right on time, and reports the LED writes and the host CPU time per
+// tick.  The fades end on the first tick at or after 4.5 s.  RGBLed's own
+// fades would have blocked the caller for the whole 4.5 s.
+//
+// Returns:
+//    Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+static uint32_t TestLedAnimator()
+{
+    const uint32_t TICKS[]   = { 20, 7 };
+    const uint32_t NUM_TICKS = sizeof(TICKS) / sizeof(TICKS[0]);
+    const uint32_t CPU_TICKS = 10000000;
+    uint32_t errors = 0;
+
+    printf("LED animator, virtual time\n");
+    printf("  %-10s %7s %10s %8s %8s %10s %6s\n", "animation", "tick ms", "length ms",
+           "blinks", "writes", "ns/tick", "");
+    for (uint32_t i = 0; i < NUM_TICKS; i++)
+    {
+        // The power up fades.  Run till idle.
+        RGBLed led(0, 0, 0, false);
+        LedAnimator animator(led);
+        int *pColors[] = { RGBLed::BLUE, RGBLed::GREEN, RGBLed::RED };
+        for (uint32_t c = 0; c < 3; c++)
+        {
+            LedAnimation_t fadeIn  = { LedFadeIn,  pColors[c], 100, 750, 0, 1, 0, 0 };
+            LedAnimation_t fadeOut = { LedFadeOut, pColors[c], 100, 750, 0, 1, 0, 0 };
+            animator.Queue(fadeIn);
+            animator.Queue(fadeOut);
+        }
+        animator.SetBackground(RGBLed::WHITE, 2);
+        uint32_t nowMs = 1000;
+        uint32_t peak  = 0;
+        uint64_t startNs = NowNs();
+        uint32_t ticks = 0;
+        for (; !animator.IsIdle() && (nowMs < 20000); nowMs += TICKS[i], ticks++)
+        {
+            animator.Tick(nowMs);
+            peak = (animator.Brightness() > peak) ? animator.Brightness() : peak;
+        }
+        double   ns     = static_cast<double>(NowNs() - startNs) / ticks;
+        uint32_t length = nowMs - TICKS[i] - 1000;
+        bool pass = (length >= 4500) && (length < 4500 + TICKS[i]) && (peak >= 97) &&
+                    (animator.Color() == RGBLed::WHITE);
+        errors += !pass;
+        printf("  %-10s %7u %10u %8s %8u %10.1f %6s\n", "power up", TICKS[i], length, "",
+               animator.Writes(), ns, pass ? "pass" : "FAIL");
+
+        // A 3 blink error, repeated.  Count the blinks and their on times.
+        LedAnimation_t error = { LedFlash, RGBLed::RED, 100, 150, 200, 0, 3, 2000 };
+        animator.Play(error);
+        uint32_t writes  = animator.Writes();
+        uint32_t blinks  = 0;
+        uint32_t onMs    = 0;
+        bool     wasOn   = false;
+        uint32_t startMs = nowMs;
+        startNs = NowNs();
+        ticks   = 0;
+        for (; nowMs < startMs + 10 * 3050; nowMs += TICKS[i], ticks++)
+        {
+            animator.Tick(nowMs);
+            bool on = (animator.Brightness() > 0);
+            blinks += (on && !wasOn);
+            onMs   += on ? TICKS[i] : 0;
+            wasOn   = on;
+        }
+        ns   = static_cast<double>(NowNs() - startNs) / ticks;
+        pass = (blinks == 30) && (fabs(onMs / 30.0 - 150.0) <= TICKS[i]);
+        errors += !pass;
+        printf("  %-10s %7u %10u %8u %8u %10.1f %6s\n", "error x3", TICKS[i],
+               nowMs - startMs, blinks, animator.Writes() - writes, ns,
+               pass ? "pass" : "FAIL");
+    }
+
+    // The CPU time of a tick that changes the level, and one that doesn't.
+    RGBLed led(0, 0, 0, false);
+    LedAnimator animator(led);
+    LedAnimation_t breathe = { LedBreathe, RGBLed::CYAN, 100, 1000, 1000, 0, 0, 0 };
+    animator.Play(breathe);
+    uint64_t startNs = NowNs();
+    for (uint32_t n = 0; n < CPU_TICKS; n++)
+    {
+        animator.Tick(n);
+    }
+    double breatheNs = static_cast<double>(NowNs() - startNs) / CPU_TICKS;
+    uint32_t writes = animator.Writes();
+    LedAnimation_t solid = { LedSolid, RGBLed::CYAN, 2, 0, 0, 0, 0, 0 };
+    animator.Play(solid);
+    startNs = NowNs();
+    for (uint32_t n = 0; n < CPU_TICKS; n++)
+    {
+        animator.Tick(n);
+    }
+    double solidNs = static_cast<double>(NowNs() - startNs) / CPU_TICKS;
+    printf("  breathe every 1 ms: %.1f ns/tick, %u writes in %u ticks; solid: %.1f ns/tick\n",
+           breatheNs, writes, CPU_TICKS, solidNs);
+    printf("  (the stand-in RGBLed writes cost nothing; on the ESP32 each write is\n"
+           "   three LEDC duty updates, so only ticks that change the level cost more)\n\n");
+    return errors;
+} // End TestLedAnimator().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TickCompositor()
+//
+// Ticks 'compositor' every 'tickMs' from 'nowMs' up to 'endMs', and returns
+// the time 'layer' was on top.  'nowMs' is left at 'endMs'.
+/////////////////////////////////////////////////////////////////////////////////
+static uint32_t TickCompositor(LedCompositor &compositor, uint32_t &nowMs, uint32_t endMs,
+                               uint32_t tickMs, uint32_t layer)
+{
+    uint32_t visibleMs = 0;
+    for (; nowMs < endMs; nowMs += tickMs)
+    {
+        compositor.Tick(nowMs);
+        visibleMs += (compositor.TopLayer() == layer) ? tickMs : 0;
+    }
+    return visibleMs;
+} // End TickCompositor().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestLedCompositor()
+//
+// Posts the sketch's LED status layers to a compositor ticked every 20 ms in
+// virtual time, and checks what the LED shows:
+//  - sync      - A sync pulse is shown for its 1 s minimum, though the steady
+//                layer under it is posted again every tick.
+//  - deferred  - A sync pulse during a 3 s home is shown for 1 s once the home
+//                ends, not lost under it.
+//  - brief     - A home that is set and cleared before a tick still shows for
+//                its 1 s minimum.
+//  - fatal     - An error covers homing and events, and stays.
+//  - threads   - Several threads pulse the event layer and set the steady
+//                layer while the compositor ticks, and the layers settle as
+//                posted.
+// Also reports the host CPU time of a post and of a tick.
+//
+// Returns:
+//    Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+static uint32_t TestLedCompositor()
+{
+    const uint32_t TICK_MS     = 20;
+    const uint32_t MIN_MS      = 1000;
+    const uint32_t NUM_THREADS = 4;
+    const uint32_t NUM_POSTS   = 100000;
+    const uint32_t CPU_TICKS   = 10000000;
+    const LedAnimation_t NTP    = { LedSolid, RGBLed::BLUE,    2, 0, 0, 0, 0, 0 };
+    const LedAnimation_t LOCAL  = { LedSolid, RGBLed::GREEN,   2, 0, 0, 0, 0, 0 };
+    const LedAnimation_t HOMING = { LedSolid, RGBLed::WHITE,   2, 0, 0, 0, 0, 0 };
+    const LedAnimation_t SYNC   = { LedFlash, RGBLed::MAGENTA, 2, 250, 250, 0, 1, 0 };
+    const LedAnimation_t FATAL  = { LedFlash, RGBLed::RED, 100, 150, 200, 0, 3, 2000 };
+    uint32_t errors = 0;
+
+    printf("LED compositor, virtual time, %u ms ticks\n", TICK_MS);
+    RGBLed led(0, 0, 0, false);
+    LedAnimator animator(led);
+    LedCompositor compositor(animator);
+    uint8_t ntp    = compositor.AddPattern(NTP, 0);
+    uint8_t local  = compositor.AddPattern(LOCAL, 0);
+    uint8_t homing = compositor.AddPattern(HOMING, MIN_MS);
+    uint8_t sync   = compositor.AddPattern(SYNC, MIN_MS);
+    uint8_t fatal  = compositor.AddPattern(FATAL, 0);
+    uint32_t nowMs = 1000;
+
+    // A sync pulse over a steady layer that keeps being posted.
+    compositor.Set(LedLayerSteady, local);
+    TickCompositor(compositor, nowMs, nowMs + 200, TICK_MS, LedLayerSteady);
+    compositor.Pulse(LedLayerEvent, sync);
+    uint32_t visibleMs = 0;
+    uint32_t flashes   = 0;
+    bool     wasOn     = false;
+    for (uint32_t endMs = nowMs + 2000; nowMs < endMs; nowMs += TICK_MS)
+    {
+        compositor.Set(LedLayerSteady, local);
+        compositor.Tick(nowMs);
+        bool on = (compositor.TopLayer() == LedLayerEvent) && (animator.Brightness() > 0);
+        visibleMs += (compositor.TopLayer() == LedLayerEvent) ? TICK_MS : 0;
+        flashes   += (on && !wasOn);
+        wasOn      = on;
+    }
+    bool pass = (visibleMs >= MIN_MS) && (visibleMs < MIN_MS + TICK_MS) && (flashes == 2) &&
+                (compositor.TopPattern() == local) && (animator.Color() == RGBLed::GREEN);
+    errors += !pass;
+    printf("  %-10s shown %5u ms, %u flashes %24s\n", "sync", visibleMs, flashes,
+           pass ? "pass" : "FAIL");
+
+    // A sync pulse during a home waits for the home to end.
+    compositor.Set(LedLayerHoming, homing);
+    uint32_t homeMs = TickCompositor(compositor, nowMs, nowMs + 200, TICK_MS, LedLayerHoming);
+    compositor.Pulse(LedLayerEvent, sync);
+    uint32_t duringMs = 0;
+    for (uint32_t endMs = nowMs + 2800; nowMs < endMs; nowMs += TICK_MS)
+    {
+        compositor.Tick(nowMs);
+        homeMs   += (compositor.TopLayer() == LedLayerHoming) ? TICK_MS : 0;
+        duringMs += (compositor.TopLayer() == LedLayerEvent) ? TICK_MS : 0;
+    }
+    compositor.Clear(LedLayerHoming);
+    compositor.Tick(nowMs);
+    pass = (compositor.TopLayer() == LedLayerEvent);
+    visibleMs = TickCompositor(compositor, nowMs, nowMs + 2000, TICK_MS, LedLayerEvent);
+    pass = pass && !duringMs && (homeMs == 3000) && (visibleMs >= MIN_MS) &&
+           (visibleMs < MIN_MS + TICK_MS) && (compositor.TopLayer() == LedLayerSteady);
+    errors += !pass;
+    printf("  %-10s home  %5u ms, sync %u ms during, %u ms after %7s\n",
+           "deferred", homeMs, duringMs, visibleMs, pass ? "pass" : "FAIL");
+
+    // A home shorter than a tick.
+    compositor.Set(LedLayerHoming, homing);
+    compositor.Clear(LedLayerHoming);
+    visibleMs = TickCompositor(compositor, nowMs, nowMs + 2000, TICK_MS, LedLayerHoming);
+    pass = (visibleMs >= MIN_MS) && (visibleMs < MIN_MS + TICK_MS) &&
+           (animator.Color() == RGBLed::GREEN);
+    errors += !pass;
+    printf("  %-10s shown %5u ms %35s\n", "brief", visibleMs, pass ? "pass" : "FAIL");
+
+    // An error during a home, with events and time source changes after it.
+    compositor.Set(LedLayerHoming, homing);
+    TickCompositor(compositor, nowMs, nowMs + 500, TICK_MS, LedLayerHoming);
+    compositor.Set(LedLayerFatal, fatal);
+    compositor.Pulse(LedLayerEvent, sync);
+    compositor.Set(LedLayerSteady, ntp);
+    compositor.Clear(LedLayerHoming);
+    visibleMs = TickCompositor(compositor, nowMs, nowMs + 10000, TICK_MS, LedLayerFatal);
+    pass = (visibleMs == 10000) && (compositor.TopPattern() == fatal);
+    errors += !pass;
+    printf("  %-10s shown %5u ms of 10000 %26s\n", "fatal", visibleMs, pass ? "pass" : "FAIL");
+
+    // Posts from several threads while the compositor ticks.
+    LedCompositor threaded(animator);
+    ntp   = threaded.AddPattern(NTP, 0);
+    local = threaded.AddPattern(LOCAL, 0);
+    sync  = threaded.AddPattern(SYNC, MIN_MS);
+    std::atomic<uint32_t> running(NUM_THREADS);
+    std::vector<std::thread> threads;
+    uint64_t startNs = NowNs();
+    for (uint32_t t = 0; t < NUM_THREADS; t++)
+    {
+        threads.push_back(std::thread([&threaded, &running, t, ntp, local, sync, NUM_POSTS]()
+        {
+            for (uint32_t n = 0; n < NUM_POSTS; n++)
+            {
+                threaded.Pulse(LedLayerEvent, sync);
+                threaded.Set(LedLayerSteady, ((n + t) & 1) ? ntp : local);
+            }
+            running--;
+        }));
+    }
+    uint32_t eventMs = 0;
+    while (running.load())
+    {
+        threaded.Tick(nowMs);
+        eventMs += (threaded.TopLayer() == LedLayerEvent) ? TICK_MS : 0;
+        nowMs   += TICK_MS;
+    }
+    for (uint32_t t = 0; t < NUM_THREADS; t++)
+    {
+        threads[t].join();
+    }
+    double postNs = static_cast<double>(NowNs() - startNs) / (NUM_THREADS * NUM_POSTS * 2);
+    threaded.Set(LedLayerSteady, local);
+    threaded.Tick(nowMs);
+    uint32_t tailMs = TickCompositor(threaded, nowMs, nowMs + 2000, TICK_MS, LedLayerEvent);
+    pass = (tailMs > 0) && (tailMs < MIN_MS + TICK_MS) &&
+           (threaded.TopPattern() == local) && (animator.Color() == RGBLed::GREEN);
+    errors += !pass;
+    printf("  %-10s %u x %u pulses, last shown %u ms %9s\n", "threads",
+           NUM_THREADS, NUM_POSTS, tailMs, pass ? "pass" : "FAIL");
+
+    // The CPU time of a tick with nothing new posted.
+    startNs = NowNs();
+    for (uint32_t n = 0; n < CPU_TICKS; n++)
+    {
+        threaded.Tick(nowMs + n);
+    }
+    double tickNs = static_cast<double>(NowNs() - startNs) / CPU_TICKS;
+    printf("  post: %.1f ns (%u threads at once), tick: %.1f ns\n\n", postNs, NUM_THREADS,
+           tickNs);
+    return errors;
+} // End TestLedCompositor().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestButtonGestures()
+//
+// Feeds made up pushbutton edge traces to ButtonGestures, polling it every
+// 20 ms as the sketch's button task does, and checks the gestures found, the
+// times they are dated, and the longest wait from a gesture being complete
+// to it being reported.  A click waits out the 400 ms double click time, or
+// if pressed again within it, for the second press to last 3 s.
+// Bounce is 5 edges over 4 ms on every press and release of the bouncy
+// traces.
+//
+// Returns:
+//    Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+static uint32_t TestButtonGestures()
+{
+    const uint32_t POLL_MS    = 20;
+    const uint32_t MAX_EDGES  = 64;
+    const uint32_t MAX_EVENTS = 4;
+    struct Trace_t
+    {
+        const char *name;                   // Name printed.
+        bool     bounce;                    // Add bounce to every edge.
+        uint32_t pressMs[4];                // Press times, 0 ends.
+        uint32_t releaseMs[4];              // Release times.
+        ButtonGesture_t expected[MAX_EVENTS];
+                                            // Gestures expected, in order.
+        uint32_t expectedMs[MAX_EVENTS];    // Their times.
+    };
+    static const Trace_t TRACES[] =
+    {
+        { "click",       false, { 100 },            { 250 },
+          { ButtonClick },                             { 250 } },
+        { "bouncy click", true, { 100 },            { 250 },
+          { ButtonClick },                             { 250 } },
+        { "glitch",      false, { 100 },            { 130 },
+          { ButtonNone },                              { 0 } },
+        { "double",       true, { 100, 400 },       { 250, 550 },
+          { ButtonDoubleClick },                       { 550 } },
+        { "two clicks",  false, { 100, 800 },       { 250, 950 },
+          { ButtonClick, ButtonClick },                { 250, 950 } },
+        { "triple",      false, { 100, 400, 700 },  { 250, 550, 850 },
+          { ButtonDoubleClick, ButtonClick },          { 550, 850 } },
+        { "long",         true, { 100 },            { 4100 },
+          { ButtonLongPress },                         { 4100 } },
+        { "click, long", false, { 100, 400 },       { 250, 5400 },
+          { ButtonClick, ButtonLongPress },            { 250, 5400 } },
+        { "very long",    true, { 100 },            { 12100 },
+          { ButtonVeryLongPress },                     { 10100 } },
+        { "2.9 s",       false, { 100 },            { 3000 },
+          { ButtonClick },                             { 3000 } },
+    };
+    const uint32_t NUM_TRACES = sizeof(TRACES) / sizeof(TRACES[0]);
+    uint32_t errors = 0;
+
+    printf("Button gestures, polled every %u ms\n", POLL_MS);
+    printf("  %-13s %-28s %12s %6s\n", "trace", "gestures (ms)", "max wait ms", "");
+    for (uint32_t t = 0; t < NUM_TRACES; t++)
+    {
+        // Build the edge list, with bounce if wanted.
+        const Trace_t &trace = TRACES[t];
+        uint64_t edgeUs[MAX_EDGES];
+        bool     edgeOn[MAX_EDGES];
+        uint32_t numEdges = 0;
+        for (uint32_t p = 0; (p < 4) && trace.pressMs[p]; p++)
+        {
+            for (uint32_t e = 0; e < 2; e++)
+            {
+                uint64_t atUs = 1000ULL * (e ? trace.releaseMs[p] : trace.pressMs[p]);
+                uint32_t bounces = trace.bounce ? 5 : 1;
+                for (uint32_t b = 0; b < bounces; b++)
+                {
+                    edgeUs[numEdges] = atUs + b * 1000;
+                    edgeOn[numEdges] = (e == 0) ^ (b & 1);
+                    numEdges++;
+                }
+            }
+        }
+
+        // Replay it, passing in the edges due before each poll.
+        ButtonGestures gestures;
+        ButtonEvent_t  found[MAX_EVENTS];
+        uint32_t numFound = 0;
+        uint32_t maxWaitMs = 0;
+        uint32_t next = 0;
+        for (uint64_t nowUs = 0; nowUs < 20000000; nowUs += POLL_MS * 1000)
+        {
+            for (; (next < numEdges) && (edgeUs[next] <= nowUs); next++)
+            {
+                gestures.OnEdge(edgeOn[next], edgeUs[next]);
+            }
+            gestures.Poll(nowUs);
+            ButtonEvent_t event;
+            while (gestures.Next(event))
+            {
+                uint32_t waitMs = static_cast<uint32_t>((nowUs - event.timeUs) / 1000);
+                maxWaitMs = (waitMs > maxWaitMs) ? waitMs : maxWaitMs;
+                if (numFound < MAX_EVENTS)
+                {
+                    found[numFound] = event;
+                }
+                numFound++;
+            }
+        }
+
+        // Compare with what was expected.
+        static const char *NAMES[] = { "none", "click", "double", "long", "very long" };
+        char text[80] = "";
+        uint32_t numExpected = 0;
+        while ((numExpected < MAX_EVENTS) && (trace.expected[numExpected] != ButtonNone))
+        {
+            numExpected++;
+        }
+        bool pass = (numFound == numExpected);
+        for (uint32_t i = 0; (i < numFound) && (i < MAX_EVENTS); i++)
+        {
+            size_t len = strlen(text);
+            snprintf(text + len, sizeof(text) - len, "%s%s %u", i ? ", " : "",
+                     NAMES[found[i].gesture], static_cast<uint32_t>(found[i].timeUs / 1000));
+            pass = pass && (i < numExpected) && (found[i].gesture == trace.expected[i]) &&
+                   (found[i].timeUs == 1000ULL * trace.expectedMs[i]);
+        }
+        errors += !pass;
+        printf("  %-13s %-28s %12u %6s\n", trace.name, numFound ? text : "none", maxWaitMs,
+               pass ? "pass" : "FAIL");
+    }
+    printf("\n");
+    return errors;
+} // End TestButtonGestures().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestMinuteBoundary()
+//
+// Runs the sketch's minute task wakeups for three simulated hours.  The time
+// source runs 50 ppm fast against the HAL clock, is read to the second, jumps
+// 0.7 s forward at 40 minutes (as an NTP correction would, after which the
+// sketch restarts the boundary search), and changes from UTC+1 to UTC+2 at
+// 90 minutes.  Each wakeup is late by up to 2 ms, as if other scheduler tasks
+// were running, and sleeps are in whole ms.  Checks that every local minute
+// is seen once, and reports the wakeups per minute and the latency from each
+// boundary to the reading that saw it, against polling every 250 ms.
+//
+// Returns:
+//    Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+static uint32_t TestMinuteBoundary()
+{
+    const uint64_t RUN_US     = 3ULL * 3600 * 1000000;
+    const double   PPM        = 50.0;
+    const int64_t  START_US   = 1793000000LL * 1000000 + 123456;    // UTC.
+    const uint64_t JUMP_AT_US = 40ULL * 60 * 1000000;
+    const int64_t  JUMP_US    = 700000;
+    const int64_t  DST_AT_S   = (START_US / 1000000 / 60 + 90) * 60; // UTC.
+    const uint32_t MAX_JITTER_US = 2000;
+    uint32_t errors = 0;
+
+    printf("Minute boundaries, 3 simulated hours, %.0f ppm drift, 0.7 s jump, DST change\n",
+           PPM);
+    printf("  %-16s %8s %10s %12s %12s %8s %6s\n", "method", "minutes", "wakes/min",
+           "avg late ms", "max late ms", "DST ok", "");
+    for (uint32_t method = 0; method < 2; method++)
+    {
+        MinuteBoundary boundary;
+        uint32_t seed      = 4242;
+        uint64_t nowUs     = 0;
+        uint32_t wakes     = 0;
+        uint32_t minutes   = 0;
+        uint32_t skipped   = 0;
+        uint32_t timed     = 0;
+        double   totalLate = 0;
+        double   maxLate   = 0;
+        bool     dstOk     = false;
+        bool     jumped    = false;
+        int32_t  lastMinute = -1;
+        while (nowUs < RUN_US)
+        {
+            // Read the time source: UTC, drifted and jumped, then local.
+            double  utcUs = START_US + nowUs * (1.0 + PPM * 1e-6) +
+                            ((nowUs >= JUMP_AT_US) ? JUMP_US : 0);
+            int64_t utcS  = static_cast<int64_t>(utcUs / 1e6);
+            time_t  local = static_cast<time_t>(utcS + ((utcS >= DST_AT_S) ? 7200 : 3600));
+            tm now;
+            gmtime_r(&local, &now);
+            wakes++;
+            if (!method && (nowUs >= JUMP_AT_US) && !jumped)
+            {
+                jumped = true;
+                boundary.Restart();
+            }
+
+            // See if the minute changed, and if so, how long ago.
+            bool    seen   = method ? false : boundary.Observe(nowUs, now);
+            int32_t minute = now.tm_hour * 60 + now.tm_min;
+            if ((lastMinute >= 0) && (minute != lastMinute))
+            {
+                int32_t step = (minute - lastMinute + 1440) % 1440;
+                bool    dst  = (utcS >= DST_AT_S) && (utcS < DST_AT_S + 60);
+                skipped += (step != 1) && !(dst && (step == 61));
+                dstOk    = dstOk || (dst && (step == 61));
+                minutes++;
+                errors  += (!method && !seen);
+
+                // Don't time the minute of the jump.
+                if (!((nowUs >= JUMP_AT_US) && (nowUs < JUMP_AT_US + 60000000)))
+                {
+                    double boundaryUtcUs = static_cast<double>(utcS - now.tm_sec) * 1e6;
+                    double offsetUs = (nowUs >= JUMP_AT_US) ? JUMP_US : 0;
+                    double edgeUs   = (boundaryUtcUs - START_US - offsetUs) /
+                                      (1.0 + PPM * 1e-6);
+                    double lateMs   = (nowUs - edgeUs) / 1000.0;
+                    totalLate += lateMs;
+                    maxLate    = (lateMs > maxLate) ? lateMs : maxLate;
+                    timed++;
+                }
+            }
+            lastMinute = minute;
+
+            // Sleep till the next wakeup, in whole ms, then run late.
+            uint64_t wantUs = method ? nowUs + 250000 : boundary.NextWakeUs();
+            uint64_t sleepUs = (wantUs > nowUs) ? ((wantUs - nowUs + 999) / 1000) * 1000 : 0;
+            seed   = seed * 1664525 + 1013904223;
+            nowUs += sleepUs + (seed >> 8) % MAX_JITTER_US;
+        }
+
+        double perMinute = wakes / (RUN_US / 60e6);
+        bool pass = (minutes >= 179) && !skipped && dstOk &&
+                    (method || ((maxLate < 5.0) && (perMinute < 40.0)));
+        errors += !pass;
+        printf("  %-16s %8u %10.1f %12.2f %12.2f %8s %6s\n",
+               method ? "poll every 250ms" : "MinuteBoundary", minutes, perMinute,
+               totalLate / (timed ? timed : 1), maxLate, dstOk ? "yes" : "no",
+               pass ? "pass" : "FAIL");
+    }
+    printf("\n");
+    return errors;
+} // End TestMinuteBoundary().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// MinuteSim_t
+//
+// State of the simulated minute and motion tasks used by TestMinuteTask().
+/////////////////////////////////////////////////////////////////////////////////
+struct MinuteSim_t
+{
+    SimulatedHal   *pHal;               // The simulated board.
+    TaskScheduler  *pScheduler;         // The scheduler running the tasks.
+    int32_t         minuteTask;         // The minute task.
+    int32_t         motionTask;         // The motion task.
+    MinuteBoundary *pBoundary;          // Finds the minute boundaries.
+    MotionTask     *pMotion;            // Runs the minute updates.
+    uint64_t startUs;                   // HAL time the time source starts at.
+    uint64_t readyUs;                   // When the time source is first set.
+    uint64_t jumpUs;                    // When the time source jumps.
+    bool     jumped;                    // True once it has jumped.
+    bool     timeSet;                   // The sketch's gTimeSet.
+    LoopSim_t *pLoop;                   // State of the WiFi stand-in.
+    int32_t  lastMinute;                // Last minute seen, or -1.
+    uint64_t edgeUs;                    // HAL time of the boundary to time, or 0.
+    uint32_t runs;                      // Minute task runs.
+    uint32_t minutes;                   // Minute changes seen.
+    uint32_t skipped;                   // Minute changes that skipped minutes.
+    bool     dstOk;                     // True if the DST change was seen.
+    uint32_t timed;                     // Minute updates timed.
+    double   totalLateMs;               // Total boundary to update latency.
+    double   maxLateMs;                 // Worst boundary to update latency.
+};
+
+// The time source of TestMinuteBoundary(): UTC, 50 ppm fast, jumped 0.7 s,
+// and local from UTC+1 to UTC+2 at 90 minutes.
+static const uint64_t MINUTE_RUN_US   = 3ULL * 3600 * 1000000;
+static const double   MINUTE_PPM      = 50.0;
+static const int64_t  MINUTE_START_US = 1793000000LL * 1000000 + 123456;
+static const int64_t  MINUTE_JUMP_US  = 700000;
+static const int64_t  MINUTE_DST_AT_S = (MINUTE_START_US / 1000000 / 60 + 90) * 60;
+
+// Does what the sketch's MinuteTask() does: waits 250 ms at a time for a time
+// source, then reads the time at the wakeups MinuteBoundary wants, sends
+// each new minute to the motion task, and reschedules itself with RunAt()
+// on every run.
+static void SimMinuteBoundaryTask(void *pArg)
+{
+    const uint64_t WAIT_US = 250000;
+    MinuteSim_t &sim = *static_cast<MinuteSim_t *>(pArg);
+    uint64_t nowUs = sim.pHal->Micros();
+    sim.runs++;
+    if (nowUs < sim.readyUs)
+    {
+        sim.pScheduler->RunAt(sim.minuteTask, nowUs + WAIT_US);
+        return;
+    }
+
+    if (sim.timeSet)
+    {
+        sim.timeSet = false;
+        sim.pBoundary->Restart();
+    }
+
+    bool    jumped = nowUs >= sim.jumpUs;
+    double  utcUs  = MINUTE_START_US + (nowUs - sim.startUs) * (1.0 + MINUTE_PPM * 1e-6) +
+                     (jumped ? MINUTE_JUMP_US : 0);
+    int64_t utcS   = static_cast<int64_t>(utcUs / 1e6);
+    time_t  local  = static_cast<time_t>(utcS + ((utcS >= MINUTE_DST_AT_S) ? 7200 : 3600));
+    tm now;
+    gmtime_r(&local, &now);
+    sim.pBoundary->Observe(nowUs, now);
+    int32_t minute = now.tm_hour * 60 + now.tm_min;
+    if (minute != sim.lastMinute)
+    {
+        sim.pMotion->UpdateClock(now);
+        sim.pScheduler->Trigger(sim.motionTask);
+    }
+    if ((sim.lastMinute >= 0) && (minute != sim.lastMinute))
+    {
+        int32_t step = (minute - sim.lastMinute + 1440) % 1440;
+        bool    dst  = (utcS >= MINUTE_DST_AT_S) && (utcS < MINUTE_DST_AT_S + 60);
+        sim.skipped += (step != 1) && !(dst && (step == 61));
+        sim.dstOk    = sim.dstOk || (dst && (step == 61));
+        sim.minutes++;
+
+        // Time the update from the boundary, except in the minute of the jump.
+        if (!(jumped && (nowUs < sim.jumpUs + 60000000)))
+        {
+            double boundaryUtcUs = static_cast<double>(utcS - now.tm_sec) * 1e6;
+            sim.edgeUs = sim.startUs + static_cast<uint64_t>(
+                         (boundaryUtcUs - MINUTE_START_US - (jumped ? MINUTE_JUMP_US : 0)) /
+                         (1.0 + MINUTE_PPM * 1e-6));
+        }
+    }
+    sim.lastMinute = minute;
+    sim.pScheduler->RunAt(sim.minuteTask, sim.pBoundary->NextWakeUs());
+} // End SimMinuteBoundaryTask().
+
+// Plays the part of the motion task, woken by the minute task, and times
+// each update from its minute boundary to when the motion task started it.
+static void SimMotionTask(void *pArg)
+{
+    MinuteSim_t &sim = *static_cast<MinuteSim_t *>(pArg);
+    sim.pMotion->Poll();
+    MotionStatus_t status = sim.pMotion->Status();
+    if (sim.edgeUs && (status.updateStartUs >= sim.edgeUs))
+    {
+        double lateMs = (status.updateStartUs - sim.edgeUs) / 1000.0;
+        sim.totalLateMs += lateMs;
+        sim.maxLateMs    = (lateMs > sim.maxLateMs) ? lateMs : sim.maxLateMs;
+        sim.timed++;
+        sim.edgeUs = 0;
+    }
+} // End SimMotionTask().
+
+// Does what the sketch's WiFiTask() does: wakes the minute task if the time
+// was set, then stands in for the WiFi work.
+static void SimTimeSetWiFiTask(void *pArg)
+{
+    MinuteSim_t &sim = *static_cast<MinuteSim_t *>(pArg);
+    if (sim.timeSet)
+    {
+        sim.pScheduler->Trigger(sim.minuteTask);
+    }
+    SimWiFiTask(sim.pLoop);
+} // End SimTimeSetWiFiTask().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestMinuteTask()
+//
+// Runs the sketch's minute task through TaskScheduler for three simulated
+// hours, against the time source of TestMinuteBoundary(), with the minute
+// updates run by a MotionTask that really moves the simulated clock.  Like
+// the sketch's, the minute task is triggered once at setup, is not periodic,
+// and reschedules itself with RunAt() on every run: every 250 ms till the
+// time source is set 5 s in, then at the wakeups MinuteBoundary wants.  When
+// the time jumps, it is only flagged, as UtcSetCallback() does, and the WiFi
+// task wakes the minute task, which restarts the boundary search.  The
+// motion task is triggered by the minute task, as the sketch's is notified,
+// and the WiFi and LED stand-ins of BenchmarkScheduler() run alongside.
+// Checks that every local minute is seen, and reports the minute task runs
+// per minute and the latency from each boundary to the motion task starting
+// its update.
+//
+// Returns:
+//    Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+static uint32_t TestMinuteTask()
+{
+    const uint64_t JUMP_AT_US = 40ULL * 60 * 1000000;
+
+    printf("Scheduled minute task, 3 simulated hours, %.0f ppm drift, 0.7 s jump, "
+           "DST change\n", MINUTE_PPM);
+    printf("  %8s %8s %10s %12s %12s %8s %6s\n", "minutes", "updates", "runs/min",
+           "avg late ms", "max late ms", "DST ok", "");
+
+    SimulatedHal hal(true, true);
+    hal.SetHalfStepsPerRev(4075.52);
+    GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                               USE_HALF_STEPPING, true, &hal);
+    StepTables::Install(clock.Planner());
+    clock.SetFullStepsPerRev(203776, 100);
+    clock.Home();
+    MotionTask motion(clock);
+    motion.Begin();
+
+    TaskScheduler  scheduler(&hal);
+    MinuteBoundary boundary;
+    LoopSim_t      loop  = { &hal, &clock, 777, 0, 0, 0, 0, 0 };
+    uint64_t       start = hal.Micros();
+    MinuteSim_t    sim   = { &hal, &scheduler, TaskScheduler::INVALID_TASK,
+                             TaskScheduler::INVALID_TASK, &boundary, &motion, start,
+                             start + 5000000, start + JUMP_AT_US, false, false, &loop,
+                             -1, 0, 0, 0, 0, false, 0, 0.0, 0.0 };
+    sim.motionTask = scheduler.AddTask("motion", SimMotionTask, &sim, 0, 10, 8);
+    sim.minuteTask = scheduler.AddTask("minute", SimMinuteBoundaryTask, &sim, 0, 1000, 6);
+    scheduler.AddTask("wifi", SimTimeSetWiFiTask, &sim,  50, 200, 4);
+    scheduler.AddTask("led",  SimLedTask,         &loop, 500, 500, 3);
+    scheduler.Trigger(sim.minuteTask);
+    while (hal.Micros() - start < MINUTE_RUN_US)
+    {
+        if (!sim.jumped && (hal.Micros() >= sim.jumpUs))
+        {
+            sim.jumped  = true;
+            sim.timeSet = true;
+        }
+        scheduler.RunOnce();
+    }
+
+    double perMinute = sim.runs / (MINUTE_RUN_US / 60e6);
+    bool pass = (sim.minutes >= 179) && (sim.timed >= 178) && !sim.skipped && sim.dstOk &&
+                (sim.maxLateMs < 10.0) && (perMinute < 40.0);
+    printf("  %8u %8u %10.1f %12.2f %12.2f %8s %6s\n\n", sim.minutes, sim.timed, perMinute,
+           sim.totalLateMs / (sim.timed ? sim.timed : 1), sim.maxLateMs,
+           sim.dstOk ? "yes" : "no", pass ? "pass" : "FAIL");
+    return !pass;
+} // End TestMinuteTask().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestLowPower()
+//
+// Simulates a day of the sketch's LOW_POWER_MODE.  The clock is homed and its
+// position retained, as the full wake after power on does, then woken once a
+// minute.  Each wake is a new clock instance on the same SimulatedHal, as a
+// deep sleep loses everything but retained memory and storage: it restores
+// the position, moves to the new minute, retains the position, and sleeps
+// till the next minute.  This is done with no power loss, and with retained
+// memory lost (a power loss while asleep) in the first sleep and every four
+// hours after, where the Idle position in storage must lead to a boot probe.
+// Reports the awake time and storage writes per wake, the probes, the dial
+// error, and the average current per hour from the awake time accounting,
+// against staying awake with WiFi on.  Fails if a wake can't restore its position, a clock that
+// kept its retained memory needs a home, a step is missed, or the dial is
+// ever more than MAX_ERROR_MINUTES off.
+//
+// Returns:
+//    Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+static uint32_t TestLowPower()
+{
+    const uint32_t DAY_MINUTES       = 24 * 60;
+    const int32_t  START_MINUTES     = 500;
+    const uint32_t LOSS_MINUTES      = 4 * 60;
+    const double   MAX_ERROR_MINUTES = 0.05;
+    const char    *CASES[]           = { "retained", "lost/4h" };
+    const uint32_t NUM_CASES         = sizeof(CASES) / sizeof(CASES[0]);
+    uint32_t errors = 0;
+    double   sleepMa = 0.0;
+
+    printf("Low power mode, a day of minute wakes from deep sleep\n");
+    printf("  %-9s %7s %7s %9s %11s %7s %12s %7s %9s %6s\n", "case", "wakes", "probes",
+           "awake ms", "writes/wake", "missed", "max err min", "coil mA", "avg mA", "");
+    for (uint32_t c = 0; c < NUM_CASES; c++)
+    {
+        SimulatedHal hal(true, true);
+        SetUpScenarioHal(hal);
+        hal.SetDialMinutes(200.0);
+        int32_t  minutes = START_MINUTES;
+        uint32_t failed  = 0;
+
+        // The full wake after power on homes the clock, and retains its
+        // position before the first sleep.
+        {
+            GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                                       USE_HALF_STEPPING, true, &hal);
+            SetUpScenarioClock(clock);
+            failed += (clock.Home() != StatusSuccess);
+            tm now = {};
+            now.tm_hour = minutes / 60;
+            now.tm_min  = minutes % 60;
+            clock.UpdateClock(now);
+            clock.WaitForMove();
+            failed += !clock.RetainPosition();
+        }
+
+        uint32_t probes   = 0;
+        uint32_t missed   = hal.MissedSteps();
+        uint32_t writes   = hal.StorageWrites();
+        uint64_t awakeUs  = 0;
+        double   coilMaUs = 0.0;
+        double   maxError = 0.0;
+        uint32_t wakes    = 0;
+        uint32_t minute   = 0;
+        uint32_t lossAt   = 1;
+        uint64_t startUs  = hal.Micros();
+        while (minute < DAY_MINUTES)
+        {
+            // Sleep till the next minute alarm.  A wake that ran past one,
+            // such as a probe, misses it, and the next wake catches up.
+            minute = static_cast<uint32_t>((hal.Micros() - startUs) / 60000000ULL) + 1;
+            hal.Delay(static_cast<uint32_t>((startUs + minute * 60000000ULL - hal.Micros()) / 1000));
+            if ((c == 1) && (minute >= lossAt))
+            {
+                hal.ClearRetained();
+                lossAt += LOSS_MINUTES;
+            }
+            wakes++;
+            minutes = (START_MINUTES + minute) % 1440;
+            uint64_t wakeUs = hal.Micros();
+            {
+                GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                                           USE_HALF_STEPPING, true, &hal);
+                SetUpScenarioClock(clock);
+                clock.LoadCalibration();
+                failed += !clock.RestorePosition();
+                if (clock.HomeRequired())
+                {
+                    probes++;
+                    failed += (c == 0) || (clock.Home() != StatusSuccess);
+                }
+                tm now = {};
+                now.tm_hour = minutes / 60;
+                now.tm_min  = minutes % 60;
+                clock.UpdateClock(now);
+                clock.WaitForMove();
+                failed += !clock.RetainPosition();
+                CoilStats_t coils;
+                clock.GetCoilStats(coils);
+                coilMaUs += clock.EstimateCoilMa(CoilRelease, coils) * coils.elapsedUs;
+            }
+            awakeUs += hal.Micros() - wakeUs;
+            double error = DialError(hal, minutes % 720);
+            maxError = (fabs(error) > fabs(maxError)) ? error : maxError;
+        }
+        missed = hal.MissedSteps() - missed;
+        writes = hal.StorageWrites() - writes;
+
+        // Charge in mA us, awake (counting the boot before setup()) and asleep.
+        double totalUs      = static_cast<double>(hal.Micros() - startUs);
+        double bootUs       = wakes * LOW_POWER_BOOT_MS * 1000.0;
+        double awakeMaUs    = (awakeUs + bootUs) * LOW_POWER_AWAKE_MA + coilMaUs;
+        double asleepMaUs   = (totalUs - awakeUs - bootUs) * LOW_POWER_SLEEP_MA;
+        double avgMa        = (awakeMaUs + asleepMaUs) / totalUs;
+        bool pass = !failed && !missed && (fabs(maxError) <= MAX_ERROR_MINUTES) &&
+                    (probes == ((c == 0) ? 0 : DAY_MINUTES / LOSS_MINUTES));
+        errors += !pass;
+        printf("  %-9s %7u %7u %9.1f %11.2f %7u %12.4f %7.3f %9.3f %6s\n", CASES[c], wakes,
+               probes, awakeUs / 1000.0 / wakes, static_cast<double>(writes) / wakes, missed,
+               maxError, coilMaUs / totalUs, avgMa, pass ? "pass" : "FAIL");
+        if (c == 0)
+        {
+            sleepMa = avgMa;
+            printf("  %-9s %7s %7s %9s %11s %7s %12s %7.3f %9.3f\n", "awake", "", "", "", "", "", "",
+                   coilMaUs / totalUs, LOW_POWER_WIFI_MA + coilMaUs / totalUs);
+        }
+    }
+    printf("  (virtual time; avg mA counts %u ms of boot per wake at %.0f mA awake, and\n"
+           "   %.2f mA asleep; a 2000 mAh battery would last %.0f days)\n\n",
+           LOW_POWER_BOOT_MS, LOW_POWER_AWAKE_MA, LOW_POWER_SLEEP_MA, 2000.0 / (sleepMa * 24.0));
+    return errors;
+} // End TestLowPower().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TestStepTiming()
+//
+// Runs moves at each speed while the step timer is made late by a random
+// amount on every step: usually 5 to 60 us, as esp_timer dispatch adds, but
+// 2% of the time 200 to 3000 us, as a burst of WiFi interrupts might add.
+// Since each step is timed from the phase write that starts it to the one
+// that ends it, the statistics must count every step, and the recorded
+// overruns must add up to exactly the latency that was added.
+//
+// Returns:
+//    Returns the number of errors found.
+/////////////////////////////////////////////////////////////////////////////////
+struct LatencySim_t
+{
+    uint32_t seed;              // Random number state.
+    uint64_t totalUs;           // Latency added so far.
+    uint32_t maxUs;             // Most latency added to one step.
+};
+
+static uint32_t SimStepLatency(void *pArg)
+{
+    LatencySim_t &sim = *static_cast<LatencySim_t *>(pArg);
+    sim.seed = sim.seed * 1664525 + 1013904223;
+    uint32_t r = sim.seed >> 8;
+    uint32_t latencyUs = (r % 100 < 2) ? 200 + (r >> 8) % 2801 : 5 + (r >> 8) % 56;
+    sim.totalUs += latencyUs;
+    sim.maxUs    = std::max(sim.maxUs, latencyUs);
+    return latencyUs;
+} // End SimStepLatency().
+
+static uint32_t TestStepTiming()
+{
+#if STEP_TIMING_STATS
+    const StepperSpeed_t SPEEDS[] = { StepSlow, StepAuto, StepFast };
+    const char *SPEED_NAMES[]     = { "slow", "auto", "fast" };
+    const uint32_t NUM_SPEEDS     = sizeof(SPEEDS) / sizeof(SPEEDS[0]);
+    const uint32_t MOVES          = 10;
+    const int32_t  STEPS          = 1000;
+    uint32_t errors = 0;
+
+    SimulatedHal hal(true, true);
+    GenericClockBoard board(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                            USE_HALF_STEPPING, true, &hal);
+    LatencySim_t sim = { 24680, 0, 0 };
+    StepTimer::SetHostLatency(SimStepLatency, &sim);
+    for (uint32_t i = 0; i < NUM_SPEEDS; i++)
+    {
+        for (uint32_t m = 0; m < MOVES; m++)
+        {
+            board.Step((m & 1) ? -STEPS : STEPS, SPEEDS[i]);
+            hal.Delay(50);
+        }
+    }
+    StepTimer::SetHostLatency(NULL, NULL);
+
+    StepTimingStats stats;
+    board.GetStepTiming(stats);
+    uint64_t totalOverrunUs = 0;
+    uint32_t maxOverrunUs   = 0;
+    printf("Step timing test, %u moves of %d steps per speed\n", MOVES, STEPS);
+    printf("  %-6s %8s %8s %8s %12s %12s %8s\n", "speed", "steps", "min us",
+           "max us", "avg late us", "max late us", "early");
+    for (uint32_t i = 0; i < NUM_SPEEDS; i++)
+    {
+        const StepTimingStats::SpeedStats_t &s = stats.Speed(SPEEDS[i]);
+        uint32_t bucketed = 0;
+        for (uint32_t b = 0; b < StepTimingStats::NUM_BUCKETS; b++)
+        {
+            bucketed += s.overruns[b];
+        }
+        errors += (s.steps != MOVES * STEPS) || (bucketed != s.steps) || s.early;
+        totalOverrunUs += s.totalOverrunUs;
+        maxOverrunUs    = std::max(maxOverrunUs, s.maxOverrunUs);
+        printf("  %-6s %8u %8u %8u %12.1f %12u %8u\n", SPEED_NAMES[i], s.steps,
+               s.minIntervalUs, s.maxIntervalUs,
+               s.steps ? static_cast<double>(s.totalOverrunUs) / s.steps : 0.0,
+               s.maxOverrunUs, s.early);
+    }
+    errors += (totalOverrunUs != sim.totalUs) || (maxOverrunUs != sim.maxUs);
+
+    // Show the fast overrun histogram.
+    const StepTimingStats::SpeedStats_t &fast = stats.Speed(StepFast);
+    printf("  fast overruns:");
+    for (uint32_t b = 0; b < StepTimingStats::NUM_BUCKETS; b++)
+    {
+        if (fast.overruns[b])
+        {
+            printf(" %u+:%u", StepTimingStats::BucketLowUs(b), fast.overruns[b]);
+        }
+    }
+    printf("\n  latency added %llu us, overruns recorded %llu us   %s\n\n",
+           static_cast<unsigned long long>(sim.totalUs),
+           static_cast<unsigned long long>(totalOverrunUs), errors ? "FAIL" : "pass");
+    return errors;
+#else
+    printf("Step timing test skipped, STEP_TIMING_STATS is 0\n\n");
+    return 0;
+#endif
+} // End TestStepTiming().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// BenchmarkButton()
+//
+// Scripts a series of short button presses (10 to 80 ms) while the sketch's
+// loop() runs every 100 ms, and counts how many are seen by polling the
+// button once per pass with the original 50 ms debounce, and how many are
+// seen in the queued input edges.
+/////////////////////////////////////////////////////////////////////////////////
+static void BenchmarkButton()
+{
+    const uint32_t PRESSES      = 200;
+    const uint32_t LOOP_MS      = 100;
+    const uint32_t DEBOUNCE_MS  = 50;
+
+    SimulatedHal hal(true, true);
+    GenevaClockMechanics clock(RAPID_SECONDS_PER_REV, FULL_STEPS_PER_REV, true,
+                               USE_HALF_STEPPING, true, &hal);
+
+    uint32_t seed   = 12345;
+    uint32_t polled = 0;
+    uint32_t edges  = 0;
+    uint32_t maxLagUs = 0;
+    InputEdge_t edge;
+    for (uint32_t p = 0; p < PRESSES; p++)
+    {
+        // Start each press somewhere in the next loop() pass.
+        seed = seed * 1664525 + 1013904223;
+        uint64_t atUs       = hal.Micros() + (seed >> 8) % (LOOP_MS * 1000);
+        uint64_t durationUs = 10000 + (seed >> 4) % 70000;
+        hal.PressButtonAt(atUs, durationUs);
+
+        // Run loop() passes until the press is over.
+        while (hal.Micros() < atUs + durationUs + LOOP_MS * 1000)
+        {
+            if (clock.IsButtonPressed())
+            {
+                hal.Delay(DEBOUNCE_MS);
+                polled += clock.IsButtonPressed();
+                while (clock.IsButtonPressed())
+                {
+                    hal.Delay(LOOP_MS);
+                }
+            }
+            while (clock.NextInputEdge(edge))
+            {
+                if ((edge.pin == GenericClockBoard::PUSHBUTTON_PIN) && edge.active)
+                {
+                    edges++;
+                    maxLagUs = std::max(maxLagUs, static_cast<uint32_t>(edge.timeUs - atUs));
+                }
+            }
+            hal.Delay(LOOP_MS);
+        }
+    }
+
+    printf("Button presses of 10 to 80 ms with loop() every %u ms\n", LOOP_MS);
+    printf("  %-10s %8s %8s\n", "method", "presses", "seen");
+    printf("  %-10s %8u %8u\n", "polled", PRESSES, polled);
+    printf("  %-10s %8u %8u   (edge time error %u us, %u dropped)\n\n", "edges",
+           PRESSES, edges, maxLagUs, clock.InputEdgesDropped());
+} // End BenchmarkButton().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// main()
+//
+// Runs each benchmark in turn.  With the argument "scenarios", only runs the
+// scenario suite, which takes well under a second.
+/////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char *argv[])
+{
+    if ((argc > 1) && (strcmp(argv[1], "scenarios") == 0))
+    {
+        return TestScenarios() ? 1 : 0;
+    }
+
+    BenchmarkIntervalCost();
+    BenchmarkJitter();
+    BenchmarkCalibration();
+    BenchmarkFlyBy();
+    BenchmarkHoming();
+    BenchmarkButton();
+    BenchmarkScheduler();
+    bool failed = TestHomeLatency();
+    failed = TestSpscRing() || failed;
+    failed = TestSeqLock() || failed;
+    failed = TestMotionTask() || failed;
+    failed = TestStepTiming() || failed;
+    BenchmarkCoilPower();
+    BenchmarkMicrostepping();
+    failed = TestScenarios() || failed;
+    failed = TestBacklash() || failed;
+    failed = TestBoot() || failed;
+    failed = TestLedAnimator() || failed;
+    failed = TestLedCompositor() || failed;
+    failed = TestButtonGestures() || failed;
+    failed = TestMinuteBoundary() || failed;
+    failed = TestMinuteTask() || failed;
+    failed = TestLowPower() || failed;
+    return failed ? 1 : 0;
+} // End main().
+
+#endif // !ARDUINO
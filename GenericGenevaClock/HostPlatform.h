@@ -0,0 +1,110 @@
+/////////////////////////////////////////////////////////////////////////////////
+// HostPlatform.h
+//
+// Minimal stand-ins for the Arduino, FreeRTOS, SerialDebug, and RGBLed
+// definitions that the clock classes rely on.  This file is only used when
+// building on a host (i.e. when ARDUINO is not defined) so that the clock
+// mechanics can be run against the SimulatedHal on Linux.  It is never used
+// in the ESP32 build.
+//
+// The SerialDebug print macros compile to nothing unless HOST_DEBUG_PRINT is
+// defined, in which case they print to stdout.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined HOSTPLATFORM_H
+#define HOSTPLATFORM_H
+
+#if !defined ARDUINO
+
+#include <stdint.h>             // For standard integer types.
+#include <stdlib.h>             // For abs().
+#include <stddef.h>             // For NULL.
+#include <stdio.h>              // For printf().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Arduino stand-ins.
+/////////////////////////////////////////////////////////////////////////////////
+#define HIGH            1
+#define LOW             0
+#define INPUT           0x01
+#define OUTPUT          0x03
+#define INPUT_PULLUP    0x05
+#define IRAM_ATTR
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// FreeRTOS stand-ins.  The host build is single threaded and runs in virtual
+// time, so critical sections are empty.
+/////////////////////////////////////////////////////////////////////////////////
+typedef void *TaskHandle_t;
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED    { 0 }
+#define portENTER_CRITICAL(pMux)        ((void)(pMux))
+#define portEXIT_CRITICAL(pMux)         ((void)(pMux))
+#define portENTER_CRITICAL_ISR(pMux)    ((void)(pMux))
+#define portEXIT_CRITICAL_ISR(pMux)     ((void)(pMux))
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SerialDebug stand-ins.
+/////////////////////////////////////////////////////////////////////////////////
+#if defined HOST_DEBUG_PRINT
+    #define HOST_PRINTLN(...)   (printf(__VA_ARGS__), printf("\n"))
+#else
+    #define HOST_PRINTLN(...)   ((void)0)
+#endif
+#define printlnA(...)   HOST_PRINTLN(__VA_ARGS__)
+#define printlnE(...)   HOST_PRINTLN(__VA_ARGS__)
+#define printlnW(...)   HOST_PRINTLN(__VA_ARGS__)
+#define printlnI(...)   HOST_PRINTLN(__VA_ARGS__)
+#define printlnD(...)   HOST_PRINTLN(__VA_ARGS__)
+#define printlnV(...)   HOST_PRINTLN(__VA_ARGS__)
+#define debugA(...)     HOST_PRINTLN(__VA_ARGS__)
+#define debugE(...)     HOST_PRINTLN(__VA_ARGS__)
+#define debugW(...)     HOST_PRINTLN(__VA_ARGS__)
+#define debugI(...)     HOST_PRINTLN(__VA_ARGS__)
+#define debugD(...)     HOST_PRINTLN(__VA_ARGS__)
+#define debugV(...)     HOST_PRINTLN(__VA_ARGS__)
+#define debugHandle()   ((void)0)
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// RGBLed stand-in.  Remembers the last requested color and brightness so
+// that host code can inspect them, but otherwise does nothing.
+/////////////////////////////////////////////////////////////////////////////////
+class RGBLed
+{
+public:
+    static int RED[3];
+    static int GREEN[3];
+    static int BLUE[3];
+    static int MAGENTA[3];
+    static int CYAN[3];
+    static int YELLOW[3];
+    static int WHITE[3];
+    static const bool COMMON_ANODE   = true;
+    static const bool COMMON_CATHODE = false;
+
+    RGBLed(int, int, int, bool) : m_Red(0), m_Green(0), m_Blue(0), m_Brightness(100) {}
+    void off()                                  { setColor(0, 0, 0); }
+    void setColor(int r, int g, int b)          { m_Red = r; m_Green = g; m_Blue = b; }
+    void setColor(int rgb[3])                   { setColor(rgb[0], rgb[1], rgb[2]); }
+    void brightness(int b)                      { m_Brightness = b; }
+    void brightness(int r, int g, int b, int p) { setColor(r, g, b); brightness(p); }
+    void brightness(int rgb[3], int p)          { setColor(rgb); brightness(p); }
+    void flash(int rgb[3], int, int)            { setColor(rgb); off(); }
+    void flash(int rgb[3], int)                 { setColor(rgb); off(); }
+    void fadeIn(int rgb[3], int, int)           { setColor(rgb); }
+    void fadeOut(int rgb[3], int, int)          { setColor(rgb); off(); }
+
+    int m_Red, m_Green, m_Blue, m_Brightness;   // Last requested settings.
+};
+
+#endif // !ARDUINO
+
+#endif // HOSTPLATFORM_H
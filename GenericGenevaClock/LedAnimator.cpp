@@ -0,0 +1,229 @@
+/////////////////////////////////////////////////////////////////////////////////
+// LedAnimator.cpp
+//
+// Contains the implementation of the LedAnimator class.  This plays fades,
+// flashes, and other animations on an RGBLed without blocking.  See
+// LedAnimator.h for more information.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original code.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>                 // For memset().
+#include "LedAnimator.h"            // For LedAnimator class.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// LedAnimator()  (constructor)
+//
+// Constructs an animator with nothing playing and the background off.  The
+// LED is not written till the first Tick().
+/////////////////////////////////////////////////////////////////////////////////
+LedAnimator::LedAnimator(RGBLed &led) :
+    m_Led(led), m_Head(0), m_Count(0), m_Started(false), m_StartMs(0), m_CycleMs(0),
+    m_CyclesLeft(0), m_pBackColor(NULL), m_BackBrightness(0), m_pLastColor(NULL),
+    m_LastBrightness(0), m_Written(false), m_Writes(0)
+{
+    memset(m_Queue, 0, sizeof(m_Queue));
+} // End LedAnimator().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Play(), Queue(), Stop()
+//
+// A queued animation gets its start time from the Tick() that first plays it,
+// unless it follows another, in which case it starts exactly as that one ends.
+/////////////////////////////////////////////////////////////////////////////////
+void LedAnimator::Play(const LedAnimation_t &animation)
+{
+    Stop();
+    Queue(animation);
+} // End Play().
+
+bool LedAnimator::Queue(const LedAnimation_t &animation)
+{
+    if (m_Count >= QUEUE_SIZE)
+    {
+        return false;
+    }
+    m_Queue[(m_Head + m_Count) % QUEUE_SIZE] = animation;
+    if (!m_Count++)
+    {
+        m_Started = false;
+    }
+    return true;
+} // End Queue().
+
+void LedAnimator::Stop()
+{
+    m_Count   = 0;
+    m_Started = false;
+} // End Stop().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetBackground()
+//
+// Sets the color and brightness shown when no animation is playing.  Takes
+// effect at the next Tick().
+/////////////////////////////////////////////////////////////////////////////////
+void LedAnimator::SetBackground(int *pColor, uint8_t brightness)
+{
+    m_pBackColor     = pColor;
+    m_BackBrightness = brightness;
+} // End SetBackground().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Tick()
+//
+// Moves on past any cycles that have ended since the last call, carrying the
+// time over so that a sequence takes exactly as long as its parts however
+// often it is ticked, then shows the level at 'nowMs'.  Cycles of an
+// animation that runs forever are skipped in one step, however long Tick()
+// was not called.
+/////////////////////////////////////////////////////////////////////////////////
+void LedAnimator::Tick(uint32_t nowMs)
+{
+    while (m_Count)
+    {
+        const LedAnimation_t &animation = m_Queue[m_Head];
+        if (!m_Started)
+        {
+            m_Started    = true;
+            m_StartMs    = nowMs;
+            m_CycleMs    = CycleMs(animation);
+            m_CyclesLeft = animation.repeats;
+        }
+
+        uint32_t t = nowMs - m_StartMs;
+        if (!m_CycleMs || (t < m_CycleMs))
+        {
+            Write(animation.pColor, Level(animation, t));
+            return;
+        }
+        if (!m_CyclesLeft)
+        {
+            m_StartMs += (t / m_CycleMs) * m_CycleMs;
+        }
+        else
+        {
+            m_StartMs += m_CycleMs;
+            if (!--m_CyclesLeft)
+            {
+                Next(m_StartMs);
+            }
+        }
+    }
+    Write(m_pBackColor, m_BackBrightness);
+} // End Tick().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Level()
+//
+// Fades are linear in percent, which the eye sees as fast at the bottom, but
+// matches what RGBLed::fadeIn() and fadeOut() did.
+/////////////////////////////////////////////////////////////////////////////////
+uint8_t LedAnimator::Level(const LedAnimation_t &animation, uint32_t t)
+{
+    uint32_t peak = animation.brightness;
+    uint32_t on   = animation.onMs;
+    uint32_t off  = animation.offMs;
+    switch (animation.effect)
+    {
+    case LedSolid:
+        return (!on || (t < on)) ? peak : 0;
+    case LedFadeIn:
+        return (t < on) ? peak * t / on : (t < on + off) ? peak : 0;
+    case LedFadeOut:
+        return (t < on) ? peak * (on - t) / on : 0;
+    case LedFlash:
+    {
+        uint32_t flashes = animation.flashes ? animation.flashes : 1;
+        if (!on || (t >= flashes * (on + off)))
+        {
+            return 0;
+        }
+        return ((t % (on + off)) < on) ? peak : 0;
+    }
+    case LedBreathe:
+        return (t < on) ? peak * t / on : (t < on + off) ? peak * (on + off - t) / off : 0;
+    default:
+        return 0;
+    }
+} // End Level().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// CycleMs()
+/////////////////////////////////////////////////////////////////////////////////
+uint32_t LedAnimator::CycleMs(const LedAnimation_t &animation)
+{
+    uint32_t cycle = animation.onMs + animation.offMs;
+    if (animation.effect == LedSolid)
+    {
+        cycle = animation.onMs;
+    }
+    else if (animation.effect == LedFlash)
+    {
+        cycle *= animation.flashes ? animation.flashes : 1;
+    }
+    return cycle + animation.pauseMs;
+} // End CycleMs().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Next()
+/////////////////////////////////////////////////////////////////////////////////
+void LedAnimator::Next(uint32_t nowMs)
+{
+    m_Head = (m_Head + 1) % QUEUE_SIZE;
+    m_Count--;
+    if (m_Count)
+    {
+        m_Started    = true;
+        m_StartMs    = nowMs;
+        m_CycleMs    = CycleMs(m_Queue[m_Head]);
+        m_CyclesLeft = m_Queue[m_Head].repeats;
+    }
+    else
+    {
+        m_Started = false;
+    }
+} // End Next().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Write()
+//
+// Writing the LED costs several LEDC register writes on the ESP32, so it is
+// only done when what it shows changes.  Off is written as off, whatever the
+// color.
+/////////////////////////////////////////////////////////////////////////////////
+void LedAnimator::Write(int *pColor, uint8_t brightness)
+{
+    if (!pColor || !brightness)
+    {
+        pColor     = NULL;
+        brightness = 0;
+    }
+    if (m_Written && (pColor == m_pLastColor) && (brightness == m_LastBrightness))
+    {
+        return;
+    }
+    if (pColor)
+    {
+        m_Led.brightness(pColor, brightness);
+    }
+    else
+    {
+        m_Led.off();
+    }
+    m_pLastColor     = pColor;
+    m_LastBrightness = brightness;
+    m_Written        = true;
+    m_Writes++;
+} // End Write().
@@ -0,0 +1,212 @@
+/////////////////////////////////////////////////////////////////////////////////
+// LedAnimator.h
+//
+// Contains the LedAnimator class.  This plays fades, flashes, and other
+// animations on an RGBLed without blocking.  The RGBLed library's own fadeIn(),
+// fadeOut(), and flash() calls delay() between frames, stalling whatever
+// called them for the length of the animation.  LedAnimator instead works out
+// the LED's brightness from the time each time Tick() is called, from a
+// scheduler task or a timer, and only writes the LED when its brightness
+// changes.
+//
+// Animations are described by LedAnimation_t, and are either played at once
+// (Play()) or queued to follow the one playing (Queue()).  When none are
+// playing, the LED shows a background color (SetBackground()).
+//
+// Example:
+//      LedAnimator animator(GenericClockBoard::RgbLed);
+//      LedAnimation_t fade = { LedFadeIn, RGBLed::BLUE, 100, 750, 0, 1, 0, 0 };
+//      animator.Play(fade);
+//      ...
+//      void LedTask(void *pArg) { animator.Tick(millis()); }
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined LEDANIMATOR_H
+#define LEDANIMATOR_H
+
+#include <stdint.h>             // For standard integer types.
+#include <stddef.h>             // For NULL.
+#include "SerialDebugSetup.h"   // For common SerialDebug options.
+#if defined ARDUINO
+#include <RGBLed.h>             // For RGBLed class.
+#endif
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// LedEffect_t
+//
+// The effects an animation may have.  Each runs 'repeats' cycles, each ending
+// with 'pauseMs' off, as follows:
+//  LedSolid    - 'color' at 'brightness' for 'onMs'.  If the whole cycle is 0
+//                ms long, it is shown till replaced.
+//  LedFadeIn   - From off up to 'brightness' over 'onMs', then holds it for
+//                'offMs'.
+//  LedFadeOut  - From 'brightness' down to off over 'onMs', then off for
+//                'offMs'.
+//  LedFlash    - 'flashes' flashes, each on for 'onMs' then off for 'offMs'.
+//  LedBreathe  - From off up to 'brightness' over 'onMs', then back down over
+//                'offMs'.
+/////////////////////////////////////////////////////////////////////////////////
+enum LedEffect_t
+{
+    LedSolid = 0,
+    LedFadeIn,
+    LedFadeOut,
+    LedFlash,
+    LedBreathe
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// LedAnimation_t
+//
+// Describes one animation.  Durations are in ms.
+//      effect     - What the animation does (see LedEffect_t).
+//      pColor     - Color, as one of the RGBLed color arrays (e.g.
+//                   RGBLed::RED).
+//      brightness - Peak brightness in percent.
+//      onMs       - Length of the first part of each cycle (see LedEffect_t).
+//      offMs      - Length of the second part of each cycle.
+//      repeats    - Cycles to run, or 0 to run till replaced.
+//      flashes    - LedFlash flashes per cycle (0 is taken as 1).
+//      pauseMs    - Time off at the end of each cycle, e.g. between groups
+//                   of flashes.
+/////////////////////////////////////////////////////////////////////////////////
+struct LedAnimation_t
+{
+    LedEffect_t effect;         // What to do.
+    int     *pColor;            // RGBLed color array.
+    uint8_t  brightness;        // Peak brightness (percent).
+    uint16_t onMs;              // First part of each cycle.
+    uint16_t offMs;             // Second part of each cycle.
+    uint16_t repeats;           // Cycles, or 0 for forever.
+    uint16_t flashes;           // LedFlash flashes per cycle.
+    uint16_t pauseMs;           // Off time at the end of each cycle.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// LedAnimator class
+//
+// Plays LedAnimation_t animations on an RGBLed from a periodic Tick().
+/////////////////////////////////////////////////////////////////////////////////
+class LedAnimator
+{
+public:
+    static const uint32_t QUEUE_SIZE = 8;       // Most animations queued.
+
+    /////////////////////////////////////////////////////////////////////////////
+    // LedAnimator()  (constructor)
+    //
+    // Arguments:
+    //   - led - The LED to animate.  Nothing else should write it.
+    /////////////////////////////////////////////////////////////////////////////
+    LedAnimator(RGBLed &led);
+
+    // Destructor.
+    ~LedAnimator() {}
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Animations.
+    //
+    // Play()          - Drops any playing or queued animations and plays
+    //                   'animation' from the next Tick().
+    // Queue()         - Queues 'animation' to play after the others.  Returns
+    //                   'false' if the queue is full.
+    // Stop()          - Drops all animations, leaving the background.
+    // SetBackground() - Sets the color and brightness shown when no animation
+    //                   is playing.  A NULL color or 0 brightness is off.
+    // IsIdle()        - Returns 'true' if no animation is playing.
+    /////////////////////////////////////////////////////////////////////////////
+    void Play(const LedAnimation_t &animation);
+    bool Queue(const LedAnimation_t &animation);
+    void Stop();
+    void SetBackground(int *pColor, uint8_t brightness);
+    bool IsIdle() const                             { return m_Count == 0; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Tick()
+    //
+    // Advances the animation to 'nowMs' (e.g. millis()), and writes the LED
+    // if its color or brightness changed.  Call at the frame rate wanted; every
+    // 20 ms is smooth.  Times wrap after 49 days, which is harmless.
+    /////////////////////////////////////////////////////////////////////////////
+    void Tick(uint32_t nowMs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Accessors.
+    //
+    // Writes()     - Returns the number of times the LED has been written.
+    // Brightness() - Returns the brightness last written (percent).
+    // Color()      - Returns the color last written, or NULL if off.
+    /////////////////////////////////////////////////////////////////////////////
+    uint32_t Writes() const                         { return m_Writes; }
+    uint8_t  Brightness() const                     { return m_LastBrightness; }
+    int     *Color() const                          { return m_pLastColor; }
+
+private:
+    /////////////////////////////////////////////////////////////////////////////
+    // Private methods.
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Level()
+    //
+    // Returns the brightness of 'animation' 't' ms into one of its cycles.
+    /////////////////////////////////////////////////////////////////////////////
+    static uint8_t Level(const LedAnimation_t &animation, uint32_t t);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // CycleMs()
+    //
+    // Returns the length of one cycle of 'animation'.
+    /////////////////////////////////////////////////////////////////////////////
+    static uint32_t CycleMs(const LedAnimation_t &animation);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Next()
+    //
+    // Drops the playing animation and starts the next queued one at 'nowMs'.
+    /////////////////////////////////////////////////////////////////////////////
+    void Next(uint32_t nowMs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Write()
+    //
+    // Writes 'pColor' at 'brightness' to the LED, unless that is what it
+    // already shows.
+    /////////////////////////////////////////////////////////////////////////////
+    void Write(int *pColor, uint8_t brightness);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Unimplemented methods.  We don't want users to try to use these.
+    /////////////////////////////////////////////////////////////////////////////
+    LedAnimator(LedAnimator const &);
+    LedAnimator &operator=(LedAnimator &la);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private instance data.
+    /////////////////////////////////////////////////////////////////////////////
+    RGBLed  &m_Led;                 // LED being animated.
+    LedAnimation_t m_Queue[QUEUE_SIZE];
+                                    // Playing animation, then queued ones.
+    uint32_t m_Head;                // Index of the playing animation.
+    uint32_t m_Count;               // Playing and queued animations.
+    bool     m_Started;             // True once the playing one has a start.
+    uint32_t m_StartMs;             // When the current cycle started.
+    uint32_t m_CycleMs;             // Length of a cycle of the playing one.
+    uint32_t m_CyclesLeft;          // Cycles left, 0 for forever.
+    int     *m_pBackColor;          // Background color, or NULL.
+    uint8_t  m_BackBrightness;      // Background brightness.
+    int     *m_pLastColor;          // Color last written, or NULL if off.
+    uint8_t  m_LastBrightness;      // Brightness last written.
+    bool     m_Written;             // True once the LED has been written.
+    uint32_t m_Writes;              // Times the LED was written.
+
+}; // End class LedAnimator
+
+#endif // LEDANIMATOR_H
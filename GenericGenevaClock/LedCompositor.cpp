@@ -0,0 +1,152 @@
+/////////////////////////////////////////////////////////////////////////////////
+// LedCompositor.cpp
+//
+// Contains the implementation of the LedCompositor class.  This shows the
+// highest priority active status layer on the RGB LED, keeping each pattern
+// visible for its minimum time.  See LedCompositor.h for more information.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original code.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>                 // For memset().
+#include "LedCompositor.h"          // For LedCompositor class.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// LedCompositor()  (constructor)
+//
+// Constructs a compositor with no patterns and every layer clear.  The
+// animator's background is left as it is, and shows when no layer is active.
+/////////////////////////////////////////////////////////////////////////////////
+LedCompositor::LedCompositor(LedAnimator &animator) :
+    m_Animator(animator), m_NumPatterns(0), m_Top(NUM_LED_LAYERS),
+    m_TopPattern(INVALID_PATTERN), m_TopSequence(0), m_LastMs(0), m_Ticked(false)
+{
+    memset(m_Patterns, 0, sizeof(m_Patterns));
+    memset(m_Layers, 0, sizeof(m_Layers));
+    for (uint32_t i = 0; i < NUM_LED_LAYERS; i++)
+    {
+        m_SetWords[i].store(0);
+        m_ClearSequences[i].store(0);
+    }
+} // End LedCompositor().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// AddPattern()
+/////////////////////////////////////////////////////////////////////////////////
+uint8_t LedCompositor::AddPattern(const LedAnimation_t &animation, uint32_t minMs)
+{
+    if (m_NumPatterns >= MAX_PATTERNS)
+    {
+        return INVALID_PATTERN;
+    }
+    m_Patterns[m_NumPatterns].animation = animation;
+    m_Patterns[m_NumPatterns].minMs     = minMs;
+    return (uint8_t)m_NumPatterns++;
+} // End AddPattern().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Set(), Clear()
+//
+// Set() bumps the layer's sequence number with a compare and swap, so that two
+// tasks setting the same layer at once each get their own sequence, and the
+// last one stored wins.  A set is never lost to Tick(): if several land
+// between ticks, only the last is shown, which is what a layer means.
+//
+// Clear() records the sequence it saw, so a set that races ahead of it is not
+// cleared by it.
+/////////////////////////////////////////////////////////////////////////////////
+void LedCompositor::Set(LedLayer_t layer, uint8_t pattern)
+{
+    if (layer >= NUM_LED_LAYERS)
+    {
+        return;
+    }
+    uint32_t word = m_SetWords[layer].load(std::memory_order_relaxed);
+    while (!m_SetWords[layer].compare_exchange_weak(word,
+                (((word >> 8) + 1) << 8) | pattern,
+                std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+} // End Set().
+
+void LedCompositor::Clear(LedLayer_t layer)
+{
+    if (layer >= NUM_LED_LAYERS)
+    {
+        return;
+    }
+    m_ClearSequences[layer].store(m_SetWords[layer].load(std::memory_order_acquire) >> 8,
+                                  std::memory_order_release);
+} // End Clear().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Tick()
+//
+// The time since the last call is counted against the pattern that was on
+// top for it, before any new posts are taken in, so a pattern's minimum time
+// is time it was actually seen.  A cleared layer under a higher one keeps its
+// pattern till the higher layers go, and is then shown for what is left of
+// its minimum time.
+/////////////////////////////////////////////////////////////////////////////////
+void LedCompositor::Tick(uint32_t nowMs)
+{
+    if (m_Ticked && (m_Top < NUM_LED_LAYERS))
+    {
+        m_Layers[m_Top].visibleMs += nowMs - m_LastMs;
+    }
+    m_LastMs = nowMs;
+    m_Ticked = true;
+
+    uint32_t top = NUM_LED_LAYERS;
+    for (uint32_t i = 0; i < NUM_LED_LAYERS; i++)
+    {
+        Layer_t &layer    = m_Layers[i];
+        uint32_t word     = m_SetWords[i].load(std::memory_order_acquire);
+        uint32_t sequence = word >> 8;
+        if (sequence != layer.sequence)
+        {
+            layer.sequence  = sequence;
+            layer.pattern   = (uint8_t)(word & 0xff);
+            layer.active    = layer.pattern < m_NumPatterns;
+            layer.clearing  = false;
+            layer.visibleMs = 0;
+        }
+        if (m_ClearSequences[i].load(std::memory_order_acquire) == sequence)
+        {
+            layer.clearing = true;
+        }
+        if (layer.active && layer.clearing &&
+            (layer.visibleMs >= m_Patterns[layer.pattern].minMs))
+        {
+            layer.active = false;
+        }
+        if (layer.active)
+        {
+            top = i;
+        }
+    }
+
+    if (top >= NUM_LED_LAYERS)
+    {
+        if (m_Top < NUM_LED_LAYERS)
+        {
+            m_Animator.Stop();
+        }
+        m_TopPattern = INVALID_PATTERN;
+    }
+    else if ((top != m_Top) || (m_Layers[top].sequence != m_TopSequence))
+    {
+        m_TopPattern  = m_Layers[top].pattern;
+        m_TopSequence = m_Layers[top].sequence;
+        m_Animator.Play(m_Patterns[m_TopPattern].animation);
+    }
+    m_Top = top;
+    m_Animator.Tick(nowMs);
+} // End Tick().
@@ -0,0 +1,179 @@
+/////////////////////////////////////////////////////////////////////////////////
+// LedCompositor.h
+//
+// Contains the LedCompositor class.  This decides what the RGB LED shows when
+// several things want it at once.  Each kind of status has its own layer, and
+// the LED shows the highest layer that is active:
+//      LedLayerFatal  - An error that stops the clock.
+//      LedLayerHoming - The clock is homing.
+//      LedLayerEvent  - A passing event, such as a time sync.
+//      LedLayerSteady - The time source in use.
+//
+// What a layer shows is one of a small set of patterns (LedAnimation_t
+// animations) registered up front, each with a minimum display time.  Once a
+// pattern has been set on a layer, it stays until it has been visible for its
+// minimum time, even if the layer is cleared sooner, so that an event that is
+// over in a moment, or that happens while a higher layer is showing, is still
+// seen.  Pulse() sets a pattern and clears it at once, so it is shown for
+// exactly its minimum time.
+//
+// Set(), Clear(), and Pulse() post to a lock-free mailbox, one word per layer,
+// and may be called from any task or callback, on either core.  Only the task
+// that calls Tick() touches the LED, through a LedAnimator.
+//
+// Example:
+//      LedCompositor compositor(animator);
+//      uint8_t sync = compositor.AddPattern(magentaFlash, 1000);
+//      ...
+//      compositor.Pulse(LedLayerEvent, sync);  // From a callback.
+//      ...
+//      void LedTask(void *pArg) { compositor.Tick(millis()); }
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined LEDCOMPOSITOR_H
+#define LEDCOMPOSITOR_H
+
+#include <stdint.h>             // For standard integer types.
+#include <atomic>               // For std::atomic.
+#include "LedAnimator.h"        // For LedAnimator and LedAnimation_t.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// LedLayer_t
+//
+// The compositor's layers, lowest priority first.
+/////////////////////////////////////////////////////////////////////////////////
+enum LedLayer_t
+{
+    LedLayerSteady = 0,
+    LedLayerEvent,
+    LedLayerHoming,
+    LedLayerFatal,
+    NUM_LED_LAYERS
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// LedCompositor class
+//
+// Shows the highest priority active layer's pattern on a LedAnimator.
+/////////////////////////////////////////////////////////////////////////////////
+class LedCompositor
+{
+public:
+    static const uint32_t MAX_PATTERNS    = 16;     // Most patterns.
+    static const uint8_t  INVALID_PATTERN = 0xff;   // Returned if none fit.
+
+    /////////////////////////////////////////////////////////////////////////////
+    // LedCompositor()  (constructor)
+    //
+    // Arguments:
+    //   - animator - Plays the patterns.  Only Tick() may use it from then on.
+    /////////////////////////////////////////////////////////////////////////////
+    LedCompositor(LedAnimator &animator);
+
+    // Destructor.
+    ~LedCompositor() {}
+
+    /////////////////////////////////////////////////////////////////////////////
+    // AddPattern()
+    //
+    // Registers a pattern, and returns its id for Set() and Pulse(), or
+    // INVALID_PATTERN if no more fit.  Only call from the task that calls
+    // Tick(), for example from setup().
+    //
+    // Arguments:
+    //   - animation - What the pattern shows.  An animation that ends leaves
+    //                 the LED off till the layer is cleared.
+    //   - minMs     - Least time the pattern is visible once set.
+    /////////////////////////////////////////////////////////////////////////////
+    uint8_t AddPattern(const LedAnimation_t &animation, uint32_t minMs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Posting.  May be called from any task.  Takes effect at the next Tick().
+    //
+    // Set()   - Shows 'pattern' on 'layer' till the layer is cleared, or
+    //           another pattern is set on it.  Setting a layer again restarts
+    //           its pattern and minimum time.
+    // Clear() - Clears 'layer' once its pattern has been visible for the
+    //           pattern's minimum time.
+    // Pulse() - Shows 'pattern' on 'layer' for the pattern's minimum time.
+    /////////////////////////////////////////////////////////////////////////////
+    void Set(LedLayer_t layer, uint8_t pattern);
+    void Clear(LedLayer_t layer);
+    void Pulse(LedLayer_t layer, uint8_t pattern)   { Set(layer, pattern); Clear(layer); }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Tick()
+    //
+    // Takes in the posts made since the last call, works out the top layer,
+    // and ticks the animator.  Call periodically, e.g. every 20 ms.
+    /////////////////////////////////////////////////////////////////////////////
+    void Tick(uint32_t nowMs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Accessors.
+    //
+    // TopLayer()   - Returns the layer being shown, or NUM_LED_LAYERS if none.
+    // TopPattern() - Returns the pattern being shown, or INVALID_PATTERN.
+    /////////////////////////////////////////////////////////////////////////////
+    uint32_t TopLayer() const                       { return m_Top; }
+    uint8_t  TopPattern() const                     { return m_TopPattern; }
+
+private:
+    /////////////////////////////////////////////////////////////////////////////
+    // Private types.
+    /////////////////////////////////////////////////////////////////////////////
+
+    // A registered pattern.
+    struct Pattern_t
+    {
+        LedAnimation_t animation;   // What it shows.
+        uint32_t minMs;             // Least time visible once set.
+    };
+
+    // What Tick() knows of a layer.
+    struct Layer_t
+    {
+        uint32_t sequence;          // Sequence of the last set taken in.
+        uint8_t  pattern;           // Pattern set.
+        bool     active;            // True while the pattern is shown.
+        bool     clearing;          // True once the layer has been cleared.
+        uint32_t visibleMs;         // Time the pattern has been on top.
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Unimplemented methods.  We don't want users to try to use these.
+    /////////////////////////////////////////////////////////////////////////////
+    LedCompositor(LedCompositor const &);
+    LedCompositor &operator=(LedCompositor &lc);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private instance data.
+    /////////////////////////////////////////////////////////////////////////////
+    LedAnimator &m_Animator;        // Plays the top pattern.
+    Pattern_t m_Patterns[MAX_PATTERNS];
+                                    // Registered patterns.
+    uint32_t  m_NumPatterns;        // Number of registered patterns.
+    Layer_t   m_Layers[NUM_LED_LAYERS];
+                                    // Tick()'s view of each layer.
+    uint32_t  m_Top;                // Layer shown, or NUM_LED_LAYERS.
+    uint8_t   m_TopPattern;         // Pattern shown, or INVALID_PATTERN.
+    uint32_t  m_TopSequence;        // Sequence of the pattern shown.
+    uint32_t  m_LastMs;             // Time of the last Tick().
+    bool      m_Ticked;             // True once Tick() has been called.
+
+    // The mailbox.  Each set stores the layer's next sequence number in the
+    // upper 24 bits of its set word, with the pattern in the low 8.  Each
+    // clear stores the sequence of the set it clears, so that a clear posted
+    // before a set never clears it.
+    std::atomic<uint32_t> m_SetWords[NUM_LED_LAYERS];
+    std::atomic<uint32_t> m_ClearSequences[NUM_LED_LAYERS];
+
+}; // End class LedCompositor
+
+#endif // LEDCOMPOSITOR_H
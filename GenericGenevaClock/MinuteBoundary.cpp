@@ -0,0 +1,106 @@
+/////////////////////////////////////////////////////////////////////////////////
+// MinuteBoundary.cpp
+//
+// Contains the implementation of the MinuteBoundary class.  This works out
+// the HAL time of the next local minute boundary from readings of the time.
+// See MinuteBoundary.h for more information.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original code.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include "MinuteBoundary.h"         // For MinuteBoundary class.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// MinuteBoundary()  (constructor)
+//
+// Constructs an instance with no readings, which wants a reading at once.
+/////////////////////////////////////////////////////////////////////////////////
+MinuteBoundary::MinuteBoundary(uint32_t guardUs, uint32_t pollUs) :
+    m_GuardUs(guardUs), m_PollUs(pollUs), m_Started(false), m_Minute(0), m_LastUs(0),
+    m_WindowStartUs(0), m_WindowEndUs(0), m_Locked(false), m_BoundaryUs(0),
+    m_UncertainUs(0)
+{
+} // End MinuteBoundary().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Observe()
+//
+// Minutes are numbered from the year, day of the year, hour, and minute, so
+// that any change of the local minute counts, including a DST change or a
+// jump of the time source.  A change is only trusted to fix the phase of the
+// minute if it was seen within the guard time of the reading before it, and
+// at the start of a minute; anything else is a jump, and the next change is
+// found again from the seconds.
+/////////////////////////////////////////////////////////////////////////////////
+bool MinuteBoundary::Observe(uint64_t nowUs, const tm &local)
+{
+    const uint64_t MINUTE_US = 60000000;
+    int32_t minute = ((local.tm_year * 366 + local.tm_yday) * 24 + local.tm_hour) * 60 +
+                     local.tm_min;
+    bool changed = !m_Started || (minute != m_Minute);
+    if (!m_Started)
+    {
+        m_Started = true;
+        FindFromSeconds(nowUs, local.tm_sec);
+    }
+    else if (changed)
+    {
+        uint64_t sinceUs = nowUs - m_LastUs;
+        if ((sinceUs <= m_GuardUs) && (local.tm_sec == 0))
+        {
+            m_Locked        = true;
+            m_WindowStartUs = m_LastUs + MINUTE_US - m_GuardUs;
+            m_WindowEndUs   = nowUs + MINUTE_US + m_GuardUs;
+        }
+        else
+        {
+            FindFromSeconds(nowUs, local.tm_sec);
+        }
+        m_UncertainUs = static_cast<uint32_t>((sinceUs < MINUTE_US) ? sinceUs : MINUTE_US);
+    }
+    else if (nowUs > m_WindowEndUs)
+    {
+        FindFromSeconds(nowUs, local.tm_sec);
+    }
+
+    if (changed)
+    {
+        m_BoundaryUs = nowUs;
+    }
+    m_Minute = minute;
+    m_LastUs = nowUs;
+    return changed;
+} // End Observe().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// NextWakeUs()
+//
+// Sleeps till the window opens, then polls.
+/////////////////////////////////////////////////////////////////////////////////
+uint64_t MinuteBoundary::NextWakeUs() const
+{
+    uint64_t pollUs = m_LastUs + m_PollUs;
+    return (pollUs > m_WindowStartUs) ? pollUs : m_WindowStartUs;
+} // End NextWakeUs().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// FindFromSeconds()
+//
+// The reading's second started at or before 'nowUs', so the minute ends more
+// than 59 - 'seconds' seconds later, and at most 60 - 'seconds' seconds later.
+// A leap second (60) is taken as 59.
+/////////////////////////////////////////////////////////////////////////////////
+void MinuteBoundary::FindFromSeconds(uint64_t nowUs, int seconds)
+{
+    uint64_t left   = (seconds < 0) ? 60 : (seconds > 59) ? 1 : 60 - seconds;
+    m_Locked        = false;
+    m_WindowStartUs = nowUs + (left - 1) * 1000000;
+    m_WindowEndUs   = nowUs + left * 1000000 + m_GuardUs;
+} // End FindFromSeconds().
@@ -0,0 +1,146 @@
+/////////////////////////////////////////////////////////////////////////////////
+// MinuteBoundary.h
+//
+// Contains the MinuteBoundary class.  This works out when the next local
+// minute starts, as a HAL time (ClockBoardHal::Micros()), so that the sketch's
+// minute task can sleep till then instead of reading the time several times a
+// second to see if the minute has changed.
+//
+// The time is only read to the second, so the sub-second phase of the minute
+// is found by watching for the change: the task is woken a guard time before
+// the minute is expected to change, then every poll time till it does.  The
+// minute then changed between the last two reads, and the next one is 60
+// seconds later, give or take the guard time for drift between the HAL clock
+// and the time source.  If the time source jumps, e.g. on an NTP correction,
+// or the change is not seen in the expected window, the next change is found
+// again from the seconds, which takes up to a second of polling.
+//
+// Time zone offsets are whole minutes (in practice quarter hours), so the
+// local minute always changes on a UTC minute boundary, and so does a daylight
+// saving time change.  A DST change is simply a minute whose local time is an
+// hour away from the last one's, and is shown as soon as it starts.
+//
+// The class has no hardware dependencies, so it can be tested on the host.
+//
+// Example:
+//      MinuteBoundary boundary;
+//      ...
+//      void MinuteTask(void *pArg)
+//      {
+//          tm now;
+//          gpWtm->GetLocalTime(&now);
+//          if (boundary.Observe(hal.Micros(), now)) { ...update the clock... }
+//          scheduler.RunAt(minuteTask, boundary.NextWakeUs());
+//      }
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined MINUTEBOUNDARY_H
+#define MINUTEBOUNDARY_H
+
+#include <stdint.h>             // For standard integer types.
+#include <time.h>               // For struct tm.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// MinuteBoundary class
+//
+// Finds the HAL time of the next local minute boundary.
+/////////////////////////////////////////////////////////////////////////////////
+class MinuteBoundary
+{
+public:
+    static const uint32_t GUARD_US = 20000;     // Default guard time.
+    static const uint32_t POLL_US  = 1000;      // Default poll time.
+
+    /////////////////////////////////////////////////////////////////////////////
+    // MinuteBoundary()  (constructor)
+    //
+    // Arguments:
+    //   - guardUs - Time before the expected minute change to start polling,
+    //               and after it to give up and find it again.  Must cover
+    //               the HAL clock's drift over a minute (20 ms is 330 ppm).
+    //   - pollUs  - Time between reads while waiting for the minute to change.
+    /////////////////////////////////////////////////////////////////////////////
+    MinuteBoundary(uint32_t guardUs = GUARD_US, uint32_t pollUs = POLL_US);
+
+    // Destructor.
+    ~MinuteBoundary() {}
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Observe()
+    //
+    // Passes in a reading of the local time.  Returns 'true' if the minute
+    // changed since the last reading (or this is the first).
+    //
+    // Arguments:
+    //   - nowUs - HAL time of the reading.
+    //   - local - Local time read.
+    /////////////////////////////////////////////////////////////////////////////
+    bool Observe(uint64_t nowUs, const tm &local);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Restart()
+    //
+    // Forgets the phase of the minute, e.g. after the time source was set.
+    // The next reading is taken as a change, and wanted at once.
+    /////////////////////////////////////////////////////////////////////////////
+    void Restart()                                  { m_Started = false;
+                                                      m_WindowStartUs = 0; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Accessors.
+    //
+    // NextWakeUs()  - Returns the HAL time of the next reading wanted.
+    // IsLocked()    - Returns 'true' if the last minute change was seen
+    //                 within the guard time, and the next will be polled for
+    //                 only around its expected time.
+    // BoundaryUs()  - Returns the latest HAL time the last minute change can
+    //                 have happened at (the reading that saw it).
+    // UncertainUs() - Returns how much earlier the last change may have been.
+    /////////////////////////////////////////////////////////////////////////////
+    uint64_t NextWakeUs() const;
+    bool     IsLocked() const                       { return m_Locked; }
+    uint64_t BoundaryUs() const                     { return m_BoundaryUs; }
+    uint32_t UncertainUs() const                    { return m_UncertainUs; }
+
+private:
+    /////////////////////////////////////////////////////////////////////////////
+    // Private methods.
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    // FindFromSeconds()
+    //
+    // Sets the window for the next minute change from the seconds of a
+    // reading at 'nowUs'.
+    /////////////////////////////////////////////////////////////////////////////
+    void FindFromSeconds(uint64_t nowUs, int seconds);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Unimplemented methods.  We don't want users to try to use these.
+    /////////////////////////////////////////////////////////////////////////////
+    MinuteBoundary(MinuteBoundary const &);
+    MinuteBoundary &operator=(MinuteBoundary &mb);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private instance data.
+    /////////////////////////////////////////////////////////////////////////////
+    uint32_t m_GuardUs;             // Guard time.
+    uint32_t m_PollUs;              // Poll time.
+    bool     m_Started;             // True once a reading was passed in.
+    int32_t  m_Minute;              // Minute of the last reading (see
+                                    // Observe()).
+    uint64_t m_LastUs;              // HAL time of the last reading.
+    uint64_t m_WindowStartUs;       // Earliest the next change is expected.
+    uint64_t m_WindowEndUs;         // Latest the next change is expected.
+    bool     m_Locked;              // True if the window came from a change.
+    uint64_t m_BoundaryUs;          // Reading that saw the last change.
+    uint32_t m_UncertainUs;         // Time since the reading before it.
+
+}; // End class MinuteBoundary
+
+#endif // MINUTEBOUNDARY_H
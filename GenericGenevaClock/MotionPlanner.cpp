@@ -0,0 +1,271 @@
+/////////////////////////////////////////////////////////////////////////////////
+// MotionPlanner.cpp
+//
+// Contains the implementation of the MotionPlanner class.  This class computes
+// per-step intervals for stepper moves from trapezoidal or S-curve motion
+// profiles.  See MotionPlanner.h for more information.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original code.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include "MotionPlanner.h"          // For MotionPlanner class.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// MotionPlanner()  (constructor)
+//
+// Constructs an empty planner.  Until a profile is added, every step uses a
+// conservative 2 ms interval.
+/////////////////////////////////////////////////////////////////////////////////
+MotionPlanner::MotionPlanner() :
+    m_NumProfiles(0), m_Selected(0), m_StartVelocity(100),
+    m_MaxVelocity(UINT32_MAX), m_MaxAcceleration(UINT32_MAX)
+{
+    ClearProfiles();
+} // End MotionPlanner().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ClearProfiles()
+//
+// Removes all profiles.  Until a profile is added, every step uses a
+// conservative 2 ms interval.
+/////////////////////////////////////////////////////////////////////////////////
+void MotionPlanner::ClearProfiles()
+{
+    const uint32_t DEFAULT_INTERVAL_US = 2000;
+    for (uint32_t i = 0; i < MAX_PROFILES; i++)
+    {
+        m_Ramps[i].ramp.pIntervalUs = m_Ramps[i].table;
+        m_Ramps[i].ramp.length      = 0;
+        m_Ramps[i].ramp.cruiseUs    = DEFAULT_INTERVAL_US;
+        m_Ramps[i].ramp.shift       = 0;
+    }
+    m_NumProfiles = 0;
+    m_Selected    = 0;
+} // End ClearProfiles().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetMotorLimits()
+//
+// Sets the motor limits and reselects the fastest profile within them.
+/////////////////////////////////////////////////////////////////////////////////
+void MotionPlanner::SetMotorLimits(uint32_t maxVelocity, uint32_t maxAcceleration)
+{
+    m_MaxVelocity     = maxVelocity;
+    m_MaxAcceleration = maxAcceleration;
+    SelectFastest();
+} // End SetMotorLimits().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// AddProfile()
+//
+// Adds a profile, precomputes its ramp, and reselects the fastest profile.
+/////////////////////////////////////////////////////////////////////////////////
+bool MotionPlanner::AddProfile(const MotionProfile_t &profile)
+{
+    if (m_NumProfiles >= MAX_PROFILES)
+    {
+        return false;
+    }
+    Ramp_t &ramp = m_Ramps[m_NumProfiles];
+    ramp.profile = profile;
+    ramp.ramp.pIntervalUs = ramp.table;
+    // Coarsen the ramp until it fits.
+    uint32_t shift = 0;
+    while (!ComputeRamp(ramp, shift) && (shift < MAX_RAMP_SHIFT))
+    {
+        shift++;
+    }
+    m_NumProfiles++;
+    SelectFastest();
+    return true;
+} // End AddProfile().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// AddProfile()
+//
+// Adds a profile with a precomputed ramp and reselects the fastest profile.
+/////////////////////////////////////////////////////////////////////////////////
+bool MotionPlanner::AddProfile(const MotionProfile_t &profile, const StepRamp_t &ramp)
+{
+    if (m_NumProfiles >= MAX_PROFILES)
+    {
+        return false;
+    }
+    m_Ramps[m_NumProfiles].profile = profile;
+    m_Ramps[m_NumProfiles].ramp    = ramp;
+    m_NumProfiles++;
+    SelectFastest();
+    return true;
+} // End AddProfile().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ReportMissedSteps()
+//
+// Lowers the motor limits to just below the selected profile and selects the
+// next slower profile, if any.
+/////////////////////////////////////////////////////////////////////////////////
+bool MotionPlanner::ReportMissedSteps()
+{
+    uint32_t previous = m_Selected;
+    if (previous + 1 >= m_NumProfiles)
+    {
+        return false;
+    }
+    m_MaxVelocity = m_Ramps[previous].profile.maxVelocity - 1;
+    SelectFastest();
+    return m_Selected != previous;
+} // End ReportMissedSteps().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// MoveDurationUs()
+//
+// Returns the total duration of a move using the selected profile.  Only the
+// ramps are summed step by step, since every step between them is at the
+// cruise interval.
+/////////////////////////////////////////////////////////////////////////////////
+uint64_t MotionPlanner::MoveDurationUs(int32_t absSteps) const
+{
+    int32_t  rampSteps = static_cast<int32_t>(RampLength());
+    uint64_t total     = 0;
+    if (absSteps > 2 * rampSteps)
+    {
+        for (int32_t j = 0; j < rampSteps; j++)
+        {
+            total += 2 * IntervalUs(j, absSteps);
+        }
+        return total + static_cast<uint64_t>(absSteps - 2 * rampSteps) *
+                       SelectedRamp().cruiseUs;
+    }
+    for (int32_t j = 0; j < absSteps; j++)
+    {
+        total += IntervalUs(j, absSteps);
+    }
+    return total;
+} // End MoveDurationUs().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ComputeRamp()
+//
+// Integrates the motion from the start velocity up to the cruise velocity in
+// small time increments, recording the time at which each group of 2^shift
+// steps is crossed.  Each entry is the group's average step interval.
+// For S-curves, the acceleration is ramped up at the jerk limit, and is ramped
+// back down early enough to reach the cruise velocity with zero acceleration.
+// Single precision is used since the ESP32 has hardware support for it.
+/////////////////////////////////////////////////////////////////////////////////
+bool MotionPlanner::ComputeRamp(Ramp_t &ramp, uint32_t shift) const
+{
+    const float DT        = 25.0e-6f;   // Integration step (seconds).
+    const float US_PER_S  = 1.0e6f;
+    const float MAX_INTERVAL_US = 65535.0f; // Fits in uint16_t.
+
+    const float vMax = static_cast<float>(ramp.profile.maxVelocity);
+    const float aMax = static_cast<float>(ramp.profile.acceleration);
+    const float jerk = static_cast<float>(ramp.profile.jerk);
+
+    // Never let the acceleration decay completely, or we would never arrive.
+    const float aMin = aMax * 0.02f;
+
+    float    v = static_cast<float>(m_StartVelocity);
+    float    a = (jerk > 0.0f) ? 0.0f : aMax;
+    float    x = 0.0f;
+    float    t = 0.0f;
+    float    lastT = 0.0f;
+    uint32_t k = 0;
+    const float groupSteps = static_cast<float>(1UL << shift);
+
+    while ((k < MAX_RAMP_STEPS) && (v < vMax) && (aMax > 0.0f))
+    {
+        if (jerk > 0.0f)
+        {
+            // Begin easing off while the remaining velocity gain from
+            // reducing the acceleration to zero would overshoot.
+            if (v + (a * a) / (2.0f * jerk) >= vMax)
+            {
+                a -= jerk * DT;
+                if (a < aMin)
+                {
+                    a = aMin;
+                }
+            }
+            else
+            {
+                a += jerk * DT;
+                if (a > aMax)
+                {
+                    a = aMax;
+                }
+            }
+        }
+
+        v += a * DT;
+        if (v > vMax)
+        {
+            v = vMax;
+        }
+        x += v * DT;
+        t += DT;
+
+        // Record each group crossed during this increment, interpolating the
+        // exact crossing time so the intervals are not quantized to DT.
+        while ((x >= (k + 1) * groupSteps) && (k < MAX_RAMP_STEPS))
+        {
+            float crossT     = t - (x - (k + 1) * groupSteps) / v;
+            float intervalUs = (crossT - lastT) * US_PER_S / groupSteps;
+            if (intervalUs > MAX_INTERVAL_US)
+            {
+                intervalUs = MAX_INTERVAL_US;
+            }
+            ramp.table[k++] = static_cast<uint16_t>(intervalUs + 0.5f);
+            lastT = crossT;
+        }
+    }
+
+    ramp.ramp.length = k;
+    ramp.ramp.shift  = shift;
+    if ((k >= MAX_RAMP_STEPS) && (v < vMax))
+    {
+        // The ramp was truncated before reaching full speed.  Cruise at the
+        // speed that was reached.
+        ramp.ramp.cruiseUs = ramp.table[k - 1];
+        return false;
+    }
+    ramp.ramp.cruiseUs = static_cast<uint32_t>(US_PER_S / vMax + 0.5f);
+    return true;
+} // End ComputeRamp().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SelectFastest()
+//
+// Selects the fastest profile within the motor limits, or the slowest profile
+// if none are within the limits.  Profiles are stored fastest first.
+/////////////////////////////////////////////////////////////////////////////////
+void MotionPlanner::SelectFastest()
+{
+    if (!m_NumProfiles)
+    {
+        return;
+    }
+    for (uint32_t i = 0; i < m_NumProfiles; i++)
+    {
+        const MotionProfile_t &p = m_Ramps[i].profile;
+        if ((p.maxVelocity <= m_MaxVelocity) && (p.acceleration <= m_MaxAcceleration))
+        {
+            m_Selected = i;
+            return;
+        }
+    }
+    m_Selected = m_NumProfiles - 1;
+} // End SelectFastest().
@@ -0,0 +1,274 @@
+/////////////////////////////////////////////////////////////////////////////////
+// MotionPlanner.h
+//
+// Contains the MotionPlanner class.  This class computes per-step intervals
+// for stepper moves from a motion profile consisting of a maximum velocity,
+// an acceleration, and an optional jerk limit.  A zero jerk limit gives a
+// trapezoidal velocity profile, while a non-zero jerk limit gives an S-curve.
+//
+// The acceleration ramp of each profile is computed once, when the profile is
+// added, and stored as a table of step intervals (StepRamp_t).  Ramps may also
+// be precomputed at compile time (see StepIntervalTable.h).  Moves then look up the
+// interval of each step from the table, using the same ramp in reverse for
+// deceleration.  Moves that are too short to reach full speed simply turn
+// around at their midpoint.  A ramp with more steps than fit in its table, as
+// when microstepping, is stored with each entry covering 2, 4, or more steps.
+//
+// Several profiles may be registered, ordered from fastest to slowest.  The
+// planner selects the fastest profile that stays within the configured motor
+// limits, and may be told to fall back to a slower profile if missed steps are
+// ever detected.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined MOTIONPLANNER_H
+#define MOTIONPLANNER_H
+
+#include <stdint.h>             // For standard integer types.
+#include <stddef.h>             // For NULL.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// MotionProfile_t
+//
+// Describes a motion profile.  All values are in steps of the current stepping
+// mode (i.e. half steps when half stepping).
+//      maxVelocity  - Cruise velocity in steps per second.
+//      acceleration - Maximum acceleration in steps per second squared.
+//      jerk         - Maximum jerk in steps per second cubed.  Zero selects a
+//                     trapezoidal profile (infinite jerk).
+/////////////////////////////////////////////////////////////////////////////////
+struct MotionProfile_t
+{
+    uint32_t maxVelocity;       // Cruise velocity (steps/s).
+    uint32_t acceleration;      // Max acceleration (steps/s^2).
+    uint32_t jerk;              // Max jerk (steps/s^3), 0 for trapezoidal.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// StepRamp_t
+//
+// Describes the step intervals of one speed profile.
+//      pIntervalUs - Interval, in microseconds, of each step of the
+//                    acceleration ramp.  May be NULL if 'length' is 0.
+//      length      - Number of entries in pIntervalUs.
+//      cruiseUs    - Interval of every step past the end of the ramp.
+//      shift       - Each entry holds the interval of 2^shift consecutive
+//                    steps.  This is 0 unless a ramp of many small steps
+//                    (e.g. microsteps) had to be coarsened to fit.
+/////////////////////////////////////////////////////////////////////////////////
+struct StepRamp_t
+{
+    const uint16_t *pIntervalUs;    // Acceleration ramp intervals.
+    uint32_t length;                // Number of ramp entries.
+    uint32_t cruiseUs;              // Interval once the ramp is complete.
+    uint32_t shift;                 // Log2 of the steps per entry.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// StepRampIntervalUs()
+//
+// Returns the number of microseconds that step 'j' (0 based) of a move that is
+// 'absSteps' long should be held using 'ramp'.  This is the only work done per
+// step, so it is kept inline and branch light.
+/////////////////////////////////////////////////////////////////////////////////
+inline uint32_t StepRampIntervalUs(const StepRamp_t &ramp, int32_t j, int32_t absSteps)
+{
+    int32_t k = absSteps - 1 - j;
+    if (j < k)
+    {
+        k = j;
+    }
+    uint32_t entry = static_cast<uint32_t>(k) >> ramp.shift;
+    return (entry < ramp.length) ? ramp.pIntervalUs[entry] : ramp.cruiseUs;
+} // End StepRampIntervalUs().
+
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// MotionPlanner class
+//
+// Precomputes and looks up per-step intervals for a set of motion profiles.
+/////////////////////////////////////////////////////////////////////////////////
+class MotionPlanner
+{
+public:
+    // Constructor.
+    MotionPlanner();
+
+    // Destructor.
+    ~MotionPlanner() {}
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SetStartVelocity()
+    //
+    // Sets the velocity, in steps per second, at which every move starts and
+    // ends.  This should be at or below the motor's pull-in rate.  Must be
+    // called before adding profiles.
+    /////////////////////////////////////////////////////////////////////////////
+    void SetStartVelocity(uint32_t stepsPerSec) { m_StartVelocity = stepsPerSec; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SetMotorLimits()
+    //
+    // Sets the fastest velocity (steps/s) and acceleration (steps/s^2) that the
+    // motor is known to follow without missing steps, then reselects the
+    // fastest profile that is within those limits.
+    /////////////////////////////////////////////////////////////////////////////
+    void SetMotorLimits(uint32_t maxVelocity, uint32_t maxAcceleration);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // AddProfile()
+    //
+    // Adds a profile and precomputes its acceleration ramp.  Profiles should be
+    // added in order from fastest to slowest.  The fastest profile within the
+    // motor limits is then reselected.
+    //
+    // Returns:
+    //   Returns 'true' on success, or 'false' if no more profiles fit.
+    /////////////////////////////////////////////////////////////////////////////
+    bool AddProfile(const MotionProfile_t &profile);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // AddProfile()
+    //
+    // Adds a profile whose ramp was precomputed elsewhere (e.g. at compile time
+    // by the StepIntervalTable template).  The ramp's table is referenced, not
+    // copied, so it must remain valid for the life of the planner.
+    //
+    // Returns:
+    //   Returns 'true' on success, or 'false' if no more profiles fit.
+    /////////////////////////////////////////////////////////////////////////////
+    bool AddProfile(const MotionProfile_t &profile, const StepRamp_t &ramp);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // ClearProfiles()
+    //
+    // Removes all profiles.  Until a profile is added, every step uses a
+    // conservative default interval.
+    /////////////////////////////////////////////////////////////////////////////
+    void ClearProfiles();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // ReportMissedSteps()
+    //
+    // Called when a position check reveals that steps were missed.  Lowers the
+    // motor limits to just below the current profile and selects the next
+    // slower profile, if any.
+    //
+    // Returns:
+    //   Returns 'true' if a slower profile was selected, or 'false' if the
+    //   slowest profile is already in use.
+    /////////////////////////////////////////////////////////////////////////////
+    bool ReportMissedSteps();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // IntervalUs()
+    //
+    // Returns the number of microseconds that step 'j' (0 based) of a move that
+    // is 'absSteps' long should be held using the selected profile.
+    /////////////////////////////////////////////////////////////////////////////
+    uint32_t IntervalUs(int32_t j, int32_t absSteps) const
+    {
+        return StepRampIntervalUs(m_Ramps[m_Selected].ramp, j, absSteps);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SelectedRamp()
+    //
+    // Returns the ramp of the selected profile.  The board looks this up once
+    // at the start of each move so that each step is a single table lookup.
+    /////////////////////////////////////////////////////////////////////////////
+    const StepRamp_t &SelectedRamp() const { return m_Ramps[m_Selected].ramp; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // MoveDurationUs()
+    //
+    // Returns the total duration, in microseconds, of a move of 'absSteps'
+    // steps using the selected profile.
+    /////////////////////////////////////////////////////////////////////////////
+    uint64_t MoveDurationUs(int32_t absSteps) const;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Accessors.
+    //
+    // NumProfiles()     - Returns the number of registered profiles.
+    // SelectedProfile() - Returns the index of the selected profile.
+    // Profile()         - Returns the profile at the specified index.
+    // RampLength()      - Returns the number of steps in the acceleration ramp
+    //                     of the selected profile.
+    /////////////////////////////////////////////////////////////////////////////
+    uint32_t NumProfiles() const                    { return m_NumProfiles; }
+    uint32_t SelectedProfile() const                { return m_Selected; }
+    const MotionProfile_t &Profile(uint32_t i) const { return m_Ramps[i].profile; }
+    uint32_t RampLength() const
+                { return m_Ramps[m_Selected].ramp.length << m_Ramps[m_Selected].ramp.shift; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Public static constants.
+    /////////////////////////////////////////////////////////////////////////////
+    static const uint32_t MAX_PROFILES   = 4;   // Max number of profiles.
+    static const uint32_t MAX_RAMP_STEPS = 256; // Max entries per accel ramp.
+    static const uint32_t MAX_RAMP_SHIFT = 5;   // Max log2 of steps per entry.
+
+private:
+    /////////////////////////////////////////////////////////////////////////////
+    // Private types.
+    /////////////////////////////////////////////////////////////////////////////
+
+    // A profile and its precomputed acceleration ramp.
+    struct Ramp_t
+    {
+        MotionProfile_t profile;    // Profile the ramp was computed from.
+        StepRamp_t ramp;            // Ramp in use.  Points to 'table' unless
+                                    // the ramp was precomputed elsewhere.
+        uint16_t table[MAX_RAMP_STEPS];
+                                    // Computed interval of each ramp step.
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private methods.
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    // ComputeRamp()
+    //
+    // Fills in 'ramp' from its profile by integrating the jerk limited
+    // acceleration from the start velocity up to the cruise velocity, and
+    // recording the time at which each group of 2^shift steps is crossed.
+    // Returns 'false' if the ramp did not fit in MAX_RAMP_STEPS entries.
+    /////////////////////////////////////////////////////////////////////////////
+    bool ComputeRamp(Ramp_t &ramp, uint32_t shift) const;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SelectFastest()
+    //
+    // Selects the fastest profile that is within the motor limits.  If none
+    // are, the slowest profile is selected.
+    /////////////////////////////////////////////////////////////////////////////
+    void SelectFastest();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Unimplemented methods.  We don't want users to try to use these.
+    /////////////////////////////////////////////////////////////////////////////
+    MotionPlanner(MotionPlanner const &);
+    MotionPlanner &operator=(MotionPlanner &mp);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private instance data.
+    /////////////////////////////////////////////////////////////////////////////
+    Ramp_t   m_Ramps[MAX_PROFILES]; // Registered profiles and their ramps.
+    uint32_t m_NumProfiles;         // Number of registered profiles.
+    volatile uint32_t m_Selected;   // Index of the selected profile.
+    uint32_t m_StartVelocity;       // Start/stop velocity (steps/s).
+    uint32_t m_MaxVelocity;         // Motor velocity limit (steps/s).
+    uint32_t m_MaxAcceleration;     // Motor acceleration limit (steps/s^2).
+
+}; // End class MotionPlanner
+
+#endif // MOTIONPLANNER_H
@@ -0,0 +1,244 @@
+/////////////////////////////////////////////////////////////////////////////////
+// MotionTask.cpp
+//
+// Contains the implementation of the MotionTask class.  This runs the clock
+// mechanics in their own task, fed by a lock-free command queue.  See
+// MotionTask.h for more information.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original code.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>                 // For memset().
+#include "SerialDebugSetup.h"       // For SerialDebug macros.
+#include "MotionTask.h"             // For MotionTask class.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// MotionTask()  (constructor)
+//
+// Arguments:
+//   - clock - The clock mechanics to run.
+/////////////////////////////////////////////////////////////////////////////////
+MotionTask::MotionTask(GenevaClockMechanics &clock) :
+    m_Clock(clock), m_CommandsRun(0), m_HomesDone(0), m_TimeValid(false),
+    m_UpdateStartUs(0), m_Task(NULL)
+{
+    memset(&m_Time, 0, sizeof(m_Time));
+} // End MotionTask().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Begin()
+//
+// Publishes the initial status and, on the ESP32, starts the motion task
+// pinned to 'core'.  Returns 'false' if the task could not be created.
+/////////////////////////////////////////////////////////////////////////////////
+bool MotionTask::Begin(int32_t core, uint32_t priority)
+{
+    PublishStatus();
+#if defined ARDUINO
+    if (!m_Task &&
+        (xTaskCreatePinnedToCore(TaskMain, "motion", STACK_SIZE, this, priority,
+                                 &m_Task, core) != pdPASS))
+    {
+        printlnE("Could not create the motion task.");
+        m_Task = NULL;
+        return false;
+    }
+#else
+    (void)core;
+    (void)priority;
+#endif
+    return true;
+} // End Begin().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Commands.
+//
+// Each builds a command and queues it with Send().
+/////////////////////////////////////////////////////////////////////////////////
+bool MotionTask::UpdateClock(const tm &localTime)
+{
+    MotionCommand_t command = { MotionUpdateClock, localTime.tm_hour, localTime.tm_min,
+                                0, StepAuto };
+    return Send(command);
+} // End UpdateClock().
+
+bool MotionTask::Step(int32_t steps, StepperSpeed_t speed)
+{
+    MotionCommand_t command = { MotionStep, 0, 0, steps, speed };
+    return Send(command);
+} // End Step().
+
+bool MotionTask::Home()
+{
+    MotionCommand_t command = { MotionHome, 0, 0, 0, StepAuto };
+    return Send(command);
+} // End Home().
+
+bool MotionTask::Calibrate()
+{
+    MotionCommand_t command = { MotionCalibrate, 0, 0, 0, StepAuto };
+    return Send(command);
+} // End Calibrate().
+
+bool MotionTask::SavePosition()
+{
+    MotionCommand_t command = { MotionSavePosition, 0, 0, 0, StepAuto };
+    return Send(command);
+} // End SavePosition().
+
+bool MotionTask::RetainPosition()
+{
+    MotionCommand_t command = { MotionRetainPosition, 0, 0, 0, StepAuto };
+    return Send(command);
+} // End RetainPosition().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Send()
+//
+// Queues a command and wakes the motion task.  Returns 'false' if the queue
+// is full.
+/////////////////////////////////////////////////////////////////////////////////
+bool MotionTask::Send(const MotionCommand_t &command)
+{
+    if (!m_Commands.Push(command))
+    {
+        return false;
+    }
+#if defined ARDUINO
+    if (m_Task)
+    {
+        xTaskNotifyGive(m_Task);
+    }
+#endif
+    return true;
+} // End Send().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Poll()
+//
+// Runs the queued commands, unless homing, then advances any home in
+// progress.  The status is published after every command and every home poll.
+// Returns 'true' while homing.
+/////////////////////////////////////////////////////////////////////////////////
+bool MotionTask::Poll()
+{
+    MotionCommand_t command;
+    while (!m_Clock.IsHoming() && m_Commands.Pop(command))
+    {
+        Execute(command);
+        m_CommandsRun++;
+        PublishStatus();
+    }
+
+    if (m_Clock.IsHoming())
+    {
+        m_Clock.PollHome();
+        if (!m_Clock.IsHoming())
+        {
+            // Time has moved on while homing.
+            m_HomesDone++;
+            if (m_TimeValid)
+            {
+                m_Clock.UpdateClock(m_Time);
+            }
+        }
+        PublishStatus();
+    }
+    return m_Clock.IsHoming();
+} // End Poll().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Execute()
+//
+// Runs one command.  Homes are only started here, and advanced by Poll().
+/////////////////////////////////////////////////////////////////////////////////
+void MotionTask::Execute(const MotionCommand_t &command)
+{
+    switch (command.type)
+    {
+    case MotionUpdateClock:
+        m_Time.tm_hour  = command.hour;
+        m_Time.tm_min   = command.minute;
+        m_TimeValid     = true;
+        m_UpdateStartUs = m_Clock.Hal()->Micros();
+        m_Clock.UpdateClock(m_Time);
+        break;
+    case MotionStep:
+        m_Clock.Step(command.steps, command.speed);
+        break;
+    case MotionHome:
+        m_Clock.StartHome();
+        break;
+    case MotionCalibrate:
+        m_Clock.Calibrate();
+        break;
+    case MotionSavePosition:
+        m_Clock.SavePosition();
+        break;
+    case MotionRetainPosition:
+        m_Clock.RetainPosition();
+        break;
+    default:
+        debugW("Unknown motion command %d.", command.type);
+        break;
+    }
+} // End Execute().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// PublishStatus()
+//
+// Publishes a snapshot of the clock's state for Status().
+/////////////////////////////////////////////////////////////////////////////////
+void MotionTask::PublishStatus()
+{
+    MotionStatus_t status;
+    memset(&status, 0, sizeof(status));
+    status.stepPosition  = m_Clock.StepPosition();
+    status.commandsRun   = m_CommandsRun;
+    status.homesDone     = m_HomesDone;
+    status.homeState     = m_Clock.HomeState();
+    status.homeStatus    = m_Clock.HomeStatus();
+    status.generation    = m_Clock.PositionGeneration();
+    status.homeRequired  = m_Clock.HomeRequired();
+    status.moving        = m_Clock.IsMoving();
+    status.showingTime   = m_TimeValid && !m_Clock.IsHoming() && !status.homeRequired &&
+                           !status.moving;
+    status.updateStartUs = m_UpdateStartUs;
+    m_Status.Publish(status);
+} // End PublishStatus().
+
+
+#if defined ARDUINO
+/////////////////////////////////////////////////////////////////////////////////
+// TaskMain()
+//
+// The motion task.  While homing, the phase 1 moves run from the step timer,
+// so Poll() is called again every tick.  Otherwise the task sleeps till a
+// command is sent.
+/////////////////////////////////////////////////////////////////////////////////
+void MotionTask::TaskMain(void *pArg)
+{
+    MotionTask *pTask = static_cast<MotionTask *>(pArg);
+    for (;;)
+    {
+        if (pTask->Poll())
+        {
+            vTaskDelay(1);
+        }
+        else
+        {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(IDLE_WAIT_MS));
+        }
+    }
+} // End TaskMain().
+#endif
@@ -0,0 +1,237 @@
+/////////////////////////////////////////////////////////////////////////////////
+// MotionTask.h
+//
+// Contains the MotionTask class.  This runs the clock mechanics in a FreeRTOS
+// task of their own, pinned to the ESP32's application core (core 1), so that
+// minute moves and homes never block WiFi or the rest of the sketch, and WiFi
+// processing in loop() never delays the mechanics.  The ESP32's WiFi stack
+// runs on the protocol core (core 0).
+//
+// The motion task owns the GenevaClockMechanics instance: once Begin() has
+// been called, only the motion task may move the stepper, home, or calibrate.
+// Other code sends it commands through a lock-free single producer, single
+// consumer queue (SpscRing), and reads back its state from a snapshot that
+// the motion task publishes through a SeqLock after each command and while
+// homing.  Neither side ever blocks the other.
+//
+// On the host, Begin() does not create a task.  Poll() must be called instead,
+// from whichever thread plays the part of the motion task.
+//
+// Example:
+//      MotionTask motion(gClock);
+//      motion.Begin();
+//      motion.Home();
+//      ...
+//      MotionStatus_t status = motion.Status();
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined MOTIONTASK_H
+#define MOTIONTASK_H
+
+#include <stdint.h>                 // For standard integer types.
+#include <time.h>                   // For tm structure.
+#include "GenevaClockMechanics.h"   // For GenevaClockMechanics class.
+#include "SpscRing.h"               // For SpscRing template.
+#include "SeqLock.h"                // For SeqLock template.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// MotionCommandType_t
+//
+// Commands accepted by the motion task:
+//  MotionUpdateClock - GenevaClockMechanics::UpdateClock() to 'hour':'minute'.
+//  MotionStep        - GenericClockBoard::Step() of 'steps' at 'speed'.
+//  MotionHome        - Home the clock.
+//  MotionCalibrate   - GenevaClockMechanics::Calibrate().  Runs till the
+//                      pushbutton is pressed.
+//  MotionSavePosition - GenevaClockMechanics::SavePosition().
+//  MotionRetainPosition - GenevaClockMechanics::RetainPosition().
+/////////////////////////////////////////////////////////////////////////////////
+enum MotionCommandType_t
+{
+    MotionUpdateClock = 0,
+    MotionStep,
+    MotionHome,
+    MotionCalibrate,
+    MotionSavePosition,
+    MotionRetainPosition
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// MotionCommand_t
+//
+// One queued motion command.
+/////////////////////////////////////////////////////////////////////////////////
+struct MotionCommand_t
+{
+    MotionCommandType_t type;   // What to do.
+    int32_t  hour;              // MotionUpdateClock hour (0 - 23).
+    int32_t  minute;            // MotionUpdateClock minute (0 - 59).
+    int32_t  steps;             // MotionStep steps (positive is clockwise).
+    StepperSpeed_t speed;       // MotionStep speed.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// MotionStatus_t
+//
+// Snapshot of the motion task's state, as returned by MotionTask::Status().
+/////////////////////////////////////////////////////////////////////////////////
+struct MotionStatus_t
+{
+    int64_t      stepPosition;  // Board step position (see StepPosition()).
+    uint32_t     commandsRun;   // Commands run (or for a home, started).
+    uint32_t     homesDone;     // Homes completed since Begin().
+    HomeState_t  homeState;     // Phase of the home in progress, if any.
+    StatusCode_t homeStatus;    // Result of the last home.
+    uint32_t     generation;    // GenevaClockMechanics::PositionGeneration().
+    bool         homeRequired;  // GenevaClockMechanics::HomeRequired().
+    bool         moving;        // True while the stepper is moving.
+    bool         showingTime;   // True once the dial shows the last time
+                                // sent, from a known position.
+    uint64_t     updateStartUs; // HAL time the last minute update started.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// MotionTask class
+//
+// Runs a GenevaClockMechanics instance from its own task.
+/////////////////////////////////////////////////////////////////////////////////
+class MotionTask
+{
+public:
+    static const uint32_t QUEUE_SIZE = 8;       // Most commands queued at once.
+    static const int32_t  MOTION_CORE = 1;      // Core the task is pinned to.
+    static const uint32_t MOTION_PRIORITY = 5;  // Task priority.  Above loop()
+                                                // (1), below the esp_timer
+                                                // task that paces the steps.
+
+    /////////////////////////////////////////////////////////////////////////////
+    // MotionTask()  (constructor)
+    //
+    // Arguments:
+    //   - clock - The clock mechanics to run.  After Begin(), only the motion
+    //             task may use them to move.
+    /////////////////////////////////////////////////////////////////////////////
+    MotionTask(GenevaClockMechanics &clock);
+
+    // Destructor.
+    ~MotionTask() {}
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Begin()
+    //
+    // Publishes the initial status and, on the ESP32, starts the motion task.
+    //
+    // Arguments:
+    //   - core     - Core to pin the task to.
+    //   - priority - FreeRTOS priority of the task.
+    //
+    // Returns:
+    //   Returns 'true' on success, or 'false' if the task could not be created.
+    /////////////////////////////////////////////////////////////////////////////
+    bool Begin(int32_t core = MOTION_CORE, uint32_t priority = MOTION_PRIORITY);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Commands.
+    //
+    // Each queues a command for the motion task and returns 'true', or returns
+    // 'false' (and counts it in CommandsDropped()) if the queue is full.  Only
+    // one task may send commands.
+    //
+    // UpdateClock() - Moves the clock to 'localTime'.
+    // Step()        - Moves 'steps' at 'speed'.
+    // Home()        - Homes the clock.
+    // Calibrate()   - Runs the home sensor calibration.
+    // SavePosition() - Saves the position as a clean shutdown.
+    // RetainPosition() - Saves the position as a clean shutdown to retained
+    //                  memory only, before a deep sleep.
+    // Send()        - Queues any command.
+    /////////////////////////////////////////////////////////////////////////////
+    bool UpdateClock(const tm &localTime);
+    bool Step(int32_t steps, StepperSpeed_t speed);
+    bool Home();
+    bool Calibrate();
+    bool SavePosition();
+    bool RetainPosition();
+    bool Send(const MotionCommand_t &command);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Status.
+    //
+    // Status()          - Returns a consistent copy of the latest published
+    //                     state.  May be called from any task.
+    // CommandsDropped() - Returns the number of commands refused because the
+    //                     queue was full.
+    /////////////////////////////////////////////////////////////////////////////
+    MotionStatus_t Status() const                   { return m_Status.Read(); }
+    uint32_t CommandsDropped() const                { return m_Commands.Dropped(); }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Poll()
+    //
+    // Runs every queued command, advances any home in progress, and publishes
+    // the status.  This is the body of the motion task.  On the host it must
+    // be called directly.  Commands wait in the queue while homing, and once
+    // the home ends the clock is moved to the last UpdateClock() time.
+    //
+    // Returns:
+    //   Returns 'true' while a home is in progress, so that the caller should
+    //   call again soon.
+    /////////////////////////////////////////////////////////////////////////////
+    bool Poll();
+
+
+protected:
+
+
+private:
+    /////////////////////////////////////////////////////////////////////////////
+    // Private constants.
+    /////////////////////////////////////////////////////////////////////////////
+    static const uint32_t STACK_SIZE   = 4096;  // Task stack size (bytes).
+    static const uint32_t IDLE_WAIT_MS = 100;   // Longest idle sleep.
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private methods.
+    /////////////////////////////////////////////////////////////////////////////
+
+    // Runs one command.
+    void Execute(const MotionCommand_t &command);
+
+    // Publishes the current state.
+    void PublishStatus();
+
+#if defined ARDUINO
+    // The FreeRTOS task function.  'pArg' is the MotionTask.
+    static void TaskMain(void *pArg);
+#endif
+
+    // Unimplemented methods.  We don't want users to try to use these.
+    MotionTask();
+    MotionTask(MotionTask const &);
+    MotionTask &operator=(MotionTask &task);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private instance data.
+    /////////////////////////////////////////////////////////////////////////////
+    GenevaClockMechanics &m_Clock;                  // The clock mechanics.
+    SpscRing<MotionCommand_t, QUEUE_SIZE> m_Commands;   // Command queue.
+    SeqLock<MotionStatus_t> m_Status;               // Published status.
+    uint32_t m_CommandsRun;                         // Commands run.
+    uint32_t m_HomesDone;                           // Homes completed.
+    bool     m_TimeValid;                           // True if m_Time is valid.
+    tm       m_Time;                                // Last UpdateClock() time.
+    uint64_t m_UpdateStartUs;                       // Start of the last one.
+    TaskHandle_t m_Task;                            // The motion task, or NULL.
+
+}; // End class MotionTask.
+
+
+#endif // MOTIONTASK_H
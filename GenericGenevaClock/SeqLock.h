@@ -0,0 +1,150 @@
+/////////////////////////////////////////////////////////////////////////////////
+// SeqLock.h
+//
+// Contains the SeqLock template.  This publishes a small snapshot structure
+// from exactly one writer to any number of readers, which may run on different
+// cores.  The writer never blocks or waits for the readers, and readers never
+// see a snapshot that is partly old and partly new.
+//
+// The writer makes the sequence count odd, stores the snapshot, then makes it
+// even again.  A reader copies the snapshot between two reads of the count and
+// retries if the count was odd or changed, since the writer was busy.  The
+// snapshot is stored as relaxed atomic words rather than as a plain T, so that
+// a reader that races with the writer merely copies stale words and retries,
+// rather than causing a data race.
+//
+// Example:
+//      SeqLock<Status_t> status;
+//      status.Publish(current);        // Writer (e.g. the motion task).
+//      Status_t copy = status.Read();  // Reader (e.g. loop()).
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined SEQLOCK_H
+#define SEQLOCK_H
+
+#include <stdint.h>             // For standard integer types.
+#include <string.h>             // For memcpy().
+#include <atomic>               // For std::atomic.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SeqLock template
+//
+// Template arguments:
+//   - T - Snapshot type.  Must be trivially copyable (plain data).
+/////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+class SeqLock
+{
+public:
+    // Constructor.  The snapshot starts as all zero bytes.
+    SeqLock() : m_Sequence(0)
+#if !defined ARDUINO
+        , m_pReadHook(NULL), m_pReadHookArg(NULL)
+#endif
+    {
+        for (uint32_t i = 0; i < WORDS; i++)
+        {
+            m_Words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Publish()
+    //
+    // Writer side.  Replaces the snapshot with 'value'.  Only one task may
+    // publish.
+    /////////////////////////////////////////////////////////////////////////////
+    void Publish(const T &value)
+    {
+        uint32_t words[WORDS] = {};
+        memcpy(words, &value, sizeof(T));
+
+        uint32_t sequence = m_Sequence.load(std::memory_order_relaxed);
+        m_Sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (uint32_t i = 0; i < WORDS; i++)
+        {
+            m_Words[i].store(words[i], std::memory_order_relaxed);
+        }
+        m_Sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Read()
+    //
+    // Reader side.  Returns a consistent copy of the latest snapshot.  Spins
+    // for as long as the writer is part way through a Publish(), which is only
+    // a few dozen instructions.
+    /////////////////////////////////////////////////////////////////////////////
+    T Read() const
+    {
+        uint32_t words[WORDS];
+        uint32_t before;
+        uint32_t after;
+        do
+        {
+            before = m_Sequence.load(std::memory_order_acquire);
+            for (uint32_t i = 0; i < WORDS; i++)
+            {
+                words[i] = m_Words[i].load(std::memory_order_relaxed);
+#if !defined ARDUINO
+                if (m_pReadHook)
+                {
+                    m_pReadHook(m_pReadHookArg, i);
+                }
+#endif
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_Sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || (before != after));
+
+        T value;
+        memcpy(&value, words, sizeof(T));
+        return value;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Sequence()
+    //
+    // Returns twice the number of Publish() calls made so far (plus one while
+    // one is in progress).  A reader can compare this with an earlier value
+    // to tell if anything new has been published.
+    /////////////////////////////////////////////////////////////////////////////
+    uint32_t Sequence() const   { return m_Sequence.load(std::memory_order_acquire); }
+
+#if !defined ARDUINO
+    /////////////////////////////////////////////////////////////////////////////
+    // SetReadHook()  (host only)
+    //
+    // Has Read() call 'pFn' with 'pArg' and the word's index after it copies
+    // each snapshot word, so that a test can publish part way through a read.
+    // NULL removes the hook.
+    /////////////////////////////////////////////////////////////////////////////
+    typedef void (*ReadHookFn_t)(void *pArg, uint32_t word);
+    void SetReadHook(ReadHookFn_t pFn, void *pArg)
+                                { m_pReadHook = pFn; m_pReadHookArg = pArg; }
+#endif
+
+private:
+    // Unimplemented methods.  We don't want users to try to use these.
+    SeqLock(SeqLock const &);
+    SeqLock &operator=(SeqLock &lock);
+
+    // Snapshot size in 32 bit words.
+    static const uint32_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+    std::atomic<uint32_t> m_Sequence;       // Odd while publishing.
+    std::atomic<uint32_t> m_Words[WORDS];   // The snapshot.
+#if !defined ARDUINO
+    ReadHookFn_t m_pReadHook;               // SetReadHook() function, or NULL.
+    void        *m_pReadHookArg;            // SetReadHook() argument.
+#endif
+
+}; // End class SeqLock
+
+#endif // SEQLOCK_H
@@ -9,6 +9,8 @@
 // for more information.
 //
 // History:
+//  - agent 16-OCT-2026
+//    Use HostPlatform.h in place of SerialDebug on the host.
 //  - jmcorbett 11-MAY-2024
 //    Original code.
 //
@@ -51,6 +53,10 @@
 //#define DEBUG_AUTO_FUNC_DISABLED true
 
 
+#if defined ARDUINO
 #include "SerialDebug.h" //https://github.com/JoaoLopesF/SerialDebug
+#else
+#include "HostPlatform.h" // Host stand-ins for SerialDebug macros.
+#endif
 
 #endif // SERIAL_DEBUG_SETUP
\ No newline at end of file
@@ -0,0 +1,610 @@
+/////////////////////////////////////////////////////////////////////////////////
+// SimulatedHal.cpp
+//
+// Contains the implementation of the SimulatedHal class.  This is a host
+// (Linux) ClockBoardHal backend that models a 28BYJ-48 stepper, the clock's
+// gear train, the home reed switch, and the pushbutton in virtual time.  See
+// SimulatedHal.h for more information.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original code.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#if !defined ARDUINO
+
+#include <math.h>                   // For atan2(), fmod() ...
+#include <string.h>                 // For strncmp(), memcpy() ...
+#include "SimulatedHal.h"           // For SimulatedHal class.
+#include "GenericClockBoard.h"      // For board pin assignments.
+#include "StepTimer.h"              // For the virtual clock.
+
+// Host RGBLed stand-in static definitions.
+int RGBLed::RED[3]     = { 255,   0,   0 };
+int RGBLed::GREEN[3]   = {   0, 255,   0 };
+int RGBLed::BLUE[3]    = {   0,   0, 255 };
+int RGBLed::MAGENTA[3] = { 255,   0, 255 };
+int RGBLed::CYAN[3]    = {   0, 255, 255 };
+int RGBLed::YELLOW[3]  = { 255, 255,   0 };
+int RGBLed::WHITE[3]   = { 255, 255, 255 };
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SimulatedHal()  (constructor)
+//
+// Arguments:
+//   - stepperPinsReversed - Should match the value given to the
+//                           GenericClockBoard.
+//   - homeNormallyOpen    - Should match the value given to the
+//                           GenericClockBoard.
+/////////////////////////////////////////////////////////////////////////////////
+SimulatedHal::SimulatedHal(bool stepperPinsReversed, bool homeNormallyOpen) :
+    m_InvertHome(homeNormallyOpen), m_PinLevels(0), m_HeldPins(0), m_HoldDuty(0),
+    m_DutyPins(0),
+    m_HalfStepsPerRev(4096.0), m_BacklashHalfSteps(0.0), m_HomeWidthMinutes(4.0),
+    m_PullInRate(600.0), m_PullOutRate(1100.0), m_MaxAccel(6000.0),
+    m_RotorHalfSteps(0.0), m_DialHalfSteps(0.0), m_RotorRate(0.0),
+    m_LastStepUs(NEVER_STEPPED), m_RateFromUs(0), m_RateFromHalfSteps(0.0), m_MissedSteps(0),
+    m_MotorHalfSteps(0.0), m_Direction(0), m_Reversals(0),
+    m_StorageWrites(0), m_RetainedLength(0),
+    m_ButtonPressed(false), m_ButtonPressAtUs(0), m_ButtonPressEndUs(0)
+{
+    ClearStorage();
+    memset(m_PinChanges, 0, sizeof(m_PinChanges));
+    memset(m_PhaseDuty, 0, sizeof(m_PhaseDuty));
+
+    // Use the same electrical order as the board so that positive steps
+    // turn the simulated dial clockwise.
+    const uint8_t pins[NUM_PHASES] =
+    {
+        GenericClockBoard::PHASE_1_PIN, GenericClockBoard::PHASE_2_PIN,
+        GenericClockBoard::PHASE_3_PIN, GenericClockBoard::PHASE_4_PIN
+    };
+    for (uint32_t i = 0; i < NUM_PHASES; i++)
+    {
+        m_PhasePins[i] = stepperPinsReversed ? pins[NUM_PHASES - 1 - i] : pins[i];
+    }
+} // End SimulatedHal().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// PinMode()
+//
+// Inputs with pullups idle high.  Everything else is ignored.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::PinMode(uint8_t pin, uint8_t mode)
+{
+    if (mode == INPUT_PULLUP)
+    {
+        m_PinLevels |= (1ULL << pin);
+    }
+} // End PinMode().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// WritePin()
+//
+// Drives a single pin and updates the motor model.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::WritePin(uint8_t pin, bool high)
+{
+    if (high)
+    {
+        m_PinLevels |= (1ULL << pin);
+    }
+    else
+    {
+        m_PinLevels &= ~(1ULL << pin);
+    }
+    UpdateRotor();
+} // End WritePin().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetPins()
+//
+// Drives the masked pins high and updates the motor model.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::SetPins(uint32_t mask)
+{
+    m_PinLevels |= mask;
+    UpdateRotor();
+} // End SetPins().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ClearPins()
+//
+// Drives the masked pins low.  With no coils energized the rotor simply
+// stays where it is.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::ClearPins(uint32_t mask)
+{
+    m_PinLevels &= ~static_cast<uint64_t>(mask);
+    UpdateRotor();
+} // End ClearPins().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// HoldPins()
+//
+// Records the held pins.  A held phase keeps the rotor where it is, as do
+// clear phases, so the motor model is unaffected.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::HoldPins(uint32_t mask, uint32_t dutyPercent)
+{
+    m_HeldPins = mask;
+    m_HoldDuty = mask ? dutyPercent : 0;
+} // End HoldPins().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetPinDuties()
+//
+// Sets the duties of the phase pins, then updates the motor model once for
+// all of them.  Other pins are not modeled, so are ignored.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::SetPinDuties(const uint8_t *pPins, const uint32_t *pDuties, uint32_t count)
+{
+    for (uint32_t p = 0; p < count; p++)
+    {
+        for (uint32_t i = 0; i < NUM_PHASES; i++)
+        {
+            if (m_PhasePins[i] == pPins[p])
+            {
+                m_DutyPins    |= (1UL << pPins[p]);
+                m_PhaseDuty[i] = (pDuties[p] > DUTY_MAX) ? DUTY_MAX : pDuties[p];
+            }
+        }
+    }
+    UpdateRotor();
+} // End SetPinDuties().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ReleasePinDuties()
+//
+// Returns the pins to SetPins() / ClearPins() control, driven low.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::ReleasePinDuties(const uint8_t *pPins, uint32_t count)
+{
+    for (uint32_t p = 0; p < count; p++)
+    {
+        for (uint32_t i = 0; i < NUM_PHASES; i++)
+        {
+            if (m_PhasePins[i] == pPins[p])
+            {
+                m_PhaseDuty[i] = 0;
+            }
+        }
+        m_DutyPins  &= ~(1UL << pPins[p]);
+        m_PinLevels &= ~(1ULL << pPins[p]);
+    }
+    UpdateRotor();
+} // End ReleasePinDuties().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ReadPin()
+//
+// Returns the simulated level of the home sensor and pushbutton inputs, or the
+// last written level of any other pin.
+/////////////////////////////////////////////////////////////////////////////////
+bool SimulatedHal::ReadPin(uint8_t pin)
+{
+    if (pin == GenericClockBoard::HOME_PIN)
+    {
+        // GenericClockBoard::IsHome() inverts N.O. sensors.
+        return IsSensorActive() ^ m_InvertHome;
+    }
+    if (pin == GenericClockBoard::PUSHBUTTON_PIN)
+    {
+        // The pushbutton pulls its input low when pressed.
+        uint64_t now = Micros();
+        bool scripted = (now >= m_ButtonPressAtUs) && (now < m_ButtonPressEndUs);
+        return !(m_ButtonPressed || scripted);
+    }
+    return (m_PinLevels >> pin) & 1;
+} // End ReadPin().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Micros()
+//
+// Returns the virtual time in microseconds.
+/////////////////////////////////////////////////////////////////////////////////
+uint64_t SimulatedHal::Micros()
+{
+    return StepTimer::NowUs();
+} // End Micros().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// DelayMicroseconds()
+//
+// Advances virtual time, firing any step timer callbacks that come due.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::DelayMicroseconds(uint32_t us)
+{
+    AdvanceTo(Micros() + us);
+} // End DelayMicroseconds().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Delay()
+//
+// Advances virtual time, firing any step timer callbacks that come due.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::Delay(uint32_t ms)
+{
+    AdvanceTo(Micros() + static_cast<uint64_t>(ms) * 1000);
+} // End Delay().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// AdvanceTo()
+//
+// Advances virtual time in pieces, so that the edges of a scripted button
+// press are reported at the right time.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::AdvanceTo(uint64_t endUs)
+{
+    const uint64_t stops[2] = { m_ButtonPressAtUs, m_ButtonPressEndUs };
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        uint64_t now = Micros();
+        if ((stops[i] > now) && (stops[i] < endUs))
+        {
+            StepTimer::AdvanceHost(stops[i] - now);
+            CheckPinChanges();
+        }
+    }
+    StepTimer::AdvanceHost(endUs - Micros());
+    CheckPinChanges();
+} // End AdvanceTo().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// AttachPinChange()
+//
+// Registers a handler for changes of an input pin.  A pin may only have one
+// handler.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::AttachPinChange(uint8_t pin, PinChangeIsr_t pIsr, void *pArg)
+{
+    DetachPinChange(pin);
+    for (uint32_t i = 0; i < MAX_PIN_CHANGE_ISRS; i++)
+    {
+        PinChange_t &change = m_PinChanges[i];
+        if (!change.pIsr)
+        {
+            change.pIsr  = pIsr;
+            change.pArg  = pArg;
+            change.pin   = pin;
+            change.level = ReadPin(pin);
+            return;
+        }
+    }
+} // End AttachPinChange().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// DetachPinChange()
+//
+// Removes the handler for an input pin, if any.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::DetachPinChange(uint8_t pin)
+{
+    for (uint32_t i = 0; i < MAX_PIN_CHANGE_ISRS; i++)
+    {
+        if (m_PinChanges[i].pIsr && (m_PinChanges[i].pin == pin))
+        {
+            m_PinChanges[i].pIsr = NULL;
+        }
+    }
+} // End DetachPinChange().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// CheckPinChanges()
+//
+// Calls the handler of every input whose level has changed.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::CheckPinChanges()
+{
+    for (uint32_t i = 0; i < MAX_PIN_CHANGE_ISRS; i++)
+    {
+        PinChange_t &change = m_PinChanges[i];
+        if (change.pIsr)
+        {
+            bool level = ReadPin(change.pin);
+            if (level != change.level)
+            {
+                change.level = level;
+                change.pIsr(change.pArg);
+            }
+        }
+    }
+} // End CheckPinChanges().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ReadStorage()
+//
+// Reads a block from simulated storage if it exists and is the expected size.
+/////////////////////////////////////////////////////////////////////////////////
+bool SimulatedHal::ReadStorage(const char *pKey, void *pData, uint32_t length)
+{
+    for (uint32_t i = 0; i < MAX_STORAGE_BLOCKS; i++)
+    {
+        StorageBlock_t &block = m_Storage[i];
+        if (block.key[0] && !strncmp(block.key, pKey, MAX_STORAGE_KEY))
+        {
+            if (block.length != length)
+            {
+                return false;
+            }
+            memcpy(pData, block.data, length);
+            return true;
+        }
+    }
+    return false;
+} // End ReadStorage().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// WriteStorage()
+//
+// Writes a block to simulated storage, replacing any block of the same name.
+/////////////////////////////////////////////////////////////////////////////////
+bool SimulatedHal::WriteStorage(const char *pKey, const void *pData, uint32_t length)
+{
+    if ((length > MAX_STORAGE_BYTES) || (strlen(pKey) >= MAX_STORAGE_KEY))
+    {
+        return false;
+    }
+    StorageBlock_t *pFree = NULL;
+    for (uint32_t i = 0; i < MAX_STORAGE_BLOCKS; i++)
+    {
+        StorageBlock_t &block = m_Storage[i];
+        if (block.key[0] && !strncmp(block.key, pKey, MAX_STORAGE_KEY))
+        {
+            pFree = &block;
+            break;
+        }
+        if (!block.key[0] && !pFree)
+        {
+            pFree = &block;
+        }
+    }
+    if (!pFree)
+    {
+        return false;
+    }
+    strncpy(pFree->key, pKey, MAX_STORAGE_KEY);
+    pFree->length = length;
+    memcpy(pFree->data, pData, length);
+    m_StorageWrites++;
+    return true;
+} // End WriteStorage().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ClearStorage()
+//
+// Erases all simulated storage.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::ClearStorage()
+{
+    memset(m_Storage, 0, sizeof(m_Storage));
+} // End ClearStorage().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ReadRetained()
+//
+// Reads the simulated retained block if it has the expected size.
+/////////////////////////////////////////////////////////////////////////////////
+bool SimulatedHal::ReadRetained(void *pData, uint32_t length)
+{
+    if (!m_RetainedLength || (m_RetainedLength != length))
+    {
+        return false;
+    }
+    memcpy(pData, m_Retained, length);
+    return true;
+} // End ReadRetained().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// WriteRetained()
+//
+// Writes the simulated retained block.
+/////////////////////////////////////////////////////////////////////////////////
+bool SimulatedHal::WriteRetained(const void *pData, uint32_t length)
+{
+    if (length > MAX_RETAINED_BYTES)
+    {
+        return false;
+    }
+    memcpy(m_Retained, pData, length);
+    m_RetainedLength = length;
+    return true;
+} // End WriteRetained().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetDialMinutes()
+//
+// Places the dial and motor at the specified dial position.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::SetDialMinutes(double minutes)
+{
+    m_RotorHalfSteps =
+        minutes * m_HalfStepsPerRev * MOTOR_REVS_PER_CYCLE / MINUTES_PER_CYCLE;
+    m_DialHalfSteps  = m_RotorHalfSteps;
+    m_RateFromHalfSteps = m_RotorHalfSteps;
+    CheckPinChanges();
+} // End SetDialMinutes().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// DialMinutes()
+//
+// Returns the current dial position in minutes past 12:00.
+/////////////////////////////////////////////////////////////////////////////////
+double SimulatedHal::DialMinutes() const
+{
+    double cycles = m_DialHalfSteps / (m_HalfStepsPerRev * MOTOR_REVS_PER_CYCLE);
+    double frac   = cycles - floor(cycles);
+    return frac * MINUTES_PER_CYCLE;
+} // End DialMinutes().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// IsSensorActive()
+//
+// The reed switch is active over a short arc that starts at 12:00 and extends
+// clockwise.
+/////////////////////////////////////////////////////////////////////////////////
+bool SimulatedHal::IsSensorActive() const
+{
+    return DialMinutes() < m_HomeWidthMinutes;
+} // End IsSensorActive().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// UpdateRotor()
+//
+// Computes the electrical angle commanded by the energized coils, each weighted
+// by its PWM duty if it has one, and moves the rotor to it if the motor can
+// follow.  Angles are measured in full steps, with
+// 4 full steps per electrical cycle.  The rotor cannot follow if the commanded
+// angle is directly opposite the rotor, or if doing so would exceed the
+// motor's rate or acceleration limits.  In that case the step is missed and
+// the rotor stays put; if enough steps are missed in a row the commanded angle
+// wraps around and the rotor slips backwards, just like a stalled stepper.
+/////////////////////////////////////////////////////////////////////////////////
+void SimulatedHal::UpdateRotor()
+{
+    const double PI_2 = 1.57079632679489661923;   // Radians per full step.
+    const double EPSILON = 1.0e-6;
+
+    // Sum the energized coil vectors.
+    double x = 0.0;
+    double y = 0.0;
+    for (uint32_t i = 0; i < NUM_PHASES; i++)
+    {
+        double current = ((m_DutyPins >> m_PhasePins[i]) & 1)
+                       ? static_cast<double>(m_PhaseDuty[i]) / DUTY_MAX
+                       : static_cast<double>((m_PinLevels >> m_PhasePins[i]) & 1);
+        x += current * cos(i * PI_2);
+        y += current * sin(i * PI_2);
+    }
+    if ((fabs(x) < EPSILON) && (fabs(y) < EPSILON))
+    {
+        // No net torque.  The rotor stays where it is.
+        return;
+    }
+
+    // Signed distance, in full steps, from the rotor to the commanded angle,
+    // wrapped into the range -2 to +2.
+    double target = atan2(y, x) / PI_2;
+    double diff   = fmod(target - m_RotorHalfSteps / 2.0, 4.0);
+    if (diff > 2.0)
+    {
+        diff -= 4.0;
+    }
+    else if (diff <= -2.0)
+    {
+        diff += 4.0;
+    }
+    if (fabs(diff) < EPSILON)
+    {
+        // Already there (holding).
+        return;
+    }
+
+    // A rotor that has been still for a while (or has never moved) starts
+    // from rest, and can always take a single step.  Otherwise the rate
+    // implied by this step must be within the motor's limits.  The rate is
+    // judged over whole half steps of travel, since the rotor's inertia
+    // smooths out the uneven sizes of PWM microsteps.
+    const double REST_SECONDS = 0.05;
+    double   moveHalfSteps = 2.0 * diff;
+    uint64_t now  = Micros();
+    bool     atRest = (m_LastStepUs == NEVER_STEPPED) ||
+                      ((now - m_LastStepUs) / 1.0e6 > REST_SECONDS);
+    double   travel = fabs(m_RotorHalfSteps + moveHalfSteps - m_RateFromHalfSteps);
+    bool     wholeStep = atRest || (travel > 1.0 - EPSILON);
+    double   rate = 0.0;
+    if (!atRest && wholeStep)
+    {
+        double dt = (now - m_RateFromUs) / 1.0e6;
+        rate = (dt > 0.0) ? travel / dt : 1.0e9;
+
+        double maxRate = m_RotorRate + m_MaxAccel * dt;
+        if (maxRate < m_PullInRate)
+        {
+            maxRate = m_PullInRate;
+        }
+        if (maxRate > m_PullOutRate)
+        {
+            maxRate = m_PullOutRate;
+        }
+        if (rate > maxRate)
+        {
+            m_MissedSteps++;
+            return;
+        }
+    }
+    if (fabs(diff) > 2.0 - EPSILON)
+    {
+        m_MissedSteps++;
+        return;
+    }
+
+    // The rotor follows.  The dial side of the gear train only moves once the
+    // backlash has been taken up.
+    int32_t direction = (moveHalfSteps > 0.0) ? 1 : -1;
+    if (direction == -m_Direction)
+    {
+        m_Reversals++;
+    }
+    m_Direction       = direction;
+    m_RotorHalfSteps += moveHalfSteps;
+    m_MotorHalfSteps += fabs(moveHalfSteps);
+    m_LastStepUs      = now;
+    if (wholeStep)
+    {
+        m_RotorRate         = rate;
+        m_RateFromUs        = now;
+        m_RateFromHalfSteps = m_RotorHalfSteps;
+    }
+
+    double halfBacklash = m_BacklashHalfSteps / 2.0;
+    if (m_RotorHalfSteps - m_DialHalfSteps > halfBacklash)
+    {
+        m_DialHalfSteps = m_RotorHalfSteps - halfBacklash;
+    }
+    else if (m_DialHalfSteps - m_RotorHalfSteps > halfBacklash)
+    {
+        m_DialHalfSteps = m_RotorHalfSteps + halfBacklash;
+    }
+    CheckPinChanges();
+} // End UpdateRotor().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// DefaultClockBoardHal()
+//
+// On the host, the default HAL is a SimulatedHal with default settings.
+/////////////////////////////////////////////////////////////////////////////////
+ClockBoardHal *DefaultClockBoardHal()
+{
+    static SimulatedHal hal;
+    return &hal;
+} // End DefaultClockBoardHal().
+
+#endif // !ARDUINO
@@ -0,0 +1,297 @@
+/////////////////////////////////////////////////////////////////////////////////
+// SimulatedHal.h
+//
+// Declares the SimulatedHal class.  This is a host (Linux) ClockBoardHal
+// backend that lets the GenericClockBoard and GenevaClockMechanics classes be
+// run and benchmarked without an ESP32.  It models:
+//      - A 28BYJ-48 stepper driven through the board's four phase pins.  The
+//        rotor follows the energized coils as long as the commanded step rate
+//        stays within its pull-in, pull-out, and acceleration limits.  Steps
+//        that arrive too quickly are missed, just like on the real motor.
+//        Coils driven by SetPinDuties() pull in proportion to their duty, so
+//        microsteps move the rotor part of a step.
+//      - The 8 tooth motor gear driving the 32 tooth main gear, giving 16 motor
+//        revolutions per 12 hour dial cycle.
+//      - Optional gear train backlash between the motor and the dial.
+//      - A reed switch that is active for a short arc of the dial starting at
+//        the 12:00 position.
+//      - The board's pushbutton, which may be pressed on demand or scripted to
+//        be pressed at a given virtual time.
+//      - Pin change interrupts on the home sensor and pushbutton inputs.  The
+//        handlers are called synchronously when the motor model or button
+//        changes an input.  The simulated rotor jumps at the start of each
+//        step, so home sensor edges always coincide with a step.
+//      - Non-volatile storage, kept in memory.
+//
+// All time is virtual.  Micros() returns the StepTimer virtual clock, and the
+// delay methods simply advance it, firing any step timer callbacks that come
+// due.  Long homing and calibration runs therefore complete in milliseconds.
+//
+// This class is only built on the host (i.e. when ARDUINO is not defined).
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined SIMULATEDHAL_H
+#define SIMULATEDHAL_H
+
+#if !defined ARDUINO
+
+#include "HostPlatform.h"       // For host stand-ins.
+#include "ClockBoardHal.h"      // For ClockBoardHal interface.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SimulatedHal class
+//
+// Host implementation of the ClockBoardHal interface with a simulated motor,
+// gear train, home sensor, and pushbutton.
+/////////////////////////////////////////////////////////////////////////////////
+class SimulatedHal : public ClockBoardHal
+{
+public:
+    /////////////////////////////////////////////////////////////////////////////
+    // SimulatedHal()  (constructor)
+    //
+    // Arguments:
+    //   - stepperPinsReversed - Should match the value given to the
+    //                           GenericClockBoard.  Positive steps then turn the
+    //                           simulated dial clockwise.
+    //   - homeNormallyOpen    - Should match the value given to the
+    //                           GenericClockBoard.
+    /////////////////////////////////////////////////////////////////////////////
+    SimulatedHal(bool stepperPinsReversed = true, bool homeNormallyOpen = true);
+
+    // Destructor.
+    ~SimulatedHal() {}
+
+    // ClockBoardHal interface.  See ClockBoardHal.h.
+    void     PinMode(uint8_t pin, uint8_t mode);
+    void     WritePin(uint8_t pin, bool high);
+    void     SetPins(uint32_t mask);
+    void     ClearPins(uint32_t mask);
+    void     HoldPins(uint32_t mask, uint32_t dutyPercent);
+    void     SetPinDuties(const uint8_t *pPins, const uint32_t *pDuties, uint32_t count);
+    void     ReleasePinDuties(const uint8_t *pPins, uint32_t count);
+    bool     ReadPin(uint8_t pin);
+    uint64_t Micros();
+    void     DelayMicroseconds(uint32_t us);
+    void     Delay(uint32_t ms);
+    bool     ReadStorage(const char *pKey, void *pData, uint32_t length);
+    bool     WriteStorage(const char *pKey, const void *pData, uint32_t length);
+    bool     ReadRetained(void *pData, uint32_t length);
+    bool     WriteRetained(const void *pData, uint32_t length);
+    void     AttachPinChange(uint8_t pin, PinChangeIsr_t pIsr, void *pArg);
+    void     DetachPinChange(uint8_t pin);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Model configuration.
+    //
+    // SetHalfStepsPerRev()  - Actual half steps per motor output shaft rev.
+    //                         Defaults to 4096.  A real 28BYJ-48 is closer to
+    //                         4075.52, which may be used to inject gear ratio
+    //                         error.
+    // SetBacklash()         - Gear train backlash in motor half steps.
+    //                         Defaults to 0.
+    // SetHomeWidthMinutes() - Width of the arc, in dial minutes, over which
+    //                         the reed switch is active.  Defaults to 4.
+    // SetRateLimits()       - Motor pull-in rate, pull-out rate (both in half
+    //                         steps per second), and maximum acceleration (in
+    //                         half steps per second squared).  Defaults to
+    //                         600, 1100, and 6000 respectively.
+    /////////////////////////////////////////////////////////////////////////////
+    void SetHalfStepsPerRev(double halfStepsPerRev) { m_HalfStepsPerRev = halfStepsPerRev; }
+    void SetBacklash(double halfSteps)              { m_BacklashHalfSteps = halfSteps; }
+    void SetHomeWidthMinutes(double minutes)        { m_HomeWidthMinutes = minutes; }
+    void SetRateLimits(double pullIn, double pullOut, double accel)
+                        { m_PullInRate = pullIn; m_PullOutRate = pullOut; m_MaxAccel = accel; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Model state.
+    //
+    // SetDialMinutes()   - Places the dial (and motor) at the specified dial
+    //                      position in minutes past 12:00 (0 to 720).
+    // DialMinutes()      - Returns the current dial position in minutes past
+    //                      12:00 (0 to 720).
+    // IsSensorActive()   - Returns 'true' if the reed switch is active.
+    // MissedSteps()      - Returns the number of commanded steps the motor
+    //                      failed to follow.
+    // MotorSteps()       - Returns the number of half steps the motor has
+    //                      actually moved (absolute), rounded.
+    // Reversals()        - Returns the number of times the rotor has changed
+    //                      direction.
+    /////////////////////////////////////////////////////////////////////////////
+    void     SetDialMinutes(double minutes);
+    double   DialMinutes() const;
+    bool     IsSensorActive() const;
+    uint32_t MissedSteps() const                    { return m_MissedSteps; }
+    uint64_t MotorSteps() const     { return static_cast<uint64_t>(m_MotorHalfSteps + 0.5); }
+    uint32_t Reversals() const                      { return m_Reversals; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Coil hold state.
+    //
+    // HeldPins()  - Returns the pins being held by HoldPins(), if any.
+    // HoldDuty()  - Returns their PWM duty in percent.
+    /////////////////////////////////////////////////////////////////////////////
+    uint32_t HeldPins() const                       { return m_HeldPins; }
+    uint32_t HoldDuty() const                       { return m_HoldDuty; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // PWM coil state.
+    //
+    // DutyPins()  - Returns the phase pins driven by SetPinDuties(), if any.
+    // PhaseDuty() - Returns the duty of phase 'i' (0 to 3, in electrical
+    //               order) if it is in DutyPins().
+    /////////////////////////////////////////////////////////////////////////////
+    uint32_t DutyPins() const                       { return m_DutyPins; }
+    uint32_t PhaseDuty(uint32_t i) const            { return m_PhaseDuty[i]; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Pushbutton control.
+    //
+    // SetButtonPressed() - Presses (true) or releases (false) the button.
+    // PressButtonAt()    - Scripts a press that starts at virtual time 'atUs'
+    //                      and lasts for 'durationUs' microseconds.
+    /////////////////////////////////////////////////////////////////////////////
+    void SetButtonPressed(bool pressed)             { m_ButtonPressed = pressed;
+                                                      CheckPinChanges(); }
+    void PressButtonAt(uint64_t atUs, uint64_t durationUs)
+                        { m_ButtonPressAtUs = atUs; m_ButtonPressEndUs = atUs + durationUs; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Storage control.
+    //
+    // Storage is kept in memory, so it survives as long as the SimulatedHal
+    // instance does.  A "reboot" may be simulated by constructing a new clock
+    // with the same SimulatedHal.
+    //
+    // ClearStorage()     - Erases all stored blocks.
+    // StorageWrites()    - Returns the number of WriteStorage() calls made.
+    // ClearRetained()    - Erases the retained block, as a restart or power
+    //                      loss would.  A deep sleep does not.
+    /////////////////////////////////////////////////////////////////////////////
+    void     ClearStorage();
+    uint32_t StorageWrites() const                  { return m_StorageWrites; }
+    void     ClearRetained()                        { m_RetainedLength = 0; }
+
+private:
+    /////////////////////////////////////////////////////////////////////////////
+    // Private methods.
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    // UpdateRotor()
+    //
+    // Called whenever the phase pins change.  Moves the rotor toward the new
+    // electrical angle if the motor can follow, otherwise records a missed
+    // step.
+    /////////////////////////////////////////////////////////////////////////////
+    void UpdateRotor();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // CheckPinChanges()
+    //
+    // Calls the pin change handler of each input whose level has changed
+    // since the last call.
+    /////////////////////////////////////////////////////////////////////////////
+    void CheckPinChanges();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // AdvanceTo()
+    //
+    // Advances virtual time to 'endUs', stopping at the start and end of any
+    // scripted button press on the way so that its edges are seen on time.
+    /////////////////////////////////////////////////////////////////////////////
+    void AdvanceTo(uint64_t endUs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Unimplemented methods.  We don't want users to try to use these.
+    /////////////////////////////////////////////////////////////////////////////
+    SimulatedHal(SimulatedHal const &);
+    SimulatedHal &operator=(SimulatedHal &hal);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private static constants.
+    /////////////////////////////////////////////////////////////////////////////
+    static const uint32_t NUM_PHASES        = 4;    // Number of motor coils.
+    static const uint32_t MOTOR_REVS_PER_CYCLE = (32 / 8) * (12 / 3);
+                                    // 32:8 gears, 3 hours per main gear rev.
+    static const uint32_t MINUTES_PER_CYCLE = 12 * 60;
+    static const uint64_t NEVER_STEPPED     = ~0ULL; // m_LastStepUs before the
+                                                     // first rotor step.
+    static const uint32_t MAX_STORAGE_BLOCKS = 8;   // Max stored blocks.
+    static const uint32_t MAX_STORAGE_KEY    = 16;  // Max key length + 1.
+    static const uint32_t MAX_STORAGE_BYTES  = 256; // Max bytes per block.
+    static const uint32_t MAX_PIN_CHANGE_ISRS = 4;  // Max attached handlers.
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private types.
+    /////////////////////////////////////////////////////////////////////////////
+
+    // A block of simulated non-volatile storage.
+    struct StorageBlock_t
+    {
+        char     key[MAX_STORAGE_KEY];  // Block name.  Empty if unused.
+        uint32_t length;                // Number of valid bytes.
+        uint8_t  data[MAX_STORAGE_BYTES];
+    };
+
+    // An attached pin change handler.
+    struct PinChange_t
+    {
+        PinChangeIsr_t pIsr;            // Handler, or NULL if unused.
+        void    *pArg;                  // Handler argument.
+        uint8_t  pin;                   // Input pin.
+        bool     level;                 // Level when last checked.
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private instance data.
+    /////////////////////////////////////////////////////////////////////////////
+    uint8_t  m_PhasePins[NUM_PHASES]; // Phase pins in electrical order.
+    bool     m_InvertHome;          // True if home switch is N.O.
+    uint64_t m_PinLevels;           // Current level of every pin.
+    uint32_t m_HeldPins;            // Pins held with PWM.
+    uint32_t m_HoldDuty;            // PWM duty of m_HeldPins (percent).
+    uint32_t m_DutyPins;            // Phase pins driven by SetPinDuties().
+    uint32_t m_PhaseDuty[NUM_PHASES]; // SetPinDuties() duty of each phase.
+
+    double   m_HalfStepsPerRev;     // Actual half steps per motor rev.
+    double   m_BacklashHalfSteps;   // Gear train backlash.
+    double   m_HomeWidthMinutes;    // Reed switch active arc.
+    double   m_PullInRate;          // Max start rate from rest (half steps/s).
+    double   m_PullOutRate;         // Max running rate (half steps/s).
+    double   m_MaxAccel;            // Max acceleration (half steps/s^2).
+
+    double   m_RotorHalfSteps;      // Motor rotor position (unbounded).
+    double   m_DialHalfSteps;       // Dial side of the gear train (unbounded).
+    double   m_RotorRate;           // Rotor rate at the last step (half steps/s).
+    uint64_t m_LastStepUs;          // Virtual time of the last rotor step.
+    uint64_t m_RateFromUs;          // Start of the travel the rate is
+                                    // judged over.
+    double   m_RateFromHalfSteps;   // Rotor position at m_RateFromUs.
+    uint32_t m_MissedSteps;         // Number of steps the rotor did not follow.
+    double   m_MotorHalfSteps;      // Number of half steps actually moved.
+    int32_t  m_Direction;           // Last rotor direction (1, -1, or 0).
+    uint32_t m_Reversals;           // Number of rotor direction changes.
+
+    StorageBlock_t m_Storage[MAX_STORAGE_BLOCKS];
+                                    // Simulated non-volatile storage.
+    uint32_t m_StorageWrites;       // Number of WriteStorage() calls.
+    uint8_t  m_Retained[MAX_RETAINED_BYTES];
+                                    // Simulated retained memory.
+    uint32_t m_RetainedLength;      // Valid bytes in m_Retained, or 0.
+
+    bool     m_ButtonPressed;       // True while the button is held.
+    uint64_t m_ButtonPressAtUs;     // Start of a scripted button press.
+    uint64_t m_ButtonPressEndUs;    // End of a scripted button press.
+    PinChange_t m_PinChanges[MAX_PIN_CHANGE_ISRS];  // Pin change handlers.
+
+}; // End class SimulatedHal
+
+#endif // !ARDUINO
+
+#endif // SIMULATEDHAL_H
@@ -0,0 +1,113 @@
+/////////////////////////////////////////////////////////////////////////////////
+// SpscRing.h
+//
+// Contains the SpscRing template.  This is a fixed size, lock-free ring buffer
+// for exactly one producer and one consumer, which may run on different cores
+// or in interrupt context.  Neither side ever blocks or disables interrupts,
+// so it is safe to push from an ISR and pop from a task.
+//
+// The producer only writes m_Head and the consumer only writes m_Tail.  Each
+// side publishes its index with release ordering after touching the slot, and
+// reads the other side's index with acquire ordering, so a slot is never read
+// before it has been completely written, or overwritten before it has been
+// completely read.
+//
+// Example:
+//      SpscRing<Event_t, 16> ring;
+//      ring.Push(event);               // Producer (e.g. ISR).
+//      while (ring.Pop(event)) {...}   // Consumer (e.g. loop()).
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined SPSCRING_H
+#define SPSCRING_H
+
+#include <stdint.h>             // For standard integer types.
+#include <atomic>               // For std::atomic.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SpscRing template
+//
+// Template arguments:
+//   - T    - Element type.  Must be copyable.
+//   - SIZE - Number of slots.  Must be a power of 2.  Up to SIZE elements may
+//            be queued at once.
+/////////////////////////////////////////////////////////////////////////////////
+template <typename T, uint32_t SIZE>
+class SpscRing
+{
+public:
+    static_assert((SIZE != 0) && ((SIZE & (SIZE - 1)) == 0), "SIZE must be a power of 2.");
+
+    // Constructor.  The ring starts empty.
+    SpscRing() : m_Head(0), m_Tail(0), m_Dropped(0) {}
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Push()
+    //
+    // Producer side.  Appends 'item' and returns 'true', or returns 'false' and
+    // counts a dropped item if the ring is full.
+    /////////////////////////////////////////////////////////////////////////////
+    bool Push(const T &item)
+    {
+        uint32_t head = m_Head.load(std::memory_order_relaxed);
+        if (head - m_Tail.load(std::memory_order_acquire) >= SIZE)
+        {
+            m_Dropped.store(m_Dropped.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
+            return false;
+        }
+        m_Items[head & (SIZE - 1)] = item;
+        m_Head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Pop()
+    //
+    // Consumer side.  Removes the oldest item into 'item' and returns 'true',
+    // or returns 'false' if the ring is empty.
+    /////////////////////////////////////////////////////////////////////////////
+    bool Pop(T &item)
+    {
+        uint32_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail == m_Head.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = m_Items[tail & (SIZE - 1)];
+        m_Tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Count(), Dropped()
+    //
+    // Return the number of queued items (a snapshot, which may be stale by the
+    // time it is used), and the number of items dropped because the ring was
+    // full.
+    /////////////////////////////////////////////////////////////////////////////
+    uint32_t Count() const
+    {
+        return m_Head.load(std::memory_order_acquire) - m_Tail.load(std::memory_order_acquire);
+    }
+    uint32_t Dropped() const    { return m_Dropped.load(std::memory_order_relaxed); }
+
+private:
+    // Unimplemented methods.  We don't want users to try to use these.
+    SpscRing(SpscRing const &);
+    SpscRing &operator=(SpscRing &ring);
+
+    // Free running indices.  They wrap at 2^32, which is a multiple of SIZE.
+    std::atomic<uint32_t> m_Head;       // Next slot to write (producer).
+    std::atomic<uint32_t> m_Tail;       // Next slot to read (consumer).
+    std::atomic<uint32_t> m_Dropped;    // Items dropped (producer).
+    T m_Items[SIZE];                    // The slots.
+
+}; // End class SpscRing
+
+#endif // SPSCRING_H
@@ -0,0 +1,222 @@
+/////////////////////////////////////////////////////////////////////////////////
+// StepIntervalTable.h
+//
+// Contains the StepIntervalTable template.  The template generates, at compile
+// time, the per-step interval tables for every StepperSpeed_t of a given motor
+// configuration (rapid seconds per rev, full steps per rev, and half or full
+// stepping), so that no ramp needs to be computed at run time and the tables
+// live in flash rather than RAM.
+//
+// Each speed is described by a StepRamp_t (see MotionPlanner.h).  StepSlow
+// and StepFast are constant speed, so their ramps are empty.
+//
+// The StepAuto tables are trapezoidal (constant acceleration) since the
+// interval of each step then has a closed form that a C++11 constexpr
+// function can evaluate.  Three profiles are generated, at 1.5, 1.25, and 1.0
+// times the rapid rate, matching the speeds of the board's default run time
+// S-curve profiles.  Install() replaces the planner's run time profiles with
+// these.
+//
+// Example:
+//      typedef StepIntervalTable<8, 2048, true> StepTables;
+//      StepTables::Install(gClock.Planner());
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined STEPINTERVALTABLE_H
+#define STEPINTERVALTABLE_H
+
+#include <stdint.h>             // For standard integer types.
+#include <stddef.h>             // For NULL.
+#include "MotionPlanner.h"      // For MotionPlanner, StepRamp_t ...
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Compile time helpers.  These are implementation details of the
+// StepIntervalTable template and are not meant to be used directly.
+/////////////////////////////////////////////////////////////////////////////////
+namespace StepTableDetail
+{
+    // Square root by Newton's method, usable in C++11 constant expressions.
+    constexpr double SqrtIter(double x, double cur, double prev)
+    {
+        return (cur == prev) ? cur : SqrtIter(x, 0.5 * (cur + x / cur), cur);
+    }
+    constexpr double Sqrt(double x)
+    {
+        return (x <= 0.0) ? 0.0 : SqrtIter(x, 0.5 * (x + 1.0), 0.0);
+    }
+
+    // Time, in seconds, to travel 'x' steps from velocity 'v0' (steps/s) at a
+    // constant acceleration 'a' (steps/s^2).
+    constexpr double TimeAt(double x, double v0, double a)
+    {
+        return (Sqrt(v0 * v0 + 2.0 * a * x) - v0) / a;
+    }
+
+    // Rounds 'us' and limits it to the range 'minUs' to 65535.
+    constexpr uint16_t ClampUs(double us, uint32_t minUs)
+    {
+        return static_cast<uint16_t>((us + 0.5 > 65535.0) ? 65535.0
+                                     : (us + 0.5 < minUs) ? minUs : us + 0.5);
+    }
+
+    // Interval, in microseconds, of ramp step 'k'.  The final step of the ramp
+    // may slightly overshoot the cruise velocity, so intervals are never
+    // allowed to be shorter than the cruise interval.
+    constexpr uint16_t RampIntervalUs(uint32_t k, double v0, double a, uint32_t cruiseUs)
+    {
+        return ClampUs(1.0e6 * (TimeAt(k + 1.0, v0, a) - TimeAt(k, v0, a)), cruiseUs);
+    }
+
+    // Interval, in microseconds, of a step at 'v' steps/s.
+    constexpr uint32_t CruiseUs(uint32_t v)
+    {
+        return (1000000UL + v / 2) / v;
+    }
+
+    // Number of steps needed to accelerate from 'v0' to 'vMax' (at least 1 so
+    // that the table is never empty).
+    constexpr uint32_t RampLength(uint32_t v0, uint32_t vMax, uint32_t a)
+    {
+        return (vMax <= v0) ? 1
+               : (static_cast<uint64_t>(vMax) * vMax - static_cast<uint64_t>(v0) * v0
+                  + 2ULL * a - 1) / (2ULL * a);
+    }
+
+    // Compile time list of table indices (std::index_sequence is C++14).
+    template <uint32_t... I> struct IndexList {};
+    template <uint32_t N, uint32_t... I>
+    struct MakeIndexList : MakeIndexList<N - 1, N - 1, I...> {};
+    template <uint32_t... I>
+    struct MakeIndexList<0, I...> { typedef IndexList<I...> Type; };
+
+    // Trapezoidal ramp table from 'V0' to 'VMAX' at acceleration 'ACCEL'.
+    template <uint32_t V0, uint32_t VMAX, uint32_t ACCEL,
+              typename INDICES = typename MakeIndexList<RampLength(V0, VMAX, ACCEL)>::Type>
+    struct TrapezoidRamp;
+
+    template <uint32_t V0, uint32_t VMAX, uint32_t ACCEL, uint32_t... I>
+    struct TrapezoidRamp<V0, VMAX, ACCEL, IndexList<I...> >
+    {
+        static const uint32_t LENGTH    = sizeof...(I);
+        static const uint32_t CRUISE_US = CruiseUs(VMAX);
+        static constexpr uint16_t TABLE[sizeof...(I)] =
+            { RampIntervalUs(I, static_cast<double>(V0), static_cast<double>(ACCEL),
+                             CruiseUs(VMAX))... };
+    };
+
+    template <uint32_t V0, uint32_t VMAX, uint32_t ACCEL, uint32_t... I>
+    constexpr uint16_t TrapezoidRamp<V0, VMAX, ACCEL, IndexList<I...> >::TABLE[sizeof...(I)];
+
+} // End namespace StepTableDetail.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// StepIntervalTable template
+//
+// Compile time step interval tables for one motor configuration.  The
+// template arguments should be the same values that are given to the
+// GenericClockBoard constructor.
+//
+// Template arguments:
+//   - RAPID_SECONDS_PER_REV - Seconds per output shaft rev at rapid speed.
+//   - FULL_STEPS_PER_REV    - Full steps per output shaft rev.
+//   - HALF_STEPPING         - 'true' if half stepping is used.
+/////////////////////////////////////////////////////////////////////////////////
+template <uint32_t RAPID_SECONDS_PER_REV, uint32_t FULL_STEPS_PER_REV, bool HALF_STEPPING>
+class StepIntervalTable
+{
+public:
+    // Steps per output shaft revolution in the selected stepping mode.
+    static const uint32_t STEPS_PER_REV = FULL_STEPS_PER_REV * (HALF_STEPPING ? 2 : 1);
+
+    // Constant speed intervals, matching the GenericClockBoard.
+    static const uint32_t FAST_US = 1000000UL * RAPID_SECONDS_PER_REV / STEPS_PER_REV;
+    static const uint32_t SLOW_US = FAST_US * 5;
+
+    // StepAuto rates, matching the board's default run time profiles.
+    static const uint32_t RAPID_RATE  = STEPS_PER_REV / RAPID_SECONDS_PER_REV;
+    static const uint32_t START_RATE  = RAPID_RATE / 2;     // Steps/s.
+    static const uint32_t ACCEL       = RAPID_RATE * 8;     // Steps/s^2.
+    static const uint32_t NUM_AUTO_PROFILES = 3;
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SlowRamp(), FastRamp()
+    //
+    // Return the (empty) ramps of the constant speed profiles.
+    /////////////////////////////////////////////////////////////////////////////
+    static StepRamp_t SlowRamp() { StepRamp_t r = { NULL, 0, SLOW_US, 0 }; return r; }
+    static StepRamp_t FastRamp() { StepRamp_t r = { NULL, 0, FAST_US, 0 }; return r; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // AutoProfile(), AutoRamp()
+    //
+    // Return the StepAuto motion profile and ramp with index 'i' (0 is the
+    // fastest).
+    /////////////////////////////////////////////////////////////////////////////
+    static MotionProfile_t AutoProfile(uint32_t i)
+    {
+        MotionProfile_t p = { AutoRate(i), ACCEL, 0 };
+        return p;
+    }
+    static StepRamp_t AutoRamp(uint32_t i)
+    {
+        StepRamp_t r;
+        switch (i)
+        {
+            case 0:  r = MakeRamp<Auto0>(); break;
+            case 1:  r = MakeRamp<Auto1>(); break;
+            default: r = MakeRamp<Auto2>(); break;
+        }
+        return r;
+    }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Install()
+    //
+    // Replaces the profiles of 'planner' with the compile time StepAuto
+    // profiles, and limits the motor to the middle (1.25 times rapid) one, the
+    // same as the board's default.  Must only be called while the stepper is
+    // idle.
+    /////////////////////////////////////////////////////////////////////////////
+    static void Install(MotionPlanner &planner)
+    {
+        planner.ClearProfiles();
+        planner.SetStartVelocity(START_RATE);
+        for (uint32_t i = 0; i < NUM_AUTO_PROFILES; i++)
+        {
+            planner.AddProfile(AutoProfile(i), AutoRamp(i));
+        }
+        planner.SetMotorLimits(AutoRate(1), ACCEL);
+    }
+
+private:
+    // Cruise rate of StepAuto profile 'i'.
+    static uint32_t AutoRate(uint32_t i)
+    {
+        return (i == 0) ? RAPID_RATE * 3 / 2 : (i == 1) ? RAPID_RATE * 5 / 4 : RAPID_RATE;
+    }
+
+    // The generated StepAuto tables.
+    typedef StepTableDetail::TrapezoidRamp<START_RATE, RAPID_RATE * 3 / 2, ACCEL> Auto0;
+    typedef StepTableDetail::TrapezoidRamp<START_RATE, RAPID_RATE * 5 / 4, ACCEL> Auto1;
+    typedef StepTableDetail::TrapezoidRamp<START_RATE, RAPID_RATE,         ACCEL> Auto2;
+
+    // Builds a StepRamp_t from a generated table.
+    template <typename RAMP>
+    static StepRamp_t MakeRamp()
+    {
+        StepRamp_t r = { RAMP::TABLE, RAMP::LENGTH, RAMP::CRUISE_US, 0 };
+        return r;
+    }
+
+    // Not constructable.  All members are static.
+    StepIntervalTable();
+
+}; // End class StepIntervalTable
+
+#endif // STEPINTERVALTABLE_H
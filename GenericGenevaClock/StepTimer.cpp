@@ -0,0 +1,283 @@
+/////////////////////////////////////////////////////////////////////////////////
+// StepTimer.cpp
+//
+// Contains the implementation of the StepTimer class.  This class provides a
+// one-shot microsecond timer used to pace stepper motor phase updates.  See
+// StepTimer.h for more information.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original code.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include <stddef.h>                 // For NULL.
+#include "StepTimer.h"              // For StepTimer class.
+
+#if defined ARDUINO
+
+/////////////////////////////////////////////////////////////////////////////////
+// ESP32 implementation.
+/////////////////////////////////////////////////////////////////////////////////
+
+/////////////////////////////////////////////////////////////////////////////////
+// StepTimer()  (constructor)
+/////////////////////////////////////////////////////////////////////////////////
+StepTimer::StepTimer() : m_pCallback(NULL), m_pArg(NULL), m_Handle(NULL)
+{
+} // End StepTimer().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ~StepTimer()  (destructor)
+/////////////////////////////////////////////////////////////////////////////////
+StepTimer::~StepTimer()
+{
+    if (m_Handle)
+    {
+        esp_timer_stop(m_Handle);
+        esp_timer_delete(m_Handle);
+    }
+} // End ~StepTimer().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Begin()
+//
+// Sets the callback that will be invoked each time the timer expires.  The
+// esp_timer itself is created lazily on the first StartOnce() since instances
+// of this class are often constructed statically, before the esp_timer
+// service is guaranteed to be available.
+/////////////////////////////////////////////////////////////////////////////////
+void StepTimer::Begin(Callback_t pCallback, void *pArg)
+{
+    m_pCallback = pCallback;
+    m_pArg      = pArg;
+} // End Begin().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// StartOnce()
+//
+// Arms the timer to expire once after the specified number of microseconds.
+/////////////////////////////////////////////////////////////////////////////////
+void StepTimer::StartOnce(uint32_t delayUs)
+{
+    if (!m_Handle)
+    {
+        esp_timer_create_args_t args = {};
+        args.callback        = m_pCallback;
+        args.arg             = m_pArg;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name            = "StepTimer";
+        esp_timer_create(&args, &m_Handle);
+    }
+
+    // esp_timer_start_once() fails if the timer is already armed, so always
+    // stop it first.
+    esp_timer_stop(m_Handle);
+    esp_timer_start_once(m_Handle, delayUs);
+} // End StartOnce().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Stop()
+//
+// Disarms the timer.
+/////////////////////////////////////////////////////////////////////////////////
+void StepTimer::Stop()
+{
+    if (m_Handle)
+    {
+        esp_timer_stop(m_Handle);
+    }
+} // End Stop().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// NowUs()
+//
+// Returns the current time in microseconds since boot.
+/////////////////////////////////////////////////////////////////////////////////
+uint64_t StepTimer::NowUs()
+{
+    return static_cast<uint64_t>(esp_timer_get_time());
+} // End NowUs().
+
+
+#else // !ARDUINO
+
+/////////////////////////////////////////////////////////////////////////////////
+// Host stand-in implementation.
+/////////////////////////////////////////////////////////////////////////////////
+
+// StepTimer static definitions.
+StepTimer *StepTimer::s_pHostTimers[MAX_HOST_TIMERS] = { NULL };
+uint64_t   StepTimer::s_HostNowUs = 0;
+StepTimer::HostLatency_t StepTimer::s_pHostLatency = NULL;
+void      *StepTimer::s_pHostLatencyArg = NULL;
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// StepTimer()  (constructor)
+//
+// Registers the new timer so that AdvanceHost() can find it.
+/////////////////////////////////////////////////////////////////////////////////
+StepTimer::StepTimer() :
+    m_pCallback(NULL), m_pArg(NULL), m_DueUs(0), m_Armed(false)
+{
+    for (uint32_t i = 0; i < MAX_HOST_TIMERS; i++)
+    {
+        if (!s_pHostTimers[i])
+        {
+            s_pHostTimers[i] = this;
+            break;
+        }
+    }
+} // End StepTimer().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ~StepTimer()  (destructor)
+//
+// Unregisters the timer.
+/////////////////////////////////////////////////////////////////////////////////
+StepTimer::~StepTimer()
+{
+    for (uint32_t i = 0; i < MAX_HOST_TIMERS; i++)
+    {
+        if (s_pHostTimers[i] == this)
+        {
+            s_pHostTimers[i] = NULL;
+        }
+    }
+} // End ~StepTimer().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Begin()
+//
+// Sets the callback that will be invoked each time the timer expires.
+/////////////////////////////////////////////////////////////////////////////////
+void StepTimer::Begin(Callback_t pCallback, void *pArg)
+{
+    m_pCallback = pCallback;
+    m_pArg      = pArg;
+} // End Begin().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// StartOnce()
+//
+// Arms the timer to expire once after the specified number of virtual
+// microseconds, plus any latency added by SetHostLatency().
+/////////////////////////////////////////////////////////////////////////////////
+void StepTimer::StartOnce(uint32_t delayUs)
+{
+    m_DueUs = s_HostNowUs + delayUs + (s_pHostLatency ? s_pHostLatency(s_pHostLatencyArg) : 0);
+    m_Armed = true;
+} // End StartOnce().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Stop()
+//
+// Disarms the timer.
+/////////////////////////////////////////////////////////////////////////////////
+void StepTimer::Stop()
+{
+    m_Armed = false;
+} // End Stop().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// NowUs()
+//
+// Returns the current virtual time in microseconds.
+/////////////////////////////////////////////////////////////////////////////////
+uint64_t StepTimer::NowUs()
+{
+    return s_HostNowUs;
+} // End NowUs().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// AdvanceHost()
+//
+// Advances virtual time by the specified number of microseconds, firing each
+// timer that comes due in time order.
+/////////////////////////////////////////////////////////////////////////////////
+void StepTimer::AdvanceHost(uint64_t us)
+{
+    const uint64_t endUs = s_HostNowUs + us;
+    while (true)
+    {
+        // Find the earliest armed timer that is due by the end of the interval.
+        StepTimer *pNext = NULL;
+        for (uint32_t i = 0; i < MAX_HOST_TIMERS; i++)
+        {
+            StepTimer *pTimer = s_pHostTimers[i];
+            if (pTimer && pTimer->m_Armed && (pTimer->m_DueUs <= endUs) &&
+                (!pNext || (pTimer->m_DueUs < pNext->m_DueUs)))
+            {
+                pNext = pTimer;
+            }
+        }
+        if (!pNext)
+        {
+            break;
+        }
+
+        // Fire it with the virtual clock set to its due time.
+        if (pNext->m_DueUs > s_HostNowUs)
+        {
+            s_HostNowUs = pNext->m_DueUs;
+        }
+        pNext->m_Armed = false;
+        if (pNext->m_pCallback)
+        {
+            pNext->m_pCallback(pNext->m_pArg);
+        }
+    }
+    s_HostNowUs = endUs;
+} // End AdvanceHost().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// AdvanceHostToNext()
+//
+// Advances virtual time to the next armed timer and fires it.
+/////////////////////////////////////////////////////////////////////////////////
+bool StepTimer::AdvanceHostToNext()
+{
+    StepTimer *pNext = NULL;
+    for (uint32_t i = 0; i < MAX_HOST_TIMERS; i++)
+    {
+        StepTimer *pTimer = s_pHostTimers[i];
+        if (pTimer && pTimer->m_Armed &&
+            (!pNext || (pTimer->m_DueUs < pNext->m_DueUs)))
+        {
+            pNext = pTimer;
+        }
+    }
+    if (!pNext)
+    {
+        return false;
+    }
+    AdvanceHost(pNext->m_DueUs > s_HostNowUs ? pNext->m_DueUs - s_HostNowUs : 0);
+    return true;
+} // End AdvanceHostToNext().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetHostLatency()
+//
+// Sets the function that adds latency to each StartOnce().
+/////////////////////////////////////////////////////////////////////////////////
+void StepTimer::SetHostLatency(HostLatency_t pLatency, void *pArg)
+{
+    s_pHostLatency    = pLatency;
+    s_pHostLatencyArg = pArg;
+} // End SetHostLatency().
+
+#endif // ARDUINO
@@ -0,0 +1,155 @@
+/////////////////////////////////////////////////////////////////////////////////
+// StepTimer.h
+//
+// Contains the StepTimer class.  This class provides a simple one-shot
+// microsecond timer that is used to pace stepper motor phase updates without
+// busy waiting.
+//
+// On the ESP32 the timer is implemented with the esp_timer high resolution
+// timer service.  Callbacks are dispatched from the esp_timer task, so they
+// run at a high priority, but not at interrupt level.
+//
+// When built on a host (i.e. when ARDUINO is not defined), a stand-in is used
+// that keeps a virtual microsecond clock.  Virtual time only advances when
+// AdvanceHost() is called, and any timers that come due are fired in order.
+// This allows the stepper queue logic to be exercised on Linux in virtual
+// time.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined STEPTIMER_H
+#define STEPTIMER_H
+
+#include <stdint.h>             // For standard integer types.
+#if defined ARDUINO
+#include <esp_timer.h>          // For esp_timer high resolution timer.
+#endif
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// StepTimer class
+//
+// One-shot microsecond timer with a user supplied callback.
+/////////////////////////////////////////////////////////////////////////////////
+class StepTimer
+{
+public:
+    // Type of the function that is called when the timer expires.
+    typedef void (*Callback_t)(void *pArg);
+
+    // Constructor.
+    StepTimer();
+
+    // Destructor.
+    ~StepTimer();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Begin()
+    //
+    // Sets the callback that will be invoked each time the timer expires.
+    // Must be called before StartOnce().
+    //
+    // Arguments:
+    //   - pCallback - The function to call when the timer expires.
+    //   - pArg      - An arbitrary argument that is passed to the callback.
+    /////////////////////////////////////////////////////////////////////////////
+    void Begin(Callback_t pCallback, void *pArg);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // StartOnce()
+    //
+    // Arms the timer to expire once after the specified number of microseconds.
+    // Any previously armed expiration is replaced.
+    //
+    // Arguments:
+    //   - delayUs - The number of microseconds until the callback is invoked.
+    /////////////////////////////////////////////////////////////////////////////
+    void StartOnce(uint32_t delayUs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Stop()
+    //
+    // Disarms the timer.  It is harmless to stop a timer that is not armed.
+    /////////////////////////////////////////////////////////////////////////////
+    void Stop();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // NowUs()
+    //
+    // Returns the current time in microseconds.  On the host, this is the
+    // current virtual time.
+    /////////////////////////////////////////////////////////////////////////////
+    static uint64_t NowUs();
+
+#if !defined ARDUINO
+    /////////////////////////////////////////////////////////////////////////////
+    // AdvanceHost()  (host only)
+    //
+    // Advances virtual time by the specified number of microseconds.  Each
+    // timer that comes due during the interval is fired in time order with
+    // the virtual clock set to its due time.  Callbacks may re-arm timers.
+    //
+    // Arguments:
+    //   - us - The number of microseconds to advance virtual time.
+    /////////////////////////////////////////////////////////////////////////////
+    static void AdvanceHost(uint64_t us);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // AdvanceHostToNext()  (host only)
+    //
+    // Advances virtual time to the next armed timer and fires it.  Returns
+    // 'true' if a timer was fired, or 'false' if no timer was armed.
+    /////////////////////////////////////////////////////////////////////////////
+    static bool AdvanceHostToNext();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SetHostLatency()  (host only)
+    //
+    // Makes every timer expire late, as interrupts and higher priority tasks
+    // make the esp_timer task late on the ESP32.  Each StartOnce() adds the
+    // number of microseconds returned by 'pLatency' to the timer's delay.
+    //
+    // Arguments:
+    //   - pLatency - Returns the latency to add.  NULL for no latency.
+    //   - pArg     - An arbitrary argument that is passed to 'pLatency'.
+    /////////////////////////////////////////////////////////////////////////////
+    typedef uint32_t (*HostLatency_t)(void *pArg);
+    static void SetHostLatency(HostLatency_t pLatency, void *pArg);
+#endif
+
+private:
+    /////////////////////////////////////////////////////////////////////////////
+    // Unimplemented methods.  We don't want users to try to use these.
+    /////////////////////////////////////////////////////////////////////////////
+    StepTimer(StepTimer const &);
+    StepTimer &operator=(StepTimer &st);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private instance data.
+    /////////////////////////////////////////////////////////////////////////////
+    Callback_t m_pCallback;         // Function to call on expiration.
+    void      *m_pArg;              // Argument passed to m_pCallback.
+
+#if defined ARDUINO
+    esp_timer_handle_t m_Handle;    // esp_timer handle.  Created on first use.
+#else
+    // Host stand-in data.
+    static const uint32_t MAX_HOST_TIMERS = 8;
+                                    // Max simultaneously constructed timers.
+    static StepTimer *s_pHostTimers[MAX_HOST_TIMERS];
+                                    // All constructed host timers.
+    static uint64_t   s_HostNowUs;  // Current virtual time.
+    static HostLatency_t s_pHostLatency;
+                                    // Added latency, or NULL.
+    static void      *s_pHostLatencyArg;
+                                    // Argument passed to s_pHostLatency.
+    uint64_t m_DueUs;               // Virtual time of next expiration.
+    bool     m_Armed;               // True if an expiration is pending.
+#endif
+
+}; // End class StepTimer
+
+#endif // STEPTIMER_H
@@ -0,0 +1,95 @@
+/////////////////////////////////////////////////////////////////////////////////
+// StepTimingStats.cpp
+//
+// Contains the implementation of the StepTimingStats class.  This keeps
+// fixed size histograms of stepper step intervals.  See StepTimingStats.h for
+// more information.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original code.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>                 // For memset().
+#include "SerialDebugSetup.h"       // For SerialDebug macros.
+#include "StepTimingStats.h"        // For StepTimingStats class.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Reset()
+//
+// Clears all of the statistics.
+/////////////////////////////////////////////////////////////////////////////////
+void StepTimingStats::Reset()
+{
+    memset(m_Speeds, 0, sizeof(m_Speeds));
+} // End Reset().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Record()
+//
+// Records one step of 'speed' that was meant to be held for 'intendedUs' and
+// was actually held for 'actualUs'.
+/////////////////////////////////////////////////////////////////////////////////
+void StepTimingStats::Record(int32_t speed, uint32_t intendedUs, uint32_t actualUs)
+{
+    SpeedStats_t &s = m_Speeds[SpeedIndex(speed)];
+    uint32_t overrunUs = 0;
+    if (actualUs >= intendedUs)
+    {
+        overrunUs = actualUs - intendedUs;
+    }
+    else
+    {
+        s.early++;
+    }
+
+    if (!s.steps || (actualUs < s.minIntervalUs))
+    {
+        s.minIntervalUs = actualUs;
+    }
+    if (actualUs > s.maxIntervalUs)
+    {
+        s.maxIntervalUs = actualUs;
+    }
+    if (overrunUs > s.maxOverrunUs)
+    {
+        s.maxOverrunUs = overrunUs;
+    }
+    s.steps++;
+    s.totalOverrunUs += overrunUs;
+    s.intervals[Bucket(actualUs)]++;
+    s.overruns[Bucket(overrunUs)]++;
+} // End Record().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Report()
+//
+// Logs the statistics of every speed that has recorded steps.
+/////////////////////////////////////////////////////////////////////////////////
+void StepTimingStats::Report() const
+{
+    for (uint32_t i = 0; i < NUM_SPEEDS; i++)
+    {
+        const SpeedStats_t &s = m_Speeds[i];
+        if (!s.steps)
+        {
+            continue;
+        }
+        debugI("Step timing %s: %u steps, %u - %u us, avg overrun %u us, max %u us, %u early",
+            (i == 0) ? "slow" : (i == 1) ? "auto" : "fast", s.steps, s.minIntervalUs,
+            s.maxIntervalUs, static_cast<uint32_t>(s.totalOverrunUs / s.steps),
+            s.maxOverrunUs, s.early);
+        debugI("  from us    intervals  overruns");
+        for (uint32_t b = 0; b < NUM_BUCKETS; b++)
+        {
+            if (s.intervals[b] || s.overruns[b])
+            {
+                debugI("  %7u %12u %9u", BucketLowUs(b), s.intervals[b], s.overruns[b]);
+            }
+        }
+    }
+} // End Report().
@@ -0,0 +1,128 @@
+/////////////////////////////////////////////////////////////////////////////////
+// StepTimingStats.h
+//
+// Contains the StepTimingStats class.  This records how long each stepper
+// step was actually held compared to how long it was meant to be held, so
+// that the effect of WiFi interrupts and other latency on the step timer can
+// be seen.  For each StepperSpeed_t it keeps log2 histograms of the actual
+// step intervals and of their overruns (how much longer than intended they
+// were), plus the worst overrun.  Memory use is fixed.
+//
+// GenericClockBoard only records step timing when STEP_TIMING_STATS is 1.
+// This defaults to 1 on the host and to 0 on the ESP32, where it must be
+// changed below (or defined on the compiler command line) to enable it.  When
+// it is 0 no timing code is compiled into the step timer callback at all.
+//
+// Histogram bucket 0 counts values of 0 us.  Bucket 'b' counts values from
+// 2^(b-1) up to (2^b) - 1 us, and the last bucket also counts everything
+// larger.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined STEPTIMINGSTATS_H
+#define STEPTIMINGSTATS_H
+
+#include <stdint.h>             // For standard integer types.
+
+// Set to 1 to record step timing in GenericClockBoard.
+#if !defined STEP_TIMING_STATS
+#if defined ARDUINO
+#define STEP_TIMING_STATS 0
+#else
+#define STEP_TIMING_STATS 1
+#endif
+#endif
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// StepTimingStats class
+//
+// Step interval histograms for each StepperSpeed_t.
+/////////////////////////////////////////////////////////////////////////////////
+class StepTimingStats
+{
+public:
+    static const uint32_t NUM_SPEEDS  = 3;      // StepSlow, StepAuto, StepFast.
+    static const uint32_t NUM_BUCKETS = 20;     // Last bucket is >= 262144 us.
+
+    // Statistics for one speed.
+    struct SpeedStats_t
+    {
+        uint32_t steps;             // Steps recorded.
+        uint32_t early;             // Steps held for less than intended.
+        uint32_t minIntervalUs;     // Shortest step (0 if none recorded).
+        uint32_t maxIntervalUs;     // Longest step.
+        uint32_t maxOverrunUs;      // Worst overrun.
+        uint64_t totalOverrunUs;    // Sum of all overruns.
+        uint32_t intervals[NUM_BUCKETS];    // Histogram of actual intervals.
+        uint32_t overruns[NUM_BUCKETS];     // Histogram of overruns.
+    };
+
+    // Constructor.  Starts with no steps recorded.
+    StepTimingStats()   { Reset(); }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Reset()
+    //
+    // Clears all of the statistics.
+    /////////////////////////////////////////////////////////////////////////////
+    void Reset();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Record()
+    //
+    // Records one step.  This is called from the step timer callback, so it
+    // is short and does not block.
+    //
+    // Arguments:
+    //   - speed      - The StepperSpeed_t of the step's move.
+    //   - intendedUs - How long the step was meant to be held.
+    //   - actualUs   - How long it was actually held.
+    /////////////////////////////////////////////////////////////////////////////
+    void Record(int32_t speed, uint32_t intendedUs, uint32_t actualUs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Speed()
+    //
+    // Returns the statistics of a StepperSpeed_t.
+    /////////////////////////////////////////////////////////////////////////////
+    const SpeedStats_t &Speed(int32_t speed) const  { return m_Speeds[SpeedIndex(speed)]; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Bucket(), BucketLowUs()
+    //
+    // Bucket() returns the histogram bucket that counts 'us'.  BucketLowUs()
+    // returns the smallest value counted by 'bucket'.
+    /////////////////////////////////////////////////////////////////////////////
+    static uint32_t Bucket(uint32_t us)
+    {
+        uint32_t bucket = us ? 32 - __builtin_clz(us) : 0;
+        return (bucket < NUM_BUCKETS) ? bucket : NUM_BUCKETS - 1;
+    }
+    static uint32_t BucketLowUs(uint32_t bucket)    { return bucket ? 1u << (bucket - 1) : 0; }
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Report()
+    //
+    // Logs the statistics of every speed that has recorded steps, including
+    // the non-empty histogram buckets.
+    /////////////////////////////////////////////////////////////////////////////
+    void Report() const;
+
+
+private:
+    // Returns the m_Speeds index of a StepperSpeed_t (-1, 0, or 1).
+    static uint32_t SpeedIndex(int32_t speed)
+    {
+        return (speed < 0) ? 0 : (speed > 0) ? 2 : 1;
+    }
+
+    SpeedStats_t m_Speeds[NUM_SPEEDS];  // Indexed by SpeedIndex().
+
+}; // End class StepTimingStats.
+
+
+#endif // STEPTIMINGSTATS_H
@@ -0,0 +1,275 @@
+/////////////////////////////////////////////////////////////////////////////////
+// TaskScheduler.cpp
+//
+// Contains the implementation of the TaskScheduler class.  This is a small
+// cooperative scheduler for periodic and triggered tasks.  See TaskScheduler.h
+// for more information.
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original code.
+//
+/////////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>                 // For memset().
+#include "SerialDebugSetup.h"       // For SerialDebug macros.
+#include "TaskScheduler.h"          // For TaskScheduler class.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TaskScheduler()  (constructor)
+//
+// Constructs a scheduler with no tasks.
+//
+// Arguments:
+//   - pHal - The HAL used for time and idle delays.  If NULL, the default HAL
+//            (DefaultClockBoardHal()) is used.
+/////////////////////////////////////////////////////////////////////////////////
+TaskScheduler::TaskScheduler(ClockBoardHal *pHal) :
+    m_pHal(pHal ? pHal : DefaultClockBoardHal()), m_NumTasks(0), m_IdleUs(0),
+    m_StatsStartUs(0)
+{
+    memset(m_Tasks, 0, sizeof(m_Tasks));
+} // End TaskScheduler().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// AddTask()
+//
+// Adds a task.  A periodic task is first due right away.  Returns the task's
+// id, or INVALID_TASK if no more tasks fit.
+/////////////////////////////////////////////////////////////////////////////////
+int32_t TaskScheduler::AddTask(const char *pName, SchedulerTaskFn_t pFn, void *pArg,
+                               uint32_t periodMs, uint32_t deadlineMs, uint8_t priority)
+{
+    if ((m_NumTasks >= MAX_TASKS) || !pFn)
+    {
+        return INVALID_TASK;
+    }
+
+    Task_t &task     = m_Tasks[m_NumTasks];
+    task.pFn         = pFn;
+    task.pArg        = pArg;
+    task.periodUs    = periodMs * 1000;
+    task.deadlineUs  = deadlineMs * 1000;
+    task.priority    = priority;
+    task.due         = (periodMs != 0);
+    task.dueUs       = m_pHal->Micros();
+    memset(&task.stats, 0, sizeof(task.stats));
+    task.stats.pName = pName;
+    return m_NumTasks++;
+} // End AddTask().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Trigger()
+//
+// Makes a task due now, if it is not already due sooner.
+/////////////////////////////////////////////////////////////////////////////////
+void TaskScheduler::Trigger(int32_t task)
+{
+    if ((task < 0) || (static_cast<uint32_t>(task) >= m_NumTasks))
+    {
+        return;
+    }
+    uint64_t now = m_pHal->Micros();
+    Task_t &t = m_Tasks[task];
+    if (!t.due || (t.dueUs > now))
+    {
+        t.due   = true;
+        t.dueUs = now;
+    }
+} // End Trigger().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// RunAt()
+//
+// Makes a task due at 'atUs'.  RunOnce() sleeps in whole milliseconds rounded
+// up, so the task runs within a millisecond after 'atUs' if nothing else is
+// running then.
+/////////////////////////////////////////////////////////////////////////////////
+void TaskScheduler::RunAt(int32_t task, uint64_t atUs)
+{
+    if ((task < 0) || (static_cast<uint32_t>(task) >= m_NumTasks))
+    {
+        return;
+    }
+    m_Tasks[task].due   = true;
+    m_Tasks[task].dueUs = atUs;
+} // End RunAt().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SetPeriod()
+//
+// Changes a task's period.  Takes effect after its next run.
+/////////////////////////////////////////////////////////////////////////////////
+void TaskScheduler::SetPeriod(int32_t task, uint32_t periodMs)
+{
+    if ((task >= 0) && (static_cast<uint32_t>(task) < m_NumTasks))
+    {
+        m_Tasks[task].periodUs = periodMs * 1000;
+    }
+} // End SetPeriod().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// RunOnce()
+//
+// Runs every due task, highest priority first and then earliest deadline
+// first, choosing again after each run since a run takes time and may make
+// other tasks due.  Then sleeps until the next task is due.
+/////////////////////////////////////////////////////////////////////////////////
+void TaskScheduler::RunOnce()
+{
+    for (;;)
+    {
+        uint64_t now  = m_pHal->Micros();
+        int32_t  best = INVALID_TASK;
+        for (uint32_t i = 0; i < m_NumTasks; i++)
+        {
+            const Task_t &t = m_Tasks[i];
+            if (!t.due || (t.dueUs > now))
+            {
+                continue;
+            }
+            if ((best == INVALID_TASK) || (t.priority > m_Tasks[best].priority) ||
+                ((t.priority == m_Tasks[best].priority) &&
+                 (t.dueUs + t.deadlineUs < m_Tasks[best].dueUs + m_Tasks[best].deadlineUs)))
+            {
+                best = i;
+            }
+        }
+        if (best == INVALID_TASK)
+        {
+            break;
+        }
+        RunTask(best);
+    }
+
+    // Nothing is due, so sleep till something is.
+    uint64_t now    = m_pHal->Micros();
+    uint64_t idleUs = static_cast<uint64_t>(MAX_IDLE_MS) * 1000;
+    for (uint32_t i = 0; i < m_NumTasks; i++)
+    {
+        const Task_t &t = m_Tasks[i];
+        if (t.due)
+        {
+            uint64_t untilUs = (t.dueUs > now) ? t.dueUs - now : 0;
+            if (untilUs < idleUs)
+            {
+                idleUs = untilUs;
+            }
+        }
+    }
+    uint32_t idleMs = static_cast<uint32_t>((idleUs + 999) / 1000);
+    if (idleMs)
+    {
+        m_pHal->Delay(idleMs);
+        m_IdleUs += m_pHal->Micros() - now;
+    }
+} // End RunOnce().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// RunTask()
+//
+// Runs a task and updates its statistics.  A periodic task is next due one
+// period after it was last due.  If it ran so late that it is already due
+// again, the missed periods are skipped rather than run back to back.  A
+// triggered task is no longer due once it starts, so a Trigger() or RunAt()
+// it makes on itself while running is kept.
+/////////////////////////////////////////////////////////////////////////////////
+void TaskScheduler::RunTask(uint32_t task)
+{
+    Task_t  &t     = m_Tasks[task];
+    uint64_t dueUs = t.dueUs;
+    if (!t.periodUs)
+    {
+        t.due = false;
+    }
+    uint64_t start = m_pHal->Micros();
+    t.pFn(t.pArg);
+    uint64_t end   = m_pHal->Micros();
+
+    uint32_t latencyUs = static_cast<uint32_t>(start - dueUs);
+    uint32_t runUs     = static_cast<uint32_t>(end - start);
+    t.stats.runs++;
+    t.stats.totalRunUs += runUs;
+    if (runUs > t.stats.maxRunUs)
+    {
+        t.stats.maxRunUs = runUs;
+    }
+    if (latencyUs > t.stats.maxLatencyUs)
+    {
+        t.stats.maxLatencyUs = latencyUs;
+    }
+    if (end - dueUs > t.deadlineUs)
+    {
+        t.stats.deadlineMisses++;
+    }
+
+    if (t.periodUs)
+    {
+        t.dueUs += t.periodUs;
+        if (t.dueUs <= end)
+        {
+            t.dueUs += ((end - t.dueUs) / t.periodUs + 1) * t.periodUs;
+        }
+    }
+} // End RunTask().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// GetStats()
+//
+// Copies a task's statistics.  Returns 'false' if 'task' is invalid.
+/////////////////////////////////////////////////////////////////////////////////
+bool TaskScheduler::GetStats(int32_t task, TaskStats_t &stats) const
+{
+    if ((task < 0) || (static_cast<uint32_t>(task) >= m_NumTasks))
+    {
+        return false;
+    }
+    stats = m_Tasks[task].stats;
+    return true;
+} // End GetStats().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// ResetStats()
+//
+// Clears the statistics of all tasks and the idle time.
+/////////////////////////////////////////////////////////////////////////////////
+void TaskScheduler::ResetStats()
+{
+    for (uint32_t i = 0; i < m_NumTasks; i++)
+    {
+        const char *pName = m_Tasks[i].stats.pName;
+        memset(&m_Tasks[i].stats, 0, sizeof(m_Tasks[i].stats));
+        m_Tasks[i].stats.pName = pName;
+    }
+    m_IdleUs       = 0;
+    m_StatsStartUs = m_pHal->Micros();
+} // End ResetStats().
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// Report()
+//
+// Logs the statistics of every task, and the idle time.
+/////////////////////////////////////////////////////////////////////////////////
+void TaskScheduler::Report()
+{
+    debugI("Task        runs   avg us   max us  max late us  missed");
+    for (uint32_t i = 0; i < m_NumTasks; i++)
+    {
+        debugI("%-8s %7u %8u %8u %12u %7u", m_Tasks[i].stats.pName, m_Tasks[i].stats.runs,
+            m_Tasks[i].stats.runs ? static_cast<uint32_t>(m_Tasks[i].stats.totalRunUs /
+                                                          m_Tasks[i].stats.runs) : 0,
+            m_Tasks[i].stats.maxRunUs, m_Tasks[i].stats.maxLatencyUs,
+            m_Tasks[i].stats.deadlineMisses);
+    }
+    debugI("Idle %u%%", static_cast<uint32_t>(m_IdleUs * 100 / (ElapsedUs() + 1)));
+} // End Report().
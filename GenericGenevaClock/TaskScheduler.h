@@ -0,0 +1,210 @@
+/////////////////////////////////////////////////////////////////////////////////
+// TaskScheduler.h
+//
+// Contains the TaskScheduler class.  This is a small cooperative scheduler for
+// the work that the sketch's loop() used to do in sequence followed by a fixed
+// delay.  Each task is a function with a period, a deadline, and a priority.
+// Whenever tasks are due, the highest priority one runs first (ties go to the
+// earliest deadline), and when none are due the scheduler sleeps until the
+// next one is.
+//
+// Tasks are cooperative: each runs to completion, so one that blocks delays
+// all the others.  Per-task run time, worst case latency (time from when the
+// task became due till it started), and deadline misses are recorded so that
+// slow tasks can be found.
+//
+// Idle time is spent in the HAL's Delay(), which on the ESP32 blocks the loop
+// task.  FreeRTOS then runs its idle task, which clock gates the CPU, and
+// lowers the CPU clock if power management is enabled.  Light sleep is not
+// used, since it would stop the step timer, the coil PWM, and the input
+// interrupts, and drop the WiFi connection.
+//
+// Example:
+//      TaskScheduler scheduler;
+//      scheduler.AddTask("button", CheckButtonTask, NULL, 20, 50, 5);
+//      ...
+//      void loop() { scheduler.RunOnce(); }
+//
+// History:
+//  - agent 16-OCT-2026
+//    Original creation.
+//
+/////////////////////////////////////////////////////////////////////////////////
+#if !defined TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include <stdint.h>             // For standard integer types.
+#include <stddef.h>             // For NULL.
+#include "ClockBoardHal.h"      // For ClockBoardHal hardware abstraction.
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// SchedulerTaskFn_t
+//
+// A scheduled task's function.  'pArg' is the value given to AddTask().
+/////////////////////////////////////////////////////////////////////////////////
+typedef void (*SchedulerTaskFn_t)(void *pArg);
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TaskStats_t
+//
+// Run statistics of one task, as returned by TaskScheduler::GetStats().
+/////////////////////////////////////////////////////////////////////////////////
+struct TaskStats_t
+{
+    const char *pName;          // Task name.
+    uint32_t runs;              // Number of runs.
+    uint32_t deadlineMisses;    // Runs that finished after their deadline.
+    uint64_t totalRunUs;        // Total run time.
+    uint32_t maxRunUs;          // Longest single run.
+    uint32_t maxLatencyUs;      // Longest time from due to started.
+};
+
+
+/////////////////////////////////////////////////////////////////////////////////
+// TaskScheduler class
+//
+// Runs periodic and triggered tasks cooperatively from loop().
+/////////////////////////////////////////////////////////////////////////////////
+class TaskScheduler
+{
+public:
+    static const uint32_t MAX_TASKS    = 10;    // Most tasks that can be added.
+    static const int32_t  INVALID_TASK = -1;    // Returned if AddTask() fails.
+
+    /////////////////////////////////////////////////////////////////////////////
+    // TaskScheduler()  (constructor)
+    //
+    // Arguments:
+    //   - pHal - The HAL used for time and idle delays.  If NULL, the default
+    //            HAL (DefaultClockBoardHal()) is used.
+    /////////////////////////////////////////////////////////////////////////////
+    TaskScheduler(ClockBoardHal *pHal = NULL);
+
+    // Destructor.
+    ~TaskScheduler() {}
+
+    /////////////////////////////////////////////////////////////////////////////
+    // AddTask()
+    //
+    // Adds a task.  A periodic task is first due right away.
+    //
+    // Arguments:
+    //   - pName      - Name used in reports.  Must remain valid.
+    //   - pFn        - Function to run.
+    //   - pArg       - Argument passed to 'pFn'.
+    //   - periodMs   - Time between runs, or 0 for a task that only runs when
+    //                  triggered (see Trigger()).
+    //   - deadlineMs - Time after becoming due by which a run should finish.
+    //   - priority   - Higher values run first.
+    //
+    // Returns:
+    //   Returns the task's id, or INVALID_TASK if no more tasks fit.
+    /////////////////////////////////////////////////////////////////////////////
+    int32_t AddTask(const char *pName, SchedulerTaskFn_t pFn, void *pArg,
+                    uint32_t periodMs, uint32_t deadlineMs, uint8_t priority);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Trigger()
+    //
+    // Makes a task due now, if it is not already due.  Must not be called from
+    // an interrupt or another FreeRTOS task.
+    /////////////////////////////////////////////////////////////////////////////
+    void Trigger(int32_t task);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // RunAt()
+    //
+    // Makes a task due at HAL time 'atUs' (see ClockBoardHal::Micros()),
+    // replacing when it was next due.  Meant for tasks that only run when
+    // triggered, to wake them at an exact time.  Must not be called from an
+    // interrupt or another FreeRTOS task.
+    /////////////////////////////////////////////////////////////////////////////
+    void RunAt(int32_t task, uint64_t atUs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // SetPeriod()
+    //
+    // Changes a task's period.  Takes effect after its next run.
+    /////////////////////////////////////////////////////////////////////////////
+    void SetPeriod(int32_t task, uint32_t periodMs);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // RunOnce()
+    //
+    // Runs every task that is due, highest priority (then earliest deadline)
+    // first, then sleeps until the next task is due, for at most
+    // MAX_IDLE_MS.  Call it repeatedly from loop().
+    /////////////////////////////////////////////////////////////////////////////
+    void RunOnce();
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Statistics.
+    //
+    // GetStats()   - Copies the statistics of task 'task' into 'stats' and
+    //                returns 'true', or returns 'false' if 'task' is invalid.
+    // ResetStats() - Clears the statistics of all tasks and the idle time.
+    // IdleUs()     - Returns the total time spent idle.
+    // ElapsedUs()  - Returns the time since the statistics were reset.
+    // Report()     - Logs the statistics of every task.
+    /////////////////////////////////////////////////////////////////////////////
+    bool     GetStats(int32_t task, TaskStats_t &stats) const;
+    void     ResetStats();
+    uint64_t IdleUs() const                         { return m_IdleUs; }
+    uint64_t ElapsedUs()                            { return m_pHal->Micros() - m_StatsStartUs; }
+    void     Report();
+
+
+protected:
+
+
+private:
+    /////////////////////////////////////////////////////////////////////////////
+    // Private constants.
+    /////////////////////////////////////////////////////////////////////////////
+    static const uint32_t MAX_IDLE_MS = 100;    // Longest single idle sleep.
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private types.
+    /////////////////////////////////////////////////////////////////////////////
+    struct Task_t
+    {
+        SchedulerTaskFn_t pFn;  // Function to run.
+        void    *pArg;          // Its argument.
+        uint32_t periodUs;      // Period, or 0 if triggered only.
+        uint32_t deadlineUs;    // Deadline relative to the due time.
+        uint8_t  priority;      // Higher runs first.
+        bool     due;           // True if 'dueUs' is valid.
+        uint64_t dueUs;         // When the task is next due.
+        TaskStats_t stats;      // Run statistics.
+    };
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private methods.
+    /////////////////////////////////////////////////////////////////////////////
+
+    /////////////////////////////////////////////////////////////////////////////
+    // RunTask()
+    //
+    // Runs task 'task', updates its statistics, and schedules its next run.
+    /////////////////////////////////////////////////////////////////////////////
+    void RunTask(uint32_t task);
+
+    // Unimplemented methods.  We don't want users to try to use these.
+    TaskScheduler(TaskScheduler const &);
+    TaskScheduler &operator=(TaskScheduler &scheduler);
+
+    /////////////////////////////////////////////////////////////////////////////
+    // Private instance data.
+    /////////////////////////////////////////////////////////////////////////////
+    ClockBoardHal *m_pHal;          // Time and delay source.
+    Task_t   m_Tasks[MAX_TASKS];    // The tasks.
+    uint32_t m_NumTasks;            // Number of tasks in m_Tasks.
+    uint64_t m_IdleUs;              // Total idle time since the reset.
+    uint64_t m_StatsStartUs;        // Time of the statistics reset.
+
+}; // End class TaskScheduler.
+
+
+#endif // TASKSCHEDULER_H